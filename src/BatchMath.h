@@ -0,0 +1,341 @@
+#pragma once
+
+// Kernels de matemática em lote sobre arrays SoA (x, y e z em arrays separados), para os
+// laços de CPU que hoje fazem glm um valor por vez:
+//
+//   batchTransform(m, points, out)                      mat4 * vec4 para N pontos
+//   batchComposeTRS(translation, rotation, scale, out)  N matrizes como composeTRS (SceneGraph.h)
+//   batchLength(v, out) / batchNormalize(v, out)        comprimento e normalização de N vec3
+//   batchTransformAABB(m, min, max, outMin, outMax)     N caixas como transformAABB (Bounds.h)
+//
+// O conjunto de instruções é escolhido em tempo de execução (SSE2, AVX2 ou AVX-512F,
+// o melhor que a CPU e o SO suportam); os kernels de cada um são compilados com
+// atributos de alvo, sem precisar de -mavx2 no build. setBatchIsa() força um nível
+// menor (comparações e benchmarks). Fora de x86 só existe o caminho escalar.
+//
+// A ordem das operações é a mesma da glm e dos helpers escalares, e nenhum caminho usa
+// FMA (o AVX-512 soma e multiplica com as instruções de arredondamento explícito, que o
+// compilador não funde), então transform, length, normalize e AABB dão os mesmos bits
+// da glm compilada sem FMA. Em batchComposeTRS seno e cosseno vêm de um polinômio
+// (erro ~3e-7), não da libm. ./Tests simd compara cada kernel em cada nível com a
+// glm; ./Benchmarks simd mede o ganho.
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CG_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CG_BATCH_TARGET_SSE2
+#define CG_BATCH_TARGET_AVX2
+#define CG_BATCH_TARGET_AVX512
+#define CG_BATCH_NOINLINE
+#else
+#define CG_BATCH_TARGET_SSE2 __attribute__((target("sse2")))
+#define CG_BATCH_TARGET_AVX2 __attribute__((target("avx2")))
+#define CG_BATCH_TARGET_AVX512 __attribute__((target("avx512f")))
+// Os laços escalares não podem ser embutidos nos kernels AVX-512: com o alvo deles o
+// compilador passaria a fundir as operações em FMA e as sobras mudariam de resultado
+#define CG_BATCH_NOINLINE __attribute__((noinline))
+#endif
+#else
+#define CG_BATCH_NOINLINE
+#endif
+
+// vec3/vec4 em SoA
+struct Vec3Array {
+    std::vector<float> x, y, z;
+
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+    size_t size() const { return x.size(); }
+    glm::vec3 get(size_t i) const { return glm::vec3(x[i], y[i], z[i]); }
+    void set(size_t i, const glm::vec3& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; }
+};
+
+struct Vec4Array {
+    std::vector<float> x, y, z, w;
+
+    void resize(size_t n) { x.resize(n); y.resize(n); z.resize(n); w.resize(n); }
+    size_t size() const { return x.size(); }
+    glm::vec4 get(size_t i) const { return glm::vec4(x[i], y[i], z[i], w[i]); }
+    void set(size_t i, const glm::vec4& v) { x[i] = v.x; y[i] = v.y; z[i] = v.z; w[i] = v.w; }
+};
+
+enum class BatchIsa { Scalar, Sse2, Avx2, Avx512 };
+
+inline const char* batchIsaName(BatchIsa isa) {
+    switch (isa) {
+        case BatchIsa::Sse2: return "sse2";
+        case BatchIsa::Avx2: return "avx2";
+        case BatchIsa::Avx512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+// Melhor nível suportado pela CPU e pelo SO (registradores salvos no troca de contexto)
+inline BatchIsa batchIsaSupported() {
+#if !defined(CG_BATCH_X86)
+    return BatchIsa::Scalar;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28));
+    unsigned long long xcr0 = osAvx ? _xgetbv(0) : 0;
+    if (maxLeaf < 7 || (xcr0 & 0x6) != 0x6) return BatchIsa::Sse2;
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6) return BatchIsa::Avx512;
+    if (info[1] & (1 << 5)) return BatchIsa::Avx2;
+    return BatchIsa::Sse2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return BatchIsa::Avx512;
+    if (__builtin_cpu_supports("avx2")) return BatchIsa::Avx2;
+    if (__builtin_cpu_supports("sse2")) return BatchIsa::Sse2;
+    return BatchIsa::Scalar;
+#endif
+}
+
+namespace batch_detail {
+
+inline BatchIsa& currentIsa() {
+    static BatchIsa isa = batchIsaSupported();
+    return isa;
+}
+
+// Constantes da redução de argumento de sin/cos: pi/2 em três partes (Cody-Waite)
+const float TwoOverPi = 0.636619772f;
+const float HalfPi1 = 1.5703125f, HalfPi2 = 4.837512969970703125e-4f, HalfPi3 = 7.54978995489188216e-8f;
+const float DegreesToRadians = static_cast<float>(0.01745329251994329576923690768489);   // o mesmo de glm::radians
+
+// Caminho escalar (fora de x86 e nas sobras dos laços vetoriais), na ordem da glm
+CG_BATCH_NOINLINE inline void transformScalar(const glm::mat4& m, const float* x, const float* y, const float* z, const float* w,
+                            float* ox, float* oy, float* oz, float* ow, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec4 r = m * glm::vec4(x[i], y[i], z[i], w[i]);
+        ox[i] = r.x; oy[i] = r.y; oz[i] = r.z; ow[i] = r.w;
+    }
+}
+
+CG_BATCH_NOINLINE inline void lengthScalar(const float* x, const float* y, const float* z, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        out[i] = glm::length(glm::vec3(x[i], y[i], z[i]));
+}
+
+CG_BATCH_NOINLINE inline void normalizeScalar(const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 r = glm::normalize(glm::vec3(x[i], y[i], z[i]));
+        ox[i] = r.x; oy[i] = r.y; oz[i] = r.z;
+    }
+}
+
+// Mesmo polinômio dos caminhos vetoriais, para as sobras darem o mesmo resultado
+inline void sinCosScalar(float degrees, float& s, float& c) {
+    float x = degrees * DegreesToRadians;
+    float j = std::nearbyint(x * TwoOverPi);
+    float r = ((x - j * HalfPi1) - j * HalfPi2) - j * HalfPi3;
+    float z = r * r;
+    float sinR = r + r * z * (-1.6666654611e-1f + z * (8.3321608736e-3f + z * -1.9515295891e-4f));
+    float cosR = 1.0f - 0.5f * z + z * z * (4.166664568298827e-2f + z * (-1.388731625493765e-3f + z * 2.443315711809948e-5f));
+    int quadrant = (int)j;
+    s = (quadrant & 1) ? cosR : sinR;
+    c = (quadrant & 1) ? sinR : cosR;
+    if (quadrant & 2) s = -s;
+    if ((quadrant + 1) & 2) c = -c;
+}
+
+CG_BATCH_NOINLINE inline void composeTRSScalar(const float* tx, const float* ty, const float* tz, const float* rx, const float* ry, const float* rz,
+                             const float* scx, const float* scy, const float* scz, glm::mat4* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float sx, cx, sy, cy, sz, cz;
+        sinCosScalar(rx[i], sx, cx);
+        sinCosScalar(ry[i], sy, cy);
+        sinCosScalar(rz[i], sz, cz);
+        glm::mat4& m = out[i];
+        m[0] = glm::vec4(cy * cz * scx[i], (sx * sy * cz + cx * sz) * scx[i], (-cx * sy * cz + sx * sz) * scx[i], 0.0f);
+        m[1] = glm::vec4(-cy * sz * scy[i], (-sx * sy * sz + cx * cz) * scy[i], (cx * sy * sz + sx * cz) * scy[i], 0.0f);
+        m[2] = glm::vec4(sy * scz[i], -sx * cy * scz[i], cx * cy * scz[i], 0.0f);
+        m[3] = glm::vec4(tx[i], ty[i], tz[i], 1.0f);
+    }
+}
+
+// Como transformAABB (Bounds.h): centro e extensões, com |m| nas extensões
+CG_BATCH_NOINLINE inline void transformAABBScalar(const glm::mat4& m, const float* minX, const float* minY, const float* minZ,
+                                const float* maxX, const float* maxY, const float* maxZ,
+                                float* outMinX, float* outMinY, float* outMinZ, float* outMaxX, float* outMaxY, float* outMaxZ, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 low(minX[i], minY[i], minZ[i]), high(maxX[i], maxY[i], maxZ[i]);
+        glm::vec3 c = (low + high) * 0.5f;
+        glm::vec3 e = (high - low) * 0.5f;
+        glm::vec3 center = glm::vec3(m * glm::vec4(c, 1.0f));
+        glm::vec3 extents(
+            std::fabs(m[0][0]) * e.x + std::fabs(m[1][0]) * e.y + std::fabs(m[2][0]) * e.z,
+            std::fabs(m[0][1]) * e.x + std::fabs(m[1][1]) * e.y + std::fabs(m[2][1]) * e.z,
+            std::fabs(m[0][2]) * e.x + std::fabs(m[1][2]) * e.y + std::fabs(m[2][2]) * e.z);
+        outMinX[i] = center.x - extents.x; outMinY[i] = center.y - extents.y; outMinZ[i] = center.z - extents.z;
+        outMaxX[i] = center.x + extents.x; outMaxY[i] = center.y + extents.y; outMaxZ[i] = center.z + extents.z;
+    }
+}
+
+#ifdef CG_BATCH_X86
+
+// Operações de cada nível com a mesma interface; os kernels (BatchMathKernels.h) são
+// escritos uma vez e compilados para cada um
+struct Sse2 {
+    typedef __m128 T;
+    typedef __m128 Mask;
+    static const int Width = 4;
+    CG_BATCH_TARGET_SSE2 static T load(const float* p) { return _mm_loadu_ps(p); }
+    CG_BATCH_TARGET_SSE2 static void store(float* p, T a) { _mm_storeu_ps(p, a); }
+    CG_BATCH_TARGET_SSE2 static T set1(float s) { return _mm_set1_ps(s); }
+    CG_BATCH_TARGET_SSE2 static T add(T a, T b) { return _mm_add_ps(a, b); }
+    CG_BATCH_TARGET_SSE2 static T sub(T a, T b) { return _mm_sub_ps(a, b); }
+    CG_BATCH_TARGET_SSE2 static T mul(T a, T b) { return _mm_mul_ps(a, b); }
+    CG_BATCH_TARGET_SSE2 static T div(T a, T b) { return _mm_div_ps(a, b); }
+    CG_BATCH_TARGET_SSE2 static T sqrt(T a) { return _mm_sqrt_ps(a); }
+    CG_BATCH_TARGET_SSE2 static T neg(T a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+    CG_BATCH_TARGET_SSE2 static T roundNearest(T a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+    // Faixas em que o inteiro (já arredondado) tem o bit ligado
+    CG_BATCH_TARGET_SSE2 static Mask hasBit(T rounded, int bit) {
+        __m128i b = _mm_set1_epi32(bit);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_cvtps_epi32(rounded), b), b));
+    }
+    CG_BATCH_TARGET_SSE2 static T select(Mask m, T a, T b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+};
+
+struct Avx2 {
+    typedef __m256 T;
+    typedef __m256 Mask;
+    static const int Width = 8;
+    CG_BATCH_TARGET_AVX2 static T load(const float* p) { return _mm256_loadu_ps(p); }
+    CG_BATCH_TARGET_AVX2 static void store(float* p, T a) { _mm256_storeu_ps(p, a); }
+    CG_BATCH_TARGET_AVX2 static T set1(float s) { return _mm256_set1_ps(s); }
+    CG_BATCH_TARGET_AVX2 static T add(T a, T b) { return _mm256_add_ps(a, b); }
+    CG_BATCH_TARGET_AVX2 static T sub(T a, T b) { return _mm256_sub_ps(a, b); }
+    CG_BATCH_TARGET_AVX2 static T mul(T a, T b) { return _mm256_mul_ps(a, b); }
+    CG_BATCH_TARGET_AVX2 static T div(T a, T b) { return _mm256_div_ps(a, b); }
+    CG_BATCH_TARGET_AVX2 static T sqrt(T a) { return _mm256_sqrt_ps(a); }
+    CG_BATCH_TARGET_AVX2 static T neg(T a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+    CG_BATCH_TARGET_AVX2 static T roundNearest(T a) { return _mm256_cvtepi32_ps(_mm256_cvtps_epi32(a)); }
+    CG_BATCH_TARGET_AVX2 static Mask hasBit(T rounded, int bit) {
+        __m256i b = _mm256_set1_epi32(bit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_cvtps_epi32(rounded), b), b));
+    }
+    CG_BATCH_TARGET_AVX2 static T select(Mask m, T a, T b) { return _mm256_blendv_ps(b, a, m); }
+};
+
+// add/sub/mul com arredondamento explícito: o compilador não os funde em FMA (a forma
+// com máscara zero, aqui e nas conversões, evita o aviso de valor indefinido do GCC)
+struct Avx512 {
+    typedef __m512 T;
+    typedef __mmask16 Mask;
+    static const int Width = 16;
+    static const Mask All = 0xFFFF;
+    CG_BATCH_TARGET_AVX512 static T load(const float* p) { return _mm512_loadu_ps(p); }
+    CG_BATCH_TARGET_AVX512 static void store(float* p, T a) { _mm512_storeu_ps(p, a); }
+    CG_BATCH_TARGET_AVX512 static T set1(float s) { return _mm512_set1_ps(s); }
+    CG_BATCH_TARGET_AVX512 static T add(T a, T b) { return _mm512_maskz_add_round_ps(All, a, b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    CG_BATCH_TARGET_AVX512 static T sub(T a, T b) { return _mm512_maskz_sub_round_ps(All, a, b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    CG_BATCH_TARGET_AVX512 static T mul(T a, T b) { return _mm512_maskz_mul_round_ps(All, a, b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    CG_BATCH_TARGET_AVX512 static T div(T a, T b) { return _mm512_div_ps(a, b); }
+    CG_BATCH_TARGET_AVX512 static T sqrt(T a) { return _mm512_maskz_sqrt_ps(All, a); }
+    CG_BATCH_TARGET_AVX512 static T neg(T a) {
+        return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32((int)0x80000000u)));
+    }
+    CG_BATCH_TARGET_AVX512 static T roundNearest(T a) { return _mm512_maskz_cvtepi32_ps(All, _mm512_maskz_cvtps_epi32(All, a)); }
+    CG_BATCH_TARGET_AVX512 static Mask hasBit(T rounded, int bit) {
+        return _mm512_test_epi32_mask(_mm512_maskz_cvtps_epi32(All, rounded), _mm512_set1_epi32(bit));
+    }
+    CG_BATCH_TARGET_AVX512 static T select(Mask m, T a, T b) { return _mm512_mask_blend_ps(m, b, a); }
+};
+
+#endif
+
+} // namespace batch_detail
+
+#ifdef CG_BATCH_X86
+#define CG_BATCH_NS batch_sse2
+#define CG_BATCH_V batch_detail::Sse2
+#define CG_BATCH_TARGET CG_BATCH_TARGET_SSE2
+#include "BatchMathKernels.h"
+#define CG_BATCH_NS batch_avx2
+#define CG_BATCH_V batch_detail::Avx2
+#define CG_BATCH_TARGET CG_BATCH_TARGET_AVX2
+#include "BatchMathKernels.h"
+#define CG_BATCH_NS batch_avx512
+#define CG_BATCH_V batch_detail::Avx512
+#define CG_BATCH_TARGET CG_BATCH_TARGET_AVX512
+#include "BatchMathKernels.h"
+#endif
+
+inline BatchIsa batchIsa() { return batch_detail::currentIsa(); }
+
+// Força um nível (limitado ao suportado); devolve o que ficou valendo
+inline BatchIsa setBatchIsa(BatchIsa isa) {
+    BatchIsa supported = batchIsaSupported();
+    batch_detail::currentIsa() = (int)isa <= (int)supported ? isa : supported;
+    return batch_detail::currentIsa();
+}
+
+#ifdef CG_BATCH_X86
+#define CG_BATCH_DISPATCH(call)                                         \
+    switch (batch_detail::currentIsa()) {                               \
+        case BatchIsa::Avx512: batch_avx512::call; return;              \
+        case BatchIsa::Avx2: batch_avx2::call; return;                  \
+        case BatchIsa::Sse2: batch_sse2::call; return;                  \
+        default: break;                                                 \
+    }
+#else
+#define CG_BATCH_DISPATCH(call)
+#endif
+
+// out[i] = m * in[i]; out pode ser o próprio in
+inline void batchTransform(const glm::mat4& m, const Vec4Array& in, Vec4Array& out) {
+    size_t n = in.size();
+    out.resize(n);
+    CG_BATCH_DISPATCH(transform(m, in.x.data(), in.y.data(), in.z.data(), in.w.data(), out.x.data(), out.y.data(), out.z.data(), out.w.data(), n))
+    batch_detail::transformScalar(m, in.x.data(), in.y.data(), in.z.data(), in.w.data(), out.x.data(), out.y.data(), out.z.data(), out.w.data(), n);
+}
+
+// out[i] = composeTRS({translation[i], rotation[i] (graus), scale[i]}); out com N matrizes
+inline void batchComposeTRS(const Vec3Array& translation, const Vec3Array& rotation, const Vec3Array& scale, glm::mat4* out) {
+    size_t n = translation.size();
+    CG_BATCH_DISPATCH(composeTRS(translation.x.data(), translation.y.data(), translation.z.data(), rotation.x.data(), rotation.y.data(),
+                                 rotation.z.data(), scale.x.data(), scale.y.data(), scale.z.data(), out, n))
+    batch_detail::composeTRSScalar(translation.x.data(), translation.y.data(), translation.z.data(), rotation.x.data(), rotation.y.data(),
+                                   rotation.z.data(), scale.x.data(), scale.y.data(), scale.z.data(), out, n);
+}
+
+inline void batchLength(const Vec3Array& v, std::vector<float>& out) {
+    size_t n = v.size();
+    out.resize(n);
+    CG_BATCH_DISPATCH(length(v.x.data(), v.y.data(), v.z.data(), out.data(), n))
+    batch_detail::lengthScalar(v.x.data(), v.y.data(), v.z.data(), out.data(), n);
+}
+
+// Como glm::normalize (vetor nulo dá NaN); out pode ser o próprio v
+inline void batchNormalize(const Vec3Array& v, Vec3Array& out) {
+    size_t n = v.size();
+    out.resize(n);
+    CG_BATCH_DISPATCH(normalize(v.x.data(), v.y.data(), v.z.data(), out.x.data(), out.y.data(), out.z.data(), n))
+    batch_detail::normalizeScalar(v.x.data(), v.y.data(), v.z.data(), out.x.data(), out.y.data(), out.z.data(), n);
+}
+
+// Caixas (min, max) transformadas por m, como transformAABB
+inline void batchTransformAABB(const glm::mat4& m, const Vec3Array& min, const Vec3Array& max, Vec3Array& outMin, Vec3Array& outMax) {
+    size_t n = min.size();
+    outMin.resize(n);
+    outMax.resize(n);
+    CG_BATCH_DISPATCH(transformAABB(m, min.x.data(), min.y.data(), min.z.data(), max.x.data(), max.y.data(), max.z.data(), outMin.x.data(),
+                                    outMin.y.data(), outMin.z.data(), outMax.x.data(), outMax.y.data(), outMax.z.data(), n))
+    batch_detail::transformAABBScalar(m, min.x.data(), min.y.data(), min.z.data(), max.x.data(), max.y.data(), max.z.data(), outMin.x.data(),
+                                      outMin.y.data(), outMin.z.data(), outMax.x.data(), outMax.y.data(), outMax.z.data(), n);
+}
+
+#undef CG_BATCH_DISPATCH
@@ -0,0 +1,142 @@
+// Sem #pragma once: BatchMath.h inclui este arquivo uma vez por nível de SIMD, com
+// CG_BATCH_NS (namespace), CG_BATCH_V (operações, batch_detail::Sse2/Avx2/Avx512) e
+// CG_BATCH_TARGET (atributo de alvo) definidos. As sobras de cada laço vão para o
+// caminho escalar de batch_detail.
+
+namespace CG_BATCH_NS {
+
+typedef CG_BATCH_V V;
+typedef V::T T;
+
+CG_BATCH_TARGET inline void transform(const glm::mat4& m, const float* x, const float* y, const float* z, const float* w,
+                                      float* ox, float* oy, float* oz, float* ow, size_t n) {
+    T c[4][4];
+    for (int col = 0; col < 4; ++col)
+        for (int row = 0; row < 4; ++row)
+            c[col][row] = V::set1(m[col][row]);
+
+    size_t i = 0;
+    for (; i + V::Width <= n; i += V::Width) {
+        T vx = V::load(x + i), vy = V::load(y + i), vz = V::load(z + i), vw = V::load(w + i);
+        float* out[4] = { ox + i, oy + i, oz + i, ow + i };
+        for (int row = 0; row < 4; ++row)
+            V::store(out[row], V::add(V::add(V::mul(c[0][row], vx), V::mul(c[1][row], vy)),
+                                      V::add(V::mul(c[2][row], vz), V::mul(c[3][row], vw))));
+    }
+    batch_detail::transformScalar(m, x + i, y + i, z + i, w + i, ox + i, oy + i, oz + i, ow + i, n - i);
+}
+
+CG_BATCH_TARGET inline T dot3(T x, T y, T z) {
+    return V::add(V::add(V::mul(x, x), V::mul(y, y)), V::mul(z, z));
+}
+
+CG_BATCH_TARGET inline void length(const float* x, const float* y, const float* z, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + V::Width <= n; i += V::Width)
+        V::store(out + i, V::sqrt(dot3(V::load(x + i), V::load(y + i), V::load(z + i))));
+    batch_detail::lengthScalar(x + i, y + i, z + i, out + i, n - i);
+}
+
+CG_BATCH_TARGET inline void normalize(const float* x, const float* y, const float* z, float* ox, float* oy, float* oz, size_t n) {
+    T one = V::set1(1.0f);
+    size_t i = 0;
+    for (; i + V::Width <= n; i += V::Width) {
+        T vx = V::load(x + i), vy = V::load(y + i), vz = V::load(z + i);
+        T inv = V::div(one, V::sqrt(dot3(vx, vy, vz)));
+        V::store(ox + i, V::mul(vx, inv));
+        V::store(oy + i, V::mul(vy, inv));
+        V::store(oz + i, V::mul(vz, inv));
+    }
+    batch_detail::normalizeScalar(x + i, y + i, z + i, ox + i, oy + i, oz + i, n - i);
+}
+
+// Mesmo algoritmo de batch_detail::sinCosScalar, com o quadrante escolhido por máscara
+CG_BATCH_TARGET inline void sinCos(T degrees, T& s, T& c) {
+    T x = V::mul(degrees, V::set1(batch_detail::DegreesToRadians));
+    T j = V::roundNearest(V::mul(x, V::set1(batch_detail::TwoOverPi)));
+    T r = V::sub(V::sub(V::sub(x, V::mul(j, V::set1(batch_detail::HalfPi1))), V::mul(j, V::set1(batch_detail::HalfPi2))),
+                 V::mul(j, V::set1(batch_detail::HalfPi3)));
+    T z = V::mul(r, r);
+    T sinPoly = V::add(V::set1(-1.6666654611e-1f), V::mul(z, V::add(V::set1(8.3321608736e-3f), V::mul(z, V::set1(-1.9515295891e-4f)))));
+    T sinR = V::add(r, V::mul(V::mul(r, z), sinPoly));
+    T cosPoly = V::add(V::set1(4.166664568298827e-2f),
+                       V::mul(z, V::add(V::set1(-1.388731625493765e-3f), V::mul(z, V::set1(2.443315711809948e-5f)))));
+    T cosR = V::add(V::sub(V::set1(1.0f), V::mul(V::set1(0.5f), z)), V::mul(V::mul(z, z), cosPoly));
+
+    V::Mask swap = V::hasBit(j, 1);
+    s = V::select(swap, cosR, sinR);
+    c = V::select(swap, sinR, cosR);
+    s = V::select(V::hasBit(j, 2), V::neg(s), s);
+    c = V::select(V::hasBit(V::add(j, V::set1(1.0f)), 2), V::neg(c), c);
+}
+
+CG_BATCH_TARGET inline void composeTRS(const float* tx, const float* ty, const float* tz, const float* rx, const float* ry, const float* rz,
+                                       const float* scx, const float* scy, const float* scz, glm::mat4* out, size_t n) {
+    // Colunas 0..2 (x, y, z) de cada faixa, escritas depois para as matrizes
+    alignas(64) float cols[9][V::Width];
+    size_t i = 0;
+    for (; i + V::Width <= n; i += V::Width) {
+        T sx, cx, sy, cy, sz, cz;
+        sinCos(V::load(rx + i), sx, cx);
+        sinCos(V::load(ry + i), sy, cy);
+        sinCos(V::load(rz + i), sz, cz);
+        T vsx = V::load(scx + i), vsy = V::load(scy + i), vsz = V::load(scz + i);
+
+        V::store(cols[0], V::mul(V::mul(cy, cz), vsx));
+        V::store(cols[1], V::mul(V::add(V::mul(V::mul(sx, sy), cz), V::mul(cx, sz)), vsx));
+        V::store(cols[2], V::mul(V::add(V::mul(V::mul(V::neg(cx), sy), cz), V::mul(sx, sz)), vsx));
+        V::store(cols[3], V::mul(V::mul(V::neg(cy), sz), vsy));
+        V::store(cols[4], V::mul(V::add(V::mul(V::mul(V::neg(sx), sy), sz), V::mul(cx, cz)), vsy));
+        V::store(cols[5], V::mul(V::add(V::mul(V::mul(cx, sy), sz), V::mul(sx, cz)), vsy));
+        V::store(cols[6], V::mul(sy, vsz));
+        V::store(cols[7], V::mul(V::mul(V::neg(sx), cy), vsz));
+        V::store(cols[8], V::mul(V::mul(cx, cy), vsz));
+
+        for (int lane = 0; lane < V::Width; ++lane) {
+            glm::mat4& m = out[i + lane];
+            m[0] = glm::vec4(cols[0][lane], cols[1][lane], cols[2][lane], 0.0f);
+            m[1] = glm::vec4(cols[3][lane], cols[4][lane], cols[5][lane], 0.0f);
+            m[2] = glm::vec4(cols[6][lane], cols[7][lane], cols[8][lane], 0.0f);
+            m[3] = glm::vec4(tx[i + lane], ty[i + lane], tz[i + lane], 1.0f);
+        }
+    }
+    batch_detail::composeTRSScalar(tx + i, ty + i, tz + i, rx + i, ry + i, rz + i, scx + i, scy + i, scz + i, out + i, n - i);
+}
+
+CG_BATCH_TARGET inline void transformAABB(const glm::mat4& m, const float* minX, const float* minY, const float* minZ,
+                                          const float* maxX, const float* maxY, const float* maxZ,
+                                          float* outMinX, float* outMinY, float* outMinZ, float* outMaxX, float* outMaxY, float* outMaxZ, size_t n) {
+    T c[4][3], a[3][3];
+    for (int col = 0; col < 4; ++col)
+        for (int row = 0; row < 3; ++row) {
+            c[col][row] = V::set1(m[col][row]);
+            if (col < 3) a[col][row] = V::set1(std::fabs(m[col][row]));
+        }
+    T half = V::set1(0.5f);
+
+    size_t i = 0;
+    for (; i + V::Width <= n; i += V::Width) {
+        T lowX = V::load(minX + i), lowY = V::load(minY + i), lowZ = V::load(minZ + i);
+        T highX = V::load(maxX + i), highY = V::load(maxY + i), highZ = V::load(maxZ + i);
+        T cx = V::mul(V::add(lowX, highX), half), cy = V::mul(V::add(lowY, highY), half), cz = V::mul(V::add(lowZ, highZ), half);
+        T ex = V::mul(V::sub(highX, lowX), half), ey = V::mul(V::sub(highY, lowY), half), ez = V::mul(V::sub(highZ, lowZ), half);
+
+        float* outMin[3] = { outMinX + i, outMinY + i, outMinZ + i };
+        float* outMax[3] = { outMaxX + i, outMaxY + i, outMaxZ + i };
+        for (int row = 0; row < 3; ++row) {
+            // Centro como m * vec4(c, 1) (w = 1 soma a coluna 3 inteira)
+            T center = V::add(V::add(V::mul(c[0][row], cx), V::mul(c[1][row], cy)), V::add(V::mul(c[2][row], cz), c[3][row]));
+            T extent = V::add(V::add(V::mul(a[0][row], ex), V::mul(a[1][row], ey)), V::mul(a[2][row], ez));
+            V::store(outMin[row], V::sub(center, extent));
+            V::store(outMax[row], V::add(center, extent));
+        }
+    }
+    batch_detail::transformAABBScalar(m, minX + i, minY + i, minZ + i, maxX + i, maxY + i, maxZ + i, outMinX + i, outMinY + i, outMinZ + i,
+                                      outMaxX + i, outMaxY + i, outMaxZ + i, n - i);
+}
+
+} // namespace CG_BATCH_NS
+
+#undef CG_BATCH_NS
+#undef CG_BATCH_V
+#undef CG_BATCH_TARGET
@@ -0,0 +1,964 @@
+// Benchmarks de CPU das estruturas compartilhadas pelos exercícios.
+// Uso: Benchmarks [nome...]   (sem argumentos executa todos)
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BatchMath.h"
+#include "Bvh.h"
+#include "LightClusters.h"
+#include "MeshNormals.h"
+#include "NumberParse.h"
+#include "ObjMaterials.h"
+#include "ObjMesh.h"
+#include "ObjStream.h"
+#include "OcclusionCuller.h"
+#include "RayTracer.h"
+#include "RenderQueue.h"
+#include "SceneGraph.h"
+#include "ShapeGenerator.h"
+#include "SpatialGrid.h"
+#include "Trace.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+double elapsedMs(Clock::time_point start) {
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+void printRate(const string& label, double count, double ms) {
+    cout << "  " << label << ": " << ms << " ms (" << (count / (ms / 1000.0)) / 1e6 << " M/s)" << endl;
+}
+
+// Cena sintética: N cubos de tamanho variado espalhados num cubo de lado "extent"
+vector<AABB> randomBoxes(int count, float extent, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<float> pos(-extent * 0.5f, extent * 0.5f);
+    uniform_real_distribution<float> size(0.25f, 1.0f);
+    vector<AABB> boxes(count);
+    for (AABB& box : boxes) {
+        glm::vec3 c(pos(rng), pos(rng), pos(rng));
+        float h = size(rng);
+        box.min = c - glm::vec3(h);
+        box.max = c + glm::vec3(h);
+    }
+    return boxes;
+}
+
+// Construção, culling (contra a força bruta) e refit com 1% dos objetos se movendo; a
+// conferência do resultado do cull() está no "Tests bvh"
+void benchBvh() {
+    const int N = 100000;
+    cout << "[bvh] " << N << " objects" << endl;
+    vector<AABB> boxes = randomBoxes(N, 400.0f, 1);
+
+    Bvh bvh;
+    Clock::time_point start = Clock::now();
+    bvh.build(boxes);
+    cout << "  build: " << elapsedMs(start) << " ms, " << bvh.getNodes().size() << " nodes" << endl;
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 150.0f);
+    vector<int> visible;
+    BvhCullStats stats;
+    double totalMs = 0.0;
+    long visited = 0, visibleTotal = 0;
+    const int frames = 200;
+    for (int f = 0; f < frames; ++f) {
+        float angle = f * 2.0f * glm::pi<float>() / frames;
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(cos(angle), 0.0f, sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+        bvh.cull(Frustum::fromMatrix(projection * view), visible, &stats);
+        totalMs += stats.cullTimeMs;
+        visited += stats.nodesVisited;
+        visibleTotal += stats.visible;
+    }
+    cout << "  cull: " << totalMs / frames << " ms/frame, " << visibleTotal / frames << " visible, "
+         << visited / frames << " nodes visited" << endl;
+
+    visibleTotal = 0;
+    start = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        float angle = f * 2.0f * glm::pi<float>() / frames;
+        glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(cos(angle), 0.0f, sin(angle)), glm::vec3(0.0f, 1.0f, 0.0f));
+        Frustum frustum = Frustum::fromMatrix(projection * view);
+        for (const AABB& box : boxes)
+            visibleTotal += frustum.intersects(box) ? 1 : 0;
+    }
+    cout << "  brute force: " << elapsedMs(start) / frames << " ms/frame, " << visibleTotal / frames << " visible" << endl;
+
+    // 1% dos objetos se movendo por quadro
+    mt19937 rng(7);
+    uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+    start = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = f % 100; i < N; i += 100) {
+            AABB box = bvh.getItemBounds(i);
+            glm::vec3 d(jitter(rng), jitter(rng), jitter(rng));
+            box.min += d;
+            box.max += d;
+            bvh.update(i, box);
+        }
+        bvh.rebuildIfDegraded();
+    }
+    cout << "  refit (1% moving): " << elapsedMs(start) / frames << " ms/frame" << endl;
+}
+
+void benchGrid() {
+    const int N = 100000;
+    cout << "[grid] " << N << " objects" << endl;
+    vector<AABB> boxes = randomBoxes(N, 400.0f, 2);
+    SpatialGrid grid(4.0f);
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < N; ++i)
+        grid.insert(i, boxes[i]);
+    printRate("insert", N, elapsedMs(start));
+
+    mt19937 rng(3);
+    uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+    const int rounds = 10;
+    start = Clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (int i = 0; i < N; ++i) {
+            glm::vec3 d(jitter(rng), jitter(rng), jitter(rng));
+            boxes[i].min += d;
+            boxes[i].max += d;
+            grid.move(i, boxes[i]);
+        }
+    }
+    printRate("move", (double)N * rounds, elapsedMs(start));
+
+    uniform_real_distribution<float> pos(-200.0f, 200.0f);
+    const int queries = 20000;
+    vector<glm::vec3> points(queries), dirs(queries);
+    for (int q = 0; q < queries; ++q) {
+        points[q] = glm::vec3(pos(rng), pos(rng), pos(rng));
+        dirs[q] = glm::normalize(glm::vec3(pos(rng), pos(rng), pos(rng)));
+    }
+
+    int hits = 0;
+    start = Clock::now();
+    for (int q = 0; q < queries; ++q)
+        hits += grid.raycast(points[q], dirs[q], 200.0f) >= 0 ? 1 : 0;
+    printRate("raycast", queries, elapsedMs(start));
+    cout << "    " << hits << " hits" << endl;
+
+    vector<int> found;
+    size_t foundTotal = 0;
+    start = Clock::now();
+    for (int q = 0; q < queries; ++q) {
+        grid.queryRadius(points[q], 8.0f, found);
+        foundTotal += found.size();
+    }
+    printRate("radius (r=8)", queries, elapsedMs(start));
+    cout << "    " << (double)foundTotal / queries << " objects/query" << endl;
+
+    start = Clock::now();
+    for (int q = 0; q < queries; ++q)
+        grid.queryNearest(points[q], 8, found);
+    printRate("k-nearest (k=8)", queries, elapsedMs(start));
+}
+
+void benchSceneGraph() {
+    const int N = 100000;
+    const int frames = 100;
+    cout << "[scenegraph] " << N << " nodes, 1% moving per frame" << endl;
+
+    // Hierarquia rasa: 1000 grupos com 99 filhos cada
+    mt19937 rng(4);
+    uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    SceneGraph graph;
+    vector<Transform> transforms(N);
+    vector<int> parents(N, -1);
+    for (int i = 0; i < N; ++i) {
+        transforms[i].translation = glm::vec3(pos(rng), pos(rng), pos(rng));
+        transforms[i].rotation = glm::vec3(pos(rng), pos(rng), pos(rng));
+        parents[i] = (i % 100 == 0) ? -1 : i - i % 100;
+        graph.addNode(parents[i], transforms[i]);
+    }
+    graph.update();
+
+    // Referência: reconstrói todas as matrizes a cada quadro, como nos exercícios
+    vector<glm::mat4> worlds(N);
+    vector<glm::mat3> normals(N);
+    Clock::time_point start = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = 0; i < N; ++i) {
+            const Transform& t = transforms[i];
+            glm::mat4 model = glm::mat4(1.0f);
+            model = glm::translate(model, t.translation);
+            model = glm::rotate(model, glm::radians(t.rotation.x), glm::vec3(1, 0, 0));
+            model = glm::rotate(model, glm::radians(t.rotation.y), glm::vec3(0, 1, 0));
+            model = glm::rotate(model, glm::radians(t.rotation.z), glm::vec3(0, 0, 1));
+            model = glm::scale(model, t.scale);
+            worlds[i] = parents[i] >= 0 ? worlds[parents[i]] * model : model;
+            normals[i] = glm::transpose(glm::inverse(glm::mat3(worlds[i])));
+        }
+    }
+    cout << "  rebuild all: " << elapsedMs(start) / frames << " ms/frame, " << N << " recomputes/frame" << endl;
+
+    long recomputes = 0;
+    start = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        for (int i = f % 100; i < N; i += 100) {
+            Transform t = graph.getLocal(i);
+            t.translation.x += 0.01f;
+            graph.setLocal(i, t);
+        }
+        recomputes += graph.update();
+    }
+    cout << "  dirty flags: " << elapsedMs(start) / frames << " ms/frame, " << recomputes / frames << " recomputes/frame" << endl;
+}
+
+// Lê apenas as normais por vértice emitido (como loadSuzanneModel monta o VBO)
+vector<glm::vec3> loadObjVertexNormals(const string& path) {
+    vector<glm::vec3> normals, out;
+    ifstream file(path);
+    string line;
+    while (getline(file, line)) {
+        istringstream iss(line);
+        string type;
+        iss >> type;
+        if (type == "vn") {
+            glm::vec3 n;
+            iss >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        } else if (type == "f") {
+            string vertexData;
+            while (iss >> vertexData) {
+                size_t slash = vertexData.rfind('/');
+                int ni = slash != string::npos ? stoi(vertexData.substr(slash + 1)) - 1 : -1;
+                out.push_back(ni >= 0 && ni < (int)normals.size() ? normals[ni] : glm::vec3(0.0f, 1.0f, 0.0f));
+            }
+        }
+    }
+    return out;
+}
+
+// Custo de CPU do antigo mat3(transpose(inverse(model))) por vértice contra a matriz
+// de normais calculada uma vez por objeto, sobre os vértices do SuzanneSubdiv1. Mede a
+// inversa, não a vazão de vértices da GPU (essa vem do M5 --normal-matrix vertex|object)
+void benchNormalMatrix() {
+    vector<glm::vec3> normals = loadObjVertexNormals("../assets/Modelos3D/SuzanneSubdiv1.obj");
+    if (normals.empty()) {
+        cout << "[normals] SuzanneSubdiv1.obj not found (run from the build directory)" << endl;
+        return;
+    }
+    const int objects = 20;
+    cout << "[normals] " << normals.size() << " vertices x " << objects << " objects" << endl;
+
+    vector<glm::mat4> models(objects);
+    for (int i = 0; i < objects; ++i) {
+        Transform t;
+        t.translation = glm::vec3((float)i, 0.0f, 0.0f);
+        t.rotation = glm::vec3(10.0f * i, 5.0f * i, 0.0f);
+        t.scale = glm::vec3(1.0f + 0.1f * i);
+        models[i] = composeTRS(t);
+    }
+
+    double vertices = (double)normals.size() * objects;
+    glm::vec3 sink(0.0f);
+    Clock::time_point start = Clock::now();
+    // "model" muda a cada vértice (como no shader, que não sabe que ela é constante),
+    // senão o compilador tiraria a inversa do laço
+    for (const glm::mat4& base : models) {
+        glm::mat4 model = base;
+        for (const glm::vec3& n : normals) {
+            model[3].w = 1.0f + sink.x * 1e-30f;
+            sink += glm::mat3(glm::transpose(glm::inverse(model))) * n;
+        }
+    }
+    double perVertexMs = elapsedMs(start);
+    cout << "  per-vertex inverse: " << perVertexMs << " ms (" << vertices / (perVertexMs / 1000.0) / 1e6 << " Mverts/s)" << endl;
+
+    start = Clock::now();
+    for (const glm::mat4& model : models) {
+        glm::mat3 normalMatrix = computeNormalMatrix(model);
+        for (const glm::vec3& n : normals)
+            sink += normalMatrix * n;
+    }
+    double perObjectMs = elapsedMs(start);
+    cout << "  per-object normal matrix: " << perObjectMs << " ms (" << vertices / (perObjectMs / 1000.0) / 1e6 << " Mverts/s)" << endl;
+    cout << "  speedup: " << perVertexMs / perObjectMs << "x (checksum " << sink.x + sink.y + sink.z << ")" << endl;
+}
+
+// Occlusion culling na cena de teste do M5 (--occlusion-scene), com a câmera
+// deslizando em frente às paredes: fração oculta e custo por quadro
+void benchOcclusion() {
+    vector<MeshVertex> suzanne;
+    AABB modelBounds;
+    if (!loadObjTriangles("../assets/Modelos3D/Suzanne.obj", suzanne, &modelBounds)) {
+        cout << "[occlusion] Suzanne.obj not found (run from the build directory)" << endl;
+        return;
+    }
+    vector<AABB> walls;
+    vector<glm::vec3> positions;
+    buildOcclusionTestScene(walls, positions);
+    vector<AABB> bounds;
+    for (const glm::vec3& p : positions)
+        bounds.push_back(transformAABB(modelBounds, glm::translate(glm::mat4(1.0f), p)));
+    vector<int> candidates(bounds.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+        candidates[i] = (int)i;
+    cout << "[occlusion] " << bounds.size() << " objects, " << walls.size() << " walls, "
+         << ThreadPool::global().threadCount() << " thread(s)" << endl;
+
+    OcclusionCuller occlusion(256, 256);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    vector<int> visible;
+    const int frames = 200;
+    double rasterMs = 0.0, pyramidMs = 0.0, testMs = 0.0;
+    long occluded = 0, tested = 0;
+    for (int f = 0; f < frames; ++f) {
+        float x = -6.0f + 12.0f * f / (frames - 1);
+        glm::mat4 view = glm::lookAt(glm::vec3(x, 0.0f, 3.0f), glm::vec3(x * 0.5f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        occlusion.beginFrame(projection * view);
+        for (const AABB& wall : walls)
+            occlusion.addOccluderBox(wall);
+        occlusion.renderOccluders();
+        occlusion.cull(candidates, bounds, visible);
+        const OcclusionStats& stats = occlusion.stats();
+        rasterMs += stats.rasterMs;
+        pyramidMs += stats.pyramidMs;
+        testMs += stats.testMs;
+        occluded += stats.occluded;
+        tested += stats.tested;
+    }
+    cout << "  occluded: " << 100.0 * occluded / tested << "% of tested objects" << endl;
+    cout << "  cost: " << (rasterMs + pyramidMs + testMs) / frames << " ms/frame (raster " << rasterMs / frames
+         << ", pyramid " << pyramidMs / frames << ", test " << testMs / frames << ")" << endl;
+}
+
+// Custo por zona do TRACE_SCOPE desligado e ligado, contra o mesmo laço sem instrumentação
+unsigned traceWork(unsigned x) {
+    for (int k = 0; k < 8; ++k)
+        x = x * 1664525u + 1013904223u;
+    return x;
+}
+
+void benchTrace() {
+    const int N = 10000000;
+    cout << "[trace] " << N << " zones" << endl;
+    unsigned sink = 1;
+
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < N; ++i)
+        sink = traceWork(sink);
+    double baseMs = elapsedMs(start);
+
+    start = Clock::now();
+    for (int i = 0; i < N; ++i) {
+        TRACE_SCOPE("work");
+        sink = traceWork(sink);
+    }
+    double disabledMs = elapsedMs(start);
+
+    Trace::start();
+    start = Clock::now();
+    for (int i = 0; i < N; ++i) {
+        TRACE_SCOPE("work");
+        sink = traceWork(sink);
+    }
+    double enabledMs = elapsedMs(start);
+    Trace::stop();
+
+    cout << "  no instrumentation: " << baseMs << " ms" << endl;
+    cout << "  disabled: " << disabledMs << " ms (" << (disabledMs - baseMs) * 1e6 / N << " ns/zone)" << endl;
+    cout << "  enabled: " << enabledMs << " ms (" << (enabledMs - baseMs) * 1e6 / N << " ns/zone, checksum " << sink << ")" << endl;
+}
+
+// BVH de triângulos e ray tracer em Suzanne e SuzanneSubdiv1: tempo de construção
+// (1 thread e todas), raios primários um a um contra pacotes de 4, e o quadro completo
+void benchRayTrace() {
+    const char* models[] = {"../assets/Modelos3D/Suzanne.obj", "../assets/Modelos3D/SuzanneSubdiv1.obj"};
+    const int size = 512;
+    glm::vec3 viewPos(0.0f, 0.0f, 3.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(viewPos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    float tanHalf = std::tan(glm::radians(45.0f) * 0.5f);
+
+    for (const char* path : models) {
+        vector<MeshVertex> vertices;
+        if (!loadObjTriangles(path, vertices)) {
+            cout << "[raytrace] " << path << " not found (run from the build directory)" << endl;
+            continue;
+        }
+        ThreadPool single(1);
+        TriangleBvh bvh;
+        bvh.build(vertices, single);
+        double singleBuildMs = bvh.lastBuildMs();
+        bvh.build(vertices);
+        cout << "[raytrace] " << path << ": " << bvh.triangleCount() << " triangles, " << bvh.getNodes().size() << " nodes" << endl;
+        cout << "  build: " << singleBuildMs << " ms (1 thread), " << bvh.lastBuildMs() << " ms ("
+             << ThreadPool::global().threadCount() << " threads)" << endl;
+
+        // Raios primários 512x512 numa thread: um por vez contra pacotes 2x2
+        auto direction = [&](int x, int y) {
+            float ndcX = 2.0f * (x + 0.5f) / size - 1.0f, ndcY = 1.0f - 2.0f * (y + 0.5f) / size;
+            return glm::normalize(glm::vec3(ndcX * tanHalf, ndcY * tanHalf, -1.0f));
+        };
+        int hits = 0;
+        Clock::time_point start = Clock::now();
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                Ray ray;
+                ray.origin = viewPos;
+                ray.direction = direction(x, y);
+                RayHit hit;
+                hits += bvh.intersect(ray, hit);
+            }
+        }
+        printRate("single rays", (double)size * size, elapsedMs(start));
+
+        int packetHits = 0;
+        start = Clock::now();
+        for (int y = 0; y < size; y += 2) {
+            for (int x = 0; x < size; x += 2) {
+                alignas(16) float dx[4], dy[4], dz[4];
+                for (int lane = 0; lane < 4; ++lane) {
+                    glm::vec3 d = direction(x + (lane & 1), y + (lane >> 1));
+                    dx[lane] = d.x;
+                    dy[lane] = d.y;
+                    dz[lane] = d.z;
+                }
+                RayPacket4 packet;
+                packet.ox = float4(viewPos.x);
+                packet.oy = float4(viewPos.y);
+                packet.oz = float4(viewPos.z);
+                packet.dx = float4::load(dx);
+                packet.dy = float4::load(dy);
+                packet.dz = float4::load(dz);
+                packet.tMax = float4(FLT_MAX);
+                RayHit4 hit;
+                bvh.intersect(packet, hit);
+                for (int lane = 0; lane < 4; ++lane)
+                    packetHits += hit.triangle[lane] >= 0;
+            }
+        }
+        printRate("4-ray packets", (double)size * size, elapsedMs(start));
+        cout << "  hits: " << hits << " single, " << packetHits << " packets" << endl;
+
+        // Quadro completo (tiles em paralelo, Phong e sombras), sem textura
+        RayTracer tracer(size, size);
+        tracer.setCamera(view, projection, viewPos);
+        vector<SoftLight> lights(3);
+        lights[0].position = glm::vec3(2.0f, 2.0f, 2.0f);
+        lights[1].position = glm::vec3(-2.0f, 1.0f, 1.0f);
+        lights[2].position = glm::vec3(0.0f, 1.0f, -2.0f);
+        tracer.setLights(lights);
+        tracer.setScene(vertices, nullptr);
+        tracer.render(1, true);
+        const RayTraceStats& stats = tracer.stats();
+        cout << "  frame with shadows: " << stats.renderMs << " ms, " << stats.primaryRays + stats.shadowRays
+             << " rays (" << stats.mraysPerSecond() << " Mrays/s)" << endl;
+    }
+}
+
+// Atribuição de luzes aos clusters (LightClusters.h), com as contagens do M5 --lights
+void benchClusters() {
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 12.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const int counts[] = {3, 64, 512, 4096};
+    for (int count : counts) {
+        mt19937 rng(7);
+        uniform_real_distribution<float> pos(-10.0f, 10.0f);
+        float radius = std::min(std::max(2.5f * std::cbrt(8000.0f / count), 0.5f), 4.0f);
+        vector<ClusterLight> lights(count);
+        for (ClusterLight& light : lights) {
+            light.position = glm::vec3(pos(rng), pos(rng), pos(rng));
+            light.radius = radius;
+        }
+        ThreadPool single(1);
+        LightClusterGrid serialGrid(single), grid;
+        serialGrid.setProjection(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+        grid.setProjection(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+        const int iterations = 200;
+        double serialMs = 0.0, parallelMs = 0.0;
+        for (int i = 0; i < iterations; ++i) {
+            serialGrid.assign(lights, view);
+            serialMs += serialGrid.stats().assignMs;
+            grid.assign(lights, view);
+            parallelMs += grid.stats().assignMs;
+        }
+        const LightClusterStats& stats = grid.stats();
+        cout << "[clusters] " << count << " lights (radius " << radius << "): " << stats.visibleLights << " visible, "
+             << stats.indexCount << " entries, max " << stats.maxPerCluster << "/cluster" << endl;
+        cout << "  assign: " << serialMs / iterations << " ms (1 thread), " << parallelMs / iterations << " ms ("
+             << ThreadPool::global().threadCount() << " threads)" << endl;
+    }
+}
+
+// Backend da fila que só conta as trocas de estado (sem GPU)
+struct CountingBackend {
+    int stateChanges = 0;
+    int draws = 0;
+    void useProgram(GLuint) { ++stateChanges; }
+    void bindTexture(GLuint) { ++stateChanges; }
+    void bindVertexArray(GLuint) { ++stateChanges; }
+    void draw(const RenderPacket& packet) { draws += packet.count > 0; }
+    void finish() {}
+};
+
+// 50k desenhos em ordem de cena, com 4 programas, 16 texturas e 128 VAOs sorteados:
+// bind de tudo por desenho (como drawModel), fila sem ordenar e fila ordenada
+void benchRenderQueue() {
+    const int draws = 50000;
+    mt19937 rng(3);
+    uniform_int_distribution<int> program(1, 4), texture(1, 16), vao(1, 128);
+    uniform_real_distribution<float> depth(0.5f, 90.0f);
+    vector<RenderPacket> scene(draws);
+    vector<float> depths(draws);
+    for (int i = 0; i < draws; ++i) {
+        RenderPacket& packet = scene[i];
+        packet.program = program(rng);
+        packet.texture = texture(rng);
+        packet.vao = vao(rng);
+        packet.count = 36;
+        packet.model = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f));
+        depths[i] = depth(rng);
+    }
+    const int iterations = 20;
+
+    // Sem GPU o custo de um bind é zero: aqui só contagens, chaves e ordenação; o envio com o
+    // GlRenderBackend é medido por "DrawBench --queue 50000"
+    CountingBackend naive;
+    for (const RenderPacket& packet : scene) {
+        naive.useProgram(packet.program);
+        naive.bindTexture(packet.texture);
+        naive.bindVertexArray(packet.vao);
+        naive.draw(packet);
+    }
+    cout << "[queue] " << draws << " draws" << endl;
+    cout << "  scene order, bind per draw: " << naive.stateChanges << " state changes" << endl;
+
+    RenderQueue queue;
+    queue.setDepthRange(0.1f, 100.0f);
+    Clock::time_point start;
+    double addMs = 0.0, sortMs = 0.0, unsortedMs = 0.0, sortedMs = 0.0;
+    int unsortedChanges = 0, sortedChanges = 0;
+    CountingBackend backend;
+    for (int it = 0; it < iterations; ++it) {
+        queue.clear();
+        start = Clock::now();
+        for (int i = 0; i < draws; ++i)
+            queue.add(0, scene[i], depths[i]);
+        addMs += elapsedMs(start);
+        queue.submit(backend);
+        unsortedMs += queue.stats().submitMs;
+        unsortedChanges = queue.stats().stateChanges();
+        queue.sort();
+        sortMs += queue.stats().sortMs;
+        queue.submit(backend);
+        sortedMs += queue.stats().submitMs;
+        sortedChanges = queue.stats().stateChanges();
+    }
+    const vector<uint64_t>& keys = queue.sortedKeyList();
+    bool ordered = std::is_sorted(keys.begin(), keys.end());
+    cout << "  scene order, redundant binds skipped: " << unsortedChanges << " state changes, submit " << unsortedMs / iterations << " ms" << endl;
+    cout << "  sorted: " << sortedChanges << " state changes, keys " << addMs / iterations << " ms + radix sort "
+         << sortMs / iterations << " ms + submit " << sortedMs / iterations << " ms" << (ordered ? "" : " (NOT SORTED)") << endl;
+}
+
+// Geração como a do SpherePhong antigo: 6 vértices de 11 floats (posição, cor, normal,
+// UV) por quadrado, com sin/cos recalculados em cada canto
+size_t legacySphereFloats(float radius, int latSegments, int lonSegments, vector<float>& buffer) {
+    const float pi = 3.14159265358979f;
+    buffer.clear();
+    auto corner = [&](int lat, int lon) {
+        float theta = lat * pi / latSegments;
+        float phi = lon * 2.0f * pi / lonSegments;
+        glm::vec3 pos(radius * cos(phi) * sin(theta), radius * cos(theta), radius * sin(phi) * sin(theta));
+        glm::vec3 normal = glm::normalize(pos);
+        buffer.insert(buffer.end(), {pos.x, pos.y, pos.z, 1.0f, 0.0f, 0.0f, normal.x, normal.y, normal.z, phi / (2.0f * pi), theta / pi});
+    };
+    for (int i = 0; i < latSegments; ++i) {
+        for (int j = 0; j < lonSegments; ++j) {
+            corner(i, j); corner(i + 1, j); corner(i, j + 1);
+            corner(i + 1, j); corner(i + 1, j + 1); corner(i, j + 1);
+        }
+    }
+    return buffer.size();
+}
+
+// Esfera UV de 16x16 a 2048x2048 segmentos: antiga (sem índices) x ShapeGenerator, e as
+// outras formas em resolução equivalente; por fim o custo de um acerto no ShapeCache
+void benchShapes() {
+    const int sizes[] = {16, 64, 256, 1024, 2048};
+    auto mb = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+    for (int size : sizes) {
+        int iterations = std::max(1, (1 << 20) / (size * size));
+        cout << "[shapes] " << size << "x" << size << " segments" << endl;
+        size_t legacyBytes = (size_t)size * size * 6 * 11 * sizeof(float);
+        if (legacyBytes <= (size_t)512 << 20) {
+            vector<float> buffer;
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < iterations; ++i)
+                legacySphereFloats(0.5f, size, size, buffer);
+            cout << "  legacy sphere: " << elapsedMs(start) / iterations << " ms, " << mb(legacyBytes) << " MB ("
+                 << buffer.size() / 11 << " vertices, no indices)" << endl;
+        } else {
+            cout << "  legacy sphere: skipped (" << mb(legacyBytes) << " MB)" << endl;
+        }
+        auto run = [&](const char* name, function<ShapeMesh()> generate) {
+            ShapeMesh mesh;
+            Clock::time_point start = Clock::now();
+            for (int i = 0; i < iterations; ++i)
+                mesh = generate();
+            cout << "  " << name << ": " << elapsedMs(start) / iterations << " ms, " << mb(mesh.bytes()) << " MB ("
+                 << mesh.vertices.size() << " vertices, " << mesh.triangleCount() << " triangles)" << endl;
+        };
+        run("uv sphere", [&] { return generateUvSphere(0.5f, size, size); });
+        run("torus", [&] { return generateTorus(1.0f, 0.3f, size, size); });
+        run("cylinder", [&] { return generateCylinder(0.5f, 1.0f, size, size); });
+        run("plane", [&] { return generatePlane(1.0f, 1.0f, size, size); });
+        run("cube", [&] { return generateCube(1.0f, std::max(1, size / 2)); });
+    }
+    for (int level = 0; level <= 8; level += 2) {
+        ShapeMesh mesh;
+        Clock::time_point start = Clock::now();
+        mesh = generateIcosphere(0.5f, level);
+        cout << "[shapes] icosphere level " << level << ": " << elapsedMs(start) << " ms, " << mb(mesh.bytes()) << " MB ("
+             << mesh.vertices.size() << " vertices, " << mesh.triangleCount() << " triangles)" << endl;
+    }
+
+    ShapeCache cache;
+    Clock::time_point start = Clock::now();
+    cache.get(ShapeDesc::uvSphere(0.5f, 256, 256));
+    double missMs = elapsedMs(start);
+    const int lookups = 100000;
+    size_t triangles = 0;
+    start = Clock::now();
+    for (int i = 0; i < lookups; ++i)
+        triangles += cache.get(ShapeDesc::uvSphere(0.5f, 256, 256)).triangleCount();
+    cout << "[shapes] cache: miss " << missMs << " ms, hit " << elapsedMs(start) * 1000.0 / lookups << " us ("
+         << cache.hits() << " hits, " << mb(cache.bytes()) << " MB cached, " << triangles / lookups << " triangles)" << endl;
+}
+
+// Normais (suaves e com vinco de 60 graus) e tangentes geradas para o SuzanneSubdiv1.obj
+// e para um toro de 2M triângulos, de 1 thread até uma por núcleo; o desvio em relação
+// às normais do arquivo confere o resultado
+void benchMeshNormals() {
+    vector<MeshVertex> suzanne;
+    if (!loadObjTriangles("../assets/Modelos3D/SuzanneSubdiv1.obj", suzanne)) {
+        cout << "[meshnormals] SuzanneSubdiv1.obj not found (run from the build directory)" << endl;
+        return;
+    }
+    ShapeMesh torus = generateTorus(1.0f, 0.3f, 1024, 1024);
+    vector<MeshVertex> torusTriangles;
+    torusTriangles.reserve(torus.indices.size());
+    for (uint32_t index : torus.indices)
+        torusTriangles.push_back(torus.vertices[index]);
+
+    vector<int> threadCounts;
+    int maxThreads = (int)std::max(1u, thread::hardware_concurrency());
+    for (int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    auto run = [&](const char* name, const vector<MeshVertex>& source, int iterations) {
+        cout << "[meshnormals] " << name << ": " << source.size() / 3 << " triangles" << endl;
+        NormalOptions crease;
+        crease.creaseAngle = 60.0f;
+        for (int threads : threadCounts) {
+            ThreadPool pool(threads);
+            vector<MeshVertex> smooth = source, creased = source;
+            vector<glm::vec4> tangents;
+            double smoothMs = 0.0, creaseMs = 0.0, tangentMs = 0.0;
+            for (int i = 0; i < iterations; ++i) {
+                Clock::time_point start = Clock::now();
+                generateNormals(smooth, NormalOptions(), pool);
+                smoothMs += elapsedMs(start);
+                start = Clock::now();
+                generateNormals(creased, crease, pool);
+                creaseMs += elapsedMs(start);
+                start = Clock::now();
+                generateTangents(smooth, tangents, pool);
+                tangentMs += elapsedMs(start);
+            }
+            double worst = 0.0, total = 0.0;
+            for (size_t v = 0; v < source.size(); ++v) {
+                double angle = acos(std::min(1.0f, std::max(-1.0f, glm::dot(glm::normalize(source[v].normal), smooth[v].normal))));
+                worst = std::max(worst, angle);
+                total += angle;
+            }
+            cout << "  " << threads << " threads: smooth " << smoothMs / iterations << " ms, crease 60 " << creaseMs / iterations
+                 << " ms, tangents " << tangentMs / iterations << " ms (vs file normals: mean " << glm::degrees(total / source.size())
+                 << " deg, max " << glm::degrees(worst) << " deg)" << endl;
+        }
+    };
+    run("SuzanneSubdiv1", suzanne, 50);
+    run("torus 1024x1024", torusTriangles, 3);
+}
+
+// Leitura de um OBJ sintético de muitos materiais (os "usemtl" mudam a cada quad) e o
+// número de desenhos com e sem o agrupamento; depois o mesmo para Suzanne.obj. A
+// conferência das faixas e dos parâmetros está no "Tests materials"
+void benchMaterials() {
+    const int materialCounts[] = {1, 16, 256};
+    const int quadCount = 20000;
+    string objPath = (filesystem::temp_directory_path() / "cg_materials_test.obj").string();
+    for (int materialCount : materialCounts) {
+        if (!writeSyntheticMaterialObj(objPath, materialCount, quadCount, 48 + materialCount))
+            return;
+        MaterialMesh mesh;
+        Clock::time_point start = Clock::now();
+        loadObjWithMaterials(objPath, mesh);
+        double loadMs = elapsedMs(start);
+        cout << "[materials] " << materialCount << " materials, " << mesh.indices.size() / 3 << " triangles, " << mesh.vertices.size()
+             << " vertices: load " << loadMs << " ms, draws " << mesh.runs.size() << " (file order) -> " << mesh.ranges.size()
+             << " (by material)" << endl;
+    }
+    filesystem::remove(objPath);
+    filesystem::remove(objPath.substr(0, objPath.size() - 4) + ".mtl");
+
+    MaterialMesh suzanne;
+    if (loadObjWithMaterials("../assets/Modelos3D/Suzanne.obj", suzanne) && !suzanne.materials.empty()) {
+        const ObjMaterial& material = suzanne.materials.front();
+        cout << "[materials] Suzanne.obj: " << suzanne.materials.size() << " material(s), " << suzanne.ranges.size() << " draw(s), "
+             << material.name << " Ns " << material.shininess << " map_Kd " << material.diffuseMap << endl;
+    }
+}
+
+// Importação em streaming (ObjStream.h): um terreno sintético lido com orçamentos de
+// memória diferentes, contra o loadObjTriangles (o resultado é conferido no "Tests objstream")
+void benchObjStream() {
+    string objPath = (filesystem::temp_directory_path() / "cg_stream_test.obj").string();
+    string blobPath = objPath + ".bin";
+    uint64_t triangles = 0;
+    if (!writeSyntheticStreamObj(objPath, uint64_t(16) << 20, &triangles))
+        return;
+    vector<MeshVertex> reference;
+    Clock::time_point start = Clock::now();
+    loadObjTriangles(objPath, reference);
+    double referenceMs = elapsedMs(start);
+    uint64_t fileBytes = filesystem::file_size(objPath);
+    cout << "[objstream] " << fileBytes / (1024.0 * 1024.0) << " MB, " << triangles << " triangles; loadObjTriangles " << referenceMs
+         << " ms (" << fileBytes / 1048.576 / referenceMs << " MB/s)" << endl;
+
+    const size_t budgets[] = {size_t(4) << 20, size_t(16) << 20, size_t(256) << 20};
+    for (size_t budget : budgets) {
+        ObjStreamOptions options;
+        options.memoryBudget = budget;
+        ObjStreamStats stats;
+        ObjBlobWriter writer(blobPath);
+        streamObj(objPath, writer, options, &stats);
+        double totalMs = stats.countMs + stats.streamMs;
+        cout << "[objstream] budget " << (budget >> 20) << " MB: pass 1 " << stats.countMs << " ms, pass 2 " << stats.streamMs << " ms ("
+             << stats.chunks << " chunks, " << stats.pageLoads << " page loads), " << fileBytes / 1048.576 / totalMs << " MB/s" << endl;
+    }
+    filesystem::remove(objPath);
+    filesystem::remove(blobPath);
+}
+
+// NumberParse.h: vazão em floats por segundo contra strtof, istringstream e from_chars com
+// números no formato dos OBJ, e a contagem de palavras das faces com e sem SSE2 (a
+// conferência contra strtof/strtod está no "Tests floatparse")
+void benchFloatParse() {
+    mt19937_64 rng(50);
+    // Vazão com números no formato dos OBJ ("%.6f")
+    const int numberCount = 2000000;
+    string numbers;
+    uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    char buffer[64];
+    for (int i = 0; i < numberCount; ++i) {
+        snprintf(buffer, sizeof(buffer), "%.6f ", coordinate(rng));
+        numbers += buffer;
+    }
+    vector<float> parsed(numberCount), reference(numberCount);
+    auto report = [&](const char* name, double ms) {
+        printf("[floatparse] %-14s %8.2f ms  %7.1f M floats/s  %7.1f MB/s\n", name, ms, numberCount / ms / 1000.0, numbers.size() / 1048.576 / ms);
+    };
+    Clock::time_point start = Clock::now();
+    {
+        const char* p = numbers.data();
+        const char* last = p + numbers.size();
+        for (int i = 0; i < numberCount; ++i)
+            p = parseFloat(skipBlanks(p, last), last, parsed[i]);
+    }
+    report("parseFloat", elapsedMs(start));
+    start = Clock::now();
+    {
+        char* p = &numbers[0];
+        for (int i = 0; i < numberCount; ++i)
+            reference[i] = strtof(p, &p);
+    }
+    report("strtof", elapsedMs(start));
+    start = Clock::now();
+    {
+        istringstream stream(numbers);
+        for (int i = 0; i < numberCount; ++i)
+            stream >> reference[i];
+    }
+    report("istringstream", elapsedMs(start));
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    start = Clock::now();
+    {
+        const char* p = numbers.data();
+        const char* last = p + numbers.size();
+        for (int i = 0; i < numberCount; ++i)
+            p = from_chars(skipBlanks(p, last), last, reference[i]).ptr;
+    }
+    report("from_chars", elapsedMs(start));
+#endif
+
+    // Palavras das linhas "f": SSE2 (countTokens) e um byte por vez
+    string faces;
+    vector<pair<size_t, size_t>> lines;
+    for (int i = 0; i < 500000; ++i) {
+        size_t begin = faces.size();
+        int corners = 3 + (int)(rng() % 2);
+        for (int c = 0; c < corners; ++c)
+            faces += to_string(rng() % 10000000 + 1) + "/" + to_string(rng() % 10000000 + 1) + "/" + to_string(rng() % 10000000 + 1) + " ";
+        lines.push_back({begin, faces.size()});
+        faces += '\n';
+    }
+    long long simdTokens = 0, scalarTokens = 0;
+    start = Clock::now();
+    for (const auto& line : lines)
+        simdTokens += countTokens(faces.data() + line.first, faces.data() + line.second);
+    double simdMs = elapsedMs(start);
+    start = Clock::now();
+    for (const auto& line : lines) {
+        bool previousBlank = true;
+        for (size_t i = line.first; i < line.second; ++i) {
+            bool blank = faces[i] == ' ' || faces[i] == '\t' || faces[i] == '\r';
+            scalarTokens += !blank && previousBlank;
+            previousBlank = blank;
+        }
+    }
+    double scalarMs = elapsedMs(start);
+    printf("[floatparse] face tokens: countTokens %.2f ms (%lld), scalar %.2f ms (%lld), %.1f MB\n", simdMs, simdTokens, scalarMs,
+           scalarTokens, faces.size() / 1048576.0);
+}
+
+// Desempenho de cada kernel de BatchMath em cada nível suportado contra o laço glm, com
+// 1M elementos (a conferência contra a glm está no "Tests simd")
+void benchSimd() {
+    BatchIsa supported = batchIsaSupported();
+    vector<BatchIsa> levels;
+    for (int isa = 0; isa <= (int)supported; ++isa)
+        levels.push_back((BatchIsa)isa);
+    cout << "[simd] supported: " << batchIsaName(supported) << endl;
+
+    mt19937 rng(46);
+    const size_t count = 1 << 20;
+    const int iterations = 20;
+    glm::mat4 m = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 2.0f, 3.0f)), 0.7f, glm::vec3(0.0f, 1.0f, 0.0f));
+    uniform_real_distribution<float> dist(-100.0f, 100.0f), angle(-180.0f, 180.0f), factor(0.5f, 2.0f);
+
+    vector<glm::vec4> aosPoints(count), aosOut(count);
+    vector<glm::vec3> aosVectors(count);
+    vector<float> aosLengths(count);
+    vector<Transform> aosTransforms(count);
+    Vec4Array points, transformed;
+    Vec3Array vectors, normalized, translation, rotation, scale, boxMin, boxMax, outMin, outMax;
+    vector<float> lengths;
+    points.resize(count);
+    vectors.resize(count);
+    translation.resize(count);
+    rotation.resize(count);
+    scale.resize(count);
+    boxMin.resize(count);
+    boxMax.resize(count);
+    vector<AABB> aosBoxes(count), aosBoxesOut(count);
+    for (size_t i = 0; i < count; ++i) {
+        aosPoints[i] = glm::vec4(dist(rng), dist(rng), dist(rng), 1.0f);
+        points.set(i, aosPoints[i]);
+        aosVectors[i] = glm::vec3(dist(rng), dist(rng), dist(rng));
+        vectors.set(i, aosVectors[i]);
+        aosTransforms[i].translation = glm::vec3(dist(rng), dist(rng), dist(rng));
+        aosTransforms[i].rotation = glm::vec3(angle(rng), angle(rng), angle(rng));
+        aosTransforms[i].scale = glm::vec3(factor(rng));
+        translation.set(i, aosTransforms[i].translation);
+        rotation.set(i, aosTransforms[i].rotation);
+        scale.set(i, aosTransforms[i].scale);
+        aosBoxes[i].min = aosVectors[i];
+        aosBoxes[i].max = aosVectors[i] + glm::vec3(factor(rng));
+        boxMin.set(i, aosBoxes[i].min);
+        boxMax.set(i, aosBoxes[i].max);
+    }
+    vector<glm::mat4> matrices(count);
+
+    auto measure = [&](const string& label, function<void()> body) {
+        body();
+        Clock::time_point start = Clock::now();
+        for (int i = 0; i < iterations; ++i)
+            body();
+        printRate(label, (double)count * iterations, elapsedMs(start));
+    };
+    auto measureAll = [&](const string& kernel, function<void()> glmBody, function<void()> batchBody) {
+        cout << "[simd] " << kernel << " x " << count << endl;
+        measure("glm", glmBody);
+        for (BatchIsa isa : levels) {
+            setBatchIsa(isa);
+            measure(batchIsaName(isa), batchBody);
+        }
+    };
+
+    measureAll("transform", [&] { for (size_t i = 0; i < count; ++i) aosOut[i] = m * aosPoints[i]; },
+               [&] { batchTransform(m, points, transformed); });
+    measureAll("compose trs", [&] { for (size_t i = 0; i < count; ++i) matrices[i] = composeTRS(aosTransforms[i]); },
+               [&] { batchComposeTRS(translation, rotation, scale, matrices.data()); });
+    measureAll("length", [&] { for (size_t i = 0; i < count; ++i) aosLengths[i] = glm::length(aosVectors[i]); },
+               [&] { batchLength(vectors, lengths); });
+    measureAll("normalize", [&] { for (size_t i = 0; i < count; ++i) aosOut[i] = glm::vec4(glm::normalize(aosVectors[i]), 0.0f); },
+               [&] { batchNormalize(vectors, normalized); });
+    measureAll("aabb", [&] { for (size_t i = 0; i < count; ++i) aosBoxesOut[i] = transformAABB(aosBoxes[i], m); },
+               [&] { batchTransformAABB(m, boxMin, boxMax, outMin, outMax); });
+    setBatchIsa(supported);
+}
+
+int main(int argc, char** argv) {
+    vector<pair<string, function<void()>>> benchmarks = {
+        {"bvh", benchBvh},
+        {"grid", benchGrid},
+        {"scenegraph", benchSceneGraph},
+        {"normals", benchNormalMatrix},
+        {"trace", benchTrace},
+        {"occlusion", benchOcclusion},
+        {"raytrace", benchRayTrace},
+        {"clusters", benchClusters},
+        {"queue", benchRenderQueue},
+        {"shapes", benchShapes},
+        {"simd", benchSimd},
+        {"meshnormals", benchMeshNormals},
+        {"materials", benchMaterials},
+        {"objstream", benchObjStream},
+        {"floatparse", benchFloatParse},
+    };
+
+    bool ranAny = false;
+    for (auto& bench : benchmarks) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            if (bench.first == argv[i]) selected = true;
+        if (selected) {
+            bench.second();
+            ranAny = true;
+        }
+    }
+
+    if (!ranAny) {
+        cout << "Available benchmarks:";
+        for (auto& bench : benchmarks)
+            cout << " " << bench.first;
+        cout << endl;
+        return 1;
+    }
+    return 0;
+}
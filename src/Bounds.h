@@ -0,0 +1,147 @@
+#pragma once
+
+// Volumes envolventes (AABB / esfera) e planos do frustum.
+// Não depende de OpenGL: pode ser usado e testado apenas na CPU.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+struct AABB {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    bool isValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+    void expand(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void expand(const AABB& other) {
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extents() const { return (max - min) * 0.5f; }
+
+    float surfaceArea() const {
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    bool contains(const AABB& other) const {
+        return other.min.x >= min.x && other.min.y >= min.y && other.min.z >= min.z &&
+               other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+    }
+};
+
+struct BoundingSphere {
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+};
+
+inline AABB computeAABB(const glm::vec3* points, size_t count, size_t stride = sizeof(glm::vec3)) {
+    AABB box;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(points);
+    for (size_t i = 0; i < count; ++i)
+        box.expand(*reinterpret_cast<const glm::vec3*>(bytes + i * stride));
+    return box;
+}
+
+// Esfera centrada no AABB que cobre todos os pontos (mais justa que a esfera do AABB)
+inline BoundingSphere computeBoundingSphere(const glm::vec3* points, size_t count, size_t stride = sizeof(glm::vec3)) {
+    BoundingSphere sphere;
+    AABB box = computeAABB(points, count, stride);
+    if (!box.isValid()) return sphere;
+    sphere.center = box.center();
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(points);
+    float maxDist2 = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 d = *reinterpret_cast<const glm::vec3*>(bytes + i * stride) - sphere.center;
+        maxDist2 = std::max(maxDist2, glm::dot(d, d));
+    }
+    sphere.radius = std::sqrt(maxDist2);
+    return sphere;
+}
+
+// Transforma um AABB local por uma matriz afim (Arvo): centro + extensões em |M|
+inline AABB transformAABB(const AABB& box, const glm::mat4& m) {
+    glm::vec3 c = box.center();
+    glm::vec3 e = box.extents();
+    glm::vec3 newCenter = glm::vec3(m * glm::vec4(c, 1.0f));
+    glm::vec3 newExtents(
+        std::fabs(m[0][0]) * e.x + std::fabs(m[1][0]) * e.y + std::fabs(m[2][0]) * e.z,
+        std::fabs(m[0][1]) * e.x + std::fabs(m[1][1]) * e.y + std::fabs(m[2][1]) * e.z,
+        std::fabs(m[0][2]) * e.x + std::fabs(m[1][2]) * e.y + std::fabs(m[2][2]) * e.z);
+    AABB out;
+    out.min = newCenter - newExtents;
+    out.max = newCenter + newExtents;
+    return out;
+}
+
+enum class CullResult { Outside, Intersecting, Inside };
+
+// Planos do frustum no formato (n, d) com n.p + d >= 0 para pontos dentro
+struct Frustum {
+    glm::vec4 planes[6];
+
+    // Extração de Gribb/Hartmann a partir de projection * view
+    static Frustum fromMatrix(const glm::mat4& viewProjection) {
+        Frustum f;
+        const glm::mat4& m = viewProjection;
+        glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+        glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+        glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+        glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+        f.planes[0] = row3 + row0; // esquerda
+        f.planes[1] = row3 - row0; // direita
+        f.planes[2] = row3 + row1; // baixo
+        f.planes[3] = row3 - row1; // cima
+        f.planes[4] = row3 + row2; // perto
+        f.planes[5] = row3 - row2; // longe
+        for (glm::vec4& p : f.planes) {
+            float len = glm::length(glm::vec3(p));
+            p = p / len;
+        }
+        return f;
+    }
+
+    bool intersects(const BoundingSphere& s) const {
+        for (const glm::vec4& p : planes) {
+            if (glm::dot(glm::vec3(p), s.center) + p.w < -s.radius)
+                return false;
+        }
+        return true;
+    }
+
+    // planeMask: bit i ligado = plano i ainda precisa ser testado (o pai pode já estar dentro)
+    CullResult classify(const AABB& box, unsigned& planeMask) const {
+        glm::vec3 c = box.center();
+        glm::vec3 e = box.extents();
+        CullResult result = CullResult::Inside;
+        for (int i = 0; i < 6; ++i) {
+            unsigned bit = 1u << i;
+            if (!(planeMask & bit)) continue;
+            const glm::vec4& p = planes[i];
+            float r = e.x * std::fabs(p.x) + e.y * std::fabs(p.y) + e.z * std::fabs(p.z);
+            float d = glm::dot(glm::vec3(p), c) + p.w;
+            if (d < -r)
+                return CullResult::Outside;
+            if (d >= r)
+                planeMask &= ~bit;
+            else
+                result = CullResult::Intersecting;
+        }
+        return result;
+    }
+
+    bool intersects(const AABB& box) const {
+        unsigned mask = 0x3F;
+        return classify(box, mask) != CullResult::Outside;
+    }
+};
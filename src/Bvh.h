@@ -0,0 +1,276 @@
+#pragma once
+
+// BVH de objetos da cena (um AABB por objeto) para frustum culling.
+// Construção por SAH com bins, refit incremental quando objetos se movem
+// e reconstrução automática quando a qualidade da árvore degrada.
+// Não depende de OpenGL.
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "Bounds.h"
+
+struct BvhNode {
+    AABB bounds;
+    int left = -1;       // filho esquerdo (o direito é "right"); -1 em folhas
+    int right = -1;
+    int parent = -1;
+    int firstItem = 0;   // folhas: intervalo em Bvh::items
+    int itemCount = 0;
+
+    bool isLeaf() const { return itemCount > 0; }
+};
+
+struct BvhCullStats {
+    int visible = 0;
+    int nodesVisited = 0;
+    double cullTimeMs = 0.0;
+};
+
+class Bvh {
+public:
+    static const int MaxLeafItems = 4;
+    static const int SahBins = 12;
+
+    void build(const std::vector<AABB>& objectBounds) {
+        itemBounds = objectBounds;
+        nodes.clear();
+        items.resize(itemBounds.size());
+        leafOfItem.assign(itemBounds.size(), -1);
+        centroids.resize(itemBounds.size());
+        for (size_t i = 0; i < itemBounds.size(); ++i) {
+            items[i] = (int)i;
+            centroids[i] = itemBounds[i].center();
+        }
+        updatesSinceBuild = 0;
+        if (items.empty()) {
+            builtCost = 0.0f;
+            return;
+        }
+        nodes.reserve(2 * items.size() / MaxLeafItems + 1);
+        buildRecursive(0, (int)items.size(), -1);
+        builtCost = sahCost();
+    }
+
+    // Atualiza o AABB de um objeto e ajusta os ancestrais até onde for necessário
+    void update(int objectIndex, const AABB& bounds) {
+        itemBounds[objectIndex] = bounds;
+        centroids[objectIndex] = bounds.center();
+        int node = leafOfItem[objectIndex];
+        while (node >= 0) {
+            BvhNode& n = nodes[node];
+            AABB box;
+            if (n.isLeaf()) {
+                for (int i = 0; i < n.itemCount; ++i)
+                    box.expand(itemBounds[items[n.firstItem + i]]);
+            } else {
+                box = nodes[n.left].bounds;
+                box.expand(nodes[n.right].bounds);
+            }
+            if (box.min == n.bounds.min && box.max == n.bounds.max)
+                break;
+            n.bounds = box;
+            node = n.parent;
+        }
+        ++updatesSinceBuild;
+    }
+
+    // Refit completo (filhos sempre têm índice maior que o pai)
+    void refit() {
+        for (int i = (int)nodes.size() - 1; i >= 0; --i) {
+            BvhNode& n = nodes[i];
+            AABB box;
+            if (n.isLeaf()) {
+                for (int k = 0; k < n.itemCount; ++k)
+                    box.expand(itemBounds[items[n.firstItem + k]]);
+            } else {
+                box = nodes[n.left].bounds;
+                box.expand(nodes[n.right].bounds);
+            }
+            n.bounds = box;
+        }
+    }
+
+    // Após muitos refits a árvore fica frouxa; reconstrói se o custo SAH
+    // cresceu mais que rebuildThreshold em relação ao da construção.
+    bool rebuildIfDegraded(float rebuildThreshold = 1.5f) {
+        if (items.empty() || updatesSinceBuild < (int)items.size() / 8 + 1)
+            return false;
+        updatesSinceBuild = 0;
+        if (sahCost() <= builtCost * rebuildThreshold)
+            return false;
+        std::vector<AABB> bounds = itemBounds;
+        build(bounds);
+        return true;
+    }
+
+    void cull(const Frustum& frustum, std::vector<int>& visible, BvhCullStats* stats = nullptr) const {
+        auto start = std::chrono::steady_clock::now();
+        visible.clear();
+        int visited = 0;
+
+        if (!nodes.empty()) {
+            struct Entry { int node; unsigned mask; };
+            std::vector<Entry> stack;
+            stack.reserve(64);
+            stack.push_back({0, 0x3Fu});
+            while (!stack.empty()) {
+                Entry e = stack.back();
+                stack.pop_back();
+                const BvhNode& n = nodes[e.node];
+                ++visited;
+                unsigned mask = e.mask;
+                CullResult r = frustum.classify(n.bounds, mask);
+                if (r == CullResult::Outside)
+                    continue;
+                if (r == CullResult::Inside) {
+                    appendSubtree(e.node, visible, visited);
+                    continue;
+                }
+                if (n.isLeaf()) {
+                    for (int i = 0; i < n.itemCount; ++i) {
+                        int item = items[n.firstItem + i];
+                        unsigned itemMask = mask;
+                        if (frustum.classify(itemBounds[item], itemMask) != CullResult::Outside)
+                            visible.push_back(item);
+                    }
+                } else {
+                    stack.push_back({n.right, mask});
+                    stack.push_back({n.left, mask});
+                }
+            }
+        }
+
+        if (stats) {
+            stats->visible = (int)visible.size();
+            stats->nodesVisited = visited;
+            stats->cullTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    float sahCost() const {
+        if (nodes.empty()) return 0.0f;
+        float rootArea = std::max(nodes[0].bounds.surfaceArea(), 1e-12f);
+        float cost = 0.0f;
+        for (const BvhNode& n : nodes) {
+            float area = n.bounds.surfaceArea() / rootArea;
+            cost += n.isLeaf() ? area * n.itemCount : area * 1.2f;
+        }
+        return cost;
+    }
+
+    const std::vector<BvhNode>& getNodes() const { return nodes; }
+    const std::vector<int>& getItems() const { return items; }
+    const AABB& getItemBounds(int objectIndex) const { return itemBounds[objectIndex]; }
+    size_t objectCount() const { return itemBounds.size(); }
+
+private:
+    std::vector<BvhNode> nodes;
+    std::vector<int> items;
+    std::vector<int> leafOfItem;
+    std::vector<AABB> itemBounds;
+    std::vector<glm::vec3> centroids;
+    float builtCost = 0.0f;
+    int updatesSinceBuild = 0;
+
+    int buildRecursive(int begin, int end, int parent) {
+        int index = (int)nodes.size();
+        nodes.push_back(BvhNode());
+        nodes[index].parent = parent;
+
+        AABB box, centroidBox;
+        for (int i = begin; i < end; ++i) {
+            box.expand(itemBounds[items[i]]);
+            centroidBox.expand(centroids[items[i]]);
+        }
+        nodes[index].bounds = box;
+
+        int count = end - begin;
+        int mid = count > MaxLeafItems ? findSplit(begin, end, centroidBox) : -1;
+        if (mid < 0) {
+            nodes[index].firstItem = begin;
+            nodes[index].itemCount = count;
+            for (int i = begin; i < end; ++i)
+                leafOfItem[items[i]] = index;
+            return index;
+        }
+
+        int left = buildRecursive(begin, mid, index);
+        int right = buildRecursive(mid, end, index);
+        nodes[index].left = left;
+        nodes[index].right = right;
+        return index;
+    }
+
+    // Particiona items[begin, end) pelo melhor plano SAH e devolve o ponto de corte
+    int findSplit(int begin, int end, const AABB& centroidBox) {
+        glm::vec3 size = centroidBox.max - centroidBox.min;
+        int axis = 0;
+        if (size.y > size.x) axis = 1;
+        if (size.z > size[axis]) axis = 2;
+        float lo = centroidBox.min[axis];
+        float extent = size[axis];
+
+        if (extent <= 1e-6f) {
+            // Centros coincidentes: divide ao meio para não gerar folhas enormes
+            return begin + (end - begin) / 2;
+        }
+
+        AABB binBounds[SahBins];
+        int binCount[SahBins] = {};
+        float scale = SahBins / extent;
+        auto binOf = [&](int item) {
+            int b = (int)((centroids[item][axis] - lo) * scale);
+            return std::min(std::max(b, 0), SahBins - 1);
+        };
+        for (int i = begin; i < end; ++i) {
+            int b = binOf(items[i]);
+            binCount[b]++;
+            binBounds[b].expand(itemBounds[items[i]]);
+        }
+
+        float rightArea[SahBins];
+        int rightCount[SahBins];
+        AABB acc;
+        int accCount = 0;
+        for (int b = SahBins - 1; b > 0; --b) {
+            acc.expand(binBounds[b]);
+            accCount += binCount[b];
+            rightArea[b] = acc.isValid() ? acc.surfaceArea() : 0.0f;
+            rightCount[b] = accCount;
+        }
+
+        float bestCost = FLT_MAX;
+        int bestBin = -1;
+        acc = AABB();
+        accCount = 0;
+        for (int b = 1; b < SahBins; ++b) {
+            acc.expand(binBounds[b - 1]);
+            accCount += binCount[b - 1];
+            if (accCount == 0 || rightCount[b] == 0) continue;
+            float cost = acc.surfaceArea() * accCount + rightArea[b] * rightCount[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = b;
+            }
+        }
+        if (bestBin < 0)
+            return begin + (end - begin) / 2;
+
+        int* mid = std::partition(items.data() + begin, items.data() + end,
+                                  [&](int item) { return binOf(item) < bestBin; });
+        return (int)(mid - items.data());
+    }
+
+    void appendSubtree(int node, std::vector<int>& visible, int& visited) const {
+        const BvhNode& n = nodes[node];
+        if (n.isLeaf()) {
+            visible.insert(visible.end(), items.begin() + n.firstItem, items.begin() + n.firstItem + n.itemCount);
+            return;
+        }
+        visited += 2;
+        appendSubtree(n.left, visible, visited);
+        appendSubtree(n.right, visible, visited);
+    }
+};
@@ -0,0 +1,263 @@
+#pragma once
+
+// Pré-passe de profundidade para o forward: os objetos são desenhados antes só com
+// posições (VAO de posições, fragment shader vazio, sem cor) e o passe principal roda
+// com GL_EQUAL e sem escrever profundidade, então cada pixel é sombreado uma vez só.
+// O custo é processar os vértices duas vezes, então o pré-passe só vale com overdraw.
+//
+//   prepass.init();
+//   bool ran = prepass.shouldRun();
+//   if (ran) {
+//       prepass.begin(projection, view);
+//       prepass.draw(depthVAO, model, nVertices);       // mesmo conjunto e ordem do passe principal
+//       prepass.end();
+//   }
+//   prepass.beginMainPass(ran);
+//   ... passe principal ...
+//   prepass.endMainPass();
+//
+// Overdraw medido com occlusion queries (GL_SAMPLES_PASSED): no pré-passe, com GL_LESS
+// na mesma ordem do passe principal, passam exatamente os fragmentos que o forward sem
+// pré-passe sombrearia; no passe principal com GL_EQUAL passa um por pixel visível.
+// overdraw = sombreados / visíveis. Sem pré-passe só os sombreados são conhecidos, e os
+// visíveis vêm da última medição com pré-passe.
+//
+// No modo Auto o pré-passe liga quando o overdraw passa do limiar e desliga abaixo de
+// 80% dele; desligado, roda uma vez a cada ProbeInterval quadros para atualizar a
+// contagem de visíveis. Os resultados são lidos com FrameLatency quadros de atraso,
+// sem bloquear (como no GpuProfiler).
+//
+// O vertex shader do passe principal precisa de "invariant gl_Position" e da mesma
+// expressão (projection * view * model * posição) para o GL_EQUAL ser exato.
+//
+// beginOverdrawView/drawOverdraw/endOverdrawView desenham a complexidade de
+// profundidade: cada fragmento que passa no teste (o que o forward sombrearia) soma
+// uma cor fixa, então as áreas mais claras são as mais sombreadas.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+struct DepthPrepassStats {
+    uint64_t shadedFragments = 0;    // fragmentos que o forward sem pré-passe sombreia
+    uint64_t visiblePixels = 0;      // 0 enquanto não houve medição com pré-passe
+    bool active = false;             // decisão atual (modo Auto)
+
+    double overdraw() const { return visiblePixels ? (double)shadedFragments / (double)visiblePixels : 0.0; }
+};
+
+class DepthPrepass {
+public:
+    enum Mode { Off, On, Auto };
+    static const int FrameLatency = 4;
+    static const int ProbeInterval = 60;
+
+    static Mode parseMode(const std::string& name) {
+        if (name == "on") return On;
+        if (name == "auto") return Auto;
+        return Off;
+    }
+    static const char* modeName(Mode mode) { return mode == On ? "on" : (mode == Auto ? "auto" : "off"); }
+
+    bool init() {
+        depthProgram = createProgram(R"(
+#version 400
+void main()
+{
+})");
+        overdrawProgram = createProgram(R"(
+#version 400
+uniform vec4 color;
+out vec4 FragColor;
+void main()
+{
+    FragColor = color;
+})");
+        if (!depthProgram || !overdrawProgram)
+            return false;
+        glGenQueries(FrameLatency * 2, &queries[0][0]);
+        return true;
+    }
+
+    void shutdown() {
+        if (depthProgram) glDeleteProgram(depthProgram);
+        if (overdrawProgram) glDeleteProgram(overdrawProgram);
+        if (queries[0][0]) glDeleteQueries(FrameLatency * 2, &queries[0][0]);
+        depthProgram = overdrawProgram = 0;
+        queries[0][0] = 0;
+    }
+
+    void setMode(Mode newMode) { currentMode = newMode; }
+    Mode mode() const { return currentMode; }
+    void setThreshold(float overdrawThreshold) { threshold = overdrawThreshold; }
+    float getThreshold() const { return threshold; }
+    const DepthPrepassStats& stats() const { return lastStats; }
+
+    // Decide se o quadro atual tem pré-passe
+    bool shouldRun() const {
+        if (currentMode != Auto) return currentMode == On;
+        return lastStats.active || frame - lastProbeFrame >= ProbeInterval || !lastStats.visiblePixels;
+    }
+
+    void begin(const glm::mat4& projection, const glm::mat4& view) {
+        collect();
+        slots[slot].ranPrepass = true;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        useProgram(depthProgram, projection, view);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glBeginQuery(GL_SAMPLES_PASSED, queries[slot][0]);
+        lastProbeFrame = frame;
+    }
+
+    void draw(GLuint positionVAO, const glm::mat4& model, int vertexCount) {
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+        glBindVertexArray(positionVAO);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    }
+
+    void end() {
+        glEndQuery(GL_SAMPLES_PASSED);
+        glBindVertexArray(0);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glUseProgram((GLuint)previousProgram);
+    }
+
+    // Com pré-passe, GL_EQUAL e sem escrita de profundidade (o pré-passe já escreveu)
+    void beginMainPass(bool prepassRan) {
+        if (!prepassRan) {
+            collect();
+            slots[slot].ranPrepass = false;
+        } else {
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
+        }
+        glBeginQuery(GL_SAMPLES_PASSED, queries[slot][1]);
+        slots[slot].pending = true;
+    }
+
+    void endMainPass() {
+        glEndQuery(GL_SAMPLES_PASSED);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        slot = (slot + 1) % FrameLatency;
+        ++frame;
+    }
+
+    // Visualização do overdraw: substitui o passe principal
+    void beginOverdrawView(const glm::mat4& projection, const glm::mat4& view) {
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        useProgram(overdrawProgram, projection, view);
+        glUniform4f(glGetUniformLocation(overdrawProgram, "color"), 0.1f, 0.05f, 0.02f, 0.0f);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+    }
+
+    void drawOverdraw(GLuint positionVAO, const glm::mat4& model, int vertexCount) { draw(positionVAO, model, vertexCount); }
+
+    void endOverdrawView() {
+        glDisable(GL_BLEND);
+        glBindVertexArray(0);
+        glUseProgram((GLuint)previousProgram);
+    }
+
+private:
+    struct Slot {
+        bool pending = false;
+        bool ranPrepass = false;
+    };
+
+    Mode currentMode = Off;
+    float threshold = 1.5f;
+    GLuint depthProgram = 0;
+    GLuint overdrawProgram = 0;
+    GLuint queries[FrameLatency][2] = {};   // [slot][0] pré-passe, [slot][1] passe principal
+    Slot slots[FrameLatency];
+    int slot = 0;
+    int64_t frame = 0;
+    int64_t lastProbeFrame = -ProbeInterval;
+    GLint previousProgram = 0;
+    GLint modelLocation = -1;
+    DepthPrepassStats lastStats;
+
+    void useProgram(GLuint program, const glm::mat4& projection, const glm::mat4& view) {
+        glUseProgram(program);
+        modelLocation = glGetUniformLocation(program, "model");
+        glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+    }
+
+    // Lê o quadro que ocupava o slot atual, se as consultas já terminaram
+    void collect() {
+        Slot& s = slots[slot];
+        if (!s.pending) return;
+        s.pending = false;
+        // As duas consultas (pré-passe e principal) precisam ter terminado; senão o quadro
+        // é descartado em vez de esperar a GPU
+        GLuint available = 0, prepassAvailable = 1;
+        glGetQueryObjectuiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (s.ranPrepass)
+            glGetQueryObjectuiv(queries[slot][0], GL_QUERY_RESULT_AVAILABLE, &prepassAvailable);
+        if (!available || !prepassAvailable) return;
+        GLuint64 mainSamples = 0;
+        glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &mainSamples);
+        if (s.ranPrepass) {
+            GLuint64 prepassSamples = 0;
+            glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &prepassSamples);
+            lastStats.shadedFragments = prepassSamples;
+            lastStats.visiblePixels = mainSamples;
+        } else {
+            lastStats.shadedFragments = mainSamples;
+        }
+        if (currentMode == Auto && lastStats.visiblePixels) {
+            double overdraw = lastStats.overdraw();
+            if (overdraw > threshold) lastStats.active = true;
+            else if (overdraw < threshold * 0.8) lastStats.active = false;
+        } else {
+            lastStats.active = currentMode == On;
+        }
+    }
+
+    static GLuint createProgram(const GLchar* fragmentSource) {
+        // Mesma expressão e "invariant" do vertex shader do passe principal
+        const GLchar* vertexSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+invariant gl_Position;
+void main()
+{
+    gl_Position = projection * view * model * vec4(position, 1.0);
+})";
+        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &vertexSource, NULL);
+        glCompileShader(vertexShader);
+        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+        glCompileShader(fragmentShader);
+
+        GLuint shaderProgram = glCreateProgram();
+        glAttachShader(shaderProgram, vertexShader);
+        glAttachShader(shaderProgram, fragmentShader);
+        glLinkProgram(shaderProgram);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        GLint success;
+        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::DEPTH_PREPASS::LINKING_FAILED\n" << infoLog << std::endl;
+            glDeleteProgram(shaderProgram);
+            return 0;
+        }
+        return shaderProgram;
+    }
+};
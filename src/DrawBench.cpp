@@ -0,0 +1,625 @@
+// Custo de CPU do envio de muitas malhas diferentes: N malhas pequenas e distintas
+// (esferas deformadas, resoluções variadas) desenhadas de três jeitos:
+//
+//   vao         um VAO/VBO/IBO por malha, uniform de modelo + glDrawElements por malha
+//   basevertex  todas na GeometryArena (um VAO), uniform + glDrawElementsBaseVertex
+//   indirect    arena + IndirectDrawList: um glMultiDrawElementsIndirect (GL 4.3) ou,
+//               com --no-mdi / sem 4.3, o laço de glDrawElementsIndirect
+//
+// Para cada modo imprime o tempo de CPU do envio (até a última chamada, sem esperar a
+// GPU) e o tempo do quadro com glFinish.
+//
+// Com --obj (um OBJ com MTL) ou --materials N (OBJ sintético com N materiais trocando a
+// cada quad) compara os materiais (MaterialDrawList.h):
+//
+//   runs       um desenho por "usemtl", na ordem do arquivo
+//   materials  um desenho por material, faixas agrupadas pelo leitor
+//
+// Com --queue N compara N pacotes da RenderQueue (4 programas, 16 texturas e 128 VAOs
+// sorteados, como no "./Benchmarks queue") com o GlRenderBackend de verdade:
+//
+//   binds      ordem de cena, programa/textura/VAO ligados a cada desenho
+//   unsorted   fila na ordem de cena, pulando binds repetidos
+//   sorted     fila ordenada (chaves + radix sort contados no envio)
+//
+// Uso: DrawBench [--headless LxA] [--meshes N] [--frames N] [--no-mdi] [--obj arquivo] [--materials N] [--queue N]
+//      ./DrawBench --headless 1280x720 --meshes 10000 --frames 200
+//      ./DrawBench --headless 1280x720 --materials 256
+//      ./DrawBench --headless 1280x720 --queue 50000
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "GeometryArena.h"
+#include "Headless.h"
+#include "MaterialDrawList.h"
+#include "NormalMatrix.h"
+#include "ObjMesh.h"
+#include "RenderQueue.h"
+
+using namespace std;
+using namespace glm;
+
+typedef chrono::steady_clock Clock;
+
+const GLchar* vertexShaderSource = R"(
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+uniform mat4 model;
+uniform mat3 normalMatrix;
+uniform mat4 viewProjection;
+uniform bool useDrawData;
+out vec3 vNormal;
+void main()
+{
+    mat4 objectModel = useDrawData ? drawDataModel() : model;
+    mat3 objectNormalMatrix = useDrawData ? drawDataNormalMatrix() : normalMatrix;
+    vNormal = objectNormalMatrix * normal;
+    gl_Position = viewProjection * objectModel * vec4(position, 1.0);
+})";
+
+const GLchar* fragmentShaderSource = R"(
+#version 400
+in vec3 vNormal;
+out vec4 FragColor;
+void main()
+{
+    float diffuse = max(dot(normalize(vNormal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+    FragColor = vec4(vec3(0.15 + 0.85 * diffuse), 1.0);
+})";
+
+const GLchar* queueVertexShaderSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texCoord;
+uniform mat4 model;
+uniform mat3 normalMatrix;
+uniform mat4 viewProjection;
+out vec3 vNormal;
+out vec2 vTexCoord;
+void main()
+{
+    vNormal = normalMatrix * normal;
+    vTexCoord = texCoord;
+    gl_Position = viewProjection * model * vec4(position, 1.0);
+})";
+
+// Precedido de "#version 400" e de "const vec3 tint = ...", diferente em cada programa
+const GLchar* queueFragmentShaderSource = R"(
+in vec3 vNormal;
+in vec2 vTexCoord;
+uniform sampler2D diffuseTexture;
+out vec4 FragColor;
+void main()
+{
+    float diffuse = max(dot(normalize(vNormal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+    FragColor = vec4(texture(diffuseTexture, vTexCoord).rgb * tint * (0.15 + 0.85 * diffuse), 1.0);
+})";
+
+const GLchar* materialVertexShaderSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texCoord;
+uniform mat4 viewProjection;
+out vec3 vNormal;
+out vec2 vTexCoord;
+void main()
+{
+    vNormal = normal;
+    vTexCoord = texCoord;
+    gl_Position = viewProjection * vec4(position, 1.0);
+})";
+
+// Vem depois de "#version 400" e MaterialDrawList::shaderSource()
+const GLchar* materialFragmentShaderSource = R"(
+in vec3 vNormal;
+in vec2 vTexCoord;
+out vec4 FragColor;
+void main()
+{
+    float diffuse = max(dot(normalize(vNormal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+    vec3 color = materialAmbient.rgb * 0.1 + materialDiffuseColor(vTexCoord) * diffuse + materialEmissive.rgb;
+    FragColor = vec4(color, materialDiffuse.a);
+})";
+
+// Malha separada (modo vao)
+struct SeparateMesh {
+    GLuint vao = 0, vertexBuffer = 0, indexBuffer = 0;
+    GLsizei indexCount = 0;
+};
+
+GLuint setupShader(int vertexCount, const GLchar** vertexSources, int fragmentCount, const GLchar** fragmentSources) {
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, vertexCount, vertexSources, NULL);
+    glCompileShader(vertexShader);
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, fragmentCount, fragmentSources, NULL);
+    glCompileShader(fragmentShader);
+
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLchar infoLog[512];
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Início de uma linha de resultado: modo e tempos médios por quadro; o resto vai entre
+// os parênteses
+void printTimes(const char* mode, double submitMs, double frameMs) {
+    cout << left << setw(10) << mode << right << fixed << setprecision(3) << "  submit: " << setw(8) << submitMs
+         << " ms  frame: " << setw(8) << frameMs << " ms  (";
+}
+
+// Esfera UV com o raio deformado por um ruído da própria malha; cada uma tem resolução
+// e forma diferentes, então nenhuma pode ser instanciada a partir de outra
+void generateMesh(mt19937& random, vector<MeshVertex>& vertices, vector<uint32_t>& indices) {
+    uniform_int_distribution<int> segmentsDistribution(6, 12);
+    uniform_real_distribution<float> amplitude(0.0f, 0.25f), phase(0.0f, 6.2831853f);
+    int rings = segmentsDistribution(random), segments = segmentsDistribution(random) + 2;
+    float a = amplitude(random), b = amplitude(random), p = phase(random), q = phase(random);
+
+    vertices.clear();
+    indices.clear();
+    for (int r = 0; r <= rings; ++r) {
+        float theta = 3.14159265f * r / rings;
+        for (int s = 0; s <= segments; ++s) {
+            float phi = 6.2831853f * s / segments;
+            vec3 direction(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+            float radius = 0.4f * (1.0f + a * sin(3.0f * phi + p) * sin(theta) + b * cos(2.0f * theta + q));
+            MeshVertex vertex;
+            vertex.position = direction * radius;
+            vertex.normal = direction;
+            vertex.texCoord = vec2((float)s / segments, (float)r / rings);
+            vertices.push_back(vertex);
+        }
+    }
+    for (int r = 0; r < rings; ++r) {
+        for (int s = 0; s < segments; ++s) {
+            uint32_t i0 = r * (segments + 1) + s, i1 = i0 + segments + 1;
+            indices.insert(indices.end(), {i0, i1, i0 + 1, i0 + 1, i1, i1 + 1});
+        }
+    }
+}
+
+// Modos runs/materials: um MaterialMesh inteiro na frente da câmera
+int runMaterialBench(GLFWwindow* window, HeadlessRun& headless, const MaterialMesh& mesh, int frames) {
+    if (mesh.vertices.empty()) {
+        cout << "No faces to draw" << endl;
+        return -1;
+    }
+    const GLchar* vertexSources[1] = {materialVertexShaderSource};
+    const GLchar* fragmentSources[3] = {"#version 400\n", MaterialDrawList::shaderSource(), materialFragmentShaderSource};
+    GLuint program = setupShader(1, vertexSources, 3, fragmentSources);
+    if (!program) return -1;
+
+    MaterialDrawList materials;
+    materials.init(mesh, 0, 0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
+    glEnableVertexAttribArray(2);
+    glBindVertexArray(0);
+    materials.bindProgram(program);
+
+    AABB bounds = computeAABB(&mesh.vertices[0].position, mesh.vertices.size(), sizeof(MeshVertex));
+    float radius = std::max(glm::length(bounds.extents()), 1e-3f);
+    int width = headless.enabled() ? headless.getWidth() : 1280, height = headless.enabled() ? headless.getHeight() : 720;
+    mat4 viewProjection = perspective(radians(60.0f), (float)width / height, radius * 0.1f, radius * 4.0f)
+                        * lookAt(bounds.center() + vec3(0.0f, 0.0f, radius * 2.0f), bounds.center(), vec3(0.0f, 1.0f, 0.0f));
+    glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, value_ptr(viewProjection));
+
+    cout << mesh.materials.size() << " materials, " << mesh.indices.size() / 3 << " triangles, " << materials.runCount()
+         << " usemtl runs, " << materials.rangeCount() << " material ranges" << endl;
+
+    const char* modeNames[2] = {"runs", "materials"};
+    for (int mode = 0; mode < 2 && !glfwWindowShouldClose(window); ++mode) {
+        double submitTotal = 0.0, frameTotal = 0.0;
+        int measured = 0;
+        for (int frame = 0; frame < frames + 5 && !glfwWindowShouldClose(window); ++frame) {
+            glfwPollEvents();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            auto start = Clock::now();
+            if (mode == 0) materials.drawRuns();
+            else materials.draw();
+            double submitMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+            glFinish();
+            double frameMs = chrono::duration<double, milli>(Clock::now() - start).count();
+            glfwSwapBuffers(window);
+            if (frame >= 5) {
+                submitTotal += submitMs;
+                frameTotal += frameMs;
+                ++measured;
+            }
+        }
+        const MaterialDrawStats& stats = materials.stats();
+        if (!measured) continue;
+        printTimes(modeNames[mode], submitTotal / measured, frameTotal / measured);
+        cout << stats.draws << " draw calls, " << stats.materialBinds << " material binds, " << stats.textureBinds << " texture binds)" << endl;
+    }
+
+    materials.shutdown();
+    glDeleteProgram(program);
+    return 0;
+}
+
+void setupVertexFormat() {
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(1);
+}
+
+// Modos binds/unsorted/sorted: pacotes numa grade na frente da câmera, com estado sorteado
+int runQueueBench(GLFWwindow* window, HeadlessRun& headless, int packetCount, int frames) {
+    const int programCount = 4, textureCount = 16, vaoCount = 128;
+    mt19937 random(3);
+
+    vector<GLuint> programs(programCount);
+    for (int i = 0; i < programCount; ++i) {
+        string tint = "const vec3 tint = vec3(" + to_string(0.6f + 0.1f * i) + ", 0.8, " + to_string(1.0f - 0.1f * i) + ");\n";
+        const GLchar* fragmentSources[3] = {"#version 400\n", tint.c_str(), queueFragmentShaderSource};
+        programs[i] = setupShader(1, &queueVertexShaderSource, 3, fragmentSources);
+        if (!programs[i]) return -1;
+    }
+
+    vector<GLuint> textures(textureCount);
+    glGenTextures(textureCount, textures.data());
+    for (int i = 0; i < textureCount; ++i) {
+        uint8_t texels[4 * 4 * 4];
+        for (int t = 0; t < 16; ++t) {
+            texels[t * 4 + 0] = (uint8_t)(random() & 0xFF);
+            texels[t * 4 + 1] = (uint8_t)(random() & 0xFF);
+            texels[t * 4 + 2] = (uint8_t)(random() & 0xFF);
+            texels[t * 4 + 3] = 255;
+        }
+        glBindTexture(GL_TEXTURE_2D, textures[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // VAOs sem índices (o GlRenderBackend usa glDrawArrays)
+    vector<GLuint> vaos(vaoCount), vertexBuffers(vaoCount);
+    vector<GLsizei> vertexCounts(vaoCount);
+    glGenVertexArrays(vaoCount, vaos.data());
+    glGenBuffers(vaoCount, vertexBuffers.data());
+    vector<MeshVertex> vertices, expanded;
+    vector<uint32_t> indices;
+    for (int i = 0; i < vaoCount; ++i) {
+        generateMesh(random, vertices, indices);
+        expanded.clear();
+        for (uint32_t index : indices)
+            expanded.push_back(vertices[index]);
+        glBindVertexArray(vaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, expanded.size() * sizeof(MeshVertex), expanded.data(), GL_STATIC_DRAW);
+        setupVertexFormat();
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
+        glEnableVertexAttribArray(2);
+        vertexCounts[i] = (GLsizei)expanded.size();
+    }
+    glBindVertexArray(0);
+
+    int columns = (int)ceil(sqrt((double)packetCount));
+    int width = headless.enabled() ? headless.getWidth() : 1280, height = headless.enabled() ? headless.getHeight() : 720;
+    mat4 view = lookAt(vec3(0.0f, 0.0f, columns * 0.9f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+    mat4 viewProjection = perspective(radians(60.0f), (float)width / height, 0.1f, columns * 2.0f) * view;
+    for (GLuint program : programs) {
+        glUseProgram(program);
+        glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, value_ptr(viewProjection));
+        glUniform1i(glGetUniformLocation(program, "diffuseTexture"), 0);
+    }
+    glActiveTexture(GL_TEXTURE0);
+
+    uniform_int_distribution<int> pickProgram(0, programCount - 1), pickTexture(0, textureCount - 1), pickVao(0, vaoCount - 1);
+    vector<RenderPacket> scene(packetCount);
+    vector<float> depths(packetCount);
+    for (int i = 0; i < packetCount; ++i) {
+        RenderPacket& packet = scene[i];
+        int vao = pickVao(random);
+        packet.program = programs[pickProgram(random)];
+        packet.texture = textures[pickTexture(random)];
+        packet.vao = vaos[vao];
+        packet.count = vertexCounts[vao];
+        vec3 position((i % columns - columns * 0.5f) + 0.5f, (i / columns - columns * 0.5f) + 0.5f, -(float)(i % 7));
+        packet.model = rotate(translate(mat4(1.0f), position), 0.1f * i, vec3(0.0f, 1.0f, 0.0f));
+        packet.normalMatrix = computeNormalMatrix(packet.model);
+        depths[i] = -(view * packet.model[3]).z;
+    }
+
+    // Localizações guardadas também no modo binds: a diferença fica só nos binds e na ordem
+    vector<GLint> modelLocations(programCount), normalMatrixLocations(programCount);
+    for (int i = 0; i < programCount; ++i) {
+        modelLocations[i] = glGetUniformLocation(programs[i], "model");
+        normalMatrixLocations[i] = glGetUniformLocation(programs[i], "normalMatrix");
+    }
+    auto programIndex = [&](GLuint program) { return (int)(find(programs.begin(), programs.end(), program) - programs.begin()); };
+    vector<int> packetPrograms(packetCount);
+    for (int i = 0; i < packetCount; ++i)
+        packetPrograms[i] = programIndex(scene[i].program);
+
+    cout << packetCount << " packets, " << programCount << " programs, " << textureCount << " textures, " << vaoCount << " VAOs" << endl;
+
+    RenderQueue queue;
+    queue.setDepthRange(0.1f, columns * 2.0f);
+    GlRenderBackend backend;
+    const char* modeNames[3] = {"binds", "unsorted", "sorted"};
+    for (int mode = 0; mode < 3 && !glfwWindowShouldClose(window); ++mode) {
+        double submitTotal = 0.0, frameTotal = 0.0, sortTotal = 0.0;
+        int measured = 0;
+        for (int frame = 0; frame < frames + 5 && !glfwWindowShouldClose(window); ++frame) {
+            glfwPollEvents();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            auto start = Clock::now();
+            if (mode == 0) {
+                for (int i = 0; i < packetCount; ++i) {
+                    const RenderPacket& packet = scene[i];
+                    glUseProgram(packet.program);
+                    glBindTexture(GL_TEXTURE_2D, packet.texture);
+                    glBindVertexArray(packet.vao);
+                    glUniformMatrix4fv(modelLocations[packetPrograms[i]], 1, GL_FALSE, value_ptr(packet.model));
+                    glUniformMatrix3fv(normalMatrixLocations[packetPrograms[i]], 1, GL_FALSE, value_ptr(packet.normalMatrix));
+                    glDrawArrays(GL_TRIANGLES, packet.first, packet.count);
+                }
+                glBindVertexArray(0);
+            } else {
+                queue.clear();
+                for (int i = 0; i < packetCount; ++i)
+                    queue.add(0, scene[i], depths[i]);
+                if (mode == 2) queue.sort();
+                queue.submit(backend);
+            }
+            double submitMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+            glFinish();
+            double frameMs = chrono::duration<double, milli>(Clock::now() - start).count();
+            glfwSwapBuffers(window);
+            if (frame >= 5) {
+                submitTotal += submitMs;
+                frameTotal += frameMs;
+                sortTotal += mode == 2 ? queue.stats().sortMs : 0.0;
+                ++measured;
+            }
+        }
+        if (!measured) continue;
+        int stateChanges = mode == 0 ? 3 * packetCount : queue.stats().stateChanges();
+        printTimes(modeNames[mode], submitTotal / measured, frameTotal / measured);
+        cout << stateChanges << " state changes";
+        if (mode == 2) cout << ", radix sort " << sortTotal / measured << " ms";
+        cout << ")" << endl;
+    }
+
+    glDeleteVertexArrays(vaoCount, vaos.data());
+    glDeleteBuffers(vaoCount, vertexBuffers.data());
+    glDeleteTextures(textureCount, textures.data());
+    for (GLuint program : programs)
+        glDeleteProgram(program);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    HeadlessRun headless(argc, argv);
+    int meshCount = 10000;
+    int frames = 100;
+    bool multiDrawRequested = true;
+    string objPath;
+    int syntheticMaterials = 0;
+    int queuePackets = 0;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--meshes" && i + 1 < argc) meshCount = max(1, min(atoi(argv[++i]), GeometryArena::MaxDraws));
+        else if (arg == "--frames" && i + 1 < argc) frames = max(1, atoi(argv[++i]));
+        else if (arg == "--no-mdi") multiDrawRequested = false;
+        else if (arg == "--obj" && i + 1 < argc) objPath = argv[++i];
+        else if (arg == "--materials" && i + 1 < argc) syntheticMaterials = max(1, atoi(argv[++i]));
+        else if (arg == "--queue" && i + 1 < argc) queuePackets = max(1, atoi(argv[++i]));
+    }
+
+    MaterialMesh materialMesh;
+    if (syntheticMaterials > 0) {
+        objPath = (filesystem::temp_directory_path() / "cg_drawbench_materials.obj").string();
+        if (!writeSyntheticMaterialObj(objPath, syntheticMaterials, 20000, 7))
+            return -1;
+    }
+    if (!objPath.empty()) {
+        bool loaded = loadObjWithMaterials(objPath, materialMesh);
+        if (syntheticMaterials > 0) {
+            std::error_code ignored;
+            filesystem::remove(objPath, ignored);
+            filesystem::remove(filesystem::path(objPath).replace_extension(".mtl"), ignored);
+        }
+        if (!loaded)
+            return -1;
+    }
+
+    headless.initGlfw();
+    GLFWwindow* window = headless.createWindow(1280, 720, "DrawBench");
+    if (!window) return -1;
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        cout << "Failed to initialize GLAD" << endl;
+        return -1;
+    }
+    headless.setupFramebuffer();
+    glfwSwapInterval(0);
+    glEnable(GL_DEPTH_TEST);
+
+    if (queuePackets > 0) {
+        int result = runQueueBench(window, headless, queuePackets, frames);
+        headless.finish();
+        glfwTerminate();
+        return result;
+    }
+    if (!objPath.empty()) {
+        int result = runMaterialBench(window, headless, materialMesh, frames);
+        headless.finish();
+        glfwTerminate();
+        return result;
+    }
+
+    const GLchar* vertexSources[3] = {"#version 400\n", IndirectDrawList::vertexSource(), vertexShaderSource};
+    GLuint program = setupShader(3, vertexSources, 1, &fragmentShaderSource);
+    if (!program) return -1;
+
+    // Malhas: separadas e na arena, com os mesmos dados
+    mt19937 random(11);
+    vector<MeshVertex> vertices;
+    vector<uint32_t> indices;
+    vector<SeparateMesh> separate(meshCount);
+    GeometryArena arena;
+    arena.init(sizeof(MeshVertex), meshCount * 14 * 15, meshCount * 12 * 14 * 6);
+    setupVertexFormat();
+    arena.enableDrawId(4);
+    glBindVertexArray(0);
+    vector<int> arenaMeshes(meshCount);
+    size_t triangleCount = 0;
+    for (int i = 0; i < meshCount; ++i) {
+        generateMesh(random, vertices, indices);
+        SeparateMesh& mesh = separate[i];
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vertexBuffer);
+        glGenBuffers(1, &mesh.indexBuffer);
+        glBindVertexArray(mesh.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+        setupVertexFormat();
+        glBindVertexArray(0);
+        mesh.indexCount = (GLsizei)indices.size();
+        arenaMeshes[i] = arena.addMesh(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+        triangleCount += indices.size() / 3;
+    }
+    if (arenaMeshes.back() < 0) return -1;
+
+    IndirectDrawList draws;
+    draws.init(0);
+    draws.setMultiDraw(multiDrawRequested);
+
+    // Grade quadrada de malhas na frente da câmera
+    int columns = (int)ceil(sqrt((double)meshCount));
+    vector<mat4> models(meshCount);
+    vector<mat3> normalMatrices(meshCount);
+    for (int i = 0; i < meshCount; ++i) {
+        vec3 position((i % columns - columns * 0.5f) + 0.5f, (i / columns - columns * 0.5f) + 0.5f, 0.0f);
+        models[i] = rotate(translate(mat4(1.0f), position), 0.1f * i, vec3(0.0f, 1.0f, 0.0f));
+        normalMatrices[i] = computeNormalMatrix(models[i]);
+    }
+    int width = headless.enabled() ? headless.getWidth() : 1280, height = headless.enabled() ? headless.getHeight() : 720;
+    mat4 viewProjection = perspective(radians(60.0f), (float)width / height, 0.1f, columns * 2.0f)
+                        * lookAt(vec3(0.0f, 0.0f, columns * 0.9f), vec3(0.0f), vec3(0.0f, 1.0f, 0.0f));
+
+    glUseProgram(program);
+    GLint modelLocation = glGetUniformLocation(program, "model");
+    GLint normalMatrixLocation = glGetUniformLocation(program, "normalMatrix");
+    GLint useDrawDataLocation = glGetUniformLocation(program, "useDrawData");
+    glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, value_ptr(viewProjection));
+    glUniform1i(glGetUniformLocation(program, "drawData"), 0);
+
+    cout << meshCount << " meshes, " << triangleCount << " triangles, arena " << arena.usedBytes() / (1024 * 1024) << " MB, "
+         << (draws.multiDraw() ? "glMultiDrawElementsIndirect" : "glDrawElementsIndirect loop") << endl;
+
+    const char* modeNames[3] = {"vao", "basevertex", "indirect"};
+    for (int mode = 0; mode < 3 && !glfwWindowShouldClose(window); ++mode) {
+        double submitTotal = 0.0, frameTotal = 0.0;
+        int measured = 0;
+        // Os primeiros quadros de cada modo aquecem o driver e não entram na média
+        for (int frame = 0; frame < frames + 5 && !glfwWindowShouldClose(window); ++frame) {
+            glfwPollEvents();
+            glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            auto start = Clock::now();
+            if (mode == 0) {
+                glUniform1i(useDrawDataLocation, 0);
+                for (int i = 0; i < meshCount; ++i) {
+                    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, value_ptr(models[i]));
+                    glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, value_ptr(normalMatrices[i]));
+                    glBindVertexArray(separate[i].vao);
+                    glDrawElements(GL_TRIANGLES, separate[i].indexCount, GL_UNSIGNED_INT, nullptr);
+                }
+            } else if (mode == 1) {
+                glUniform1i(useDrawDataLocation, 0);
+                glBindVertexArray(arena.vertexArray());
+                for (int i = 0; i < meshCount; ++i) {
+                    const ArenaMesh& mesh = arena.mesh(arenaMeshes[i]);
+                    glUniformMatrix4fv(modelLocation, 1, GL_FALSE, value_ptr(models[i]));
+                    glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, value_ptr(normalMatrices[i]));
+                    glDrawElementsBaseVertex(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT,
+                                             (void*)(sizeof(uint32_t) * mesh.firstIndex), mesh.baseVertex);
+                }
+            } else {
+                glUniform1i(useDrawDataLocation, 1);
+                draws.clear();
+                for (int i = 0; i < meshCount; ++i)
+                    draws.add(arena.mesh(arenaMeshes[i]), models[i], normalMatrices[i]);
+                draws.submit(arena);
+            }
+            glBindVertexArray(0);
+            double submitMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+            glFinish();
+            double frameMs = chrono::duration<double, milli>(Clock::now() - start).count();
+            glfwSwapBuffers(window);
+            if (frame >= 5) {
+                submitTotal += submitMs;
+                frameTotal += frameMs;
+                ++measured;
+            }
+        }
+        if (!measured) continue;
+        printTimes(modeNames[mode], submitTotal / measured, frameTotal / measured);
+        cout << (mode < 2 ? meshCount : (draws.multiDraw() ? 1 : meshCount)) << " draw calls)" << endl;
+    }
+
+    draws.shutdown();
+    arena.shutdown();
+    for (SeparateMesh& mesh : separate) {
+        glDeleteVertexArrays(1, &mesh.vao);
+        glDeleteBuffers(1, &mesh.vertexBuffer);
+        glDeleteBuffers(1, &mesh.indexBuffer);
+    }
+    glDeleteProgram(program);
+    headless.finish();
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,413 @@
+#pragma once
+
+// Modo benchmark: reproduz uma linha do tempo de câmera/entrada lida de arquivo
+// e mede o tempo de CPU e de GPU de cada quadro.
+//
+//   ./M5 --bench ../assets/benchmarks/m5_orbit.txt [--bench-out m5.json|m5.csv]
+//        [--bench-warmup N] [--bench-dt s] [--budget-ms X] [--budget-stat median|p95|p99|max]
+//        [--headless 1280x720]
+//
+// Formato da linha do tempo (linhas começando com # são comentários):
+//
+//   camera <t> <x> <y> <z> <yaw> <pitch> <fov>   quadro-chave da câmera (interpolação linear)
+//   key    <t> <tecla>                           simula o pressionar de uma tecla (1, 2, W, ...)
+//
+// O tempo avança em passos fixos (--bench-dt, padrão 1/60 s), independente do relógio,
+// então duas execuções veem exatamente os mesmos quadros. O relatório traz mínimo,
+// mediana, p95, p99, média, máximo e histograma; com --budget-ms o processo termina
+// com código 1 se a estatística escolhida passar do orçamento (CPU ou GPU).
+//
+// Com addGpuPasses() os tempos por passe do GpuProfiler também entram no relatório
+// (o histórico do perfilador precisa de setRecordHistory(true)).
+//
+// O tempo de GPU usa GL_TIME_ELAPSED com algumas consultas em anel, lidas alguns
+// quadros depois, para não esperar pela GPU a cada quadro; sem timer queries
+// (GL < 3.3) só o tempo de CPU é registrado.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+
+#include "GpuProfiler.h"
+
+struct CameraPose {
+    glm::vec3 position = glm::vec3(0.0f, 0.0f, 3.0f);
+    float yaw = -90.0f;
+    float pitch = 0.0f;
+    float fov = 45.0f;
+};
+
+class CameraTimeline {
+public:
+    bool load(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open timeline: " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            std::istringstream iss(line);
+            std::string type;
+            if (!(iss >> type) || type[0] == '#')
+                continue;
+            if (type == "camera") {
+                Keyframe k;
+                if (iss >> k.time >> k.pose.position.x >> k.pose.position.y >> k.pose.position.z
+                        >> k.pose.yaw >> k.pose.pitch >> k.pose.fov)
+                    keyframes.push_back(k);
+                else
+                    std::cerr << path << ":" << lineNumber << ": invalid camera keyframe" << std::endl;
+            } else if (type == "key") {
+                KeyEvent e;
+                std::string name;
+                if ((iss >> e.time >> name) && (e.key = keyCode(name)) != GLFW_KEY_UNKNOWN)
+                    keyEvents.push_back(e);
+                else
+                    std::cerr << path << ":" << lineNumber << ": invalid key event" << std::endl;
+            } else {
+                std::cerr << path << ":" << lineNumber << ": unknown entry '" << type << "'" << std::endl;
+            }
+        }
+        std::stable_sort(keyframes.begin(), keyframes.end(), [](const Keyframe& a, const Keyframe& b) { return a.time < b.time; });
+        std::stable_sort(keyEvents.begin(), keyEvents.end(), [](const KeyEvent& a, const KeyEvent& b) { return a.time < b.time; });
+        return !keyframes.empty();
+    }
+
+    float duration() const {
+        float end = keyframes.empty() ? 0.0f : keyframes.back().time;
+        if (!keyEvents.empty())
+            end = std::max(end, keyEvents.back().time);
+        return end;
+    }
+
+    CameraPose sample(float time) const {
+        if (keyframes.empty()) return CameraPose();
+        if (time <= keyframes.front().time) return keyframes.front().pose;
+        if (time >= keyframes.back().time) return keyframes.back().pose;
+
+        size_t next = 1;
+        while (keyframes[next].time < time)
+            ++next;
+        const Keyframe& a = keyframes[next - 1];
+        const Keyframe& b = keyframes[next];
+        float span = b.time - a.time;
+        float s = span > 0.0f ? (time - a.time) / span : 1.0f;
+
+        CameraPose pose;
+        pose.position = glm::mix(a.pose.position, b.pose.position, s);
+        pose.yaw = a.pose.yaw + (b.pose.yaw - a.pose.yaw) * s;
+        pose.pitch = a.pose.pitch + (b.pose.pitch - a.pose.pitch) * s;
+        pose.fov = a.pose.fov + (b.pose.fov - a.pose.fov) * s;
+        return pose;
+    }
+
+    // Teclas com tempo em (from, to]
+    void keysBetween(float from, float to, std::vector<int>& keys) const {
+        for (const KeyEvent& e : keyEvents)
+            if (e.time > from && e.time <= to)
+                keys.push_back(e.key);
+    }
+
+private:
+    struct Keyframe {
+        float time = 0.0f;
+        CameraPose pose;
+    };
+    struct KeyEvent {
+        float time = 0.0f;
+        int key = GLFW_KEY_UNKNOWN;
+    };
+
+    std::vector<Keyframe> keyframes;
+    std::vector<KeyEvent> keyEvents;
+
+    static int keyCode(const std::string& name) {
+        if (name.size() == 1) {
+            char c = (char)std::toupper((unsigned char)name[0]);
+            // Os códigos da GLFW para dígitos e letras coincidem com o ASCII
+            if ((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z'))
+                return c;
+        }
+        if (name == "ESCAPE") return GLFW_KEY_ESCAPE;
+        if (name == "SPACE") return GLFW_KEY_SPACE;
+        return GLFW_KEY_UNKNOWN;
+    }
+};
+
+struct FrameTimeStats {
+    int frames = 0;
+    double minMs = 0.0, medianMs = 0.0, p95Ms = 0.0, p99Ms = 0.0, meanMs = 0.0, maxMs = 0.0;
+    std::vector<int> histogram;   // contagem por faixa de binWidthMs; a última faixa acumula o excedente
+
+    static FrameTimeStats compute(std::vector<double> samples, double binWidthMs, int binCount) {
+        FrameTimeStats s;
+        s.histogram.assign(binCount, 0);
+        if (samples.empty()) return s;
+
+        std::sort(samples.begin(), samples.end());
+        s.frames = (int)samples.size();
+        s.minMs = samples.front();
+        s.maxMs = samples.back();
+        s.medianMs = percentile(samples, 0.50);
+        s.p95Ms = percentile(samples, 0.95);
+        s.p99Ms = percentile(samples, 0.99);
+        double total = 0.0;
+        for (double t : samples) {
+            total += t;
+            int bin = std::min((int)(t / binWidthMs), binCount - 1);
+            s.histogram[bin]++;
+        }
+        s.meanMs = total / samples.size();
+        return s;
+    }
+
+    double byName(const std::string& name) const {
+        if (name == "median") return medianMs;
+        if (name == "p99") return p99Ms;
+        if (name == "max") return maxMs;
+        return p95Ms;
+    }
+
+private:
+    // Percentil pelo posto mais próximo (sempre um tempo realmente medido)
+    static double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = (size_t)std::ceil(p * sorted.size());
+        return sorted[std::min(std::max(rank, (size_t)1), sorted.size()) - 1];
+    }
+};
+
+class FrameBenchmark {
+public:
+    static const int HistogramBins = 40;
+    static const int GpuQueryLatency = 4;   // quadros entre emitir e ler uma consulta
+
+    FrameBenchmark(int argc, char** argv) {
+        std::string timelinePath;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) break;
+            if (arg == "--bench") timelinePath = argv[++i];
+            else if (arg == "--bench-out") outputPath = argv[++i];
+            else if (arg == "--bench-warmup") warmupFrames = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--bench-dt") timeStep = std::max(1e-4f, (float)std::atof(argv[++i]));
+            else if (arg == "--budget-ms") budgetMs = std::atof(argv[++i]);
+            else if (arg == "--budget-stat") budgetStat = argv[++i];
+            else if (arg == "--bench-bin-ms") binWidthMs = std::max(0.01, std::atof(argv[++i]));
+        }
+        if (!timelinePath.empty())
+            active = timeline.load(timelinePath);
+        if (!timelinePath.empty() && !active)
+            std::cerr << "Benchmark disabled: timeline has no camera keyframes" << std::endl;
+    }
+
+    bool enabled() const { return active; }
+
+    // Quadros totais (aquecimento + linha do tempo), para limitar o modo headless
+    int frameCount() const { return warmupFrames + (int)std::ceil(timeline.duration() / timeStep) + 1; }
+
+    // Passo fixo da linha do tempo, para animações que precisam ser reproduzíveis
+    float frameTimeStep() const { return timeStep; }
+
+    // Chamar depois de carregar a GLAD
+    void setup() {
+        if (!active) return;
+        gpuTimers = GLAD_GL_VERSION_3_3 != 0;
+        if (gpuTimers) {
+            glGenQueries(GpuQueryLatency, queries);
+        } else {
+            std::cout << "Timer queries unavailable: recording CPU times only" << std::endl;
+        }
+        std::cout << "Benchmark: " << frameCount() << " frames (" << warmupFrames << " warm-up), dt "
+                  << timeStep << " s" << std::endl;
+    }
+
+    // Início do quadro: devolve a pose da câmera e as teclas a simular neste quadro
+    void beginFrame(CameraPose& pose, std::vector<int>& keys) {
+        keys.clear();
+        if (!active) return;
+
+        int timelineFrame = frame - warmupFrames;
+        float time = std::max(0, timelineFrame) * timeStep;
+        if (timelineFrame == 0)
+            timeline.keysBetween(-1.0f, 0.0f, keys);
+        else if (timelineFrame > 0)
+            timeline.keysBetween(time - timeStep, time, keys);
+        pose = timeline.sample(time);
+
+        frameStart = std::chrono::steady_clock::now();
+        if (gpuTimers) {
+            collectGpuTime(frame - GpuQueryLatency);
+            glBeginQuery(GL_TIME_ELAPSED, queries[frame % GpuQueryLatency]);
+        }
+    }
+
+    // Fim do quadro (antes do glfwSwapBuffers). Fecha a janela ao fim da linha do tempo.
+    void endFrame(GLFWwindow* window) {
+        if (!active) return;
+
+        if (gpuTimers)
+            glEndQuery(GL_TIME_ELAPSED);
+        double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        cpuTimes.push_back(cpuMs);
+        gpuTimes.push_back(-1.0);
+        ++frame;
+        if (frame >= frameCount())
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+    }
+
+    // Inclui no relatório os tempos por passe (quadros de aquecimento descartados)
+    void addGpuPasses(GpuProfiler& profiler) {
+        if (!active) return;
+        profiler.flush();
+        for (const GpuProfiler::Pass& pass : profiler.getPasses()) {
+            std::vector<double> samples;
+            for (const std::pair<int, double>& entry : pass.history)
+                if (entry.first >= warmupFrames)
+                    samples.push_back(entry.second);
+            passTimes.push_back(std::make_pair(pass.name, samples));
+        }
+    }
+
+    // Gera o relatório; devolve o código de saída do processo (1 se estourou o orçamento)
+    int finish() {
+        if (!active || frame == 0) return 0;
+
+        if (gpuTimers) {
+            for (int f = std::max(0, frame - GpuQueryLatency); f < frame; ++f)
+                collectGpuTime(f);
+            glDeleteQueries(GpuQueryLatency, queries);
+        }
+
+        std::vector<double> cpu(cpuTimes.begin() + std::min(warmupFrames, frame), cpuTimes.end());
+        std::vector<double> gpu;
+        for (int f = warmupFrames; f < frame; ++f)
+            if (gpuTimes[f] >= 0.0)
+                gpu.push_back(gpuTimes[f]);
+        FrameTimeStats cpuStats = FrameTimeStats::compute(cpu, binWidthMs, HistogramBins);
+        FrameTimeStats gpuStats = FrameTimeStats::compute(gpu, binWidthMs, HistogramBins);
+
+        printStats("CPU", cpuStats);
+        if (gpuStats.frames > 0)
+            printStats("GPU", gpuStats);
+
+        std::vector<std::pair<std::string, FrameTimeStats>> passStats;
+        for (const auto& pass : passTimes) {
+            passStats.push_back(std::make_pair(pass.first, FrameTimeStats::compute(pass.second, binWidthMs, HistogramBins)));
+            printStats(("GPU " + pass.first).c_str(), passStats.back().second);
+        }
+
+        if (!outputPath.empty())
+            writeReport(cpuStats, gpuStats, passStats);
+
+        if (budgetMs > 0.0) {
+            double cpuValue = cpuStats.byName(budgetStat);
+            double gpuValue = gpuStats.frames > 0 ? gpuStats.byName(budgetStat) : 0.0;
+            if (cpuValue > budgetMs || gpuValue > budgetMs) {
+                std::cerr << "Frame budget exceeded: " << budgetStat << " CPU " << cpuValue << " ms, GPU "
+                          << gpuValue << " ms > " << budgetMs << " ms" << std::endl;
+                return 1;
+            }
+            std::cout << "Frame budget met (" << budgetStat << " <= " << budgetMs << " ms)" << std::endl;
+        }
+        return 0;
+    }
+
+private:
+    CameraTimeline timeline;
+    bool active = false;
+    std::string outputPath;
+    std::string budgetStat = "p95";
+    double budgetMs = 0.0;
+    double binWidthMs = 1.0;
+    int warmupFrames = 10;
+    float timeStep = 1.0f / 60.0f;
+
+    int frame = 0;
+    std::chrono::steady_clock::time_point frameStart;
+    std::vector<double> cpuTimes;
+    std::vector<double> gpuTimes;   // -1 enquanto a consulta não foi lida
+    std::vector<std::pair<std::string, std::vector<double>>> passTimes;
+    bool gpuTimers = false;
+    GLuint queries[GpuQueryLatency] = {};
+
+    // Lê a consulta do quadro f antes de o slot ser reutilizado. Só bloqueia se a GPU
+    // estiver mais de GpuQueryLatency quadros atrás, e aí o gargalo já é ela.
+    void collectGpuTime(int f) {
+        if (f < 0 || f >= (int)gpuTimes.size() || gpuTimes[f] >= 0.0) return;
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries[f % GpuQueryLatency], GL_QUERY_RESULT, &ns);
+        gpuTimes[f] = ns / 1.0e6;
+    }
+
+    static void printStats(const char* label, const FrameTimeStats& s) {
+        std::printf("%s frame time over %d frames: min %.3f | median %.3f | p95 %.3f | p99 %.3f | mean %.3f | max %.3f ms\n",
+                    label, s.frames, s.minMs, s.medianMs, s.p95Ms, s.p99Ms, s.meanMs, s.maxMs);
+    }
+
+    static std::string histogramList(const std::vector<int>& histogram, const char* separator) {
+        std::string out;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            if (i) out += separator;
+            out += std::to_string(histogram[i]);
+        }
+        return out;
+    }
+
+    void writeReport(const FrameTimeStats& cpu, const FrameTimeStats& gpu,
+                     const std::vector<std::pair<std::string, FrameTimeStats>>& passes) const {
+        std::ofstream out(outputPath);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write benchmark report: " << outputPath << std::endl;
+            return;
+        }
+        bool csv = outputPath.size() >= 4 && outputPath.compare(outputPath.size() - 4, 4, ".csv") == 0;
+        if (csv) {
+            // Uma linha por métrica, fácil de acumular em planilhas de regressão
+            out << "metric,frames,min_ms,median_ms,p95_ms,p99_ms,mean_ms,max_ms,bin_ms,histogram\n";
+            auto row = [&](const char* name, const FrameTimeStats& s) {
+                out << name << "," << s.frames << "," << s.minMs << "," << s.medianMs << "," << s.p95Ms << ","
+                    << s.p99Ms << "," << s.meanMs << "," << s.maxMs << "," << binWidthMs << ","
+                    << histogramList(s.histogram, ";") << "\n";
+            };
+            row("cpu", cpu);
+            if (gpu.frames > 0) row("gpu", gpu);
+            for (const auto& pass : passes)
+                row(("gpu:" + pass.first).c_str(), pass.second);
+        } else {
+            auto object = [&](const FrameTimeStats& s) {
+                out << "{\"frames\": " << s.frames << ", \"min_ms\": " << s.minMs << ", \"median_ms\": " << s.medianMs
+                    << ", \"p95_ms\": " << s.p95Ms << ", \"p99_ms\": " << s.p99Ms << ", \"mean_ms\": " << s.meanMs
+                    << ", \"max_ms\": " << s.maxMs << ", \"histogram\": [" << histogramList(s.histogram, ", ") << "]}";
+            };
+            out << "{\n  \"frames\": " << frame << ",\n  \"warmup_frames\": " << warmupFrames
+                << ",\n  \"dt\": " << timeStep << ",\n  \"bin_ms\": " << binWidthMs << ",\n  \"cpu\": ";
+            object(cpu);
+            out << ",\n  \"gpu\": ";
+            if (gpu.frames > 0) object(gpu);
+            else out << "null";
+            out << ",\n  \"gpu_passes\": {";
+            for (size_t i = 0; i < passes.size(); ++i) {
+                out << (i ? ",\n    \"" : "\n    \"") << passes[i].first << "\": ";
+                object(passes[i].second);
+            }
+            out << (passes.empty() ? "}" : "\n  }") << "\n}\n";
+        }
+        std::cout << "Benchmark report written to " << outputPath << std::endl;
+    }
+};
@@ -0,0 +1,237 @@
+#pragma once
+
+// G-buffer do renderer deferred: o passe de geometria grava só os atributos da
+// superfície e a iluminação é feita depois, uma vez por pixel visível, em vez de uma
+// vez por fragmento desenhado (o forward repete o sombreamento a cada sobreposição).
+//
+//   alvo 0  GL_RGBA8              albedo (cor do vértice * textura)
+//   alvo 1  GL_RG16               normal em codificação octaédrica (2 x 16 bits)
+//   depth   GL_DEPTH24_STENCIL8   a posição é reconstruída da profundidade
+//
+// 8 bytes de cor por pixel, contra 24 de posição e normal em RGB16F/RGB32F.
+//
+//   gbuffer.init(width, height);
+//   gbuffer.begin();                                  // liga o FBO e limpa
+//   ... desenha os objetos com um programa que grava Albedo e EncodedNormal ...
+//   gbuffer.end(headless.framebuffer());              // volta e copia a profundidade
+//   gbuffer.bindTextures(5);                          // albedo, normal, profundidade em 5, 6, 7
+//   gbuffer.drawFullscreen();                         // luzes fixas
+//   gbuffer.beginLightVolumes(); gbuffer.drawLightVolumes(n); gbuffer.endLightVolumes();
+//
+// O passe de tela cheia e os volumes de luz usam um VAO vazio: os vértices saem de
+// gl_VertexID (triângulo que cobre a tela; cubo de 36 vértices em volta da esfera de
+// cada luz, com a luz em gl_InstanceID). Os shaders de iluminação ficam no exercício;
+// aqui ficam os trechos comuns (fullscreenVertexSource, lightVolumeVertexSource,
+// normalCodingSource e surfaceSource, que lê o G-buffer e reconstrói a posição).
+
+#include <iostream>
+
+#include <glad/glad.h>
+
+class GBuffer {
+public:
+    enum { Albedo = 0, Normal = 1, Depth = 2, TextureCount = 3 };
+
+    // Pode ser chamado no meio do laço: restaura a textura e o framebuffer ligados
+    bool init(int bufferWidth, int bufferHeight) {
+        width = bufferWidth;
+        height = bufferHeight;
+        GLint previousTexture = 0, previousFramebuffer = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+        glGenTextures(TextureCount, textures);
+        allocate(textures[Albedo], GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        allocate(textures[Normal], GL_RG16, GL_RG, GL_UNSIGNED_SHORT);
+        allocate(textures[Depth], GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8);
+        glBindTexture(GL_TEXTURE_2D, (GLuint)previousTexture);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[Albedo], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, textures[Normal], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, textures[Depth], 0);
+        const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, drawBuffers);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+        if (!complete) {
+            std::cerr << "G-buffer framebuffer is incomplete" << std::endl;
+            return false;
+        }
+
+        glGenVertexArrays(1, &emptyVAO);
+        return true;
+    }
+
+    void shutdown() {
+        if (emptyVAO) glDeleteVertexArrays(1, &emptyVAO);
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (textures[0]) glDeleteTextures(TextureCount, textures);
+        emptyVAO = fbo = 0;
+        textures[0] = textures[1] = textures[2] = 0;
+        width = height = 0;
+    }
+
+    bool initialized() const { return fbo != 0; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // Albedo zero fora dos objetos; a profundidade 1 marca o fundo para os passes de luz
+    void begin() {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, width, height);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    // Volta para o framebuffer da cena (headless.framebuffer(), 0 com janela) e copia a
+    // profundidade para ele, para os volumes de luz usarem o teste de profundidade
+    void end(GLuint sceneFramebuffer) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, sceneFramebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+        glViewport(0, 0, width, height);
+    }
+
+    // Liga albedo, normal e profundidade em firstUnit, firstUnit + 1 e firstUnit + 2
+    void bindTextures(int firstUnit) const {
+        for (int i = 0; i < TextureCount; ++i) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Um triângulo que cobre a tela; o programa atual descarta os pixels de fundo
+    void drawFullscreen() const {
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(emptyVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    // Só as faces de trás dos cubos, com GL_GEQUAL: o pixel é iluminado se a superfície
+    // está na frente da face de trás, o que também vale com a câmera dentro do volume.
+    // As contribuições das luzes se somam (blend aditivo).
+    void beginLightVolumes() const {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDepthMask(GL_FALSE);
+        glDepthFunc(GL_GEQUAL);
+        glEnable(GL_CULL_FACE);
+        glCullFace(GL_FRONT);
+    }
+
+    void drawLightVolumes(int lightCount) const {
+        if (lightCount <= 0) return;
+        glBindVertexArray(emptyVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, lightCount);
+        glBindVertexArray(0);
+    }
+
+    void endLightVolumes() const {
+        glCullFace(GL_BACK);
+        glDisable(GL_CULL_FACE);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_BLEND);
+    }
+
+    // Vértices do triângulo de tela cheia, sem atributos
+    static const char* fullscreenVertexSource() {
+        return R"(
+#version 400
+void main()
+{
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+})";
+    }
+
+    // Cubo de lado 2 * raio em volta de cada luz; lightData no formato de LightClusterBuffers
+    static const char* lightVolumeVertexSource() {
+        return R"(
+#version 400
+uniform samplerBuffer lightData;
+uniform mat4 view;
+uniform mat4 projection;
+flat out int LightIndex;
+
+// 12 triângulos em sentido anti-horário vistos de fora; bit 0 = x, 1 = y, 2 = z
+const int cubeCorners[36] = int[36](4, 6, 2, 4, 2, 0, 1, 3, 7, 1, 7, 5, 1, 5, 4, 1, 4, 0,
+                                    2, 6, 7, 2, 7, 3, 2, 3, 1, 2, 1, 0, 4, 5, 7, 4, 7, 6);
+
+void main()
+{
+    int corner = cubeCorners[gl_VertexID];
+    vec3 offset = vec3(corner & 1, (corner >> 1) & 1, (corner >> 2) & 1) * 2.0 - 1.0;
+    vec4 positionRadius = texelFetch(lightData, gl_InstanceID * 2);
+    LightIndex = gl_InstanceID;
+    gl_Position = projection * view * vec4(positionRadius.xyz + offset * positionRadius.w, 1.0);
+})";
+    }
+
+    // Normal unitária <-> 2 componentes em [0, 1] (octaedro desdobrado no quadrado)
+    static const char* normalCodingSource() {
+        return R"(
+vec2 encodeNormal(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 folded = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return (n.z >= 0.0 ? n.xy : folded) * 0.5 + 0.5;
+}
+
+vec3 decodeNormal(vec2 encoded)
+{
+    vec2 f = encoded * 2.0 - 1.0;
+    vec3 n = vec3(f, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+)";
+    }
+
+    // loadSurface() para os passes de luz; precisa de normalCodingSource() antes
+    static const char* surfaceSource() {
+        return R"(
+uniform sampler2D gAlbedo;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+
+// Atributos da superfície no pixel atual; false no fundo
+bool loadSurface(out vec3 albedo, out vec3 position, out vec3 normal)
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth >= 1.0)
+        return false;
+    vec2 ndc = gl_FragCoord.xy / vec2(textureSize(gDepth, 0)) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+    position = world.xyz / world.w;
+    albedo = texelFetch(gAlbedo, pixel, 0).rgb;
+    normal = decodeNormal(texelFetch(gNormal, pixel, 0).rg);
+    return true;
+}
+)";
+    }
+
+private:
+    int width = 0, height = 0;
+    GLuint fbo = 0;
+    GLuint textures[TextureCount] = {0, 0, 0};
+    GLuint emptyVAO = 0;
+
+    void allocate(GLuint texture, GLint internalFormat, GLenum format, GLenum type) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+};
@@ -0,0 +1,282 @@
+#pragma once
+
+// Arena de geometria: um VBO e um IBO grandes, com uma faixa de cada por malha, e um
+// VAO só para todas as malhas do mesmo formato de vértice. Com isso desenhar malhas
+// diferentes não troca VAO nem buffer, e uma lista de comandos indiretos
+// (IndirectDrawList) manda todos os desenhos visíveis numa chamada só.
+//
+//   GeometryArena arena;
+//   arena.init(sizeof(MeshVertex), 1 << 20, 4 << 20);
+//   glVertexAttribPointer(...);                           // com o VAO da arena ligado (init deixa ligado)
+//   arena.enableDrawId(4);                                // atributo inteiro com o índice do desenho
+//   int suzanne = arena.addMesh(vertices.data(), vertices.size(), indices.data(), indices.size());
+//
+//   IndirectDrawList draws;
+//   draws.init(8);                                        // unidade do texture buffer por desenho
+//   draws.clear();
+//   draws.add(arena.mesh(suzanne), model, normalMatrix);
+//   draws.submit(arena);
+//
+// Dados por desenho (matriz de modelo e de normal, 7 texels RGBA32F) vão num texture
+// buffer, e o shader acha os seus pelo atributo drawId. Os exercícios carregam a GL 4.0
+// pela GLAD, que não tem SSBO, gl_DrawID nem glMultiDrawElementsIndirect (4.3), então:
+//   - drawId é um atributo por instância (divisor 1) lido de um buffer 0, 1, 2...; cada
+//     comando indireto desenha 1 instância com baseInstance = índice do desenho, o que
+//     dá o mesmo que gl_DrawID;
+//   - glMultiDrawElementsIndirect é carregado em init() pela glfwGetProcAddress quando
+//     o contexto é 4.3 ou mais novo;
+//   - sem ele (ou com baseInstance ignorado, antes da 4.2), cada comando vira um
+//     glDrawElementsIndirect (4.0) do mesmo buffer, com drawId como atributo constante
+//     (glVertexAttribI1ui com o array desligado). Continua sem troca de VAO.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Faixa de uma malha dentro da arena (parâmetros de glDrawElementsBaseVertex)
+struct ArenaMesh {
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    GLint baseVertex = 0;
+};
+
+// Layout fixo de GL_DRAW_INDIRECT_BUFFER para glDraw*ElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+class GeometryArena {
+public:
+    static const int MaxDraws = 1 << 16;
+
+    // Aloca os buffers (capacidade em vértices e índices) e deixa o VAO ligado para o
+    // chamador declarar os atributos do formato
+    bool init(int vertexStrideBytes, int maxVertices, int maxIndices) {
+        stride = vertexStrideBytes;
+        vertexCapacity = maxVertices;
+        indexCapacity = maxIndices;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)stride * vertexCapacity, nullptr, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)sizeof(uint32_t) * indexCapacity, nullptr, GL_STATIC_DRAW);
+        return true;
+    }
+
+    void shutdown() {
+        if (vao) glDeleteVertexArrays(1, &vao);
+        if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+        if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+        if (drawIdBuffer) glDeleteBuffers(1, &drawIdBuffer);
+        vao = vertexBuffer = indexBuffer = drawIdBuffer = 0;
+        meshes.clear();
+        vertexCount = indexCount = 0;
+    }
+
+    // Atributo inteiro "drawId" por instância: 0, 1, 2... (ver IndirectDrawList)
+    void enableDrawId(GLuint location) {
+        std::vector<uint32_t> ids(MaxDraws);
+        for (int i = 0; i < MaxDraws; ++i) ids[i] = (uint32_t)i;
+        glBindVertexArray(vao);
+        glGenBuffers(1, &drawIdBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+        glBufferData(GL_ARRAY_BUFFER, ids.size() * sizeof(uint32_t), ids.data(), GL_STATIC_DRAW);
+        glVertexAttribIPointer(location, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+        glVertexAttribDivisor(location, 1);
+        glEnableVertexAttribArray(location);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        drawIdLocation = (GLint)location;
+    }
+
+    // Troca a origem do atributo drawId: buffer de índices (um por instância) a partir
+    // de firstId, ou 0 para voltar ao 0, 1, 2... de enableDrawId. Deixa o VAO ligado.
+    void bindDrawIds(GLuint buffer, GLuint firstId = 0) {
+        glBindVertexArray(vao);
+        if (drawIdLocation < 0) return;
+        glBindBuffer(GL_ARRAY_BUFFER, buffer ? buffer : drawIdBuffer);
+        glVertexAttribIPointer((GLuint)drawIdLocation, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)(sizeof(uint32_t) * (size_t)firstId));
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    }
+
+    // Copia a malha para o fim da arena; índices relativos ao primeiro vértice da malha.
+    // Retorna -1 se não couber.
+    int addMesh(const void* vertices, int meshVertexCount, const uint32_t* indices, int meshIndexCount) {
+        if (vertexCount + meshVertexCount > vertexCapacity || indexCount + meshIndexCount > indexCapacity) {
+            std::cerr << "Geometry arena is full" << std::endl;
+            return -1;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)stride * vertexCount, (GLsizeiptr)stride * meshVertexCount, vertices);
+        glBindVertexArray(vao);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)sizeof(uint32_t) * indexCount, (GLsizeiptr)sizeof(uint32_t) * meshIndexCount, indices);
+        glBindVertexArray(0);
+
+        ArenaMesh mesh;
+        mesh.firstIndex = (GLuint)indexCount;
+        mesh.indexCount = (GLuint)meshIndexCount;
+        mesh.baseVertex = vertexCount;
+        meshes.push_back(mesh);
+        vertexCount += meshVertexCount;
+        indexCount += meshIndexCount;
+        return (int)meshes.size() - 1;
+    }
+
+    const ArenaMesh& mesh(int id) const { return meshes[id]; }
+    int meshCount() const { return (int)meshes.size(); }
+    GLuint vertexArray() const { return vao; }
+    GLint drawIdAttribute() const { return drawIdLocation; }
+    size_t usedBytes() const { return (size_t)stride * vertexCount + sizeof(uint32_t) * indexCount; }
+
+private:
+    int stride = 0;
+    int vertexCapacity = 0, indexCapacity = 0;
+    int vertexCount = 0, indexCount = 0;
+    GLuint vao = 0, vertexBuffer = 0, indexBuffer = 0, drawIdBuffer = 0;
+    GLint drawIdLocation = -1;
+    std::vector<ArenaMesh> meshes;
+};
+
+class IndirectDrawList {
+public:
+    static const int TexelsPerDraw = 7;   // modelo (4 colunas) + normal (3 colunas)
+
+    // dataUnit: unidade de textura do samplerBuffer "drawData"
+    bool init(int dataUnit) {
+        unit = dataUnit;
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &dataBuffer);
+        glGenTextures(1, &dataTexture);
+        glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, dataBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major > 4 || (major == 4 && minor >= 3))
+            multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        return true;
+    }
+
+    void shutdown() {
+        if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+        if (dataBuffer) glDeleteBuffers(1, &dataBuffer);
+        if (dataTexture) glDeleteTextures(1, &dataTexture);
+        commandBuffer = dataBuffer = dataTexture = 0;
+    }
+
+    // Sem multi-draw (ou com --no-mdi) cai no laço de glDrawElementsIndirect
+    bool multiDrawAvailable() const { return multiDrawElementsIndirect != nullptr; }
+    void setMultiDraw(bool enabled) { useMultiDraw = enabled; }
+    bool multiDraw() const { return useMultiDraw && multiDrawElementsIndirect; }
+
+    void clear() {
+        commands.clear();
+        drawData.clear();
+    }
+
+    void add(const ArenaMesh& mesh, const glm::mat4& model, const glm::mat3& normalMatrix) {
+        if ((int)commands.size() >= GeometryArena::MaxDraws) return;
+        DrawElementsIndirectCommand command;
+        command.count = mesh.indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = mesh.firstIndex;
+        command.baseVertex = mesh.baseVertex;
+        command.baseInstance = (GLuint)commands.size();
+        commands.push_back(command);
+        const float* m = glm::value_ptr(model);
+        drawData.insert(drawData.end(), m, m + 16);
+        for (int column = 0; column < 3; ++column) {
+            drawData.insert(drawData.end(), glm::value_ptr(normalMatrix) + column * 3, glm::value_ptr(normalMatrix) + column * 3 + 3);
+            drawData.push_back(0.0f);
+        }
+    }
+
+    int size() const { return (int)commands.size(); }
+
+    // Envia os comandos e os dados por desenho e desenha com o VAO da arena (o programa
+    // atual precisa ter o samplerBuffer drawData na unidade de init)
+    void submit(const GeometryArena& arena) {
+        if (commands.empty()) return;
+        if (!multiDraw())
+            for (DrawElementsIndirectCommand& command : commands)
+                command.baseInstance = 0;   // "reservedMustBeZero" na 4.0
+        upload(GL_DRAW_INDIRECT_BUFFER, commandBuffer, commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand));
+        upload(GL_TEXTURE_BUFFER, dataBuffer, drawData.data(), drawData.size() * sizeof(float));
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindVertexArray(arena.vertexArray());
+        if (multiDraw()) {
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)commands.size(), 0);
+        } else {
+            // baseInstance é ignorado antes da 4.2: drawId vira atributo constante
+            GLint location = arena.drawIdAttribute();
+            if (location >= 0) glDisableVertexAttribArray(location);
+            for (size_t i = 0; i < commands.size(); ++i) {
+                if (location >= 0) glVertexAttribI1ui(location, (GLuint)i);
+                glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)(i * sizeof(DrawElementsIndirectCommand)));
+            }
+            if (location >= 0) glEnableVertexAttribArray(location);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    // Trecho de vertex shader: drawDataModel() e drawDataNormalMatrix() a partir do drawId
+    static const char* vertexSource() {
+        return R"(
+layout (location = 4) in uint drawId;
+uniform samplerBuffer drawData;
+
+mat4 drawDataModel()
+{
+    int base = int(drawId) * 7;
+    return mat4(texelFetch(drawData, base), texelFetch(drawData, base + 1),
+                texelFetch(drawData, base + 2), texelFetch(drawData, base + 3));
+}
+
+mat3 drawDataNormalMatrix()
+{
+    int base = int(drawId) * 7 + 4;
+    return mat3(texelFetch(drawData, base).xyz, texelFetch(drawData, base + 1).xyz, texelFetch(drawData, base + 2).xyz);
+}
+)";
+    }
+
+private:
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+
+    int unit = 0;
+    GLuint commandBuffer = 0, dataBuffer = 0, dataTexture = 0;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<float> drawData;
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    bool useMultiDraw = true;
+
+    // Reespecifica o buffer (sem esperar a GPU usar o do quadro anterior) e copia
+    static void upload(GLenum target, GLuint buffer, const void* data, size_t bytes) {
+        glBindBuffer(target, buffer);
+        glBufferData(target, (GLsizeiptr)bytes, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, (GLsizeiptr)bytes, data);
+    }
+};
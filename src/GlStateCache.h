@@ -0,0 +1,451 @@
+#pragma once
+
+// Contador de chamadas GL e cache de estado sobre os ponteiros da GLAD.
+//
+// install() troca os ponteiros glad_glXxx das funções abaixo por versões que
+// contam as chamadas por quadro e comparam com o último estado conhecido: bind do
+// mesmo VAO/programa/buffer/textura, glEnable de algo já ligado, glClearColor ou
+// glViewport iguais e glUniform* com o valor que o programa já tem são marcados como
+// redundantes. Com o cache ligado essas chamadas nem chegam ao driver. O código
+// dos exercícios não muda: continua chamando glBindVertexArray etc.
+//
+//   --gl-stats    imprime, uma vez por segundo, as chamadas do último quadro
+//   --gl-cache    descarta as chamadas redundantes
+//   --gl-ab N     N quadros sem cache, N com cache, e compara tempo e chamadas
+//
+// Estado inicial é "desconhecido", então a primeira chamada sempre passa. Só vale
+// para um contexto usado por uma thread, que é o caso de todos os exercícios.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+// Chamadas e chamadas redundantes de um quadro, por ponto de entrada (GlStateCache::Entry)
+struct GlFrameCounters {
+    static const int EntryCount = 26;
+    unsigned calls[EntryCount] = {};
+    unsigned redundant[EntryCount] = {};
+
+    unsigned totalCalls() const { return sum(calls); }
+    unsigned totalRedundant() const { return sum(redundant); }
+
+private:
+    static unsigned sum(const unsigned* values) {
+        unsigned total = 0;
+        for (int i = 0; i < EntryCount; ++i) total += values[i];
+        return total;
+    }
+};
+
+class GlStateCache {
+public:
+    enum Entry {
+        BindVertexArray, UseProgram, BindBuffer, ActiveTexture, BindTexture, Enable, Disable,
+        ClearColor, Viewport, Uniform1i, Uniform1f, Uniform3f, Uniform4f, Uniform3fv,
+        UniformMatrix3fv, UniformMatrix4fv, GetUniformLocation, Clear, DrawArrays, DrawElements,
+        BufferData, LinkProgram, DeleteProgram, DeleteVertexArrays, DeleteBuffers, DeleteTextures,
+        EntryCount
+    };
+    static_assert(EntryCount == GlFrameCounters::EntryCount, "GlFrameCounters::EntryCount out of date");
+
+    // Lê as opções da linha de comando; install() só é feito se alguma foi pedida
+    static void configure(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--gl-stats") printStats = true;
+            else if (arg == "--gl-cache") caching = true;
+            else if (arg == "--gl-ab" && i + 1 < argc) abFrames = std::max(1, std::atoi(argv[++i]));
+        }
+        requested = printStats || caching || abFrames > 0;
+        if (abFrames > 0) caching = false;
+    }
+
+    static bool enabled() { return installed; }
+
+    // Quadros necessários para o A/B (para limitar o modo headless); 0 sem --gl-ab
+    static int abFrameCount() { return abFrames > 0 ? 2 * abFrames + 1 : 0; }
+
+    // Chamar depois de carregar a GLAD (e antes de qualquer outra chamada GL que deva ser contada)
+    static void install() {
+        if (!requested || installed) return;
+        installed = true;
+        hook(glad_glBindVertexArray, realBindVertexArray, bindVertexArray);
+        hook(glad_glUseProgram, realUseProgram, useProgram);
+        hook(glad_glBindBuffer, realBindBuffer, bindBuffer);
+        hook(glad_glActiveTexture, realActiveTexture, activeTexture);
+        hook(glad_glBindTexture, realBindTexture, bindTexture);
+        hook(glad_glEnable, realEnable, enable);
+        hook(glad_glDisable, realDisable, disable);
+        hook(glad_glClearColor, realClearColor, clearColor);
+        hook(glad_glViewport, realViewport, viewport);
+        hook(glad_glUniform1i, realUniform1i, uniform1i);
+        hook(glad_glUniform1f, realUniform1f, uniform1f);
+        hook(glad_glUniform3f, realUniform3f, uniform3f);
+        hook(glad_glUniform4f, realUniform4f, uniform4f);
+        hook(glad_glUniform3fv, realUniform3fv, uniform3fv);
+        hook(glad_glUniformMatrix3fv, realUniformMatrix3fv, uniformMatrix3fv);
+        hook(glad_glUniformMatrix4fv, realUniformMatrix4fv, uniformMatrix4fv);
+        hook(glad_glGetUniformLocation, realGetUniformLocation, getUniformLocation);
+        hook(glad_glClear, realClear, clear);
+        hook(glad_glDrawArrays, realDrawArrays, drawArrays);
+        hook(glad_glDrawElements, realDrawElements, drawElements);
+        hook(glad_glBufferData, realBufferData, bufferData);
+        hook(glad_glLinkProgram, realLinkProgram, linkProgram);
+        hook(glad_glDeleteProgram, realDeleteProgram, deleteProgram);
+        hook(glad_glDeleteVertexArrays, realDeleteVertexArrays, deleteVertexArrays);
+        hook(glad_glDeleteBuffers, realDeleteBuffers, deleteBuffers);
+        hook(glad_glDeleteTextures, realDeleteTextures, deleteTextures);
+        std::cout << "GL call tracking on (state cache " << (caching ? "on" : "off") << ")" << std::endl;
+        frameStart = std::chrono::steady_clock::now();
+    }
+
+    static void setCaching(bool on) { caching = on; }
+    static bool isCaching() { return caching; }
+
+    // Chamar uma vez por quadro (depois do glfwSwapBuffers)
+    static void endFrame(GLFWwindow* window) {
+        if (!installed) return;
+        auto now = std::chrono::steady_clock::now();
+        double frameMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+        frameStart = now;
+
+        previous = current;
+        current = GlFrameCounters();
+        ++frame;
+
+        if (abFrames > 0)
+            recordAB(window, frameMs);
+
+        if (printStats && glfwGetTime() - lastPrintTime >= 1.0) {
+            printFrame(previous);
+            lastPrintTime = glfwGetTime();
+        }
+    }
+
+    static const GlFrameCounters& lastFrame() { return previous; }
+
+    static void printFrame(const GlFrameCounters& counters) {
+        std::printf("GL calls: %u (%u redundant%s)\n", counters.totalCalls(), counters.totalRedundant(),
+                    caching ? ", skipped by cache" : "");
+        for (int i = 0; i < EntryCount; ++i) {
+            if (!counters.calls[i]) continue;
+            std::printf("  %-22s %6u", entryNames()[i], counters.calls[i]);
+            if (counters.redundant[i])
+                std::printf("  redundant %u", counters.redundant[i]);
+            std::printf("\n");
+        }
+    }
+
+private:
+    static inline bool requested = false;
+    static inline bool installed = false;
+    static inline bool caching = false;
+    static inline bool printStats = false;
+    static inline GlFrameCounters current;
+    static inline GlFrameCounters previous;
+    static inline int frame = 0;
+    static inline double lastPrintTime = 0.0;
+    static inline std::chrono::steady_clock::time_point frameStart;
+
+    // A/B: frames [1, N] sem cache, [N+1, 2N] com cache (o quadro 0 aquece)
+    static inline int abFrames = 0;
+    static inline double abMs[2] = {};
+    static inline double abCalls[2] = {};
+    static inline double abRedundant[2] = {};
+
+    // Último estado conhecido (-1 = desconhecido)
+    static inline GLint boundVertexArray = -1;
+    static inline GLint boundProgram = -1;
+    static inline GLint boundArrayBuffer = -1;
+    static inline GLint activeUnit = -1;
+    static inline std::unordered_map<uint64_t, GLuint> boundTextures;   // (unidade, alvo) -> textura
+    static inline std::unordered_map<GLenum, bool> capabilities;
+    static inline GLfloat clearColorValue[4] = {-1.0f, -1.0f, -1.0f, -1.0f};
+    static inline GLint viewportValue[4] = {-1, -1, -1, -1};
+    static inline std::unordered_map<uint64_t, std::vector<unsigned char>> uniformValues; // (programa, local) -> bytes
+
+    static const char* const* entryNames() {
+        static const char* const names[EntryCount] = {
+            "glBindVertexArray", "glUseProgram", "glBindBuffer", "glActiveTexture", "glBindTexture", "glEnable", "glDisable",
+            "glClearColor", "glViewport", "glUniform1i", "glUniform1f", "glUniform3f", "glUniform4f", "glUniform3fv",
+            "glUniformMatrix3fv", "glUniformMatrix4fv", "glGetUniformLocation", "glClear", "glDrawArrays", "glDrawElements",
+            "glBufferData", "glLinkProgram", "glDeleteProgram", "glDeleteVertexArrays", "glDeleteBuffers", "glDeleteTextures"
+        };
+        return names;
+    }
+
+    template <typename P>
+    static void hook(P& gladPointer, P& real, P wrapper) {
+        real = gladPointer;
+        if (real) gladPointer = wrapper;
+    }
+
+    static void count(Entry e) { current.calls[e]++; }
+
+    // Marca a chamada como redundante; devolve true se ela deve ser descartada
+    static bool redundant(Entry e) {
+        current.redundant[e]++;
+        return caching;
+    }
+
+    static bool sameUniform(GLint location, const void* data, size_t size) {
+        if (location == -1) return true;   // o GL ignora local -1
+        if (boundProgram <= 0) return false;
+        uint64_t key = ((uint64_t)(uint32_t)boundProgram << 32) | (uint32_t)location;
+        std::vector<unsigned char>& stored = uniformValues[key];
+        if (stored.size() == size && std::memcmp(stored.data(), data, size) == 0)
+            return true;
+        stored.assign((const unsigned char*)data, (const unsigned char*)data + size);
+        return false;
+    }
+
+    static void forgetUniform(GLint location) {
+        if (boundProgram > 0)
+            uniformValues.erase(((uint64_t)(uint32_t)boundProgram << 32) | (uint32_t)location);
+    }
+
+    static void forgetProgram(GLuint program) {
+        for (auto it = uniformValues.begin(); it != uniformValues.end();) {
+            if ((GLuint)(it->first >> 32) == program) it = uniformValues.erase(it);
+            else ++it;
+        }
+    }
+
+    static void recordAB(GLFWwindow* window, double frameMs) {
+        if (frame == 1) return;
+        int phase = frame <= abFrames + 1 ? 0 : 1;
+        abMs[phase] += frameMs;
+        abCalls[phase] += previous.totalCalls();
+        abRedundant[phase] += previous.totalRedundant();
+        if (frame == abFrames + 1) {
+            caching = true;
+        } else if (frame == 2 * abFrames + 1) {
+            std::printf("GL state cache A/B over %d frames each:\n", abFrames);
+            std::printf("  cache off: %.3f ms/frame, %.1f calls/frame (%.1f redundant)\n",
+                        abMs[0] / abFrames, abCalls[0] / abFrames, abRedundant[0] / abFrames);
+            std::printf("  cache on:  %.3f ms/frame, %.1f calls/frame (%.1f dropped)\n",
+                        abMs[1] / abFrames, abCalls[1] / abFrames, abRedundant[1] / abFrames);
+            abFrames = 0;
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+
+    static inline PFNGLBINDVERTEXARRAYPROC realBindVertexArray = nullptr;
+    static void APIENTRY bindVertexArray(GLuint array) {
+        count(BindVertexArray);
+        if (boundVertexArray == (GLint)array) { if (redundant(BindVertexArray)) return; }
+        else boundVertexArray = array;
+        realBindVertexArray(array);
+    }
+
+    static inline PFNGLUSEPROGRAMPROC realUseProgram = nullptr;
+    static void APIENTRY useProgram(GLuint program) {
+        count(UseProgram);
+        if (boundProgram == (GLint)program) { if (redundant(UseProgram)) return; }
+        else boundProgram = program;
+        realUseProgram(program);
+    }
+
+    // Só GL_ARRAY_BUFFER é cacheado; o GL_ELEMENT_ARRAY_BUFFER faz parte do estado do VAO
+    static inline PFNGLBINDBUFFERPROC realBindBuffer = nullptr;
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer) {
+        count(BindBuffer);
+        if (target == GL_ARRAY_BUFFER) {
+            if (boundArrayBuffer == (GLint)buffer) { if (redundant(BindBuffer)) return; }
+            else boundArrayBuffer = buffer;
+        }
+        realBindBuffer(target, buffer);
+    }
+
+    static inline PFNGLACTIVETEXTUREPROC realActiveTexture = nullptr;
+    static void APIENTRY activeTexture(GLenum texture) {
+        count(ActiveTexture);
+        if (activeUnit == (GLint)texture) { if (redundant(ActiveTexture)) return; }
+        else activeUnit = texture;
+        realActiveTexture(texture);
+    }
+
+    static inline PFNGLBINDTEXTUREPROC realBindTexture = nullptr;
+    static void APIENTRY bindTexture(GLenum target, GLuint texture) {
+        count(BindTexture);
+        if (activeUnit >= 0) {
+            uint64_t key = ((uint64_t)activeUnit << 32) | target;
+            auto it = boundTextures.find(key);
+            if (it != boundTextures.end() && it->second == texture) { if (redundant(BindTexture)) return; }
+            else boundTextures[key] = texture;
+        }
+        realBindTexture(target, texture);
+    }
+
+    static inline PFNGLENABLEPROC realEnable = nullptr;
+    static void APIENTRY enable(GLenum cap) {
+        count(Enable);
+        auto it = capabilities.find(cap);
+        if (it != capabilities.end() && it->second) { if (redundant(Enable)) return; }
+        else capabilities[cap] = true;
+        realEnable(cap);
+    }
+
+    static inline PFNGLDISABLEPROC realDisable = nullptr;
+    static void APIENTRY disable(GLenum cap) {
+        count(Disable);
+        auto it = capabilities.find(cap);
+        if (it != capabilities.end() && !it->second) { if (redundant(Disable)) return; }
+        else capabilities[cap] = false;
+        realDisable(cap);
+    }
+
+    static inline PFNGLCLEARCOLORPROC realClearColor = nullptr;
+    static void APIENTRY clearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+        count(ClearColor);
+        GLfloat value[4] = {r, g, b, a};
+        if (std::memcmp(value, clearColorValue, sizeof(value)) == 0) { if (redundant(ClearColor)) return; }
+        else std::memcpy(clearColorValue, value, sizeof(value));
+        realClearColor(r, g, b, a);
+    }
+
+    static inline PFNGLVIEWPORTPROC realViewport = nullptr;
+    static void APIENTRY viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+        count(Viewport);
+        GLint value[4] = {x, y, width, height};
+        if (std::memcmp(value, viewportValue, sizeof(value)) == 0) { if (redundant(Viewport)) return; }
+        else std::memcpy(viewportValue, value, sizeof(value));
+        realViewport(x, y, width, height);
+    }
+
+    static inline PFNGLUNIFORM1IPROC realUniform1i = nullptr;
+    static void APIENTRY uniform1i(GLint location, GLint v0) {
+        count(Uniform1i);
+        if (sameUniform(location, &v0, sizeof(v0)) && redundant(Uniform1i)) return;
+        realUniform1i(location, v0);
+    }
+
+    static inline PFNGLUNIFORM1FPROC realUniform1f = nullptr;
+    static void APIENTRY uniform1f(GLint location, GLfloat v0) {
+        count(Uniform1f);
+        if (sameUniform(location, &v0, sizeof(v0)) && redundant(Uniform1f)) return;
+        realUniform1f(location, v0);
+    }
+
+    static inline PFNGLUNIFORM3FPROC realUniform3f = nullptr;
+    static void APIENTRY uniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+        count(Uniform3f);
+        GLfloat value[3] = {v0, v1, v2};
+        if (sameUniform(location, value, sizeof(value)) && redundant(Uniform3f)) return;
+        realUniform3f(location, v0, v1, v2);
+    }
+
+    static inline PFNGLUNIFORM4FPROC realUniform4f = nullptr;
+    static void APIENTRY uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+        count(Uniform4f);
+        GLfloat value[4] = {v0, v1, v2, v3};
+        if (sameUniform(location, value, sizeof(value)) && redundant(Uniform4f)) return;
+        realUniform4f(location, v0, v1, v2, v3);
+    }
+
+    static inline PFNGLUNIFORM3FVPROC realUniform3fv = nullptr;
+    static void APIENTRY uniform3fv(GLint location, GLsizei n, const GLfloat* value) {
+        count(Uniform3fv);
+        if (sameUniform(location, value, sizeof(GLfloat) * 3 * n) && redundant(Uniform3fv)) return;
+        realUniform3fv(location, n, value);
+    }
+
+    // Matrizes transpostas não são comparadas (só invalidam o valor guardado)
+    static inline PFNGLUNIFORMMATRIX3FVPROC realUniformMatrix3fv = nullptr;
+    static void APIENTRY uniformMatrix3fv(GLint location, GLsizei n, GLboolean transpose, const GLfloat* value) {
+        count(UniformMatrix3fv);
+        if (transpose) forgetUniform(location);
+        else if (sameUniform(location, value, sizeof(GLfloat) * 9 * n) && redundant(UniformMatrix3fv)) return;
+        realUniformMatrix3fv(location, n, transpose, value);
+    }
+
+    static inline PFNGLUNIFORMMATRIX4FVPROC realUniformMatrix4fv = nullptr;
+    static void APIENTRY uniformMatrix4fv(GLint location, GLsizei n, GLboolean transpose, const GLfloat* value) {
+        count(UniformMatrix4fv);
+        if (transpose) forgetUniform(location);
+        else if (sameUniform(location, value, sizeof(GLfloat) * 16 * n) && redundant(UniformMatrix4fv)) return;
+        realUniformMatrix4fv(location, n, transpose, value);
+    }
+
+    static inline PFNGLGETUNIFORMLOCATIONPROC realGetUniformLocation = nullptr;
+    static GLint APIENTRY getUniformLocation(GLuint program, const GLchar* name) {
+        count(GetUniformLocation);
+        return realGetUniformLocation(program, name);
+    }
+
+    static inline PFNGLCLEARPROC realClear = nullptr;
+    static void APIENTRY clear(GLbitfield mask) {
+        count(Clear);
+        realClear(mask);
+    }
+
+    static inline PFNGLDRAWARRAYSPROC realDrawArrays = nullptr;
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei n) {
+        count(DrawArrays);
+        realDrawArrays(mode, first, n);
+    }
+
+    static inline PFNGLDRAWELEMENTSPROC realDrawElements = nullptr;
+    static void APIENTRY drawElements(GLenum mode, GLsizei n, GLenum type, const void* indices) {
+        count(DrawElements);
+        realDrawElements(mode, n, type, indices);
+    }
+
+    static inline PFNGLBUFFERDATAPROC realBufferData = nullptr;
+    static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+        count(BufferData);
+        realBufferData(target, size, data, usage);
+    }
+
+    // Religar um programa zera seus uniforms
+    static inline PFNGLLINKPROGRAMPROC realLinkProgram = nullptr;
+    static void APIENTRY linkProgram(GLuint program) {
+        count(LinkProgram);
+        forgetProgram(program);
+        realLinkProgram(program);
+    }
+
+    static inline PFNGLDELETEPROGRAMPROC realDeleteProgram = nullptr;
+    static void APIENTRY deleteProgram(GLuint program) {
+        count(DeleteProgram);
+        forgetProgram(program);
+        if (boundProgram == (GLint)program) boundProgram = -1;
+        realDeleteProgram(program);
+    }
+
+    // Apagar um objeto ligado desfaz o bind (volta a 0)
+    static inline PFNGLDELETEVERTEXARRAYSPROC realDeleteVertexArrays = nullptr;
+    static void APIENTRY deleteVertexArrays(GLsizei n, const GLuint* arrays) {
+        count(DeleteVertexArrays);
+        for (GLsizei i = 0; i < n; ++i)
+            if (boundVertexArray == (GLint)arrays[i]) boundVertexArray = 0;
+        realDeleteVertexArrays(n, arrays);
+    }
+
+    static inline PFNGLDELETEBUFFERSPROC realDeleteBuffers = nullptr;
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers) {
+        count(DeleteBuffers);
+        for (GLsizei i = 0; i < n; ++i)
+            if (boundArrayBuffer == (GLint)buffers[i]) boundArrayBuffer = 0;
+        realDeleteBuffers(n, buffers);
+    }
+
+    static inline PFNGLDELETETEXTURESPROC realDeleteTextures = nullptr;
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures) {
+        count(DeleteTextures);
+        for (GLsizei i = 0; i < n; ++i)
+            for (auto& binding : boundTextures)
+                if (binding.second == textures[i]) binding.second = 0;
+        realDeleteTextures(n, textures);
+    }
+};
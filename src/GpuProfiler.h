@@ -0,0 +1,212 @@
+#pragma once
+
+// Perfilador de GPU por passe com timer queries (GL_TIMESTAMP).
+//
+//   gpuProfiler.beginFrame();
+//   {
+//       GpuProfiler::Scope scope(gpuProfiler, "objects");
+//       ... desenha ...
+//   }
+//   gpuProfiler.endFrame();
+//
+// Cada escopo grava dois timestamps, então escopos podem ser aninhados e convivem
+// com uma consulta GL_TIME_ELAPSED aberta (a do modo benchmark). As consultas ficam
+// num pool com FrameLatency quadros; os resultados de um quadro só são lidos quando
+// o slot dele volta a ser usado e, se ainda não estiverem prontos, o quadro é
+// descartado em vez de bloquear. Sem suporte a timer queries tudo vira no-op.
+//
+// O histórico por quadro (Pass::history) só é gravado depois de setRecordHistory(true),
+// como no modo benchmark, que tem duração conhecida; fora dele só lastMs e averageMs.
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+class GpuProfiler {
+public:
+    static const int FrameLatency = 4;
+    static const int MaxScopesPerFrame = 32;
+
+    struct Pass {
+        std::string name;
+        double lastMs = 0.0;
+        double averageMs = 0.0;                      // média móvel exponencial, para o overlay
+        int lastFrame = -1;                          // quadro de lastMs
+        int frames = 0;                              // quadros medidos
+        std::vector<std::pair<int, double>> history; // (quadro, ms), com setRecordHistory(true)
+    };
+
+    class Scope {
+    public:
+        Scope(GpuProfiler& profiler, const char* name) : profiler(profiler), record(profiler.beginScope(name)) {}
+        ~Scope() { profiler.endScope(record); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        GpuProfiler& profiler;
+        int record;
+    };
+
+    // Chamar depois de carregar a GLAD
+    void init() {
+        GLint bits = 0;
+        if (GLAD_GL_VERSION_3_3)
+            glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+        available = bits > 0;
+        if (!available) {
+            std::cout << "GPU timer queries not supported: per-pass GPU times disabled" << std::endl;
+            return;
+        }
+        for (FrameSlot& slot : slots)
+            glGenQueries(MaxScopesPerFrame * 2, slot.queries);
+    }
+
+    // Lê (esperando) os quadros ainda pendentes; para o fim de um benchmark
+    void flush() {
+        if (!available) return;
+        for (int f = std::max(0, frame - FrameLatency); f < frame; ++f) {
+            FrameSlot& slot = slots[f % FrameLatency];
+            if (slot.frame == f) {
+                collect(slot, true);
+                slot.lastQuery = -1;
+            }
+        }
+    }
+
+    void shutdown() {
+        if (!available) return;
+        for (FrameSlot& slot : slots)
+            glDeleteQueries(MaxScopesPerFrame * 2, slot.queries);
+        available = false;
+    }
+
+    bool supported() const { return available; }
+    void setRecordHistory(bool enabled) { recordHistory = enabled; }
+
+    void beginFrame() {
+        if (!available) return;
+        FrameSlot& slot = slots[frame % FrameLatency];
+        if (slot.frame >= 0)
+            collect(slot, false);
+        slot.frame = frame;
+        slot.lastQuery = -1;
+        slot.records.clear();
+    }
+
+    void endFrame() {
+        if (!available) return;
+        ++frame;
+    }
+
+    const std::vector<Pass>& getPasses() const { return passes; }
+    int droppedFrames() const { return dropped; }
+    int currentFrame() const { return frame; }
+
+    // Resumo curto ("objects 0.812 ms | trajectories 0.054 ms")
+    std::string summary() const {
+        if (!available) return "GPU timers n/a";
+        std::string text;
+        char buffer[96];
+        for (const Pass& p : passes) {
+            std::snprintf(buffer, sizeof(buffer), "%s%s %.3f ms", text.empty() ? "" : " | ", p.name.c_str(), p.averageMs);
+            text += buffer;
+        }
+        return text;
+    }
+
+    // Overlay mínimo: os tempos vão para o título da janela duas vezes por segundo
+    void updateOverlay(GLFWwindow* window, const char* baseTitle) {
+        double now = glfwGetTime();
+        if (now - lastOverlayTime < 0.5) return;
+        lastOverlayTime = now;
+        std::string title = std::string(baseTitle) + " | GPU: " + summary();
+        glfwSetWindowTitle(window, title.c_str());
+    }
+
+private:
+    struct ScopeRecord {
+        int pass;
+        bool closed;
+    };
+
+    struct FrameSlot {
+        int frame = -1;
+        int lastQuery = -1;
+        GLuint queries[MaxScopesPerFrame * 2] = {};
+        std::vector<ScopeRecord> records;
+    };
+
+    bool available = false;
+    bool recordHistory = false;
+    int frame = 0;
+    int dropped = 0;
+    double lastOverlayTime = 0.0;
+    FrameSlot slots[FrameLatency];
+    std::vector<Pass> passes;
+
+    int passIndex(const char* name) {
+        for (size_t i = 0; i < passes.size(); ++i)
+            if (passes[i].name == name)
+                return (int)i;
+        passes.push_back(Pass());
+        passes.back().name = name;
+        return (int)passes.size() - 1;
+    }
+
+    int beginScope(const char* name) {
+        if (!available) return -1;
+        FrameSlot& slot = slots[frame % FrameLatency];
+        if ((int)slot.records.size() >= MaxScopesPerFrame) return -1;
+        int record = (int)slot.records.size();
+        slot.records.push_back({passIndex(name), false});
+        glQueryCounter(slot.queries[record * 2], GL_TIMESTAMP);
+        slot.lastQuery = record * 2;
+        return record;
+    }
+
+    void endScope(int record) {
+        if (record < 0) return;
+        FrameSlot& slot = slots[frame % FrameLatency];
+        glQueryCounter(slot.queries[record * 2 + 1], GL_TIMESTAMP);
+        slot.lastQuery = record * 2 + 1;
+        slot.records[record].closed = true;
+    }
+
+    void collect(FrameSlot& slot, bool wait) {
+        if (slot.lastQuery < 0) return;
+        // Os timestamps terminam em ordem; se o último emitido está pronto, todos estão
+        GLint ready = 0;
+        if (!wait)
+            glGetQueryObjectiv(slot.queries[slot.lastQuery], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready && !wait) {
+            ++dropped;
+            return;
+        }
+        for (size_t i = 0; i < slot.records.size(); ++i) {
+            if (!slot.records[i].closed) continue;
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(slot.queries[i * 2], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(slot.queries[i * 2 + 1], GL_QUERY_RESULT, &end);
+            double ms = (end - begin) / 1.0e6;
+            Pass& p = passes[slot.records[i].pass];
+            // O mesmo passe aberto várias vezes no quadro soma num único valor
+            if (p.lastFrame != slot.frame) {
+                p.lastFrame = slot.frame;
+                p.lastMs = 0.0;
+            }
+            p.lastMs += ms;
+        }
+        for (Pass& p : passes) {
+            if (p.lastFrame != slot.frame) continue;
+            p.averageMs = ++p.frames == 1 ? p.lastMs : p.averageMs * 0.9 + p.lastMs * 0.1;
+            if (recordHistory)
+                p.history.push_back(std::make_pair(slot.frame, p.lastMs));
+        }
+    }
+};
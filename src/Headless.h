@@ -0,0 +1,168 @@
+#pragma once
+
+// Modo "headless" para rodar os exercícios sem display nem GPU (CI / benchmarks).
+//
+//   ./M5 --headless 1280x720 [--frames N] [--png saida.png]
+//
+// Usa a plataforma nula da GLFW 3.4 com contexto EGL (surfaceless, Mesa llvmpipe) ou,
+// se não houver EGL, OSMesa. A cena é desenhada num FBO do tamanho pedido por um
+// número fixo de quadros; no fim imprime os tempos e, opcionalmente, grava o último
+// quadro em PNG. Sem --headless nada muda: a janela é criada normalmente.
+//
+// Este cabeçalho inclui a implementação da stb_image_write, então deve ser
+// incluído por um único .cpp de cada executável (como já é o caso dos exercícios).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+class HeadlessRun {
+public:
+    HeadlessRun(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--headless" && i + 1 < argc) {
+                active = std::sscanf(argv[++i], "%dx%d", &width, &height) == 2 && width > 0 && height > 0;
+                if (!active)
+                    std::cerr << "Invalid --headless size, expected WxH" << std::endl;
+            } else if (arg == "--frames" && i + 1 < argc) {
+                frameCount = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--png" && i + 1 < argc) {
+                pngPath = argv[++i];
+            }
+        }
+    }
+
+    bool enabled() const { return active; }
+    int getWidth() const { return width; }
+    // Usado pelo modo benchmark para rodar a linha do tempo inteira
+    void setFrameCount(int frames) { frameCount = std::max(1, frames); }
+    int getHeight() const { return height; }
+
+    // FBO em que a cena é desenhada (0 = framebuffer da janela).
+    // Passes que trocam de framebuffer devem voltar para este, e não para 0.
+    GLuint framebuffer() const { return fbo; }
+
+    bool initGlfw() {
+        if (active)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        return glfwInit() == GLFW_TRUE;
+    }
+
+    // Substitui glfwCreateWindow; os hints de versão de contexto já definidos continuam valendo
+    GLFWwindow* createWindow(int windowWidth, int windowHeight, const char* title) {
+        if (!active)
+            return glfwCreateWindow(windowWidth, windowHeight, title, nullptr, nullptr);
+
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        GLFWwindow* window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+        if (!window) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(width, height, title, nullptr, nullptr);
+        }
+        if (!window)
+            std::cerr << "Failed to create headless context (EGL and OSMesa unavailable)" << std::endl;
+        return window;
+    }
+
+    // Chamar depois de carregar a GLAD: cria e ativa o FBO de saída
+    void setupFramebuffer() {
+        if (!active) return;
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Headless framebuffer is incomplete" << std::endl;
+
+        glViewport(0, 0, width, height);
+        std::cout << "Headless " << width << "x" << height << ", " << frameCount << " frames, renderer: "
+                  << glGetString(GL_RENDERER) << std::endl;
+        lastTime = glfwGetTime();
+    }
+
+    // Chamar no fim de cada quadro (depois do glfwSwapBuffers). Fecha a janela ao atingir o número de quadros.
+    void endFrame(GLFWwindow* window) {
+        if (!active) return;
+
+        glFinish();
+        double now = glfwGetTime();
+        frameTimes.push_back((now - lastTime) * 1000.0);
+        lastTime = now;
+
+        if ((int)frameTimes.size() >= frameCount) {
+            if (!pngPath.empty())
+                writePng();
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+    }
+
+    // Chamar depois do laço principal: imprime os tempos de quadro
+    void finish() {
+        if (!active || frameTimes.empty()) return;
+
+        double total = 0.0, minMs = frameTimes[0], maxMs = frameTimes[0];
+        for (double t : frameTimes) {
+            total += t;
+            minMs = std::min(minMs, t);
+            maxMs = std::max(maxMs, t);
+        }
+        std::cout << "Frames: " << frameTimes.size() << " | total: " << total << " ms | avg: "
+                  << total / frameTimes.size() << " ms | min: " << minMs << " ms | max: " << maxMs << " ms" << std::endl;
+
+        if (fbo) {
+            glDeleteRenderbuffers(1, &colorBuffer);
+            glDeleteRenderbuffers(1, &depthBuffer);
+            glDeleteFramebuffers(1, &fbo);
+            fbo = 0;
+        }
+    }
+
+    const std::vector<double>& getFrameTimes() const { return frameTimes; }
+
+private:
+    bool active = false;
+    int width = 800;
+    int height = 800;
+    int frameCount = 100;
+    std::string pngPath;
+
+    GLuint fbo = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+    double lastTime = 0.0;
+    std::vector<double> frameTimes;
+
+    void writePng() {
+        std::vector<unsigned char> pixels((size_t)width * height * 4);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        stbi_flip_vertically_on_write(1);
+        if (stbi_write_png(pngPath.c_str(), width, height, 4, pixels.data(), width * 4))
+            std::cout << "Saved " << pngPath << std::endl;
+        else
+            std::cerr << "Failed to write " << pngPath << std::endl;
+    }
+};
@@ -18,6 +18,8 @@ using namespace std;
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "Headless.h"
+
 //GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -59,10 +61,12 @@ const GLchar* fragmentShaderSource = "#version 450\n"
 bool rotateX=false, rotateY=false, rotateZ=false;
 
 // Função MAIN
-int main()
+int main(int argc, char** argv)
 {
+	HeadlessRun headless(argc, argv);
+
 	// Inicialização da GLFW
-	glfwInit();
+	headless.initGlfw();
 
 	//Muita atenção aqui: alguns ambientes não aceitam essas configurações
 	//Você deve adaptar para a versão do OpenGL suportada por sua placa
@@ -78,7 +82,7 @@ int main()
 //#endif
 
 	// Criação da janela GLFW
-	GLFWwindow* window = glfwCreateWindow(WIDTH, HEIGHT, "Ola 3D -- Gabriel Brasil!", nullptr, nullptr);
+	GLFWwindow* window = headless.createWindow(WIDTH, HEIGHT, "Ola 3D -- Gabriel Brasil!");
 	glfwMakeContextCurrent(window);
 
 	// Fazendo o registro da função de callback para a janela GLFW
@@ -91,6 +95,8 @@ int main()
 
 	}
 
+	headless.setupFramebuffer();
+
 	// Obtendo as informações de versão
 	const GLubyte* renderer = glGetString(GL_RENDERER); /* get renderer string */
 	const GLubyte* version = glGetString(GL_VERSION); /* version as a string */
@@ -168,10 +174,12 @@ int main()
 
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
+		headless.endFrame(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
+	headless.finish();
 	glfwTerminate();
 	return 0;
 }
@@ -0,0 +1,408 @@
+#pragma once
+
+// Frustum culling de instâncias na GPU: um compute shader testa a esfera envolvente de
+// cada instância contra os 6 planos do frustum e compacta as sobreviventes direto nos
+// buffers de desenho (índices das instâncias visíveis + um comando indireto por malha),
+// sem a CPU ler ou escrever nada por instância.
+//
+//   InstanceCuller culler;
+//   culler.init(8);                                     // unidade do samplerBuffer drawData
+//   culler.setInstances(instances, models, arena);      // uma vez (instâncias estáticas)
+//   culler.cull(Frustum::fromMatrix(projection * view));
+//   glUniform1i(useDrawDataLocation, 1);
+//   culler.draw(arena);
+//
+// Cada malha da arena tem uma faixa do buffer de visíveis (a soma das instâncias das
+// malhas anteriores) e um comando com baseInstance no começo da faixa; o shader faz
+// atomicAdd no instanceCount do comando da malha e grava o índice da instância na
+// posição devolvida. O desenho é um glMultiDrawElementsIndirect com o buffer de
+// visíveis como fonte do atributo drawId, então o vertex shader de
+// IndirectDrawList::vertexSource() acha as matrizes da instância no texture buffer.
+//
+// Compute shaders e SSBOs são da GL 4.3 e a GLAD dos exercícios é 4.0: as funções vêm
+// da glfwGetProcAddress e, sem elas, gpuAvailable() é false e cull() usa a referência
+// na CPU (cullInstancesReference, o mesmo algoritmo), enviando o resultado pronto.
+// verify() roda as duas e compara as listas por malha (a ordem na GPU depende dos
+// atômicos); instâncias com a esfera a menos de VerifyTolerance de um plano podem
+// sair diferentes por arredondamento e não contam como erro.
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Bounds.h"
+#include "GeometryArena.h"
+#include "NormalMatrix.h"
+
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+// Layout std430 do buffer de instâncias: esfera em espaço de mundo (centro, raio) e malha
+struct CullInstance {
+    glm::vec4 sphere;
+    uint32_t mesh;
+    uint32_t padding[3];
+};
+
+struct InstanceCullStats {
+    int instances = 0;
+    int visible = 0;           // na GPU, de FrameLatency quadros atrás
+    bool gpu = false;          // cull() feito pelo compute shader
+    double cpuMs = 0.0;        // referência na CPU (quando é ela que faz o culling)
+
+    int culled() const { return instances - visible; }
+};
+
+// Referência na CPU: mesmo teste do compute shader e compactação por malha, na ordem
+// das instâncias. meshOffsets[m] = primeira posição da malha m em "visible".
+inline void cullInstancesReference(const Frustum& frustum, const std::vector<CullInstance>& instances,
+                                   const std::vector<uint32_t>& meshOffsets, std::vector<uint32_t>& visibleCounts,
+                                   std::vector<uint32_t>& visible) {
+    visibleCounts.assign(meshOffsets.size(), 0);
+    visible.resize(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const CullInstance& instance = instances[i];
+        glm::vec3 center(instance.sphere);
+        bool inside = true;
+        for (const glm::vec4& plane : frustum.planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -instance.sphere.w) {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+            visible[meshOffsets[instance.mesh] + visibleCounts[instance.mesh]++] = (uint32_t)i;
+    }
+}
+
+class InstanceCuller {
+public:
+    static const int GroupSize = 64;
+    static const int FrameLatency = 4;
+    static constexpr float VerifyTolerance = 1e-3f;
+
+    // dataUnit: unidade do samplerBuffer "drawData" (como em IndirectDrawList)
+    bool init(int dataUnit) {
+        unit = dataUnit;
+        glGenBuffers(1, &instanceBuffer);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &visibleBuffer);
+        glGenBuffers(1, &dataBuffer);
+        glGenBuffers(FrameLatency, readbackBuffers);
+        glGenTextures(1, &dataTexture);
+
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major > 4 || (major == 4 && minor >= 3)) {
+            dispatchCompute = (DispatchComputeProc)glfwGetProcAddress("glDispatchCompute");
+            memoryBarrier = (MemoryBarrierProc)glfwGetProcAddress("glMemoryBarrier");
+            multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)glfwGetProcAddress("glMultiDrawElementsIndirect");
+        }
+        if (dispatchCompute && memoryBarrier && multiDrawElementsIndirect)
+            computeProgram = createComputeProgram();
+        return true;
+    }
+
+    void shutdown() {
+        if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+        if (commandBuffer) glDeleteBuffers(1, &commandBuffer);
+        if (visibleBuffer) glDeleteBuffers(1, &visibleBuffer);
+        if (dataBuffer) glDeleteBuffers(1, &dataBuffer);
+        if (readbackBuffers[0]) glDeleteBuffers(FrameLatency, readbackBuffers);
+        if (dataTexture) glDeleteTextures(1, &dataTexture);
+        if (computeProgram) glDeleteProgram(computeProgram);
+        instanceBuffer = commandBuffer = visibleBuffer = dataBuffer = dataTexture = computeProgram = 0;
+        readbackBuffers[0] = 0;
+        instances.clear();
+    }
+
+    bool gpuAvailable() const { return computeProgram != 0; }
+    void setUseGpu(bool enabled) { useGpu = enabled; }
+    bool usingGpu() const { return useGpu && gpuAvailable(); }
+    const InstanceCullStats& stats() const { return lastStats; }
+    int instanceCount() const { return (int)instances.size(); }
+
+    // Instâncias estáticas: esferas em espaço de mundo e matrizes de modelo (a de normal
+    // é calculada aqui), no formato de 7 texels de IndirectDrawList
+    void setInstances(const std::vector<CullInstance>& cullInstances, const std::vector<glm::mat4>& models, const GeometryArena& arena) {
+        instances = cullInstances;
+        int meshCount = arena.meshCount();
+        meshOffsets.assign(meshCount, 0);
+        std::vector<uint32_t> perMesh(meshCount, 0);
+        for (const CullInstance& instance : instances)
+            ++perMesh[instance.mesh];
+        for (int m = 1; m < meshCount; ++m)
+            meshOffsets[m] = meshOffsets[m - 1] + perMesh[m - 1];
+
+        commandTemplate.resize(meshCount);
+        for (int m = 0; m < meshCount; ++m) {
+            const ArenaMesh& mesh = arena.mesh(m);
+            commandTemplate[m] = {mesh.indexCount, 0, mesh.firstIndex, mesh.baseVertex, meshOffsets[m]};
+        }
+
+        std::vector<float> drawData;
+        drawData.reserve(models.size() * IndirectDrawList::TexelsPerDraw * 4);
+        for (const glm::mat4& model : models) {
+            glm::mat3 normalMatrix = computeNormalMatrix(model);
+            drawData.insert(drawData.end(), glm::value_ptr(model), glm::value_ptr(model) + 16);
+            for (int column = 0; column < 3; ++column) {
+                drawData.insert(drawData.end(), glm::value_ptr(normalMatrix) + column * 3, glm::value_ptr(normalMatrix) + column * 3 + 3);
+                drawData.push_back(0.0f);
+            }
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, dataBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, drawData.size() * sizeof(float), drawData.data(), GL_STATIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, dataBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        size_t commandBytes = commandTemplate.size() * sizeof(DrawElementsIndirectCommand);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(CullInstance), instances.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+        glBufferData(GL_ARRAY_BUFFER, std::max<size_t>(instances.size(), 1) * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, commandBuffer);
+        glBufferData(GL_ARRAY_BUFFER, commandBytes, commandTemplate.data(), GL_DYNAMIC_DRAW);
+        for (GLuint readback : readbackBuffers) {
+            glBindBuffer(GL_ARRAY_BUFFER, readback);
+            glBufferData(GL_ARRAY_BUFFER, commandBytes, nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        for (bool& pending : readbackPending)
+            pending = false;
+        // Nada visível até o primeiro cull() (draw() do GL 4.0 indexa as contagens)
+        visibleCounts.assign(meshCount, 0);
+        lastStats = InstanceCullStats();
+        lastStats.instances = (int)instances.size();
+    }
+
+    void cull(const Frustum& frustum) {
+        if (instances.empty()) return;
+        lastStats.gpu = usingGpu();
+        if (lastStats.gpu) {
+            collect();
+            glBindBuffer(GL_ARRAY_BUFFER, commandBuffer);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, commandTemplate.size() * sizeof(DrawElementsIndirectCommand), commandTemplate.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+            GLint previousProgram = 0;
+            glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+            glUseProgram(computeProgram);
+            glUniform4fv(glGetUniformLocation(computeProgram, "planes"), 6, glm::value_ptr(frustum.planes[0]));
+            glUniform1ui(glGetUniformLocation(computeProgram, "instanceCount"), (GLuint)instances.size());
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, commandBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, visibleBuffer);
+            dispatchCompute((GLuint)((instances.size() + GroupSize - 1) / GroupSize), 1, 1);
+            memoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+            glUseProgram((GLuint)previousProgram);
+
+            // Contagem de visíveis lida FrameLatency quadros depois, sem esperar a GPU
+            glBindBuffer(GL_COPY_READ_BUFFER, commandBuffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[slot]);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, commandTemplate.size() * sizeof(DrawElementsIndirectCommand));
+            readbackPending[slot] = true;
+            slot = (slot + 1) % FrameLatency;
+        } else {
+            auto start = std::chrono::steady_clock::now();
+            cullInstancesReference(frustum, instances, meshOffsets, visibleCounts, visible);
+            lastStats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            lastStats.visible = 0;
+            for (uint32_t count : visibleCounts)
+                lastStats.visible += (int)count;
+
+            std::vector<DrawElementsIndirectCommand> commands = commandTemplate;
+            for (size_t m = 0; m < commands.size(); ++m)
+                commands[m].instanceCount = visibleCounts[m];
+            glBindBuffer(GL_ARRAY_BUFFER, commandBuffer);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+            glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, visible.size() * sizeof(uint32_t), visible.data());
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
+    }
+
+    // Desenha as visíveis do último cull() com o VAO da arena; o programa atual precisa
+    // usar drawData (unidade de init) com useDrawData ligado
+    void draw(GeometryArena& arena) {
+        if (instances.empty()) return;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_BUFFER, dataTexture);
+        glActiveTexture(GL_TEXTURE0);
+        if (multiDrawElementsIndirect) {
+            arena.bindDrawIds(visibleBuffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (GLsizei)commandTemplate.size(), 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        } else {
+            // GL 4.0 (só a referência na CPU): contagens conhecidas, um desenho
+            // instanciado por malha com o atributo drawId deslocado para a faixa dela
+            for (size_t m = 0; m < commandTemplate.size(); ++m) {
+                if (!visibleCounts[m]) continue;
+                const DrawElementsIndirectCommand& command = commandTemplate[m];
+                arena.bindDrawIds(visibleBuffer, command.baseInstance);
+                glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                                                  (void*)(sizeof(uint32_t) * command.firstIndex), visibleCounts[m], command.baseVertex);
+            }
+        }
+        arena.bindDrawIds(0);
+        glBindVertexArray(0);
+    }
+
+    // Compara o resultado do compute shader com a referência na CPU para o mesmo
+    // frustum (lê os buffers de volta: espera a GPU). Retorna o número de diferenças.
+    int verify(const Frustum& frustum, int* borderline = nullptr) {
+        if (!usingGpu() || instances.empty()) return 0;
+        std::vector<DrawElementsIndirectCommand> commands(commandTemplate.size());
+        std::vector<uint32_t> gpuVisible(instances.size());
+        glBindBuffer(GL_ARRAY_BUFFER, commandBuffer);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_ARRAY_BUFFER, visibleBuffer);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, gpuVisible.size() * sizeof(uint32_t), gpuVisible.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        cullInstancesReference(frustum, instances, meshOffsets, visibleCounts, visible);
+        lastStats.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        int mismatches = 0, nearPlane = 0;
+        std::vector<uint32_t> gpuList, cpuList, difference;
+        for (size_t m = 0; m < commands.size(); ++m) {
+            uint32_t first = meshOffsets[m];
+            uint32_t gpuCount = std::min<uint32_t>(commands[m].instanceCount, (uint32_t)instances.size() - first);
+            gpuList.assign(gpuVisible.begin() + first, gpuVisible.begin() + first + gpuCount);
+            cpuList.assign(visible.begin() + first, visible.begin() + first + visibleCounts[m]);
+            std::sort(gpuList.begin(), gpuList.end());
+            difference.clear();
+            std::set_symmetric_difference(gpuList.begin(), gpuList.end(), cpuList.begin(), cpuList.end(), std::back_inserter(difference));
+            for (uint32_t index : difference) {
+                if (index < instances.size() && planeMargin(frustum, instances[index]) < VerifyTolerance * std::max(1.0f, instances[index].sphere.w))
+                    ++nearPlane;
+                else
+                    ++mismatches;
+            }
+        }
+        if (borderline) *borderline = nearPlane;
+        return mismatches;
+    }
+
+private:
+    typedef void (APIENTRYP DispatchComputeProc)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+    typedef void (APIENTRYP MemoryBarrierProc)(GLbitfield barriers);
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+
+    int unit = 0;
+    bool useGpu = true;
+    GLuint computeProgram = 0;
+    GLuint instanceBuffer = 0, commandBuffer = 0, visibleBuffer = 0, dataBuffer = 0, dataTexture = 0;
+    GLuint readbackBuffers[FrameLatency] = {};
+    bool readbackPending[FrameLatency] = {};
+    int slot = 0;
+    DispatchComputeProc dispatchCompute = nullptr;
+    MemoryBarrierProc memoryBarrier = nullptr;
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+
+    std::vector<CullInstance> instances;
+    std::vector<uint32_t> meshOffsets;
+    std::vector<DrawElementsIndirectCommand> commandTemplate;
+    std::vector<uint32_t> visibleCounts, visible;
+    InstanceCullStats lastStats;
+
+    // Distância da esfera ao plano mais próximo (negativa = fora)
+    static float planeMargin(const Frustum& frustum, const CullInstance& instance) {
+        float margin = FLT_MAX;
+        for (const glm::vec4& plane : frustum.planes)
+            margin = std::min(margin, std::fabs(glm::dot(glm::vec3(plane), glm::vec3(instance.sphere)) + plane.w + instance.sphere.w));
+        return margin;
+    }
+
+    // Soma os instanceCount do quadro que ocupava o slot atual
+    void collect() {
+        if (!readbackPending[slot]) return;
+        readbackPending[slot] = false;
+        std::vector<DrawElementsIndirectCommand> commands(commandTemplate.size());
+        glBindBuffer(GL_ARRAY_BUFFER, readbackBuffers[slot]);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        lastStats.visible = 0;
+        for (const DrawElementsIndirectCommand& command : commands)
+            lastStats.visible += (int)command.instanceCount;
+    }
+
+    static GLuint createComputeProgram() {
+        const GLchar* source = R"(
+#version 430
+layout (local_size_x = 64) in;
+
+struct Instance {
+    vec4 sphere;
+    uint mesh;
+    uint padding0, padding1, padding2;
+};
+layout (std430, binding = 0) readonly buffer Instances { Instance instances[]; };
+// DrawElementsIndirectCommand: count, instanceCount, firstIndex, baseVertex, baseInstance
+layout (std430, binding = 1) buffer Commands { uint commands[]; };
+layout (std430, binding = 2) writeonly buffer Visible { uint visible[]; };
+
+uniform vec4 planes[6];
+uniform uint instanceCount;
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= instanceCount)
+        return;
+    vec4 sphere = instances[index].sphere;
+    for (int i = 0; i < 6; ++i)
+        if (dot(planes[i].xyz, sphere.xyz) + planes[i].w < -sphere.w)
+            return;
+    uint mesh = instances[index].mesh;
+    uint slot = atomicAdd(commands[mesh * 5u + 1u], 1u);
+    visible[commands[mesh * 5u + 4u] + slot] = index;
+})";
+        GLuint shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        GLuint program = glCreateProgram();
+        glAttachShader(program, shader);
+        glLinkProgram(program);
+        glDeleteShader(shader);
+
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(program, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::INSTANCE_CULL::LINKING_FAILED\n" << infoLog << std::endl;
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+};
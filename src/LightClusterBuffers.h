@@ -0,0 +1,87 @@
+#pragma once
+
+// Buffers de GPU do forward clustered (LightClusters.h), como texture buffers
+// (GL 3.1), já que os exercícios usam GL 4.0 e não têm SSBO:
+//
+//   lightData      samplerBuffer  RGBA32F  2 texels por luz: (posição, raio), (cor * intensidade, 0)
+//   clusterRanges  usamplerBuffer RG32UI   (offset, count) por cluster
+//   lightIndices   usamplerBuffer R32UI    índices das luzes de cada cluster
+//
+// upload() reespecifica os buffers a cada quadro (glBufferData com NULL seguido de
+// glBufferSubData), para o driver não esperar a GPU terminar o quadro anterior.
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "LightClusters.h"
+
+class LightClusterBuffers {
+public:
+    enum { LightData = 0, ClusterRanges = 1, LightIndices = 2, BufferCount = 3 };
+
+    void init() {
+        glGenBuffers(BufferCount, buffers);
+        glGenTextures(BufferCount, textures);
+        const GLenum formats[BufferCount] = {GL_RGBA32F, GL_RG32UI, GL_R32UI};
+        for (int i = 0; i < BufferCount; ++i) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void shutdown() {
+        glDeleteTextures(BufferCount, textures);
+        glDeleteBuffers(BufferCount, buffers);
+    }
+
+    // Sem grade (grid == nullptr) só as luzes sobem: o shader percorre todas
+    void upload(const std::vector<ClusterLight>& lights, const LightClusterGrid* grid) {
+        lightTexels.resize(lights.size() * 8);
+        for (size_t i = 0; i < lights.size(); ++i) {
+            const ClusterLight& light = lights[i];
+            float* t = &lightTexels[i * 8];
+            t[0] = light.position.x;
+            t[1] = light.position.y;
+            t[2] = light.position.z;
+            t[3] = light.radius;
+            t[4] = light.color.r * light.intensity;
+            t[5] = light.color.g * light.intensity;
+            t[6] = light.color.b * light.intensity;
+            t[7] = 0.0f;
+        }
+        write(LightData, lightTexels.data(), lightTexels.size() * sizeof(float));
+        if (grid) {
+            write(ClusterRanges, grid->clusterRanges().data(), grid->clusterRanges().size() * sizeof(uint32_t));
+            write(LightIndices, grid->lightIndices().data(), grid->lightIndices().size() * sizeof(uint32_t));
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Liga as três texturas em firstUnit, firstUnit + 1 e firstUnit + 2 (ordem do enum)
+    void bind(int firstUnit) const {
+        for (int i = 0; i < BufferCount; ++i) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    GLuint buffers[BufferCount] = {0, 0, 0};
+    GLuint textures[BufferCount] = {0, 0, 0};
+    std::vector<float> lightTexels;
+
+    void write(int index, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[index]);
+        glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bytes, 16), nullptr, GL_STREAM_DRAW);
+        if (bytes)
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+// Grade de clusters para forward clustered: o frustum da câmera é dividido em
+// TilesX x TilesY colunas de tela e Slices fatias de profundidade exponenciais
+// (z_k = near * (far / near)^(k / Slices)), e cada luz pontual com raio finito é
+// associada aos clusters que a esfera dela pode tocar. O fragment shader acha o seu
+// cluster por gl_FragCoord e pela profundidade no espaço da câmera e só avalia as
+// luzes da lista daquele cluster.
+//
+// Por quadro (assign):
+//   1. limites da esfera em colunas, linhas e fatias, 4 luzes por vez com float4
+//      (Simd.h): as bordas das colunas e linhas são planos pela origem da câmera,
+//      então a esfera fica à direita de uma borda se a distância ao plano > raio;
+//   2. contagem por cluster, em paralelo por fatia (cada fatia tem os seus clusters);
+//   3. soma de prefixos e preenchimento da lista de índices, de novo por fatia.
+// As listas saem na ordem das luzes, então o resultado não depende das threads.
+//
+// clusterRanges() tem (offset, count) por cluster, na ordem x, depois y, depois fatia;
+// lightIndices() tem os índices das luzes. Não depende de OpenGL.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ParallelFor.h"
+#include "Simd.h"
+
+struct ClusterLight {
+    glm::vec3 position;
+    float radius = 1.0f;
+    glm::vec3 color = glm::vec3(1.0f);
+    float intensity = 1.0f;
+};
+
+struct LightClusterStats {
+    int lights = 0;
+    int visibleLights = 0;       // luzes que tocam o frustum
+    int indexCount = 0;          // pares (cluster, luz)
+    int maxPerCluster = 0;
+    double assignMs = 0.0;
+};
+
+class LightClusterGrid {
+public:
+    static const int TilesX = 16;
+    static const int TilesY = 9;
+    static const int Slices = 24;
+    static const int ClusterCount = TilesX * TilesY * Slices;
+
+    LightClusterGrid(ThreadPool& pool = ThreadPool::global()) : pool(pool), ranges(ClusterCount * 2, 0) {}
+
+    // Mesmos parâmetros da glm::perspective da câmera; farZ pode ser menor que o far
+    // da projeção (fragmentos além dele caem na última fatia)
+    void setProjection(float fovY, float aspect, float nearZ, float farZ) {
+        tanHalfY = std::tan(fovY * 0.5f);
+        tanHalfX = tanHalfY * aspect;
+        zNear = nearZ;
+        zFar = farZ;
+        sliceScale = Slices / std::log(zFar / zNear);
+        sliceBias = -std::log(zNear) * sliceScale;
+    }
+
+    // fatia = log(profundidade) * sliceScale + sliceBias, como no shader
+    float getSliceScale() const { return sliceScale; }
+    float getSliceBias() const { return sliceBias; }
+
+    int sliceOf(float viewDepth) const {
+        if (viewDepth <= zNear) return 0;
+        return std::min(Slices - 1, (int)(std::log(viewDepth) * sliceScale + sliceBias));
+    }
+
+    static int clusterIndex(int x, int y, int slice) { return (slice * TilesY + y) * TilesX + x; }
+
+    void assign(const std::vector<ClusterLight>& lights, const glm::mat4& view) {
+        auto start = std::chrono::steady_clock::now();
+        int count = (int)lights.size();
+        bounds.resize(count);
+
+        // 1. Limites de cada luz, em grupos de 4
+        int groups = (count + 3) / 4;
+        const int groupsPerTask = 64;
+        pool.parallelFor((groups + groupsPerTask - 1) / groupsPerTask, [&](int task, int) {
+            int end = std::min(groups, (task + 1) * groupsPerTask);
+            for (int g = task * groupsPerTask; g < end; ++g)
+                computeBounds(lights, view, g * 4, std::min(count, g * 4 + 4));
+        });
+
+        // Luzes por fatia, para as fases 2 e 3 não percorrerem todas
+        visible.clear();
+        for (int i = 0; i < count; ++i)
+            if (bounds[i].visible) visible.push_back(i);
+
+        // 2. Contagem por cluster
+        std::fill(ranges.begin(), ranges.end(), 0u);
+        pool.parallelFor(Slices, [&](int slice, int) {
+            for (int light : visible) {
+                const LightBounds& b = bounds[light];
+                if (slice < b.slice0 || slice > b.slice1) continue;
+                for (int y = b.y0; y <= b.y1; ++y)
+                    for (int x = b.x0; x <= b.x1; ++x)
+                        ++ranges[clusterIndex(x, y, slice) * 2 + 1];
+            }
+        });
+
+        // 3. Offsets e preenchimento
+        uint32_t total = 0;
+        int maxPerCluster = 0;
+        for (int c = 0; c < ClusterCount; ++c) {
+            ranges[c * 2] = total;
+            total += ranges[c * 2 + 1];
+            maxPerCluster = std::max(maxPerCluster, (int)ranges[c * 2 + 1]);
+        }
+        indices.resize(total);
+        pool.parallelFor(Slices, [&](int slice, int) {
+            uint32_t cursor[TilesX * TilesY];
+            for (int tile = 0; tile < TilesX * TilesY; ++tile)
+                cursor[tile] = ranges[(slice * TilesX * TilesY + tile) * 2];
+            for (int light : visible) {
+                const LightBounds& b = bounds[light];
+                if (slice < b.slice0 || slice > b.slice1) continue;
+                for (int y = b.y0; y <= b.y1; ++y)
+                    for (int x = b.x0; x <= b.x1; ++x)
+                        indices[cursor[y * TilesX + x]++] = (uint32_t)light;
+            }
+        });
+
+        lastStats.lights = count;
+        lastStats.visibleLights = (int)visible.size();
+        lastStats.indexCount = (int)total;
+        lastStats.maxPerCluster = maxPerCluster;
+        lastStats.assignMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const std::vector<uint32_t>& clusterRanges() const { return ranges; }
+    const std::vector<uint32_t>& lightIndices() const { return indices; }
+    const LightClusterStats& stats() const { return lastStats; }
+
+private:
+    struct LightBounds {
+        int x0, x1, y0, y1, slice0, slice1;
+        bool visible;
+    };
+
+    ThreadPool& pool;
+    float tanHalfX = 1.0f, tanHalfY = 1.0f;
+    float zNear = 0.1f, zFar = 100.0f;
+    float sliceScale = 1.0f, sliceBias = 0.0f;
+    std::vector<LightBounds> bounds;
+    std::vector<int> visible;
+    std::vector<uint32_t> ranges;
+    std::vector<uint32_t> indices;
+    LightClusterStats lastStats;
+
+    // Luzes [first, end), no máximo 4; lanes que sobram repetem a última luz
+    void computeBounds(const std::vector<ClusterLight>& lights, const glm::mat4& view, int first, int end) {
+        alignas(16) float px[4], py[4], pz[4], pr[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            const ClusterLight& light = lights[std::min(first + lane, end - 1)];
+            glm::vec3 p = glm::vec3(view * glm::vec4(light.position, 1.0f));
+            px[lane] = p.x;
+            py[lane] = p.y;
+            pz[lane] = p.z;
+            pr[lane] = light.radius;
+        }
+        float4 cx = float4::load(px), cy = float4::load(py), cz = float4::load(pz), r = float4::load(pr);
+        float4 negR = -r;
+        const float4 one(1.0f), zero(0.0f);
+
+        // Borda j das colunas: x = -ndc_j * tanHalfX * z, normal (1, 0, ndc_j * tanHalfX)
+        float4 rightOf(0.0f), leftOf(0.0f), outsideX(0.0f);
+        for (int j = 0; j <= TilesX; ++j) {
+            float k = (-1.0f + 2.0f * j / TilesX) * tanHalfX;
+            float4 d = (cx + cz * k) * (1.0f / std::sqrt(1.0f + k * k));
+            if (j == 0) outsideX = outsideX | (d < negR);
+            else if (j == TilesX) outsideX = outsideX | (d > r);
+            else {
+                rightOf = rightOf + (one & (d > r));
+                leftOf = leftOf + (one & (d < negR));
+            }
+        }
+        float4 aboveOf(0.0f), belowOf(0.0f), outsideY(0.0f);
+        for (int j = 0; j <= TilesY; ++j) {
+            float k = (-1.0f + 2.0f * j / TilesY) * tanHalfY;
+            float4 d = (cy + cz * k) * (1.0f / std::sqrt(1.0f + k * k));
+            if (j == 0) outsideY = outsideY | (d < negR);
+            else if (j == TilesY) outsideY = outsideY | (d > r);
+            else {
+                aboveOf = aboveOf + (one & (d > r));
+                belowOf = belowOf + (one & (d < negR));
+            }
+        }
+        // Profundidade positiva à frente da câmera
+        float4 depthMin = -cz - r, depthMax = -cz + r;
+        float4 outsideZ = (depthMax < float4(zNear)) | (depthMin > float4(zFar));
+        int culled = movemask(outsideX | outsideY | outsideZ);
+
+        alignas(16) float x0[4], x1[4], y0[4], y1[4], z0[4], z1[4];
+        rightOf.store(x0);
+        leftOf.store(x1);
+        aboveOf.store(y0);
+        belowOf.store(y1);
+        max(depthMin, zero).store(z0);
+        depthMax.store(z1);
+        for (int lane = 0; lane < end - first; ++lane) {
+            LightBounds& b = bounds[first + lane];
+            b.visible = !(culled & (1 << lane));
+            b.x0 = (int)x0[lane];
+            b.x1 = TilesX - 1 - (int)x1[lane];
+            b.y0 = (int)y0[lane];
+            b.y1 = TilesY - 1 - (int)y1[lane];
+            b.slice0 = sliceOf(z0[lane]);
+            b.slice1 = sliceOf(z1[lane]);
+            b.visible = b.visible && b.x0 <= b.x1 && b.y0 <= b.y1;
+        }
+    }
+};
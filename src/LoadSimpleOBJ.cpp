@@ -1,9 +1,7 @@
-
-// Cabeçalhos necessários (para esta função), acrescentar ao seu código 
+// Cabeçalhos necessários (para esta função), acrescentar ao seu código
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
@@ -19,165 +17,88 @@ using namespace std;
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-struct Mesh 
-{
-    GLuint VAO; 
-    string texturePath;
-};
+// stb_image: quem inclui este arquivo define STB_IMAGE_IMPLEMENTATION antes (como no M4)
+#include <stb_image.h>
 
+// Tabela de materiais do MTL (newmtl, Ka/Kd/Ks/Ns, map_Kd...) e faces agrupadas por
+// "usemtl" em faixas contíguas; o desenho é um glDrawElements por faixa, com os
+// parâmetros do material num uniform buffer (glBindBufferRange)
+#include "MaterialDrawList.h"
+#include "ObjMaterials.h"
 
-string loadMTL(const string& mtlFilePath, const string& directory)
+// Textura de um map_Kd; 0 se a imagem não abrir
+GLuint loadMTLTexture(const string& texturePath)
 {
-    std::ifstream mtlFile(mtlFilePath);
-    if (!mtlFile.is_open()) 
+    int width, height, nrComponents;
+    unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrComponents, 0);
+    if (!data)
     {
-        std::cerr << "Erro ao abrir arquivo MTL: " << mtlFilePath << std::endl;
-        return "";
+        std::cerr << "Erro ao carregar a textura " << texturePath << std::endl;
+        return 0;
     }
-    
-    string line;
-    string texturePath = "";
-    
-    while (std::getline(mtlFile, line)) 
-    {
-        std::istringstream ss(line);
-        string word;
-        ss >> word;
-        
-        if (word == "map_Kd") 
-        {
-            ss >> texturePath;
-            if (texturePath.find(':') == string::npos && texturePath[0] != '/') 
-            {
-                texturePath = directory + texturePath;
-            }
-            break;
-        }
-    }
-    
-    mtlFile.close();
-    return texturePath;
+    GLenum format = nrComponents == 1 ? GL_RED : (nrComponents == 4 ? GL_RGBA : GL_RGB);
+
+    GLuint texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    stbi_image_free(data);
+    return texture;
 }
 
-int loadSimpleOBJ(string filePATH, int &nVertices, string &texturePath)
+// Carrega o OBJ e todos os materiais dos seus MTL em "materials" (VAO, buffers e o
+// uniform buffer dos materiais) e os map_Kd em "textures" (uma por arquivo; o chamador
+// apaga). Atributos do VAO: 0 posição, 1 normal, 2 coordenada de textura. No laço de
+// renderização, materials.draw() faz um desenho por material. Retorna false se o OBJ
+// não abrir ou não tiver faces
+bool loadSimpleOBJ(string filePATH, MaterialDrawList& materials, vector<GLuint>& textures)
 {
-    std::vector<glm::vec3> vertices;
-    std::vector<glm::vec2> texCoords;
-    std::vector<glm::vec3> normals;
-    std::vector<GLfloat> vBuffer;
-    
-    glm::vec3 color = glm::vec3(1.0, 0.0, 0.0);
-    string mtlFileName = ""; 
-    texturePath = ""; 
-    
-    std::ifstream arqEntrada(filePATH.c_str());
-    if (!arqEntrada.is_open()) 
+    MaterialMesh mesh;
+    if (!loadObjWithMaterials(filePATH, mesh) || mesh.indices.empty())
     {
         std::cerr << "Erro ao tentar ler o arquivo " << filePATH << std::endl;
-        return -1;
-    }
-    
-    string directory = filePATH.substr(0, filePATH.find_last_of("/\\") + 1);
-    
-    std::string line;
-    while (std::getline(arqEntrada, line)) 
-    {
-        std::istringstream ssline(line);
-        std::string word;
-        ssline >> word;
-        
-        if (word == "mtllib") 
-        {
-            ssline >> mtlFileName;
-            string mtlFilePath = directory + mtlFileName;
-            
-            texturePath = loadMTL(mtlFilePath, directory);
-        }
-        else if (word == "v") 
-        {
-            glm::vec3 vertice;
-            ssline >> vertice.x >> vertice.y >> vertice.z;
-            vertices.push_back(vertice);
-        } 
-        else if (word == "vt") 
-        {
-            glm::vec2 vt;
-            ssline >> vt.s >> vt.t;
-            texCoords.push_back(vt);
-        } 
-        else if (word == "vn") 
-        {
-            glm::vec3 normal;
-            ssline >> normal.x >> normal.y >> normal.z;
-            normals.push_back(normal);
-        } 
-        else if (word == "f")
-        {
-            while (ssline >> word) 
-            {
-                int vi = 0, ti = 0, ni = 0;
-                std::istringstream ss(word);
-                std::string index;
-                
-                if (std::getline(ss, index, '/')) 
-                    vi = !index.empty() ? std::stoi(index) - 1 : 0;
-                if (std::getline(ss, index, '/')) 
-                    ti = !index.empty() ? std::stoi(index) - 1 : 0;
-                if (std::getline(ss, index)) 
-                    ni = !index.empty() ? std::stoi(index) - 1 : 0;
-                
-                vBuffer.push_back(vertices[vi].x);
-                vBuffer.push_back(vertices[vi].y);
-                vBuffer.push_back(vertices[vi].z);
-                
-                if (ti >= 0 && ti < texCoords.size()) 
-                {
-                    vBuffer.push_back(texCoords[ti].s);
-                    vBuffer.push_back(texCoords[ti].t);
-                } 
-                else 
-                {
-                    vBuffer.push_back(0.0f);
-                    vBuffer.push_back(0.0f);
-                }
-                
-                vBuffer.push_back(color.r);
-                vBuffer.push_back(color.g);
-                vBuffer.push_back(color.b);
-            }
-        }
-    }
-    
-    arqEntrada.close();
-    
-    if (!mtlFileName.empty()) {
-        std::cout << "Nome do arquivo de textura a ser carregado: " << directory + mtlFileName << std::endl;
+        return false;
     }
 
-    
-    GLuint VBO, VAO;
-    
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
-    
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
-    
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)0);
+    materials.init(mesh);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, position));
     glEnableVertexAttribArray(0);
-    
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, normal));
     glEnableVertexAttribArray(1);
-    
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), (GLvoid*)(5 * sizeof(GLfloat)));
+
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, texCoord));
     glEnableVertexAttribArray(2);
-    
+
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
-    
-    nVertices = vBuffer.size() / 8;
-    
-    
-    return VAO;
+
+    // Materiais que usam o mesmo arquivo dividem a textura
+    unordered_map<string, GLuint> loaded;
+    for (size_t m = 0; m < mesh.materials.size(); ++m)
+    {
+        const string& texturePath = mesh.materials[m].diffuseMap;
+        if (texturePath.empty())
+            continue;
+        auto found = loaded.find(texturePath);
+        if (found == loaded.end())
+        {
+            GLuint texture = loadMTLTexture(texturePath);
+            if (texture)
+                textures.push_back(texture);
+            found = loaded.emplace(texturePath, texture).first;
+        }
+        materials.setTexture((int)m, found->second);
+    }
+
+    std::cout << filePATH << ": " << mesh.materials.size() << " materiais, " << mesh.indices.size() / 3 << " triângulos, "
+              << materials.runCount() << " trechos de usemtl -> " << materials.rangeCount() << " desenhos (um por material)" << std::endl;
+    return true;
 }
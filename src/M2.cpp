@@ -6,6 +6,11 @@
 #include <iostream>
 #include <vector>
 
+#include "Bvh.h"
+#include "GlStateCache.h"
+#include "Headless.h"
+#include "SceneGraph.h"
+
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
@@ -118,15 +123,27 @@ void processInput(GLFWwindow* window) {
     if (glfwGetKey(window, GLFW_KEY_Z) == GLFW_PRESS) rotationZ += 1.0f;
 }
 
-int main() {
-    glfwInit();
+// AABB local do cubo unitário (usado no frustum culling)
+const AABB cubeBounds = {glm::vec3(-0.5f), glm::vec3(0.5f)};
+
+int main(int argc, char** argv) {
+    HeadlessRun headless(argc, argv);
+    GlStateCache::configure(argc, argv);
+    if (GlStateCache::abFrameCount() > 0)
+        headless.setFrameCount(GlStateCache::abFrameCount());
+
+    headless.initGlfw();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Cubo Interativo - Gabriel Brasil", nullptr, nullptr);
+    GLFWwindow* window = headless.createWindow(SCR_WIDTH, SCR_HEIGHT, "Cubo Interativo - Gabriel Brasil");
     glfwMakeContextCurrent(window);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    GlStateCache::install();
+    headless.setupFramebuffer();
+    // Proporção do framebuffer em que a cena é desenhada (no headless, o tamanho pedido)
+    float aspect = headless.enabled() ? (float)headless.getWidth() / headless.getHeight() : (float)SCR_WIDTH / SCR_HEIGHT;
     glEnable(GL_DEPTH_TEST);
 
     // Shaders
@@ -155,9 +172,45 @@ int main() {
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    // Grafo de cena: um nó raiz com a posição global e um filho por cubo
+    SceneGraph sceneGraph;
+    int rootNode = sceneGraph.addNode(-1);
+    std::vector<int> cubeNodes(cubePositions.size());
+    for (size_t i = 0; i < cubePositions.size(); ++i) {
+        Transform local;
+        local.translation = cubePositions[i];
+        cubeNodes[i] = sceneGraph.addNode(rootNode, local);
+    }
+    sceneGraph.setTranslation(rootNode, position);
+    sceneGraph.update();
+
+    // BVH com os AABBs de mundo de cada cubo
+    std::vector<AABB> cubeWorldBounds(cubePositions.size());
+    for (size_t i = 0; i < cubePositions.size(); ++i)
+        cubeWorldBounds[i] = transformAABB(cubeBounds, sceneGraph.world(cubeNodes[i]));
+    Bvh bvh;
+    bvh.build(cubeWorldBounds);
+    std::vector<int> visibleCubes;
+    BvhCullStats cullStats;
+    double lastStatsTime = glfwGetTime();
+
     while (!glfwWindowShouldClose(window)) {
         processInput(window);
 
+        // Só os nós alterados (e seus filhos) têm as matrizes refeitas
+        sceneGraph.setTranslation(rootNode, position);
+        for (int node : cubeNodes) {
+            sceneGraph.setRotation(node, glm::vec3(rotationX, rotationY, rotationZ));
+            sceneGraph.setScale(node, glm::vec3(scale));
+        }
+        if (sceneGraph.update() > 0) {
+            for (int node : sceneGraph.changedNodes()) {
+                if (node == rootNode) continue;
+                bvh.update(node - cubeNodes[0], transformAABB(cubeBounds, sceneGraph.world(node)));
+            }
+            bvh.rebuildIfDegraded();
+        }
+
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -165,15 +218,18 @@ int main() {
         glBindVertexArray(VAO);
 
         glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH/SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+        bvh.cull(Frustum::fromMatrix(projection * view), visibleCubes, &cullStats);
+        if (glfwGetTime() - lastStatsTime >= 1.0) {
+            std::cout << "Visible: " << cullStats.visible << "/" << cubePositions.size()
+                      << " | nodes visited: " << cullStats.nodesVisited
+                      << " | cull: " << cullStats.cullTimeMs << " ms\n";
+            lastStatsTime = glfwGetTime();
+        }
 
-        for (const auto& offset : cubePositions) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, position + offset);
-            model = glm::rotate(model, glm::radians(rotationX), glm::vec3(1, 0, 0));
-            model = glm::rotate(model, glm::radians(rotationY), glm::vec3(0, 1, 0));
-            model = glm::rotate(model, glm::radians(rotationZ), glm::vec3(0, 0, 1));
-            model = glm::scale(model, glm::vec3(scale));
+        for (int i : visibleCubes) {
+            const glm::mat4& model = sceneGraph.world(cubeNodes[i]);
 
             glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
             glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
@@ -183,9 +239,12 @@ int main() {
         }
 
         glfwSwapBuffers(window);
+        headless.endFrame(window);
+        GlStateCache::endFrame(window);
         glfwPollEvents();
     }
 
+    headless.finish();
     glfwTerminate();
     return 0;
 }
@@ -1,13 +1,17 @@
 #include <iostream>
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "Headless.h"
+
 using namespace std;
 
+#define STB_IMAGE_IMPLEMENTATION
 #include "LoadSimpleOBJ.cpp"
 
 GLuint compileShader(GLenum type, const char* source) {
@@ -40,8 +44,10 @@ GLuint createShaderProgram(const char* vertexShaderSource, const char* fragmentS
     return shaderProgram;
 }
 
-int main() {
-    if (!glfwInit()) {
+int main(int argc, char** argv) {
+    HeadlessRun headless(argc, argv);
+
+    if (!headless.initGlfw()) {
         std::cerr << "Falha ao inicializar GLFW" << std::endl;
         return -1;
     }
@@ -50,7 +56,7 @@ int main() {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow* window = glfwCreateWindow(800, 600, "Carregando OBJ", NULL, NULL);
+    GLFWwindow* window = headless.createWindow(800, 600, "Carregando OBJ");
     if (!window) {
         std::cerr << "Falha ao criar janela GLFW" << std::endl;
         glfwTerminate();
@@ -64,11 +70,11 @@ int main() {
         return -1;
     }
 
-    int nVertices;
-    string texturePath;
-    GLuint objVAO = loadSimpleOBJ("../assets/Modelos3D/Cube.obj", nVertices, texturePath);
-    
-    if (objVAO == -1) {
+    headless.setupFramebuffer();
+
+    MaterialDrawList materials;
+    vector<GLuint> textures;
+    if (!loadSimpleOBJ("../assets/Modelos3D/Cube.obj", materials, textures)) {
         std::cerr << "Erro ao carregar o arquivo OBJ!" << std::endl;
         glfwTerminate();
         return -1;
@@ -77,27 +83,34 @@ int main() {
     const char* vertexShaderSource = R"(
         #version 330 core
         layout (location = 0) in vec3 aPos;
-        layout (location = 2) in vec3 aColor;
-        out vec3 ourColor;
+        layout (location = 1) in vec3 aNormal;
+        layout (location = 2) in vec2 aTexCoord;
+        out vec3 normal;
+        out vec2 texCoord;
         uniform mat4 model;
         uniform mat4 view;
         uniform mat4 projection;
         void main() {
             gl_Position = projection * view * model * vec4(aPos, 1.0);
-            ourColor = aColor;
+            normal = mat3(model) * aNormal;
+            texCoord = aTexCoord;
         }
     )";
 
-    const char* fragmentShaderSource = R"(
-        #version 330 core
-        in vec3 ourColor;
+    // Cor do material da faixa (bloco "Material" de MaterialDrawList) com uma luz difusa fixa
+    string fragmentShaderSource = string("#version 330 core\n") + MaterialDrawList::shaderSource() + R"(
+        in vec3 normal;
+        in vec2 texCoord;
         out vec4 FragColor;
         void main() {
-            FragColor = vec4(ourColor, 1.0);
+            float diffuse = max(dot(normalize(normal), normalize(vec3(0.3, 0.8, 0.5))), 0.0);
+            vec3 color = materialAmbient.rgb * 0.1 + materialDiffuseColor(texCoord) * (0.2 + 0.8 * diffuse) + materialEmissive.rgb;
+            FragColor = vec4(color, materialDiffuse.a);
         }
     )";
 
-    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+    GLuint shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource.c_str());
+    materials.bindProgram(shaderProgram);
 
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 view = glm::lookAt(
@@ -105,12 +118,14 @@ int main() {
         glm::vec3(0.0f, 0.0f, 0.0f), 
         glm::vec3(0.0f, 1.0f, 0.0f)  
     );
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
     glm::mat4 projection = glm::perspective(
-        glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f
+        glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f
     );
 
     glEnable(GL_DEPTH_TEST);
-    glViewport(0, 0, 800, 600);
+    glViewport(0, 0, width, height);
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -122,14 +137,18 @@ int main() {
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
 
-        glBindVertexArray(objVAO);
-        glDrawArrays(GL_TRIANGLES, 0, nVertices);
-        glBindVertexArray(0);
+        // Um glDrawElements por material, cada um com o seu bloco do uniform buffer
+        materials.draw();
 
         glfwSwapBuffers(window);
+        headless.endFrame(window);
     }
 
-    glDeleteVertexArrays(1, &objVAO);
+    materials.shutdown();
+    if (!textures.empty())
+        glDeleteTextures((GLsizei)textures.size(), textures.data());
+    glDeleteProgram(shaderProgram);
+    headless.finish();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -14,6 +14,8 @@ using namespace std;
 
 #include <GLFW/glfw3.h>
 
+#include "Headless.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -23,6 +25,8 @@ using namespace std;
 
 using namespace glm;
 
+#include "NormalMatrix.h"
+
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
 
 int setupShader();
@@ -41,6 +45,7 @@ layout (location = 2) in vec3 normal;
 layout (location = 3) in vec2 texCoord;
 
 uniform mat4 model;
+uniform mat3 normalMatrix;
 uniform mat4 view;
 uniform mat4 projection;
 
@@ -52,7 +57,7 @@ out vec3 vColor;
 void main()
 {
     FragPos = vec3(model * vec4(position, 1.0));
-    Normal = mat3(transpose(inverse(model))) * normal;  
+    Normal = normalMatrix * normal;
     TexCoord = texCoord;
     vColor = color;
     gl_Position = projection * view * model * vec4(position, 1.0);
@@ -91,10 +96,12 @@ void main()
     FragColor = vec4(result, 1.0);
 })";
 
-int main()
+int main(int argc, char** argv)
 {
-    glfwInit();
-    GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "M4 Tarefa", nullptr, nullptr);
+    HeadlessRun headless(argc, argv);
+
+    headless.initGlfw();
+    GLFWwindow *window = headless.createWindow(WIDTH, HEIGHT, "M4 Tarefa");
     glfwMakeContextCurrent(window);
     glfwSetKeyCallback(window, key_callback);
 
@@ -104,6 +111,8 @@ int main()
         return -1;
     }
 
+    headless.setupFramebuffer();
+
     const GLubyte *renderer = glGetString(GL_RENDERER);
     const GLubyte *version = glGetString(GL_VERSION);
     cout << "Renderer: " << renderer << endl;
@@ -154,9 +163,11 @@ int main()
         drawModel(shaderID, VAO, vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f), angle, nVertices, vec3(1.0f, 1.0f, 1.0f), vec3(0.0f, 1.0f, 0.0f));
 
         glfwSwapBuffers(window);
+        headless.endFrame(window);
     }
 
     glDeleteVertexArrays(1, &VAO);
+    headless.finish();
     glfwTerminate();
     return 0;
 }
@@ -349,6 +360,7 @@ void drawModel(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, floa
     model = scale(model, dimensions);
     
     glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(shaderID, "normalMatrix"), 1, GL_FALSE, value_ptr(computeNormalMatrix(model)));
     glUniform3f(glGetUniformLocation(shaderID, "vColor"), color.r, color.g, color.b);
     
     glBindVertexArray(VAO);
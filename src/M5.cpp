@@ -7,6 +7,7 @@
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <random>
 
 using namespace std;
 
@@ -14,6 +15,10 @@ using namespace std;
 
 #include <GLFW/glfw3.h>
 
+#include "Headless.h"
+#include "FrameBenchmark.h"
+#include "Trace.h"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -23,6 +28,21 @@ using namespace std;
 
 using namespace glm;
 
+#include "BatchMath.h"
+#include "Bvh.h"
+#include "DepthPrepass.h"
+#include "GBuffer.h"
+#include "GeometryArena.h"
+#include "InstanceCuller.h"
+#include "LightClusterBuffers.h"
+#include "LightClusters.h"
+#include "MeshNormals.h"
+#include "ObjMesh.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
+#include "SceneGraph.h"
+#include "ShadowMap.h"
+
 class Camera {
 public:
     vec3 position;
@@ -80,6 +100,15 @@ public:
         updateCameraVectors();
     }
     
+    // Posiciona a câmera diretamente (linha do tempo do modo benchmark)
+    void setPose(const CameraPose& pose) {
+        position = pose.position;
+        yaw = pose.yaw;
+        pitch = pose.pitch;
+        fov = pose.fov;
+        updateCameraVectors();
+    }
+
     void processMouseScroll(float yoffset) {
         fov -= yoffset;
         if (fov < 1.0f)
@@ -102,14 +131,17 @@ private:
 };
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode);
+void processInput(GLFWwindow* window);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 
 int setupShader();
+GLuint buildProgram(const vector<const GLchar*>& vertexSources, const vector<const GLchar*>& fragmentSources);
+void setLightingUniforms(GLuint program, float ka, float kd, float ks, float shininess);
 GLuint loadTexture(string filePath);
-GLuint loadSuzanneModel(const string& objPath, int &nVertices);
-void drawModel(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, int nVertices, vec3 color = vec3(1.0, 0.0, 0.0));
+GLuint loadSuzanneModel(const string& objPath, int &nVertices, AABB *bounds = nullptr, GLuint *positionVAO = nullptr);
+void drawModel(GLuint shaderID, GLuint VAO, const mat4& model, const mat3& normalMatrix, int nVertices, vec3 color = vec3(1.0, 0.0, 0.0));
 
 const GLuint WIDTH = 800, HEIGHT = 800;
 Camera camera;
@@ -132,40 +164,80 @@ Light backLight;
 bool keyLightEnabled = true;
 bool fillLightEnabled = true;
 bool backLightEnabled = true;
+bool occlusionEnabled = false;
+bool shadowsEnabled = false;
+bool clusteredLighting = true;
+bool deferredRendering = false;
+bool overdrawView = false;
+bool renderQueueEnabled = false;
+bool arenaEnabled = false;
+DepthPrepass prepass;
+InstanceCuller instanceCuller;
+
+// Luzes dinâmicas (--lights N): orbitam em volta de um ponto fixo
+struct DynamicLight {
+    ClusterLight light;
+    vec3 center;
+    float orbit;
+    float speed;
+    float phase;
+};
+vector<DynamicLight> setupDynamicLights(int count, const AABB& sceneBounds);
+void buildInstanceField(int count, const vector<BoundingSphere>& meshSpheres, vector<CullInstance>& instances, vector<mat4>& models);
 
+const GLchar *glslVersion = "#version 400\n";
+// "#define PER_VERTEX_NORMAL_MATRIX" com --normal-matrix vertex
+const GLchar *vertexDefines = "";
+
+// Vem depois de glslVersion e IndirectDrawList::vertexSource() (drawDataModel etc.)
 const GLchar *vertexShaderSource = R"(
-#version 400
 layout (location = 0) in vec3 position;
 layout (location = 1) in vec3 color;
 layout (location = 2) in vec3 normal;
 layout (location = 3) in vec2 texCoord;
 
+// Com useDrawData as matrizes vêm do texture buffer por desenho (GeometryArena.h)
+uniform bool useDrawData;
 uniform mat4 model;
+uniform mat3 normalMatrix;
 uniform mat4 view;
 uniform mat4 projection;
+uniform mat4 lightSpace;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoord;
 out vec3 vColor;
+out vec4 LightSpacePos;
+out float ViewDepth;
+
+// O pré-passe de profundidade (DepthPrepass.h) calcula a mesma posição; sem isso o
+// GL_EQUAL do passe principal poderia falhar por diferenças de arredondamento
+invariant gl_Position;
 
 void main()
 {
-    FragPos = vec3(model * vec4(position, 1.0));
-    Normal = mat3(transpose(inverse(model))) * normal;  
+    mat4 objectModel = useDrawData ? drawDataModel() : model;
+#ifdef PER_VERTEX_NORMAL_MATRIX
+    // Shader antigo, só para comparação: a inversa a cada vértice
+    mat3 objectNormalMatrix = mat3(transpose(inverse(objectModel)));
+#else
+    mat3 objectNormalMatrix = useDrawData ? drawDataNormalMatrix() : normalMatrix;
+#endif
+    FragPos = vec3(objectModel * vec4(position, 1.0));
+    Normal = objectNormalMatrix * normal;
     TexCoord = texCoord;
     vColor = color;
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    LightSpacePos = lightSpace * vec4(FragPos, 1.0);
+    ViewDepth = -(view * vec4(FragPos, 1.0)).z;
+    gl_Position = projection * view * objectModel * vec4(position, 1.0);
 })";
 
-const GLchar *fragmentShaderSource = R"(
-#version 400
-in vec3 FragPos;
-in vec3 Normal;
-in vec2 TexCoord;
-in vec3 vColor;
-
-uniform sampler2D texture_diffuse1;
+// Iluminação comum ao forward e aos passes do deferred: as funções recebem a posição,
+// a normal e a direção da câmera, venham elas de varyings ou do G-buffer
+const GLchar *lightingSource = R"(
+uniform sampler2DShadow shadowMap;
+uniform bool shadowsEnabled;
 uniform vec3 viewPos;
 
 // Luzes
@@ -184,13 +256,14 @@ uniform vec3 backLightColor;
 uniform float backLightIntensity;
 uniform bool backLightEnabled;
 
+// Luzes dinâmicas, no formato de LightClusterBuffers.h
+uniform samplerBuffer lightData;
+
 uniform float ka;
 uniform float kd;
 uniform float ks;
 uniform float shininess;
 
-out vec4 FragColor;
-
 // Função para calcular contribuição de uma luz
 vec3 calculateLight(vec3 lightPos, vec3 lightColor, float lightIntensity, vec3 fragPos, vec3 normal, vec3 viewDir)
 {
@@ -213,22 +286,106 @@ vec3 calculateLight(vec3 lightPos, vec3 lightColor, float lightIntensity, vec3 f
     return (diffuse + specular) * attenuation;
 }
 
-void main()
+// Luz pontual com raio finito: a mesma atenuação, multiplicada por uma janela que
+// chega a zero no raio (senão a luz não poderia ficar só nos clusters que toca)
+vec3 calculatePointLight(int light, vec3 fragPos, vec3 normal, vec3 viewDir)
 {
-    vec3 ambient = ka * vec3(1.0, 1.0, 1.0);
-    vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
-    
-    vec3 result = ambient;
+    vec4 positionRadius = texelFetch(lightData, light * 2);
+    vec3 lightColor = texelFetch(lightData, light * 2 + 1).rgb;
+    vec3 toLight = positionRadius.xyz - fragPos;
+    float distance = length(toLight);
+    if (distance >= positionRadius.w)
+        return vec3(0.0);
+    vec3 lightDir = toLight / distance;
+    float window = 1.0 - pow(distance / positionRadius.w, 4.0);
+    float attenuation = window * window / (1.0 + 0.1 * distance + 0.01 * distance * distance);
+
+    float diff = max(dot(normal, lightDir), 0.0);
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    return (kd * diff + ks * spec) * lightColor * attenuation;
+}
+
+// Fração da key light que chega ao fragmento: PCF 3x3 no shadow map, em que cada
+// amostra já compara e interpola 2x2 texels (filtro linear com comparação)
+float keyLightShadow(vec4 lightSpacePos)
+{
+    if (!shadowsEnabled)
+        return 1.0;
+    vec3 coords = lightSpacePos.xyz / lightSpacePos.w * 0.5 + 0.5;
+    if (coords.z > 1.0)
+        return 1.0;
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0));
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y)
+        for (int x = -1; x <= 1; ++x)
+            lit += texture(shadowMap, vec3(coords.xy + vec2(x, y) * texel, coords.z));
+    return lit / 9.0;
+}
+
+// Ambiente e as três luzes fixas, antes de multiplicar pela cor da superfície
+vec3 fixedLights(vec3 fragPos, vec3 normal, vec3 viewDir, vec4 lightSpacePos)
+{
+    vec3 result = ka * vec3(1.0, 1.0, 1.0);
     
     if (keyLightEnabled)
-        result += calculateLight(keyLightPos, keyLightColor, keyLightIntensity, FragPos, norm, viewDir);
+        result += keyLightShadow(lightSpacePos) * calculateLight(keyLightPos, keyLightColor, keyLightIntensity, fragPos, normal, viewDir);
     
     if (fillLightEnabled)
-        result += calculateLight(fillLightPos, fillLightColor, fillLightIntensity, FragPos, norm, viewDir);
+        result += calculateLight(fillLightPos, fillLightColor, fillLightIntensity, fragPos, normal, viewDir);
     
     if (backLightEnabled)
-        result += calculateLight(backLightPos, backLightColor, backLightIntensity, FragPos, norm, viewDir);
+        result += calculateLight(backLightPos, backLightColor, backLightIntensity, fragPos, normal, viewDir);
+
+    return result;
+}
+)";
+
+const GLchar *fragmentShaderSource = R"(
+in vec3 FragPos;
+in vec3 Normal;
+in vec2 TexCoord;
+in vec3 vColor;
+in vec4 LightSpacePos;
+in float ViewDepth;
+
+uniform sampler2D texture_diffuse1;
+
+// Luzes dinâmicas: 0 = nenhuma, 1 = por cluster, 2 = todas
+uniform int dynamicLightMode;
+uniform int dynamicLightCount;
+uniform usamplerBuffer clusterRanges;
+uniform usamplerBuffer lightIndices;
+uniform ivec3 clusterGrid;
+uniform vec2 clusterTileSize;
+uniform float clusterSliceScale;
+uniform float clusterSliceBias;
+
+out vec4 FragColor;
+
+vec3 dynamicLights(vec3 normal, vec3 viewDir)
+{
+    vec3 sum = vec3(0.0);
+    if (dynamicLightMode == 1) {
+        ivec3 cluster = ivec3(gl_FragCoord.xy / clusterTileSize, int(log(max(ViewDepth, 1e-4)) * clusterSliceScale + clusterSliceBias));
+        cluster = clamp(cluster, ivec3(0), clusterGrid - 1);
+        uvec2 range = texelFetch(clusterRanges, (cluster.z * clusterGrid.y + cluster.y) * clusterGrid.x + cluster.x).xy;
+        for (uint i = 0u; i < range.y; ++i)
+            sum += calculatePointLight(int(texelFetch(lightIndices, int(range.x + i)).r), FragPos, normal, viewDir);
+    } else if (dynamicLightMode == 2) {
+        for (int light = 0; light < dynamicLightCount; ++light)
+            sum += calculatePointLight(light, FragPos, normal, viewDir);
+    }
+    return sum;
+}
+
+void main()
+{
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(viewPos - FragPos);
+    
+    vec3 result = fixedLights(FragPos, norm, viewDir, LightSpacePos);
+    result += dynamicLights(norm, viewDir);
     
     vec4 texColor = texture(texture_diffuse1, TexCoord);
     result = result * vColor * texColor.rgb;
@@ -236,6 +393,55 @@ void main()
     FragColor = vec4(result, 1.0);
 })";
 
+// Deferred (GBuffer.h): o passe de geometria usa o mesmo vertex shader e grava só a
+// cor da superfície (vColor * textura, o fator do forward) e a normal
+const GLchar *gbufferFragmentSource = R"(
+in vec3 Normal;
+in vec2 TexCoord;
+in vec3 vColor;
+
+uniform sampler2D texture_diffuse1;
+
+layout (location = 0) out vec4 Albedo;
+layout (location = 1) out vec2 EncodedNormal;
+
+void main()
+{
+    Albedo = vec4(vColor * texture(texture_diffuse1, TexCoord).rgb, 1.0);
+    EncodedNormal = encodeNormal(normalize(Normal));
+})";
+
+// Passe de tela cheia: ambiente e luzes fixas, uma vez por pixel
+const GLchar *deferredLightingSource = R"(
+uniform mat4 lightSpace;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec3 albedo, position, normal;
+    if (!loadSurface(albedo, position, normal))
+        discard;
+    vec3 viewDir = normalize(viewPos - position);
+    vec3 result = fixedLights(position, normal, viewDir, lightSpace * vec4(position, 1.0));
+    FragColor = vec4(result * albedo, 1.0);
+})";
+
+// Volumes de luz: cada luz pontual soma a sua parte só nos pixels do seu cubo
+const GLchar *lightVolumeFragmentSource = R"(
+flat in int LightIndex;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec3 albedo, position, normal;
+    if (!loadSurface(albedo, position, normal))
+        discard;
+    vec3 viewDir = normalize(viewPos - position);
+    FragColor = vec4(calculatePointLight(LightIndex, position, normal, viewDir) * albedo, 1.0);
+})";
+
 void setupLights(vec3 objectPosition, float objectScale) {
     
     keyLight.position = objectPosition + vec3(2.0f, 2.0f, 2.0f) * objectScale;
@@ -254,10 +460,87 @@ void setupLights(vec3 objectPosition, float objectScale) {
     backLight.enabled = true;
 }
 
-int main()
+int main(int argc, char** argv)
 {
-    glfwInit();
-    GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Tarefa Modulo 5", nullptr, nullptr);
+    HeadlessRun headless(argc, argv);
+    FrameBenchmark benchmark(argc, argv);
+    TraceSession trace(argc, argv);
+    if (benchmark.enabled())
+        headless.setFrameCount(benchmark.frameCount());
+
+    // --occlusion liga o occlusion culling por software; --occlusion-scene troca a cena
+    // pela de teste (paredes com muitas Suzannes atrás), sem ligar o culling: as
+    // comparações de overdraw usam a cena sozinha, o culling pede --occlusion também.
+    // --shadows liga o shadow map da key light (--shadow-map-size N, padrão 2048);
+    // --shadow-always redesenha o mapa todo quadro, para medir o custo do passe.
+    // --lights N acrescenta N luzes pontuais dinâmicas, distribuídas por clusters;
+    // --light-culling none faz cada fragmento avaliar todas elas (para comparar).
+    // --renderer deferred troca o forward pelo G-buffer com volumes de luz.
+    // --prepass off|on|auto controla o pré-passe de profundidade do forward (auto decide
+    // pelo overdraw medido, limiar em --prepass-threshold); --overdraw mostra o overdraw.
+    // --render-queue envia o passe principal por uma fila ordenada por estado.
+    // --arena desenha o passe principal da arena de geometria com um único
+    // glMultiDrawElementsIndirect (--no-mdi força o laço de glDrawElementsIndirect)
+    // --instances N acrescenta um campo de N Suzannes com frustum culling num compute
+    // shader (--cpu-cull usa a referência na CPU; --cull-check compara as duas a cada
+    // quadro e sai com erro se diferirem)
+    // --model troca a Suzanne por outro OBJ; --normal-matrix vertex volta ao vertex shader
+    // antigo, com a inversa por vértice (para comparar com a matriz por objeto)
+    bool occlusionScene = false;
+    string modelPath = "../assets/Modelos3D/Suzanne.obj";
+    int dynamicLightCount = 0;
+    int shadowMapSize = 2048;
+    bool shadowAlways = false;
+    bool multiDrawRequested = true;
+    int instanceFieldCount = 0;
+    bool gpuCullRequested = true;
+    bool cullCheck = false;
+    DepthPrepass::Mode prepassMode = DepthPrepass::Off;
+    float prepassThreshold = 1.5f;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--occlusion-scene")
+            occlusionScene = true;
+        else if (arg == "--occlusion")
+            occlusionEnabled = true;
+        else if (arg == "--shadows")
+            shadowsEnabled = true;
+        else if (arg == "--shadow-map-size" && i + 1 < argc)
+            shadowMapSize = std::max(16, atoi(argv[++i]));
+        else if (arg == "--shadow-always")
+            shadowAlways = true;
+        else if (arg == "--lights" && i + 1 < argc)
+            dynamicLightCount = std::max(0, atoi(argv[++i]));
+        else if (arg == "--light-culling" && i + 1 < argc)
+            clusteredLighting = string(argv[++i]) != "none";
+        else if (arg == "--renderer" && i + 1 < argc)
+            deferredRendering = string(argv[++i]) == "deferred";
+        else if (arg == "--prepass" && i + 1 < argc)
+            prepassMode = DepthPrepass::parseMode(argv[++i]);
+        else if (arg == "--prepass-threshold" && i + 1 < argc)
+            prepassThreshold = (float)atof(argv[++i]);
+        else if (arg == "--overdraw")
+            overdrawView = true;
+        else if (arg == "--render-queue")
+            renderQueueEnabled = true;
+        else if (arg == "--arena")
+            arenaEnabled = true;
+        else if (arg == "--no-mdi")
+            multiDrawRequested = false;
+        else if (arg == "--instances" && i + 1 < argc)
+            instanceFieldCount = std::max(0, atoi(argv[++i]));
+        else if (arg == "--cpu-cull")
+            gpuCullRequested = false;
+        else if (arg == "--cull-check")
+            cullCheck = true;
+        else if (arg == "--model" && i + 1 < argc)
+            modelPath = argv[++i];
+        else if (arg == "--normal-matrix" && i + 1 < argc)
+            vertexDefines = string(argv[++i]) == "vertex" ? "#define PER_VERTEX_NORMAL_MATRIX\n" : "";
+    }
+
+    headless.initGlfw();
+    GLFWwindow *window = headless.createWindow(WIDTH, HEIGHT, "Tarefa Modulo 5");
     glfwMakeContextCurrent(window);
     
     glfwSetKeyCallback(window, key_callback);
@@ -273,6 +556,14 @@ int main()
         return -1;
     }
 
+    headless.setupFramebuffer();
+    benchmark.setup();
+    GpuProfiler gpuProfiler;
+    gpuProfiler.init();
+    gpuProfiler.setRecordHistory(benchmark.enabled());
+    if (benchmark.enabled())
+        glfwSwapInterval(0);
+
     const GLubyte *renderer = glGetString(GL_RENDERER);
     const GLubyte *version = glGetString(GL_VERSION);
     cout << "Renderer: " << renderer << endl;
@@ -284,7 +575,9 @@ int main()
 
     GLuint shaderID = setupShader();
     int nVertices;
-    GLuint VAO = loadSuzanneModel("../assets/Modelos3D/Suzanne.obj", nVertices);
+    AABB modelBounds;
+    GLuint depthVAO = 0;
+    GLuint VAO = loadSuzanneModel(modelPath, nVertices, &modelBounds, &depthVAO);
     GLuint textureID = loadTexture("../assets/Modelos3D/Suzanne.png");
 
     float ka = 0.1f;
@@ -296,70 +589,506 @@ int main()
     float objectScale = 1.0f;
     setupLights(objectPosition, objectScale);
 
-    glUseProgram(shaderID);
-    glUniform1i(glGetUniformLocation(shaderID, "texture_diffuse1"), 0);
-    glUniform1f(glGetUniformLocation(shaderID, "ka"), ka);
-    glUniform1f(glGetUniformLocation(shaderID, "kd"), kd);
-    glUniform1f(glGetUniformLocation(shaderID, "ks"), ks);
-    glUniform1f(glGetUniformLocation(shaderID, "shininess"), shininess);
-
-
-    glUniform3f(glGetUniformLocation(shaderID, "keyLightPos"), keyLight.position.x, keyLight.position.y, keyLight.position.z);
-    glUniform3f(glGetUniformLocation(shaderID, "keyLightColor"), keyLight.color.r, keyLight.color.g, keyLight.color.b);
-    glUniform1f(glGetUniformLocation(shaderID, "keyLightIntensity"), keyLight.intensity);
-
-    glUniform3f(glGetUniformLocation(shaderID, "fillLightPos"), fillLight.position.x, fillLight.position.y, fillLight.position.z);
-    glUniform3f(glGetUniformLocation(shaderID, "fillLightColor"), fillLight.color.r, fillLight.color.g, fillLight.color.b);
-    glUniform1f(glGetUniformLocation(shaderID, "fillLightIntensity"), fillLight.intensity);
-
-    glUniform3f(glGetUniformLocation(shaderID, "backLightPos"), backLight.position.x, backLight.position.y, backLight.position.z);
-    glUniform3f(glGetUniformLocation(shaderID, "backLightColor"), backLight.color.r, backLight.color.g, backLight.color.b);
-    glUniform1f(glGetUniformLocation(shaderID, "backLightIntensity"), backLight.intensity);
-        
+    // Programas do deferred (--renderer deferred ou a tecla G): G-buffer, passe de
+    // tela cheia com as luzes fixas e volumes das luzes dinâmicas
+    GLuint gbufferProgram = buildProgram({glslVersion, vertexDefines, IndirectDrawList::vertexSource(), vertexShaderSource}, {glslVersion, GBuffer::normalCodingSource(), gbufferFragmentSource});
+    GLuint deferredLightingProgram = buildProgram({GBuffer::fullscreenVertexSource()},
+        {glslVersion, GBuffer::normalCodingSource(), GBuffer::surfaceSource(), lightingSource, deferredLightingSource});
+    GLuint lightVolumeProgram = buildProgram({GBuffer::lightVolumeVertexSource()},
+        {glslVersion, GBuffer::normalCodingSource(), GBuffer::surfaceSource(), lightingSource, lightVolumeFragmentSource});
+    for (GLuint program : {gbufferProgram, deferredLightingProgram, lightVolumeProgram})
+        setLightingUniforms(program, ka, kd, ks, shininess);
+    GBuffer gbuffer;
+    // Arena com a Suzanne e o cubo indexados, num VAO só (mesmo layout de loadSuzanneModel)
+    GeometryArena arena;
+    IndirectDrawList arenaDraws;
+    int suzanneMesh = -1, cubeMesh = -1;
+    vector<BoundingSphere> meshSpheres;
+    {
+        arena.init(sizeof(MeshVertex), 1 << 18, 1 << 20);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
+        glEnableVertexAttribArray(3);
+        arena.enableDrawId(4);
+        glBindVertexArray(0);
+        auto addObj = [&](const char* path) {
+            vector<MeshVertex> triangles, vertices;
+            vector<uint32_t> indices;
+            if (!loadObjTriangles(path, triangles))
+                return -1;
+            fillMissingNormals(triangles);
+            indexTriangles(triangles, vertices, indices);
+            meshSpheres.push_back(computeBoundingSphere(&vertices[0].position, vertices.size(), sizeof(MeshVertex)));
+            return arena.addMesh(vertices.data(), (int)vertices.size(), indices.data(), (int)indices.size());
+        };
+        suzanneMesh = addObj(modelPath.c_str());
+        if (occlusionScene)
+            cubeMesh = addObj("../assets/Modelos3D/Cube.obj");
+        arenaDraws.init(8);
+        arenaDraws.setMultiDraw(multiDrawRequested);
+        if (arenaEnabled)
+            cout << "Geometry arena: " << arena.meshCount() << " meshes, " << arena.usedBytes() / 1024 << " KiB, "
+                 << (arenaDraws.multiDraw() ? "glMultiDrawElementsIndirect" : "glDrawElementsIndirect loop") << endl;
+    }
+    instanceCuller.init(8);
+    instanceCuller.setUseGpu(gpuCullRequested);
+    if (instanceFieldCount > 0 && suzanneMesh >= 0) {
+        // Matrizes das instâncias num texture buffer de 7 texels cada
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if (instanceFieldCount > maxTexels / IndirectDrawList::TexelsPerDraw) {
+            instanceFieldCount = maxTexels / IndirectDrawList::TexelsPerDraw;
+            cout << "Instance count limited to " << instanceFieldCount << " (GL_MAX_TEXTURE_BUFFER_SIZE)" << endl;
+        }
+        vector<CullInstance> instances;
+        vector<mat4> instanceModels;
+        buildInstanceField(instanceFieldCount, meshSpheres, instances, instanceModels);
+        instanceCuller.setInstances(instances, instanceModels, arena);
+        cout << "Instance field: " << instanceFieldCount << " instances, culling on "
+             << (instanceCuller.usingGpu() ? "GPU (compute shader)" : "CPU") << endl;
+        if (gpuCullRequested && !instanceCuller.gpuAvailable())
+            cout << "Compute shaders need OpenGL 4.3, using the CPU reference" << endl;
+    }
+    int cullChecks = 0, cullMismatches = 0, cullBorderline = 0;
+    RenderQueue renderQueue;
+    GlRenderBackend renderBackend;
+    double directSubmitMs = 0.0;
+    prepass.init();
+    prepass.setMode(prepassMode);
+    prepass.setThreshold(prepassThreshold);
+
+    setLightingUniforms(shaderID, ka, kd, ks, shininess);
+    glUniform3i(glGetUniformLocation(shaderID, "clusterGrid"), LightClusterGrid::TilesX, LightClusterGrid::TilesY, LightClusterGrid::Slices);
+    glUniform2f(glGetUniformLocation(shaderID, "clusterTileSize"), (float)width / LightClusterGrid::TilesX, (float)height / LightClusterGrid::TilesY);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, textureID);
     glEnable(GL_DEPTH_TEST);
 
+    // Matrizes de modelo e de normal calculadas uma vez na CPU pelo grafo de cena.
+    // As Suzannes vêm primeiro, então o índice do nó é também o índice na BVH.
+    SceneGraph sceneGraph;
+    vector<vec3> suzannePositions(1, vec3(0.0f, 0.0f, 0.0f));
+    vector<AABB> wallBounds;
+    if (occlusionScene)
+        buildOcclusionTestScene(wallBounds, suzannePositions);
+    for (const vec3& position : suzannePositions) {
+        Transform suzanneTransform;
+        suzanneTransform.translation = position;
+        suzanneTransform.scale = vec3(1.0f, 1.0f, 1.0f);
+        sceneGraph.addNode(-1, suzanneTransform);
+    }
+    // Paredes: o cubo do OBJ vai de -1 a 1, então a escala é a meia extensão da caixa
+    int cubeVertices = 0;
+    GLuint cubeDepthVAO = 0;
+    GLuint cubeVAO = wallBounds.empty() ? 0 : loadSuzanneModel("../assets/Modelos3D/Cube.obj", cubeVertices, nullptr, &cubeDepthVAO);
+    vector<int> wallNodes;
+    for (const AABB& wall : wallBounds) {
+        Transform wallTransform;
+        wallTransform.translation = wall.center();
+        wallTransform.scale = wall.extents();
+        wallNodes.push_back(sceneGraph.addNode(-1, wallTransform));
+    }
+    sceneGraph.update();
+
+    vector<AABB> objectBounds;
+    for (size_t i = 0; i < suzannePositions.size(); ++i)
+        objectBounds.push_back(transformAABB(modelBounds, sceneGraph.world((int)i)));
+    Bvh bvh;
+    bvh.build(objectBounds);
+
+    // O shadow map só é redesenhado quando a versão da cena (ou a luz) muda
+    AABB sceneBounds;
+    for (const AABB& box : objectBounds)
+        sceneBounds.expand(box);
+    for (const AABB& wall : wallBounds)
+        sceneBounds.expand(wall);
+    ShadowMap shadowMap;
+    shadowMap.forceUpdate(shadowAlways);
+    uint64_t sceneVersion = 1;
+    vector<int> shadowCasters;
+
+    vector<DynamicLight> dynamicLights = setupDynamicLights(dynamicLightCount, sceneBounds);
+    vector<ClusterLight> frameLights(dynamicLights.size());
+    LightClusterGrid lightGrid;
+    LightClusterBuffers lightBuffers;
+    if (!dynamicLights.empty()) {
+        lightBuffers.init();
+        lightBuffers.bind(2);
+    }
+    glUniform1i(glGetUniformLocation(shaderID, "dynamicLightCount"), (int)dynamicLights.size());
+    float animationTime = 0.0f;
+    vector<int> visibleObjects, unoccludedObjects;
+    BvhCullStats cullStats;
+    OcclusionCuller occlusion(256, std::max(1, 256 * height / width));
+    double lastStatsTime = glfwGetTime();
+    CameraPose benchmarkPose;
+    vector<int> benchmarkKeys;
+
     while (!glfwWindowShouldClose(window))
     {
+        TRACE_SCOPE("frame");
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            camera.processKeyboard(GLFW_KEY_W, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            camera.processKeyboard(GLFW_KEY_S, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            camera.processKeyboard(GLFW_KEY_A, deltaTime);
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            camera.processKeyboard(GLFW_KEY_D, deltaTime);
+        if (benchmark.enabled()) {
+            benchmark.beginFrame(benchmarkPose, benchmarkKeys);
+            camera.setPose(benchmarkPose);
+            for (int key : benchmarkKeys)
+                key_callback(window, key, 0, GLFW_PRESS, 0);
+        } else {
+            processInput(window);
+        }
         
-        glfwPollEvents();
-        glClearColor(0.08f, 0.08f, 0.08f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        {
+            TRACE_SCOPE("glfwPollEvents");
+            glfwPollEvents();
+        }
+        gpuProfiler.beginFrame();
+        {
+            GpuProfiler::Scope scope(gpuProfiler, "clear");
+            glClearColor(0.08f, 0.08f, 0.08f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
 
-        mat4 projection = perspective(radians(camera.fov), (float)width / (float)height, 0.1f, 100.0f);
-        glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
-        
-        mat4 view = camera.getViewMatrix();
-        glUniformMatrix4fv(glGetUniformLocation(shaderID, "view"), 1, GL_FALSE, value_ptr(view));
-        
-        glUniform3f(glGetUniformLocation(shaderID, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
+        mat4 projection, view;
+        {
+            TRACE_SCOPE("matrices");
+            projection = perspective(radians(camera.fov), (float)width / (float)height, 0.1f, 100.0f);
+            glUniformMatrix4fv(glGetUniformLocation(shaderID, "projection"), 1, GL_FALSE, value_ptr(projection));
+
+            view = camera.getViewMatrix();
+            glUniformMatrix4fv(glGetUniformLocation(shaderID, "view"), 1, GL_FALSE, value_ptr(view));
+
+            glUniform3f(glGetUniformLocation(shaderID, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
+        }
+
+        if (sceneGraph.update() > 0)
+            ++sceneVersion;
+        if (shadowsEnabled) {
+            TRACE_SCOPE("shadowMap");
+            if (!shadowMap.mapSize())
+                shadowMap.init(shadowMapSize);
+            shadowMap.setLight(keyLight.position, sceneBounds);
+            if (shadowMap.needsUpdate(sceneVersion)) {
+                GpuProfiler::Scope scope(gpuProfiler, "shadowMap");
+                bvh.cull(Frustum::fromMatrix(shadowMap.lightSpace()), shadowCasters);
+                shadowMap.begin(sceneVersion);
+                for (int node : shadowCasters)
+                    shadowMap.drawDepth(depthVAO, sceneGraph.world(node), nVertices);
+                for (int node : wallNodes)
+                    shadowMap.drawDepth(cubeDepthVAO, sceneGraph.world(node), cubeVertices);
+                shadowMap.end(headless.framebuffer(), width, height);
+            }
+            shadowMap.bind(1);
+            glUniformMatrix4fv(glGetUniformLocation(shaderID, "lightSpace"), 1, GL_FALSE, value_ptr(shadowMap.lightSpace()));
+        }
+        glUniform1i(glGetUniformLocation(shaderID, "shadowsEnabled"), shadowsEnabled);
+
+        // Luzes dinâmicas: posições do quadro e, no modo clustered, listas por cluster
+        animationTime += benchmark.enabled() ? benchmark.frameTimeStep() : deltaTime;
+        if (!dynamicLights.empty()) {
+            TRACE_SCOPE("lightClusters");
+            for (size_t i = 0; i < dynamicLights.size(); ++i) {
+                const DynamicLight& d = dynamicLights[i];
+                float angle = d.phase + d.speed * animationTime;
+                frameLights[i] = d.light;
+                frameLights[i].position = d.center + vec3(cos(angle), 0.3f * sin(2.0f * angle), sin(angle)) * d.orbit;
+            }
+            // O deferred não usa os clusters: cada luz é rasterizada como um volume
+            bool assignClusters = clusteredLighting && !deferredRendering;
+            if (assignClusters) {
+                lightGrid.setProjection(radians(camera.fov), (float)width / (float)height, 0.1f, 100.0f);
+                lightGrid.assign(frameLights, view);
+                glUniform1f(glGetUniformLocation(shaderID, "clusterSliceScale"), lightGrid.getSliceScale());
+                glUniform1f(glGetUniformLocation(shaderID, "clusterSliceBias"), lightGrid.getSliceBias());
+            }
+            lightBuffers.upload(frameLights, assignClusters ? &lightGrid : nullptr);
+        }
+        glUniform1i(glGetUniformLocation(shaderID, "dynamicLightMode"), dynamicLights.empty() ? 0 : (clusteredLighting ? 1 : 2));
+
+        {
+            TRACE_SCOPE("cull");
+            bvh.cull(Frustum::fromMatrix(projection * view), visibleObjects, &cullStats);
+        }
+        if (occlusionEnabled) {
+            TRACE_SCOPE("occlusion");
+            occlusion.beginFrame(projection * view);
+            for (const AABB& wall : wallBounds)
+                occlusion.addOccluderBox(wall);
+            occlusion.renderOccluders();
+            occlusion.cull(visibleObjects, objectBounds, unoccludedObjects);
+            visibleObjects.swap(unoccludedObjects);
+        }
+        if (instanceCuller.instanceCount() > 0) {
+            TRACE_SCOPE("instanceCull");
+            GpuProfiler::Scope scope(gpuProfiler, "instanceCull");
+            Frustum frustum = Frustum::fromMatrix(projection * view);
+            instanceCuller.cull(frustum);
+            if (cullCheck && instanceCuller.usingGpu()) {
+                int borderline = 0;
+                cullMismatches += instanceCuller.verify(frustum, &borderline);
+                cullBorderline += borderline;
+                ++cullChecks;
+            }
+        }
+        if (glfwGetTime() - lastStatsTime >= 1.0) {
+            cout << "Visible: " << visibleObjects.size() << "/" << bvh.objectCount()
+                 << " | nodes visited: " << cullStats.nodesVisited
+                 << " | cull: " << cullStats.cullTimeMs << " ms";
+            if (occlusionEnabled) {
+                const OcclusionStats& occlusionStats = occlusion.stats();
+                cout << " | occluded: " << occlusionStats.occluded << "/" << occlusionStats.tested
+                     << " (" << occlusionStats.occludedPercent() << "%)"
+                     << " | occlusion: " << occlusionStats.totalMs() << " ms (raster " << occlusionStats.rasterMs
+                     << ", pyramid " << occlusionStats.pyramidMs << ", test " << occlusionStats.testMs << ")";
+            }
+            if (!dynamicLights.empty()) {
+                const LightClusterStats& lightStats = lightGrid.stats();
+                cout << " | lights: " << dynamicLights.size();
+                if (deferredRendering)
+                    cout << " (light volumes)";
+                else if (clusteredLighting)
+                    cout << " (" << lightStats.visibleLights << " visible, " << lightStats.indexCount << " cluster entries, max "
+                         << lightStats.maxPerCluster << "/cluster, assign " << lightStats.assignMs << " ms)";
+                else
+                    cout << " (no culling)";
+            }
+            if (shadowsEnabled)
+                cout << " | shadow map: " << shadowMap.mapSize() << "^2, " << shadowMap.updateCount() << " update(s)";
+            if (instanceCuller.instanceCount() > 0) {
+                const InstanceCullStats& instanceStats = instanceCuller.stats();
+                cout << " | instances: " << instanceStats.visible << "/" << instanceStats.instances << " visible ("
+                     << instanceStats.culled() << " culled, " << (instanceStats.gpu ? "GPU" : "CPU");
+                if (!instanceStats.gpu || cullCheck)
+                    cout << ", CPU cull " << instanceStats.cpuMs << " ms";
+                cout << ")";
+            }
+            cout << " | renderer: " << (deferredRendering ? "deferred" : "forward");
+            if (!deferredRendering) {
+                const DepthPrepassStats& prepassStats = prepass.stats();
+                cout << " | prepass: " << DepthPrepass::modeName(prepass.mode());
+                if (prepass.mode() == DepthPrepass::Auto)
+                    cout << " (" << (prepassStats.active ? "on" : "off") << ")";
+                cout << ", shaded fragments " << prepassStats.shadedFragments;
+                if (prepassStats.visiblePixels)
+                    cout << ", overdraw " << prepassStats.overdraw() << "x";
+                if (arenaEnabled) {
+                    cout << " | arena: " << arenaDraws.size() << " draws in " << (arenaDraws.multiDraw() ? 1 : arenaDraws.size())
+                         << " call(s), submit " << directSubmitMs << " ms";
+                } else if (renderQueueEnabled) {
+                    const RenderQueueStats& queueStats = renderQueue.stats();
+                    cout << " | queue: " << queueStats.draws << " draws, " << queueStats.stateChanges() << " state changes, sort "
+                         << queueStats.sortMs << " ms, submit " << queueStats.submitMs << " ms";
+                } else {
+                    cout << " | submit: " << directSubmitMs << " ms";
+                }
+            }
+            cout << " | GPU: " << gpuProfiler.summary() << endl;
+            lastStatsTime = glfwGetTime();
+        }
 
-        drawModel(shaderID, VAO, vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 1.0f, 1.0f), nVertices, vec3(1.0f, 1.0f, 1.0f));
+        // Com a fila, o passe principal vai da frente para trás: ela é montada antes para o
+        // pré-passe e a visualização do overdraw desenharem na mesma ordem (o overdraw
+        // medido, que decide o --prepass auto, é o que o passe principal sombrearia)
+        bool queuedMainPass = !deferredRendering && renderQueueEnabled && !(arenaEnabled && suzanneMesh >= 0);
+        if (queuedMainPass) {
+            renderQueue.clear();
+            renderQueue.setDepthRange(0.1f, 100.0f);
+            auto enqueue = [&](int node, GLuint vao, int count) {
+                RenderPacket packet;
+                packet.program = shaderID;
+                packet.vao = vao;
+                packet.texture = textureID;
+                packet.count = count;
+                packet.model = sceneGraph.world(node);
+                packet.normalMatrix = sceneGraph.normalMatrix(node);
+                renderQueue.add(0, packet, -(view * packet.model[3]).z);
+            };
+            for (int node : visibleObjects)
+                enqueue(node, VAO, nVertices);
+            for (int node : wallNodes)
+                enqueue(node, cubeVAO, cubeVertices);
+            renderQueue.sort();
+        }
+        // Só profundidade (VAOs de posições), na ordem do passe principal
+        auto drawDepthOnly = [&](auto draw) {
+            if (queuedMainPass) {
+                for (size_t i = 0; i < renderQueue.size(); ++i) {
+                    const RenderPacket& packet = renderQueue.packet(i);
+                    draw(packet.vao == VAO ? depthVAO : cubeDepthVAO, packet.model, packet.count);
+                }
+                return;
+            }
+            for (int node : visibleObjects)
+                draw(depthVAO, sceneGraph.world(node), nVertices);
+            for (int node : wallNodes)
+                draw(cubeDepthVAO, sceneGraph.world(node), cubeVertices);
+        };
+
+        if (deferredRendering) {
+            if (!gbuffer.initialized())
+                gbuffer.init(width, height);
+            mat4 inverseViewProjection = inverse(projection * view);
+            {
+                // Só atributos: nenhuma luz é avaliada aqui
+                TRACE_SCOPE("drawObjects");
+                GpuProfiler::Scope scope(gpuProfiler, "gbuffer");
+                gbuffer.begin();
+                glUseProgram(gbufferProgram);
+                glUniformMatrix4fv(glGetUniformLocation(gbufferProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
+                glUniformMatrix4fv(glGetUniformLocation(gbufferProgram, "view"), 1, GL_FALSE, value_ptr(view));
+                for (int node : visibleObjects)
+                    drawModel(gbufferProgram, VAO, sceneGraph.world(node), sceneGraph.normalMatrix(node), nVertices, vec3(1.0f, 1.0f, 1.0f));
+                for (int node : wallNodes)
+                    drawModel(gbufferProgram, cubeVAO, sceneGraph.world(node), sceneGraph.normalMatrix(node), cubeVertices, vec3(1.0f, 1.0f, 1.0f));
+                gbuffer.end(headless.framebuffer());
+                gbuffer.bindTextures(5);
+            }
+            {
+                TRACE_SCOPE("deferredLighting");
+                GpuProfiler::Scope scope(gpuProfiler, "lighting");
+                glUseProgram(deferredLightingProgram);
+                glUniformMatrix4fv(glGetUniformLocation(deferredLightingProgram, "inverseViewProjection"), 1, GL_FALSE, value_ptr(inverseViewProjection));
+                glUniformMatrix4fv(glGetUniformLocation(deferredLightingProgram, "lightSpace"), 1, GL_FALSE, value_ptr(shadowMap.lightSpace()));
+                glUniform3f(glGetUniformLocation(deferredLightingProgram, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
+                glUniform1i(glGetUniformLocation(deferredLightingProgram, "shadowsEnabled"), shadowsEnabled);
+                glUniform1i(glGetUniformLocation(deferredLightingProgram, "keyLightEnabled"), keyLightEnabled);
+                glUniform1i(glGetUniformLocation(deferredLightingProgram, "fillLightEnabled"), fillLightEnabled);
+                glUniform1i(glGetUniformLocation(deferredLightingProgram, "backLightEnabled"), backLightEnabled);
+                gbuffer.drawFullscreen();
+            }
+            if (!dynamicLights.empty()) {
+                TRACE_SCOPE("lightVolumes");
+                GpuProfiler::Scope scope(gpuProfiler, "lightVolumes");
+                glUseProgram(lightVolumeProgram);
+                glUniformMatrix4fv(glGetUniformLocation(lightVolumeProgram, "projection"), 1, GL_FALSE, value_ptr(projection));
+                glUniformMatrix4fv(glGetUniformLocation(lightVolumeProgram, "view"), 1, GL_FALSE, value_ptr(view));
+                glUniformMatrix4fv(glGetUniformLocation(lightVolumeProgram, "inverseViewProjection"), 1, GL_FALSE, value_ptr(inverseViewProjection));
+                glUniform3f(glGetUniformLocation(lightVolumeProgram, "viewPos"), camera.position.x, camera.position.y, camera.position.z);
+                gbuffer.beginLightVolumes();
+                gbuffer.drawLightVolumes((int)dynamicLights.size());
+                gbuffer.endLightVolumes();
+            }
+            glUseProgram(shaderID);
+        } else if (overdrawView) {
+            // Cada fragmento que o forward sombrearia soma uma cor: claro = muito overdraw
+            TRACE_SCOPE("drawObjects");
+            GpuProfiler::Scope scope(gpuProfiler, "overdraw");
+            prepass.beginOverdrawView(projection, view);
+            drawDepthOnly([&](GLuint vao, const mat4& model, int count) { prepass.drawOverdraw(vao, model, count); });
+            prepass.endOverdrawView();
+        } else {
+            bool runPrepass = prepass.shouldRun();
+            if (runPrepass) {
+                TRACE_SCOPE("depthPrepass");
+                GpuProfiler::Scope scope(gpuProfiler, "depthPrepass");
+                prepass.begin(projection, view);
+                drawDepthOnly([&](GLuint vao, const mat4& model, int count) { prepass.draw(vao, model, count); });
+                prepass.end();
+            }
+            // Inclui a avaliação das três luzes, feita no fragment shader do objeto
+            TRACE_SCOPE("drawObjects");
+            GpuProfiler::Scope scope(gpuProfiler, "objects");
+            prepass.beginMainPass(runPrepass);
+            if (arenaEnabled && suzanneMesh >= 0) {
+                // Todos os objetos visíveis numa chamada: matrizes por desenho no texture buffer
+                double submitStart = glfwGetTime();
+                arenaDraws.clear();
+                for (int node : visibleObjects)
+                    arenaDraws.add(arena.mesh(suzanneMesh), sceneGraph.world(node), sceneGraph.normalMatrix(node));
+                if (cubeMesh >= 0)
+                    for (int node : wallNodes)
+                        arenaDraws.add(arena.mesh(cubeMesh), sceneGraph.world(node), sceneGraph.normalMatrix(node));
+                glUniform1i(glGetUniformLocation(shaderID, "useDrawData"), 1);
+                arenaDraws.submit(arena);
+                glUniform1i(glGetUniformLocation(shaderID, "useDrawData"), 0);
+                directSubmitMs = (glfwGetTime() - submitStart) * 1000.0;
+            } else if (queuedMainPass) {
+                // Mesmo conjunto de desenhos, agrupado por estado e da frente para trás
+                renderQueue.submit(renderBackend);
+            } else {
+                double submitStart = glfwGetTime();
+                for (int node : visibleObjects)
+                    drawModel(shaderID, VAO, sceneGraph.world(node), sceneGraph.normalMatrix(node), nVertices, vec3(1.0f, 1.0f, 1.0f));
+                for (int node : wallNodes)
+                    drawModel(shaderID, cubeVAO, sceneGraph.world(node), sceneGraph.normalMatrix(node), cubeVertices, vec3(1.0f, 1.0f, 1.0f));
+                directSubmitMs = (glfwGetTime() - submitStart) * 1000.0;
+            }
+            prepass.endMainPass();
+            // Fora do pré-passe: desenhadas com o teste de profundidade normal
+            if (instanceCuller.instanceCount() > 0) {
+                TRACE_SCOPE("drawInstances");
+                GpuProfiler::Scope scope(gpuProfiler, "instances");
+                glUniform1i(glGetUniformLocation(shaderID, "useDrawData"), 1);
+                instanceCuller.draw(arena);
+                glUniform1i(glGetUniformLocation(shaderID, "useDrawData"), 0);
+            }
+        }
 
         glUniform1i(glGetUniformLocation(shaderID, "keyLightEnabled"), keyLightEnabled);
         glUniform1i(glGetUniformLocation(shaderID, "fillLightEnabled"), fillLightEnabled);
         glUniform1i(glGetUniformLocation(shaderID, "backLightEnabled"), backLightEnabled);
 
-        glfwSwapBuffers(window);
+        gpuProfiler.endFrame();
+        gpuProfiler.updateOverlay(window, "Tarefa Modulo 5");
+        benchmark.endFrame(window);
+        {
+            TRACE_SCOPE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        headless.endFrame(window);
     }
 
     glDeleteVertexArrays(1, &VAO);
+    glDeleteVertexArrays(1, &depthVAO);
+    if (cubeVAO) {
+        glDeleteVertexArrays(1, &cubeVAO);
+        glDeleteVertexArrays(1, &cubeDepthVAO);
+    }
+    shadowMap.shutdown();
+    gbuffer.shutdown();
+    prepass.shutdown();
+    arenaDraws.shutdown();
+    instanceCuller.shutdown();
+    arena.shutdown();
+    glDeleteProgram(gbufferProgram);
+    glDeleteProgram(deferredLightingProgram);
+    glDeleteProgram(lightVolumeProgram);
+    if (!dynamicLights.empty())
+        lightBuffers.shutdown();
+    headless.finish();
+    trace.finish();
+    benchmark.addGpuPasses(gpuProfiler);
+    int exitCode = benchmark.finish();
+    if (cullCheck) {
+        cout << "Instance cull check: " << cullChecks << " frame(s), " << cullMismatches << " mismatch(es), "
+             << cullBorderline << " borderline" << endl;
+        if (cullMismatches > 0 || cullChecks == 0)
+            exitCode = 1;
+    }
+    gpuProfiler.shutdown();
     glfwTerminate();
-    return 0;
+    return exitCode;
+}
+
+void processInput(GLFWwindow* window)
+{
+    TRACE_FUNCTION();
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.processKeyboard(GLFW_KEY_W, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.processKeyboard(GLFW_KEY_S, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.processKeyboard(GLFW_KEY_A, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.processKeyboard(GLFW_KEY_D, deltaTime);
 }
 
 void key_callback(GLFWwindow *window, int key, int scancode, int action, int mode)
@@ -382,10 +1111,102 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
                 backLightEnabled = !backLightEnabled;
                 cout << "Back light " << (backLightEnabled ? "enabled" : "disabled") << endl;
                 break;
+            case GLFW_KEY_O:
+                occlusionEnabled = !occlusionEnabled;
+                cout << "Occlusion culling " << (occlusionEnabled ? "enabled" : "disabled") << endl;
+                break;
+            case GLFW_KEY_L:
+                clusteredLighting = !clusteredLighting;
+                cout << "Clustered lighting " << (clusteredLighting ? "enabled" : "disabled") << endl;
+                break;
+            case GLFW_KEY_G:
+                deferredRendering = !deferredRendering;
+                cout << "Renderer: " << (deferredRendering ? "deferred" : "forward") << endl;
+                break;
+            case GLFW_KEY_P:
+                prepass.setMode((DepthPrepass::Mode)((prepass.mode() + 1) % 3));
+                cout << "Depth pre-pass: " << DepthPrepass::modeName(prepass.mode()) << endl;
+                break;
+            case GLFW_KEY_V:
+                overdrawView = !overdrawView;
+                cout << "Overdraw view " << (overdrawView ? "enabled" : "disabled") << endl;
+                break;
+            case GLFW_KEY_Q:
+                renderQueueEnabled = !renderQueueEnabled;
+                cout << "Render queue " << (renderQueueEnabled ? "enabled" : "disabled") << endl;
+                break;
+            case GLFW_KEY_M:
+                arenaEnabled = !arenaEnabled;
+                cout << "Geometry arena / indirect draws " << (arenaEnabled ? "enabled" : "disabled") << endl;
+                break;
+            case GLFW_KEY_C:
+                instanceCuller.setUseGpu(!instanceCuller.usingGpu());
+                cout << "Instance culling on " << (instanceCuller.usingGpu() ? "GPU" : "CPU") << endl;
+                break;
+            case GLFW_KEY_K:
+                shadowsEnabled = !shadowsEnabled;
+                cout << "Key light shadows " << (shadowsEnabled ? "enabled" : "disabled") << endl;
+                break;
         }
     }
 }
 
+// Campo de instâncias (--instances N): grade quadrada no chão, em frente à câmera,
+// com rotação e escala sorteadas (semente fixa) e as malhas da arena alternadas
+void buildInstanceField(int count, const vector<BoundingSphere>& meshSpheres, vector<CullInstance>& instances, vector<mat4>& models)
+{
+    const float spacing = 2.5f;
+    int columns = (int)ceil(sqrt((double)count));
+    mt19937 rng(13);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    instances.resize(count);
+    models.resize(count);
+    // Matrizes em lote (BatchMath.h): com 1M instâncias é o trecho mais caro da montagem
+    Vec3Array translation, rotation, scales;
+    translation.resize(count);
+    rotation.resize(count);
+    scales.resize(count);
+    for (int i = 0; i < count; ++i) {
+        translation.set(i, vec3((i % columns - (columns - 1) * 0.5f) * spacing, -2.0f, -5.0f - (i / columns) * spacing));
+        scales.set(i, vec3(0.5f + 0.5f * unit(rng)));
+        rotation.set(i, vec3(0.0f, unit(rng) * 360.0f, 0.0f));
+    }
+    batchComposeTRS(translation, rotation, scales, models.data());
+    for (int i = 0; i < count; ++i) {
+        float scale = scales.x[i];
+        uint32_t mesh = (uint32_t)(i % meshSpheres.size());
+        instances[i].sphere = vec4(vec3(models[i] * vec4(meshSpheres[mesh].center, 1.0f)), meshSpheres[mesh].radius * scale);
+        instances[i].mesh = mesh;
+    }
+}
+
+// Luzes espalhadas (semente fixa) numa caixa 2 unidades maior que a cena, com raio
+// proporcional ao espaçamento médio: cada ponto fica perto de poucas luzes
+vector<DynamicLight> setupDynamicLights(int count, const AABB& sceneBounds)
+{
+    vector<DynamicLight> lights(count);
+    if (count == 0)
+        return lights;
+    vec3 low = sceneBounds.min - vec3(2.0f), high = sceneBounds.max + vec3(2.0f);
+    vec3 size = high - low;
+    float spacing = cbrt(size.x * size.y * size.z / count);
+    float radius = std::min(std::max(2.5f * spacing, 0.5f), 4.0f);
+
+    mt19937 rng(7);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (DynamicLight& d : lights) {
+        d.center = low + vec3(unit(rng), unit(rng), unit(rng)) * size;
+        d.orbit = 0.25f + 0.75f * unit(rng);
+        d.speed = 0.5f + unit(rng);
+        d.phase = 6.2831853f * unit(rng);
+        d.light.position = d.center;
+        d.light.radius = radius;
+        d.light.color = vec3(0.3f) + 0.7f * vec3(unit(rng), unit(rng), unit(rng));
+        d.light.intensity = 0.6f;
+    }
+    return lights;
+}
+
 void mouse_callback(GLFWwindow* window, double xpos, double ypos)
 {
     if (firstMouse) {
@@ -414,9 +1235,15 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 }
 
 int setupShader()
+{
+    return buildProgram({glslVersion, vertexDefines, IndirectDrawList::vertexSource(), vertexShaderSource}, {glslVersion, lightingSource, fragmentShaderSource});
+}
+
+// Cada estágio pode vir em vários trechos (glShaderSource concatena na ordem)
+GLuint buildProgram(const vector<const GLchar*>& vertexSources, const vector<const GLchar*>& fragmentSources)
 {
     GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
+    glShaderSource(vertexShader, (GLsizei)vertexSources.size(), vertexSources.data(), NULL);
     glCompileShader(vertexShader);
 
     GLint success;
@@ -429,7 +1256,7 @@ int setupShader()
     }
 
     GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
+    glShaderSource(fragmentShader, (GLsizei)fragmentSources.size(), fragmentSources.data(), NULL);
     glCompileShader(fragmentShader);
 
     glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
@@ -457,6 +1284,38 @@ int setupShader()
     return shaderProgram;
 }
 
+// Material, luzes fixas e unidades de textura, iguais em todos os programas que
+// incluem lightingSource. Deixa o programa ligado.
+void setLightingUniforms(GLuint program, float ka, float kd, float ks, float shininess)
+{
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "texture_diffuse1"), 0);
+    glUniform1i(glGetUniformLocation(program, "shadowMap"), 1);
+    glUniform1i(glGetUniformLocation(program, "lightData"), 2 + LightClusterBuffers::LightData);
+    glUniform1i(glGetUniformLocation(program, "clusterRanges"), 2 + LightClusterBuffers::ClusterRanges);
+    glUniform1i(glGetUniformLocation(program, "lightIndices"), 2 + LightClusterBuffers::LightIndices);
+    glUniform1i(glGetUniformLocation(program, "gAlbedo"), 5 + GBuffer::Albedo);
+    glUniform1i(glGetUniformLocation(program, "gNormal"), 5 + GBuffer::Normal);
+    glUniform1i(glGetUniformLocation(program, "gDepth"), 5 + GBuffer::Depth);
+    glUniform1i(glGetUniformLocation(program, "drawData"), 8);
+    glUniform1f(glGetUniformLocation(program, "ka"), ka);
+    glUniform1f(glGetUniformLocation(program, "kd"), kd);
+    glUniform1f(glGetUniformLocation(program, "ks"), ks);
+    glUniform1f(glGetUniformLocation(program, "shininess"), shininess);
+
+    glUniform3f(glGetUniformLocation(program, "keyLightPos"), keyLight.position.x, keyLight.position.y, keyLight.position.z);
+    glUniform3f(glGetUniformLocation(program, "keyLightColor"), keyLight.color.r, keyLight.color.g, keyLight.color.b);
+    glUniform1f(glGetUniformLocation(program, "keyLightIntensity"), keyLight.intensity);
+
+    glUniform3f(glGetUniformLocation(program, "fillLightPos"), fillLight.position.x, fillLight.position.y, fillLight.position.z);
+    glUniform3f(glGetUniformLocation(program, "fillLightColor"), fillLight.color.r, fillLight.color.g, fillLight.color.b);
+    glUniform1f(glGetUniformLocation(program, "fillLightIntensity"), fillLight.intensity);
+
+    glUniform3f(glGetUniformLocation(program, "backLightPos"), backLight.position.x, backLight.position.y, backLight.position.z);
+    glUniform3f(glGetUniformLocation(program, "backLightColor"), backLight.color.r, backLight.color.g, backLight.color.b);
+    glUniform1f(glGetUniformLocation(program, "backLightIntensity"), backLight.intensity);
+}
+
 GLuint loadTexture(string filePath)
 {
     GLuint textureID;
@@ -492,79 +1351,17 @@ GLuint loadTexture(string filePath)
     return textureID;
 }
 
-struct Vertex {
-    vec3 position;
-    vec3 normal;
-    vec2 texCoord;
-};
-
-GLuint loadSuzanneModel(const string& objPath, int &nVertices) {
-    vector<vec3> temp_positions;
-    vector<vec3> temp_normals;
-    vector<vec2> temp_texcoords;
-    vector<Vertex> vertices;
-
-    ifstream file(objPath);
-    if (!file.is_open()) {
-        cerr << "Failed to open OBJ file: " << objPath << endl;
+// Mesma leitura de ObjMesh.h; sem "vn" no arquivo as normais são geradas (MeshNormals.h)
+GLuint loadSuzanneModel(const string& objPath, int &nVertices, AABB *bounds, GLuint *positionVAO) {
+    vector<MeshVertex> vertices;
+    if (!loadObjTriangles(objPath, vertices))
         return 0;
-    }
-
-    string line;
-    while (getline(file, line)) {
-        istringstream iss(line);
-        string type;
-        iss >> type;
-
-        if (type == "v") {
-            vec3 position;
-            iss >> position.x >> position.y >> position.z;
-            temp_positions.push_back(position);
-        }
-        else if (type == "vn") {
-            vec3 normal;
-            iss >> normal.x >> normal.y >> normal.z;
-            temp_normals.push_back(normal);
-        }
-        else if (type == "vt") {
-            vec2 texcoord;
-            iss >> texcoord.x >> texcoord.y;
-            texcoord.y = 1.0f - texcoord.y;
-            temp_texcoords.push_back(texcoord);
-        }
-        else if (type == "f") {
-            string vertexData;
-            while (iss >> vertexData) {
-                Vertex vertex;
-                istringstream viss(vertexData);
-                string indexStr;
-                unsigned int indices[3] = {0, 0, 0};
-                int i = 0;
-
-                while (getline(viss, indexStr, '/')) {
-                    if (!indexStr.empty()) {
-                        indices[i] = stoul(indexStr) - 1;
-                    }
-                    i++;
-                    if (i >= 3) break;
-                }
+    if (size_t generated = fillMissingNormals(vertices))
+        cout << objPath << ": generated " << generated << " missing normals" << endl;
 
-                if (indices[0] < temp_positions.size()) {
-                    vertex.position = temp_positions[indices[0]];
-                }
-                if (indices[1] < temp_texcoords.size()) {
-                    vertex.texCoord = temp_texcoords[indices[1]];
-                }
-                if (indices[2] < temp_normals.size()) {
-                    vertex.normal = temp_normals[indices[2]];
-                }
-                vertices.push_back(vertex);
-            }
-        }
-    }
-
-    file.close();
     nVertices = vertices.size();
+    if (bounds && !vertices.empty())
+        *bounds = computeAABB(&vertices[0].position, vertices.size(), sizeof(MeshVertex));
 
     GLuint VAO, VBO;
     glGenVertexArrays(1, &VAO);
@@ -572,28 +1369,41 @@ GLuint loadSuzanneModel(const string& objPath, int &nVertices) {
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshVertex), vertices.data(), GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, normal));
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoord));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, texCoord));
     glEnableVertexAttribArray(3);
 
+    // VAO do passe de profundidade: VBO só com as posições, bem empacotadas
+    if (positionVAO) {
+        vector<vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+            positions[i] = vertices[i].position;
+        GLuint positionVBO;
+        glGenVertexArrays(1, positionVAO);
+        glGenBuffers(1, &positionVBO);
+        glBindVertexArray(*positionVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, positionVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(vec3), positions.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vec3), (void*)0);
+        glEnableVertexAttribArray(0);
+    }
+
     glBindVertexArray(0);
     return VAO;
 }
 
-void drawModel(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, int nVertices, vec3 color)
+void drawModel(GLuint shaderID, GLuint VAO, const mat4& model, const mat3& normalMatrix, int nVertices, vec3 color)
 {
-    mat4 model = mat4(1.0f);
-    model = translate(model, position);
-    model = scale(model, dimensions);
-    
+    TRACE_FUNCTION();
     glUniformMatrix4fv(glGetUniformLocation(shaderID, "model"), 1, GL_FALSE, value_ptr(model));
+    glUniformMatrix3fv(glGetUniformLocation(shaderID, "normalMatrix"), 1, GL_FALSE, value_ptr(normalMatrix));
     glUniform3f(glGetUniformLocation(shaderID, "vColor"), color.r, color.g, color.b);
     
     glBindVertexArray(VAO);
@@ -7,6 +7,13 @@
 #include <vector>
 #include <algorithm>
 
+#include "Bvh.h"
+#include "Headless.h"
+#include "GpuProfiler.h"
+#include "Trace.h"
+#include "SceneGraph.h"
+#include "SpatialGrid.h"
+
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
@@ -28,6 +35,25 @@ std::vector<SceneObject> sceneObjects;
 int selectedObjectIndex = 0;
 bool showTrajectories = true;
 
+// Índice espacial para picking com o mouse e consultas de proximidade
+SpatialGrid spatialGrid(2.0f);
+bool pickRequested = false;
+double pickX = 0.0, pickY = 0.0;
+
+// AABB local do cubo unitário (usado no frustum culling)
+const AABB cubeBounds = {glm::vec3(-0.5f), glm::vec3(0.5f)};
+
+// Um nó por objeto (mesmo índice de sceneObjects); matrizes só são refeitas quando mudam
+SceneGraph sceneGraph;
+
+void syncSceneGraph() {
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        sceneGraph.setTranslation((int)i, sceneObjects[i].position);
+        sceneGraph.setRotation((int)i, glm::vec3(rotationX, rotationY, rotationZ));
+        sceneGraph.setScale((int)i, glm::vec3(scale));
+    }
+}
+
 const char* vertexShaderSource = R"(
 #version 330 core
 layout (location = 0) in vec3 aPos;
@@ -129,6 +155,7 @@ float vertices[] = {
 };
 
 void updateObjects(float deltaTime) {
+    TRACE_FUNCTION();
     for (auto& obj : sceneObjects) {
         if (!obj.isMoving || obj.trajectoryPoints.empty()) continue;
 
@@ -154,6 +181,7 @@ void updateObjects(float deltaTime) {
 }
 
 void processInput(GLFWwindow* window) {
+    TRACE_FUNCTION();
     static float lastTime = 0.0f;
     float currentTime = glfwGetTime();
     float deltaTime = currentTime - lastTime;
@@ -219,6 +247,25 @@ void processInput(GLFWwindow* window) {
         }
     }
 
+    if (glfwGetKey(window, GLFW_KEY_N) == GLFW_PRESS) {
+        static double lastPressTime = 0;
+        double currentTime = glfwGetTime();
+        if (currentTime - lastPressTime > 0.2) {
+            const glm::vec3& center = sceneObjects[selectedObjectIndex].position;
+            std::vector<int> found;
+            spatialGrid.queryRadius(center, 3.0f, found);
+            std::cout << "Objects within 3 units of object " << selectedObjectIndex << ":";
+            for (int id : found)
+                if (id != selectedObjectIndex) std::cout << " " << id;
+            spatialGrid.queryNearest(center, 4, found);
+            std::cout << "\nNearest objects:";
+            for (int id : found)
+                if (id != selectedObjectIndex) std::cout << " " << id;
+            std::cout << "\n";
+            lastPressTime = currentTime;
+        }
+    }
+
     if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS) {
         static double lastPressTime = 0;
         double currentTime = glfwGetTime();
@@ -232,15 +279,48 @@ void processInput(GLFWwindow* window) {
     updateObjects(deltaTime);
 }
 
-int main() {
-    glfwInit();
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
+        glfwGetCursorPos(window, &pickX, &pickY);
+        pickRequested = true;
+    }
+}
+
+// Seleciona o objeto sob o cursor lançando um raio pela grade espacial
+void pickObject(const glm::mat4& view, const glm::mat4& projection) {
+    float ndcX = 2.0f * (float)pickX / SCR_WIDTH - 1.0f;
+    float ndcY = 1.0f - 2.0f * (float)pickY / SCR_HEIGHT;
+    glm::mat4 invViewProjection = glm::inverse(projection * view);
+    glm::vec4 nearPoint = invViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = invViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 direction = glm::normalize(glm::vec3(farPoint) / farPoint.w - origin);
+
+    int hit = spatialGrid.raycast(origin, direction, 100.0f);
+    if (hit >= 0) {
+        selectedObjectIndex = hit;
+        std::cout << "Picked object " << selectedObjectIndex << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    HeadlessRun headless(argc, argv);
+    TraceSession trace(argc, argv);
+
+    headless.initGlfw();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Tarefa M6", nullptr, nullptr);
+    GLFWwindow* window = headless.createWindow(SCR_WIDTH, SCR_HEIGHT, "Tarefa M6");
     glfwMakeContextCurrent(window);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
     gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+    headless.setupFramebuffer();
+    // Proporção do framebuffer em que a cena é desenhada (no headless, o tamanho pedido)
+    float aspect = headless.enabled() ? (float)headless.getWidth() / headless.getHeight() : (float)SCR_WIDTH / SCR_HEIGHT;
+    GpuProfiler gpuProfiler;
+    gpuProfiler.init();
     glEnable(GL_DEPTH_TEST);
 
     int vs = glCreateShader(GL_VERTEX_SHADER);
@@ -290,16 +370,54 @@ int main() {
         {{-2.0f, 1.0f, -3.0f}, {}, 0.02f, 0, false, true}
     };
 
+    for (size_t i = 0; i < sceneObjects.size(); ++i)
+        sceneGraph.addNode(-1);
+    syncSceneGraph();
+    sceneGraph.update();
+
+    // BVH com os AABBs de mundo dos objetos; refit quando se movem
+    std::vector<AABB> objectWorldBounds(sceneObjects.size());
+    for (size_t i = 0; i < sceneObjects.size(); ++i) {
+        objectWorldBounds[i] = transformAABB(cubeBounds, sceneGraph.world((int)i));
+        spatialGrid.insert((int)i, objectWorldBounds[i]);
+    }
+    Bvh bvh;
+    bvh.build(objectWorldBounds);
+    std::vector<int> visibleObjects;
+    BvhCullStats cullStats;
+    double lastStatsTime = glfwGetTime();
+
     while (!glfwWindowShouldClose(window)) {
+        TRACE_SCOPE("frame");
         processInput(window);
 
+        {
+            TRACE_SCOPE("matrices");
+            syncSceneGraph();
+            sceneGraph.update();
+            for (int i : sceneGraph.changedNodes()) {
+                AABB bounds = transformAABB(cubeBounds, sceneGraph.world(i));
+                bvh.update(i, bounds);
+                spatialGrid.move(i, bounds);
+            }
+            bvh.rebuildIfDegraded();
+        }
+
+        gpuProfiler.beginFrame();
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glm::mat4 view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH/SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+
+        if (pickRequested) {
+            pickObject(view, projection);
+            pickRequested = false;
+        }
 
         if (showTrajectories) {
+            TRACE_SCOPE("drawTrajectories");
+            GpuProfiler::Scope scope(gpuProfiler, "trajectories");
             glUseProgram(trajectoryShaderProgram);
             glUniformMatrix4fv(glGetUniformLocation(trajectoryShaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
             glUniformMatrix4fv(glGetUniformLocation(trajectoryShaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
@@ -328,30 +446,51 @@ int main() {
         glUseProgram(shaderProgram);
         glBindVertexArray(VAO);
 
-        for (size_t i = 0; i < sceneObjects.size(); ++i) {
-            const auto& obj = sceneObjects[i];
-            
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, obj.position);
-            model = glm::rotate(model, glm::radians(rotationX), glm::vec3(1, 0, 0));
-            model = glm::rotate(model, glm::radians(rotationY), glm::vec3(0, 1, 0));
-            model = glm::rotate(model, glm::radians(rotationZ), glm::vec3(0, 0, 1));
-            model = glm::scale(model, glm::vec3(scale));
+        {
+            TRACE_SCOPE("cull");
+            bvh.cull(Frustum::fromMatrix(projection * view), visibleObjects, &cullStats);
+        }
+        if (glfwGetTime() - lastStatsTime >= 1.0) {
+            std::cout << "Visible: " << cullStats.visible << "/" << sceneObjects.size()
+                      << " | nodes visited: " << cullStats.nodesVisited
+                      << " | cull: " << cullStats.cullTimeMs << " ms"
+                      << " | GPU: " << gpuProfiler.summary() << "\n";
+            lastStatsTime = glfwGetTime();
+        }
 
-            glm::vec3 baseColor = (i == selectedObjectIndex) ? glm::vec3(1.0f, 1.0f, 1.0f) : glm::vec3(0.7f, 0.7f, 0.7f);
-            glUniform3fv(glGetUniformLocation(shaderProgram, "overrideColor"), 1, glm::value_ptr(baseColor));
+        {
+            TRACE_SCOPE("drawObjects");
+            GpuProfiler::Scope scope(gpuProfiler, "objects");
+            for (int i : visibleObjects) {
+                const glm::mat4& model = sceneGraph.world(i);
 
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-            glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+                glm::vec3 baseColor = (i == selectedObjectIndex) ? glm::vec3(1.0f, 1.0f, 1.0f) : glm::vec3(0.7f, 0.7f, 0.7f);
+                glUniform3fv(glGetUniformLocation(shaderProgram, "overrideColor"), 1, glm::value_ptr(baseColor));
 
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+                glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
+                glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
+                glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+            }
         }
+        gpuProfiler.endFrame();
+        gpuProfiler.updateOverlay(window, "Tarefa M6");
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            TRACE_SCOPE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        headless.endFrame(window);
+        {
+            TRACE_SCOPE("glfwPollEvents");
+            glfwPollEvents();
+        }
     }
 
+    headless.finish();
+    trace.finish();
+    gpuProfiler.shutdown();
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+#pragma once
+
+// Desenho de um MaterialMesh (ObjMaterials.h): VBO/IBO únicos, os parâmetros de todos
+// os materiais num uniform buffer e um glDrawElements por faixa de material, ligando o
+// bloco do material com glBindBufferRange (sem reenviar uniforms a cada desenho).
+//
+//   MaterialDrawList materials;
+//   materials.init(mesh);
+//   glVertexAttribPointer(...);                  // com o VAO ligado (init deixa ligado)
+//   materials.bindProgram(program);              // bloco "Material" no ponto de ligação do init
+//   materials.setTexture(m, texture);            // opcional, map_Kd carregado pelo chamador
+//   materials.draw();                            // uma chamada por material
+//   materials.drawRuns();                        // uma por "usemtl" do arquivo, para comparar
+//
+// O shader declara o bloco com MaterialDrawList::shaderSource() (GLSL 3.30 ou mais).
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include "ObjMaterials.h"
+
+// Layout std140 do bloco "Material"
+struct MaterialBlock {
+    glm::vec4 ambient;    // rgb = Ka
+    glm::vec4 diffuse;    // rgb = Kd, a = opacidade
+    glm::vec4 specular;   // rgb = Ks, w = Ns
+    glm::vec4 emissive;   // rgb = Ke, w = 1 quando há textura difusa
+};
+
+// Contagens do último draw()/drawRuns()
+struct MaterialDrawStats {
+    int draws = 0;
+    int materialBinds = 0;
+    int textureBinds = 0;
+};
+
+class MaterialDrawList {
+public:
+    // blockBinding: ponto de ligação do uniform buffer; textureUnit: unidade do map_Kd
+    bool init(const MaterialMesh& mesh, GLuint blockBinding = 0, int textureUnit = 0) {
+        binding = blockBinding;
+        unit = textureUnit;
+        ranges = mesh.ranges;
+        runs = mesh.runs;
+        textures.assign(mesh.materials.size(), 0);
+
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        alignment = alignment > 0 ? alignment : 256;
+        stride = ((GLsizeiptr)sizeof(MaterialBlock) + alignment - 1) / alignment * alignment;
+        std::vector<uint8_t> blocks(stride * std::max<size_t>(1, mesh.materials.size()), 0);
+        for (size_t m = 0; m < mesh.materials.size(); ++m) {
+            const ObjMaterial& material = mesh.materials[m];
+            MaterialBlock block;
+            block.ambient = glm::vec4(material.ambient, 1.0f);
+            block.diffuse = glm::vec4(material.diffuse, material.opacity);
+            block.specular = glm::vec4(material.specular, material.shininess);
+            block.emissive = glm::vec4(material.emissive, 0.0f);
+            std::memcpy(blocks.data() + stride * m, &block, sizeof(block));
+        }
+        glGenBuffers(1, &uniformBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)blocks.size(), blocks.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        blockData.swap(blocks);
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vertexBuffer);
+        glGenBuffers(1, &indexBuffer);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(mesh.vertices.size() * sizeof(MeshVertex)), mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(mesh.indices.size() * sizeof(uint32_t)), mesh.indices.data(), GL_STATIC_DRAW);
+        return true;
+    }
+
+    void shutdown() {
+        if (vao) glDeleteVertexArrays(1, &vao);
+        if (vertexBuffer) glDeleteBuffers(1, &vertexBuffer);
+        if (indexBuffer) glDeleteBuffers(1, &indexBuffer);
+        if (uniformBuffer) glDeleteBuffers(1, &uniformBuffer);
+        vao = vertexBuffer = indexBuffer = uniformBuffer = 0;
+    }
+
+    // Liga o bloco "Material" do programa ao ponto de init e o sampler à unidade
+    void bindProgram(GLuint program) const {
+        GLuint index = glGetUniformBlockIndex(program, "Material");
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, index, binding);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "materialDiffuseMap"), unit);
+    }
+
+    // Textura difusa do material (0 = sem textura); o chamador é dono da textura
+    void setTexture(int material, GLuint texture) {
+        if (material < 0 || material >= (int)textures.size()) return;
+        textures[material] = texture;
+        float flag = texture ? 1.0f : 0.0f;
+        std::memcpy(blockData.data() + stride * material + offsetof(MaterialBlock, emissive) + 3 * sizeof(float), &flag, sizeof(float));
+        glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, stride * material, sizeof(MaterialBlock), blockData.data() + stride * material);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // Uma chamada por material (faixas em ordem de material)
+    void draw() { submit(ranges); }
+
+    // Uma chamada por trecho de "usemtl" na ordem do arquivo: o que o OBJ custaria sem agrupar
+    void drawRuns() { submit(runs); }
+
+    const MaterialDrawStats& stats() const { return lastStats; }
+    int rangeCount() const { return (int)ranges.size(); }
+    int runCount() const { return (int)runs.size(); }
+    GLuint vertexArray() const { return vao; }
+
+    // Trecho de shader com o bloco de material (ver MaterialBlock)
+    static const char* shaderSource() {
+        return R"(
+layout (std140) uniform Material
+{
+    vec4 materialAmbient;
+    vec4 materialDiffuse;
+    vec4 materialSpecular;
+    vec4 materialEmissive;
+};
+uniform sampler2D materialDiffuseMap;
+
+vec3 materialDiffuseColor(vec2 texCoord)
+{
+    return materialEmissive.w > 0.5 ? materialDiffuse.rgb * texture(materialDiffuseMap, texCoord).rgb : materialDiffuse.rgb;
+}
+)";
+    }
+
+private:
+    GLuint binding = 0;
+    int unit = 0;
+    GLsizeiptr stride = 0;
+    GLuint vao = 0, vertexBuffer = 0, indexBuffer = 0, uniformBuffer = 0;
+    std::vector<MaterialRange> ranges, runs;
+    std::vector<GLuint> textures;
+    std::vector<uint8_t> blockData;
+    MaterialDrawStats lastStats;
+
+    void submit(const std::vector<MaterialRange>& list) {
+        MaterialDrawStats stats;
+        int boundMaterial = -1;
+        GLuint boundTexture = 0;
+        glBindVertexArray(vao);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        for (const MaterialRange& range : list) {
+            if (range.material != boundMaterial) {
+                glBindBufferRange(GL_UNIFORM_BUFFER, binding, uniformBuffer, stride * range.material, sizeof(MaterialBlock));
+                boundMaterial = range.material;
+                ++stats.materialBinds;
+                GLuint texture = textures[range.material];
+                if (texture && texture != boundTexture) {
+                    glBindTexture(GL_TEXTURE_2D, texture);
+                    boundTexture = texture;
+                    ++stats.textureBinds;
+                }
+            }
+            glDrawElements(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT, (void*)(sizeof(uint32_t) * (size_t)range.firstIndex));
+            ++stats.draws;
+        }
+        glActiveTexture(GL_TEXTURE0);
+        glBindVertexArray(0);
+        lastStats = stats;
+    }
+};
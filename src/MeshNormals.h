@@ -0,0 +1,342 @@
+#pragma once
+
+// Geração de normais e tangentes para listas de triângulos (o formato de
+// loadObjTriangles), usada quando o OBJ não traz "vn" e para normal mapping.
+//
+//   generateNormals(triangles, options)   normais suaves ponderadas por área e ângulo,
+//                                         separadas nas arestas acima de creaseAngle
+//   generateTangents(triangles, tangents) tangente por vértice (xyz) e sinal da
+//                                         bitangente (w): B = w * cross(N, T)
+//
+// Os vértices são agrupados pela posição (normais) ou por posição+normal+UV (tangentes),
+// com tabelas de hash independentes por thread.
+// O trabalho por triângulo roda no ThreadPool. As somas por vértice leem a lista de
+// adjacência de cada grupo (os cantos em ordem crescente), sem atômicos nem escrita
+// compartilhada, então o resultado é o mesmo bit a bit com qualquer número de threads.
+// Com creaseAngle < 180 cada canto soma só as faces vizinhas dentro do ângulo.
+//
+// As tangentes seguem as convenções do MikkTSpace: direção de dU/dx por face com o sinal
+// da orientação do UV, projetada no plano da normal do vértice, ponderada pelo ângulo do
+// canto e somada por vértice e orientação; w = +1 quando o UV preserva a orientação.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ObjMesh.h"
+#include "ParallelFor.h"
+
+struct NormalOptions {
+    float creaseAngle = 180.0f;   // graus; faces mais inclinadas que isso entre si ficam com normais separadas
+    bool areaWeighted = true;
+    bool angleWeighted = true;
+};
+
+namespace normals_detail {
+
+// Intervalo de triângulos do bloco "block" entre "blocks"
+inline void blockRange(size_t count, int block, int blocks, size_t& begin, size_t& end) {
+    begin = count * block / blocks;
+    end = count * (block + 1) / blocks;
+}
+
+// Um bloco por thread, mas sem blocos minúsculos em malhas pequenas
+inline int blockCount(ThreadPool& pool, size_t triangles) {
+    return (int)std::max<size_t>(1, std::min<size_t>(pool.threadCount(), triangles / 512));
+}
+
+// Lista de adjacência: os cantos do grupo g são incident[offsets[g], offsets[g + 1]),
+// em ordem crescente
+inline void groupCorners(const std::vector<uint32_t>& ids, uint32_t groups, std::vector<uint32_t>& offsets,
+                         std::vector<uint32_t>& incident) {
+    offsets.assign(groups + 1, 0);
+    incident.resize(ids.size());
+    for (uint32_t id : ids)
+        ++offsets[id + 1];
+    for (uint32_t g = 0; g < groups; ++g)
+        offsets[g + 1] += offsets[g];
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (size_t c = 0; c < ids.size(); ++c)
+        incident[cursor[ids[c]]++] = (uint32_t)c;
+}
+
+// sums[g] = soma de contribution(canto) dos cantos do grupo g, na ordem da lista
+template <typename Contribution>
+void gatherSums(ThreadPool& pool, const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& incident,
+                std::vector<glm::vec3>& sums, Contribution contribution) {
+    size_t groups = offsets.size() - 1;
+    sums.assign(groups, glm::vec3(0.0f));
+    int ranges = std::max(1, std::min(pool.threadCount() * 4, (int)(groups / 256)));
+    pool.parallelFor(ranges, [&](int range, int) {
+        size_t begin, end;
+        blockRange(groups, range, ranges, begin, end);
+        for (size_t g = begin; g < end; ++g) {
+            glm::vec3 sum(0.0f);
+            for (uint32_t i = offsets[g]; i < offsets[g + 1]; ++i)
+                sum += contribution(incident[i]);
+            sums[g] = sum;
+        }
+    });
+}
+
+// Executa body(triângulo) para todos os triângulos, em blocos
+template <typename Body>
+void forEachTriangle(ThreadPool& pool, size_t triangles, Body body) {
+    int blocks = std::max(1, std::min(pool.threadCount() * 4, (int)(triangles / 256)));
+    pool.parallelFor(blocks, [&](int block, int) {
+        size_t begin, end;
+        blockRange(triangles, block, blocks, begin, end);
+        for (size_t t = begin; t < end; ++t)
+            body(t);
+    });
+}
+
+// Identificador por valor (bit a bit) para cada canto; retorna quantos valores distintos.
+// Os hashes dividem as chaves em partes, uma por thread, cada uma com sua tabela de
+// endereçamento aberto (e sem nada compartilhado); os ids de cada parte vêm depois dos
+// da anterior. Os cantos são distribuídos entre as partes numa passada só
+template <typename Key, typename MakeKey>
+uint32_t weld(ThreadPool& pool, size_t corners, std::vector<uint32_t>& ids, MakeKey makeKey) {
+    std::vector<uint64_t> hashes(corners);
+    forEachTriangle(pool, corners / 3, [&](size_t t) {
+        for (size_t c = 3 * t; c < 3 * t + 3; ++c) {
+            Key key = makeKey(c);
+            uint64_t hash = 1469598103934665603ull;
+            for (uint32_t word : key.words)
+                hash = (hash ^ word) * 1099511628211ull;
+            hashes[c] = hash ^ (hash >> 29);
+        }
+    });
+
+    const uint32_t empty = 0xFFFFFFFFu;
+    int parts = blockCount(pool, corners / 3);
+    auto partOf = [&](size_t c) { return (size_t)((hashes[c] >> 40) % (uint64_t)parts); };
+    std::vector<uint32_t> partStart(parts + 1, 0), order;
+    if (parts > 1) {
+        for (size_t c = 0; c < corners; ++c)
+            ++partStart[partOf(c) + 1];
+        for (int part = 0; part < parts; ++part)
+            partStart[part + 1] += partStart[part];
+        std::vector<uint32_t> cursor(partStart.begin(), partStart.end() - 1);
+        order.resize(corners);
+        for (size_t c = 0; c < corners; ++c)
+            order[cursor[partOf(c)]++] = (uint32_t)c;
+    } else {
+        partStart[1] = (uint32_t)corners;
+    }
+
+    std::vector<uint32_t> uniqueCounts(parts + 1, 0);
+    ids.resize(corners);
+    pool.parallelFor(parts, [&](int part, int) {
+        size_t count = partStart[part + 1] - partStart[part];
+        size_t capacity = 16;
+        while (capacity < count + count / 2)
+            capacity *= 2;
+        std::vector<uint32_t> table(capacity, empty);
+        std::vector<Key> keys;
+        for (size_t i = partStart[part]; i < partStart[part + 1]; ++i) {
+            size_t c = parts > 1 ? order[i] : i;
+            Key key = makeKey(c);
+            size_t slot = (size_t)hashes[c] & (capacity - 1);
+            while (table[slot] != empty && !(keys[table[slot]] == key))
+                slot = (slot + 1) & (capacity - 1);
+            if (table[slot] == empty) {
+                table[slot] = (uint32_t)keys.size();
+                keys.push_back(key);
+            }
+            ids[c] = table[slot];
+        }
+        uniqueCounts[part + 1] = (uint32_t)keys.size();
+    });
+
+    for (int part = 0; part < parts; ++part)
+        uniqueCounts[part + 1] += uniqueCounts[part];
+    if (parts > 1) {
+        pool.parallelFor(parts, [&](int part, int) {
+            for (size_t i = partStart[part]; i < partStart[part + 1]; ++i)
+                ids[order[i]] += uniqueCounts[part];
+        });
+    }
+    return uniqueCounts[parts];
+}
+
+struct PositionKey {
+    uint32_t words[3];
+    bool operator==(const PositionKey& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+};
+
+// Posição, normal, UV e a orientação do UV do triângulo
+struct TangentKey {
+    uint32_t words[9];
+    bool operator==(const TangentKey& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+};
+
+// Ângulo do canto em "p" entre as arestas para "a" e "b" (atan2 é estável em ângulos pequenos)
+inline float cornerAngle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b) {
+    glm::vec3 e1 = a - p, e2 = b - p;
+    return std::atan2(glm::length(glm::cross(e1, e2)), glm::dot(e1, e2));
+}
+
+inline glm::vec3 safeNormalize(const glm::vec3& v, const glm::vec3& fallback) {
+    float length = glm::length(v);
+    return length > 1e-20f ? v / length : fallback;
+}
+
+// Algum vetor unitário perpendicular a n
+inline glm::vec3 anyPerpendicular(const glm::vec3& n) {
+    glm::vec3 axis = std::fabs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    return safeNormalize(glm::cross(n, axis), glm::vec3(1.0f, 0.0f, 0.0f));
+}
+
+} // namespace normals_detail
+
+// Substitui as normais de todos os vértices de "triangles" (3 por triângulo)
+inline void generateNormals(std::vector<MeshVertex>& triangles, const NormalOptions& options = NormalOptions(),
+                            ThreadPool& pool = ThreadPool::global()) {
+    using namespace normals_detail;
+    size_t triangleCount = triangles.size() / 3;
+    size_t corners = triangleCount * 3;
+    if (triangleCount == 0) return;
+
+    std::vector<uint32_t> ids;
+    uint32_t positions = weld<PositionKey>(pool, corners, ids, [&](size_t c) {
+        PositionKey key;
+        glm::vec3 p = triangles[c].position + glm::vec3(0.0f);   // -0 vira +0
+        std::memcpy(key.words, &p, sizeof(key.words));
+        return key;
+    });
+
+    // Normal unitária de cada face e peso de cada canto
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    std::vector<float> weights(corners);
+    forEachTriangle(pool, triangleCount, [&](size_t t) {
+        const glm::vec3& p0 = triangles[3 * t].position;
+        const glm::vec3& p1 = triangles[3 * t + 1].position;
+        const glm::vec3& p2 = triangles[3 * t + 2].position;
+        glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+        float doubleArea = glm::length(cross);
+        faceNormals[t] = doubleArea > 0.0f ? cross / doubleArea : glm::vec3(0.0f);
+        float angles[3] = { cornerAngle(p0, p1, p2), cornerAngle(p1, p2, p0), cornerAngle(p2, p0, p1) };
+        for (int k = 0; k < 3; ++k)
+            weights[3 * t + k] = (options.areaWeighted ? 0.5f * doubleArea : 1.0f) * (options.angleWeighted ? angles[k] : 1.0f);
+    });
+
+    // Cantos por posição (lista de adjacência)
+    std::vector<uint32_t> offsets, incident;
+    groupCorners(ids, positions, offsets, incident);
+
+    if (options.creaseAngle >= 180.0f) {
+        // Sem vincos: uma soma por posição
+        std::vector<glm::vec3> sums;
+        gatherSums(pool, offsets, incident, sums, [&](uint32_t c) { return faceNormals[c / 3] * weights[c]; });
+        forEachTriangle(pool, triangleCount, [&](size_t t) {
+            for (size_t c = 3 * t; c < 3 * t + 3; ++c)
+                triangles[c].normal = safeNormalize(sums[ids[c]], faceNormals[t]);
+        });
+        return;
+    }
+
+    // Com vincos: para cada canto, a soma das faces vizinhas que não passam do ângulo em
+    // relação à sua
+    float minCos = std::cos(glm::radians(std::max(options.creaseAngle, 0.0f)));
+    forEachTriangle(pool, triangleCount, [&](size_t t) {
+        const glm::vec3& own = faceNormals[t];
+        for (size_t c = 3 * t; c < 3 * t + 3; ++c) {
+            glm::vec3 sum(0.0f);
+            for (uint32_t i = offsets[ids[c]]; i < offsets[ids[c] + 1]; ++i) {
+                uint32_t other = incident[i];
+                const glm::vec3& n = faceNormals[other / 3];
+                if (other / 3 == t || glm::dot(n, own) >= minCos)
+                    sum += n * weights[other];
+            }
+            triangles[c].normal = safeNormalize(sum, own);
+        }
+    });
+}
+
+// tangents[i] para cada vértice de "triangles"; as normais já precisam estar prontas
+inline void generateTangents(const std::vector<MeshVertex>& triangles, std::vector<glm::vec4>& tangents,
+                             ThreadPool& pool = ThreadPool::global()) {
+    using namespace normals_detail;
+    size_t triangleCount = triangles.size() / 3;
+    size_t corners = triangleCount * 3;
+    tangents.assign(corners, glm::vec4(1.0f, 0.0f, 0.0f, 1.0f));
+    if (triangleCount == 0) return;
+
+    // Direção de dU por face, já com o sinal da orientação do UV
+    std::vector<glm::vec3> faceTangents(triangleCount);
+    std::vector<uint8_t> preserving(triangleCount);
+    forEachTriangle(pool, triangleCount, [&](size_t t) {
+        const MeshVertex& v0 = triangles[3 * t];
+        const MeshVertex& v1 = triangles[3 * t + 1];
+        const MeshVertex& v2 = triangles[3 * t + 2];
+        glm::vec3 d1 = v1.position - v0.position, d2 = v2.position - v0.position;
+        glm::vec2 t1 = v1.texCoord - v0.texCoord, t2 = v2.texCoord - v0.texCoord;
+        float signedArea = t1.x * t2.y - t1.y * t2.x;
+        preserving[t] = signedArea > 0.0f;
+        glm::vec3 os = t2.y * d1 - t1.y * d2;
+        float length = glm::length(os);
+        faceTangents[t] = signedArea != 0.0f && length > 0.0f ? os * ((preserving[t] ? 1.0f : -1.0f) / length) : glm::vec3(0.0f);
+    });
+
+    std::vector<uint32_t> ids;
+    uint32_t groups = weld<TangentKey>(pool, corners, ids, [&](size_t c) {
+        TangentKey key;
+        std::memcpy(key.words, &triangles[c], sizeof(MeshVertex));
+        key.words[8] = preserving[c / 3];
+        return key;
+    });
+    static_assert(sizeof(MeshVertex) == 8 * sizeof(uint32_t), "MeshVertex layout changed");
+
+    // Contribuição de cada canto, somada depois por grupo
+    std::vector<glm::vec3> cornerTangents(corners, glm::vec3(0.0f));
+    forEachTriangle(pool, triangleCount, [&](size_t t) {
+        if (faceTangents[t] == glm::vec3(0.0f)) return;
+        for (int k = 0; k < 3; ++k) {
+            const MeshVertex& v = triangles[3 * t + k];
+            const glm::vec3& n = v.normal;
+            // Tangente e arestas projetadas no plano da normal do vértice
+            glm::vec3 os = safeNormalize(faceTangents[t] - n * glm::dot(n, faceTangents[t]), glm::vec3(0.0f));
+            glm::vec3 e1 = triangles[3 * t + (k + 1) % 3].position - v.position;
+            glm::vec3 e2 = triangles[3 * t + (k + 2) % 3].position - v.position;
+            e1 = safeNormalize(e1 - n * glm::dot(n, e1), glm::vec3(0.0f));
+            e2 = safeNormalize(e2 - n * glm::dot(n, e2), glm::vec3(0.0f));
+            float angle = std::acos(std::min(std::max(glm::dot(e1, e2), -1.0f), 1.0f));
+            cornerTangents[3 * t + k] = os * angle;
+        }
+    });
+    std::vector<uint32_t> offsets, incident;
+    groupCorners(ids, groups, offsets, incident);
+    std::vector<glm::vec3> sums;
+    gatherSums(pool, offsets, incident, sums, [&](uint32_t c) { return cornerTangents[c]; });
+
+    forEachTriangle(pool, triangleCount, [&](size_t t) {
+        for (size_t c = 3 * t; c < 3 * t + 3; ++c) {
+            const glm::vec3& n = triangles[c].normal;
+            glm::vec3 tangent = safeNormalize(sums[ids[c]], glm::vec3(0.0f));
+            if (tangent == glm::vec3(0.0f)) tangent = anyPerpendicular(n);
+            tangents[c] = glm::vec4(tangent, preserving[t] ? 1.0f : -1.0f);
+        }
+    });
+}
+
+// Completa as normais que o OBJ não trouxe (loadObjTriangles deixa zero onde falta "vn");
+// retorna quantos vértices foram preenchidos
+inline size_t fillMissingNormals(std::vector<MeshVertex>& triangles, const NormalOptions& options = NormalOptions(),
+                                 ThreadPool& pool = ThreadPool::global()) {
+    size_t missing = 0;
+    for (const MeshVertex& v : triangles)
+        missing += v.normal == glm::vec3(0.0f);
+    if (missing == 0) return 0;
+
+    std::vector<MeshVertex> generated(triangles);
+    generateNormals(generated, options, pool);
+    for (size_t i = 0; i < triangles.size(); ++i)
+        if (triangles[i].normal == glm::vec3(0.0f))
+            triangles[i].normal = generated[i].normal;
+    return missing;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+// Matriz de normais calculada uma vez por objeto na CPU, em vez de
+// mat3(transpose(inverse(model))) a cada vértice no shader.
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+// Caminho rápido: sem cisalhamento (rotação + escala, uniforme ou não), as colunas de
+// mat3(model) são ortogonais e a inversa transposta é cada coluna dividida pelo seu
+// comprimento ao quadrado. Só cai na inversa completa quando há cisalhamento
+// (por exemplo, escala não uniforme no pai e rotação no filho).
+inline glm::mat3 computeNormalMatrix(const glm::mat4& model) {
+    glm::mat3 m(model);
+    float l0 = glm::dot(m[0], m[0]);
+    float l1 = glm::dot(m[1], m[1]);
+    float l2 = glm::dot(m[2], m[2]);
+    const float eps = 1e-5f;
+    if (std::fabs(glm::dot(m[0], m[1])) <= eps * std::sqrt(l0 * l1) &&
+        std::fabs(glm::dot(m[0], m[2])) <= eps * std::sqrt(l0 * l2) &&
+        std::fabs(glm::dot(m[1], m[2])) <= eps * std::sqrt(l1 * l2) &&
+        l0 > 0.0f && l1 > 0.0f && l2 > 0.0f) {
+        return glm::mat3(m[0] / l0, m[1] / l1, m[2] / l2);
+    }
+    return glm::transpose(glm::inverse(m));
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+// Leitura de números direto de um buffer [first, last), sem locale, sem strings
+// temporárias e sem exigir '\0' no fim (como std::from_chars): cada função devolve o
+// ponteiro depois do número, ou "first" se não havia número.
+//
+// parseFloat/parseDouble dão o mesmo resultado que strtof/strtod para números decimais
+// ([sinal] dígitos [. dígitos] [e [sinal] dígitos]; inf, nan e hexadecimais não são
+// aceitos). O caminho rápido é o de Clinger: até 19 dígitos significativos e expoente
+// pequeno cabem num double exato (mantissa <= 2^53, 10^|e| <= 10^22), com uma única
+// divisão/multiplicação corretamente arredondada. Para float, o double é arredondado de
+// novo, o que só pode errar quando ele cai exatamente no meio de dois floats; esses
+// casos, os subnormais e o resto vão para std::from_chars; fora do intervalo do tipo o
+// resultado é ±inf ou ±0, montado aqui. Sem from_chars de ponto flutuante (libstdc++
+// antes do GCC 11, libc++ antiga) o último recurso é strtod/strtof, que seguem o
+// LC_NUMERIC: com um locale de vírgula decimal esses números seriam lidos errado (os
+// programas daqui não chamam setlocale, então vale o "C").
+//
+// Para as faces do OBJ, findDelimiter e countTokens varrem 16 bytes por vez com SSE2.
+
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <system_error>
+
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CG_PARSE_SSE2 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace number_parse_detail {
+
+// Com FLT_EVAL_METHOD != 0 (x87) as contas em double usam precisão estendida e o
+// caminho rápido deixa de ser exato
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+const bool FastPath = false;
+#else
+const bool FastPath = true;
+#endif
+
+const double Pow10[23] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+const uint64_t MaxExactMantissa = uint64_t(1) << 53;
+
+inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Número decimal lido: value = ±mantissa * 10^exponent; exact = false se dígitos
+// significativos não couberam na mantissa
+struct Decimal {
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    bool negative = false;
+    bool exact = true;
+    const char* digits = nullptr;   // depois do sinal
+    const char* end = nullptr;      // == início quando não há número
+};
+
+inline Decimal scanDecimal(const char* first, const char* last) {
+    Decimal number;
+    const char* p = first;
+    number.end = first;
+    if (p < last && (*p == '-' || *p == '+')) {
+        number.negative = *p == '-';
+        ++p;
+    }
+    number.digits = p;
+    int significant = 0;
+    bool any = false;
+    for (; p < last && isDigit(*p); ++p) {
+        any = true;
+        int digit = *p - '0';
+        if (significant < 19) {
+            if (number.mantissa || digit) {
+                number.mantissa = number.mantissa * 10 + digit;
+                ++significant;
+            }
+        } else {
+            ++number.exponent;
+            if (digit) number.exact = false;
+        }
+    }
+    if (p < last && *p == '.') {
+        ++p;
+        for (; p < last && isDigit(*p); ++p) {
+            any = true;
+            int digit = *p - '0';
+            if (significant < 19) {
+                if (number.mantissa || digit) {
+                    number.mantissa = number.mantissa * 10 + digit;
+                    ++significant;
+                }
+                --number.exponent;
+            } else if (digit) {
+                number.exact = false;
+            }
+        }
+    }
+    if (!any) return number;
+    if (p < last && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        bool negativeExponent = q < last && *q == '-';
+        if (q < last && (*q == '-' || *q == '+')) ++q;
+        if (q < last && isDigit(*q)) {
+            int64_t exponent = 0;
+            for (; q < last && isDigit(*q); ++q)
+                if (exponent < 100000) exponent = exponent * 10 + (*q - '0');
+            number.exponent += negativeExponent ? -exponent : exponent;
+            p = q;
+        }
+    }
+    number.end = p;
+    return number;
+}
+
+// Caminho de Clinger; false quando o resultado não seria exato
+inline bool fastDouble(const Decimal& number, double& value) {
+    if (!FastPath || !number.exact) return false;
+    if (number.mantissa == 0) {
+        value = number.negative ? -0.0 : 0.0;
+        return true;
+    }
+    uint64_t mantissa = number.mantissa;
+    int64_t exponent = number.exponent;
+    if (mantissa > MaxExactMantissa) return false;
+    // 1e30 = 10000000 * 1e22: passa potências para a mantissa enquanto ela continuar exata
+    while (exponent > 22 && mantissa <= MaxExactMantissa / 10) {
+        mantissa *= 10;
+        --exponent;
+    }
+    if (exponent < -22 || exponent > 22) return false;
+    double result = (double)mantissa;
+    result = exponent < 0 ? result / Pow10[-exponent] : result * Pow10[exponent];
+    value = number.negative ? -result : result;
+    return true;
+}
+
+// Último recurso: número já delimitado em [digits, end)
+template <typename T>
+T slowParse(const Decimal& number) {
+    T value = 0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars_result result = std::from_chars(number.digits, number.end, value);
+    if (result.ec == std::errc::result_out_of_range) {
+        // from_chars não escreve o valor: grande demais vira inf e pequeno demais vira 0
+        // (ordem de grandeza = expoente + dígitos da mantissa - 1), como no strtod
+        int digits = 0;
+        for (uint64_t mantissa = number.mantissa; mantissa; mantissa /= 10) ++digits;
+        value = number.exponent + digits > 0 ? std::numeric_limits<T>::infinity() : T(0);
+        return number.negative ? -value : value;
+    }
+    if (result.ec == std::errc() && result.ptr == number.end)
+        return number.negative ? -value : value;
+#endif
+    // Sem from_chars: strtod/strtof (dependem do LC_NUMERIC, ver o início do arquivo)
+    char local[64];
+    size_t length = (size_t)(number.end - number.digits);
+    std::string heap;
+    char* text = local;
+    if (length >= sizeof(local)) {
+        heap.assign(number.digits, length);
+        text = &heap[0];
+    } else {
+        std::memcpy(local, number.digits, length);
+        local[length] = '\0';
+    }
+    value = sizeof(T) == sizeof(float) ? (T)std::strtof(text, nullptr) : (T)std::strtod(text, nullptr);
+    return number.negative ? -value : value;
+}
+
+inline int countTrailingZeros(uint32_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline int popCount(uint32_t mask) {
+#ifdef _MSC_VER
+    return (int)__popcnt(mask);
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool isDelimiter(char c) { return isBlank(c) || c == '\n' || c == '/'; }
+
+#ifdef CG_PARSE_SSE2
+// Bits dos bytes ' ', '\t' e '\r' dos 16 bytes em "p"
+inline uint32_t blankMask(__m128i bytes) {
+    __m128i blank = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t'))),
+                                 _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\r')));
+    return (uint32_t)_mm_movemask_epi8(blank);
+}
+#endif
+
+} // namespace number_parse_detail
+
+inline const char* skipBlanks(const char* first, const char* last) {
+    while (first < last && number_parse_detail::isBlank(*first)) ++first;
+    return first;
+}
+
+// Primeiro ' ', '\t', '\r', '\n' ou '/' em [first, last), ou last
+inline const char* findDelimiter(const char* first, const char* last) {
+    using namespace number_parse_detail;
+#ifdef CG_PARSE_SSE2
+    while (last - first >= 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)first);
+        __m128i other = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('/')));
+        uint32_t mask = blankMask(bytes) | (uint32_t)_mm_movemask_epi8(other);
+        if (mask) return first + countTrailingZeros(mask);
+        first += 16;
+    }
+#endif
+    while (first < last && !isDelimiter(*first)) ++first;
+    return first;
+}
+
+// Número de palavras separadas por ' ', '\t' ou '\r' em [first, last) (a linha, sem '\n')
+inline int countTokens(const char* first, const char* last) {
+    using namespace number_parse_detail;
+    int tokens = 0;
+    bool previousBlank = true;
+#ifdef CG_PARSE_SSE2
+    while (last - first >= 16) {
+        uint32_t blank = blankMask(_mm_loadu_si128((const __m128i*)first));
+        // Início de palavra: byte não branco com um branco (ou o bloco anterior) antes
+        uint32_t starts = ~blank & ((blank << 1) | (previousBlank ? 1u : 0u)) & 0xFFFFu;
+        tokens += popCount(starts);
+        previousBlank = (blank >> 15) & 1;
+        first += 16;
+    }
+#endif
+    for (; first < last; ++first) {
+        bool blank = isBlank(*first);
+        if (!blank && previousBlank) ++tokens;
+        previousBlank = blank;
+    }
+    return tokens;
+}
+
+// Inteiro decimal com sinal opcional; satura em vez de estourar
+inline const char* parseInteger(const char* first, const char* last, int64_t& value) {
+    const char* p = first;
+    bool negative = p < last && *p == '-';
+    if (p < last && (*p == '-' || *p == '+')) ++p;
+    if (p >= last || !number_parse_detail::isDigit(*p)) return first;
+    int64_t result = 0;
+    for (; p < last && number_parse_detail::isDigit(*p); ++p)
+        result = result < INT64_MAX / 10 ? result * 10 + (*p - '0') : INT64_MAX;
+    value = negative ? -result : result;
+    return p;
+}
+
+inline const char* parseDouble(const char* first, const char* last, double& value) {
+    number_parse_detail::Decimal number = number_parse_detail::scanDecimal(first, last);
+    if (number.end == first) return first;
+    if (!number_parse_detail::fastDouble(number, value))
+        value = number_parse_detail::slowParse<double>(number);
+    return number.end;
+}
+
+inline const char* parseFloat(const char* first, const char* last, float& value) {
+    using namespace number_parse_detail;
+    Decimal number = scanDecimal(first, last);
+    if (number.end == first) return first;
+    double exact;
+    if (fastDouble(number, exact)) {
+        // Fora do meio exato entre dois floats normais, arredondar de novo não muda nada
+        uint64_t bits;
+        std::memcpy(&bits, &exact, sizeof(bits));
+        double magnitude = exact < 0.0 ? -exact : exact;
+        if (exact == 0.0 || (magnitude >= FLT_MIN && (bits & 0x1FFFFFFFu) != 0x10000000u)) {
+            value = (float)exact;
+            return number.end;
+        }
+    }
+    value = slowParse<float>(number);
+    return number.end;
+}
+
+// Até "count" floats separados por brancos (como "iss >> x >> y >> z"); os que faltam
+// ficam zero. Devolve o ponteiro depois do último lido
+inline const char* parseFloats(const char* first, const char* last, float* values, int count) {
+    for (int i = 0; i < count; ++i) {
+        first = skipBlanks(first, last);
+        const char* next = parseFloat(first, last, values[i]);
+        if (next == first) {
+            for (; i < count; ++i) values[i] = 0.0f;
+            break;
+        }
+        first = next;
+    }
+    return first;
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+// OBJ com vários materiais: a tabela de materiais de todos os "mtllib" (newmtl, Ka, Kd,
+// Ks, Ke, Ns, Ni, d/Tr, illum e os map_*) e as faces agrupadas por "usemtl" em faixas
+// contíguas de índices, na ordem da tabela. Desenhar uma faixa por material (veja
+// MaterialDrawList.h) troca de material uma vez por material, não a cada "usemtl".
+//
+// A leitura segue loadObjTriangles (ObjMesh.h), inclusive o "1 - v" da textura, e
+// também aceita polígonos (divididos em leque) e índices negativos. Normais que faltam
+// são geradas (MeshNormals.h). Não depende de OpenGL.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "MeshNormals.h"
+#include "ObjMesh.h"
+
+struct ObjMaterial {
+    std::string name;
+    glm::vec3 ambient = glm::vec3(0.2f);    // Ka
+    glm::vec3 diffuse = glm::vec3(0.8f);    // Kd
+    glm::vec3 specular = glm::vec3(0.0f);   // Ks
+    glm::vec3 emissive = glm::vec3(0.0f);   // Ke
+    float shininess = 0.0f;                 // Ns
+    float refraction = 1.0f;                // Ni
+    float opacity = 1.0f;                   // d, ou 1 - Tr
+    int illum = 2;
+    // Caminhos já resolvidos em relação ao MTL; vazios quando não há mapa
+    std::string diffuseMap, specularMap, normalMap, alphaMap;
+};
+
+// Faixa [firstIndex, firstIndex + indexCount) de MaterialMesh::indices com um material
+struct MaterialRange {
+    int material;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+struct MaterialMesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<ObjMaterial> materials;
+    std::vector<MaterialRange> ranges;   // uma por material usado, na ordem da tabela
+    std::vector<MaterialRange> runs;     // um trecho por "usemtl" na ordem do arquivo (como o OBJ desenharia sem agrupar)
+};
+
+namespace obj_detail {
+
+inline std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+// Último token da linha (os map_* podem ter opções como "-bm 0.5" antes do arquivo)
+inline std::string mapPath(const char* p, const char* end, const std::string& directory) {
+    std::string path;
+    while ((p = skipBlanks(p, end)) < end) {
+        const char* tokenEnd = p;
+        while (tokenEnd < end && !number_parse_detail::isBlank(*tokenEnd)) ++tokenEnd;
+        path.assign(p, tokenEnd);
+        p = tokenEnd;
+    }
+    if (path.empty() || path.find(':') != std::string::npos || path[0] == '/')
+        return path;
+    return directory + path;
+}
+
+// "r [g b]" do MTL: um valor só vale para os três; sem valores a cor não muda
+inline void parseColor(const char* p, const char* end, glm::vec3& color) {
+    float values[3];
+    int count = 0;
+    for (; count < 3; ++count) {
+        p = skipBlanks(p, end);
+        const char* next = parseFloat(p, end, values[count]);
+        if (next == p) break;
+        p = next;
+    }
+    if (count == 1) color = glm::vec3(values[0]);
+    for (int i = 0; i < count && count > 1; ++i) color[i] = values[i];
+}
+
+// Resto da linha sem os brancos das pontas (nomes de material podem ter espaços)
+inline std::string lineRest(const char* p, const char* end) {
+    p = skipBlanks(p, end);
+    while (end > p && number_parse_detail::isBlank(end[-1])) --end;
+    return std::string(p, end);
+}
+
+} // namespace obj_detail
+
+// Acrescenta os materiais de "mtlPath" a "materials"; retorna false se o arquivo não abrir
+inline bool loadMtl(const std::string& mtlPath, std::vector<ObjMaterial>& materials) {
+    std::ifstream file(mtlPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open MTL file: " << mtlPath << std::endl;
+        return false;
+    }
+    std::string directory = obj_detail::directoryOf(mtlPath);
+    ObjMaterial* current = nullptr;
+
+    // Números com parseFloat (NumberParse.h): sem locale, como no OBJ
+    using obj_detail::keyword;
+    std::string line;
+    while (std::getline(file, line)) {
+        const char* p = line.data();
+        const char* end = p + line.size();
+        if (keyword(p, end, "newmtl")) {
+            materials.emplace_back();
+            current = &materials.back();
+            current->name = obj_detail::lineRest(p, end);
+        } else if (!current) {
+            continue;
+        } else if (keyword(p, end, "Ka")) {
+            obj_detail::parseColor(p, end, current->ambient);
+        } else if (keyword(p, end, "Kd")) {
+            obj_detail::parseColor(p, end, current->diffuse);
+        } else if (keyword(p, end, "Ks")) {
+            obj_detail::parseColor(p, end, current->specular);
+        } else if (keyword(p, end, "Ke")) {
+            obj_detail::parseColor(p, end, current->emissive);
+        } else if (keyword(p, end, "Ns")) {
+            parseFloat(skipBlanks(p, end), end, current->shininess);
+        } else if (keyword(p, end, "Ni")) {
+            parseFloat(skipBlanks(p, end), end, current->refraction);
+        } else if (keyword(p, end, "d")) {
+            parseFloat(skipBlanks(p, end), end, current->opacity);
+        } else if (keyword(p, end, "Tr")) {
+            float transparency = 0.0f;
+            parseFloat(skipBlanks(p, end), end, transparency);
+            current->opacity = 1.0f - transparency;
+        } else if (keyword(p, end, "illum")) {
+            int64_t illum = 0;
+            p = skipBlanks(p, end);
+            if (parseInteger(p, end, illum) != p) current->illum = (int)illum;
+        } else if (keyword(p, end, "map_Kd")) {
+            current->diffuseMap = obj_detail::mapPath(p, end, directory);
+        } else if (keyword(p, end, "map_Ks")) {
+            current->specularMap = obj_detail::mapPath(p, end, directory);
+        } else if (keyword(p, end, "map_Bump") || keyword(p, end, "map_bump") || keyword(p, end, "bump") || keyword(p, end, "norm")) {
+            current->normalMap = obj_detail::mapPath(p, end, directory);
+        } else if (keyword(p, end, "map_d")) {
+            current->alphaMap = obj_detail::mapPath(p, end, directory);
+        }
+    }
+    return true;
+}
+
+// Lê o OBJ e os seus MTL; retorna false se o OBJ não abrir (MTL ausente só gera aviso,
+// e os materiais citados ficam com os valores padrão)
+inline bool loadObjWithMaterials(const std::string& objPath, MaterialMesh& mesh) {
+    std::ifstream file(objPath);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open OBJ file: " << objPath << std::endl;
+        return false;
+    }
+    std::string directory = obj_detail::directoryOf(objPath);
+
+    mesh = MaterialMesh();
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<MeshVertex> corners;        // 3 por triângulo, na ordem do arquivo
+    std::vector<int> triangleMaterials;     // índice em usedNames até o fim da leitura
+    std::vector<std::string> usedNames;
+    std::unordered_map<std::string, int> usedByName;
+    int currentMaterial = -1;
+
+    auto usedIndex = [&](const std::string& name) {
+        auto inserted = usedByName.emplace(name, (int)usedNames.size());
+        if (inserted.second) usedNames.push_back(name);
+        return inserted.first->second;
+    };
+
+    std::string line;
+    std::vector<MeshVertex> polygon;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        const char* p = line.data();
+        const char* end = p + line.size();
+
+        if (obj_detail::keyword(p, end, "v")) {
+            glm::vec3 position;
+            parseFloats(p, end, &position.x, 3);
+            positions.push_back(position);
+        } else if (obj_detail::keyword(p, end, "vn")) {
+            glm::vec3 normal;
+            parseFloats(p, end, &normal.x, 3);
+            normals.push_back(normal);
+        } else if (obj_detail::keyword(p, end, "vt")) {
+            glm::vec2 texCoord;
+            parseFloats(p, end, &texCoord.x, 2);
+            texCoord.y = 1.0f - texCoord.y;
+            texCoords.push_back(texCoord);
+        } else if (obj_detail::keyword(p, end, "mtllib")) {
+            std::istringstream iss(std::string(p, end));
+            std::string name;
+            while (iss >> name)
+                loadMtl(directory + name, mesh.materials);
+        } else if (obj_detail::keyword(p, end, "usemtl")) {
+            currentMaterial = usedIndex(obj_detail::lineRest(p, end));
+        } else if (obj_detail::keyword(p, end, "f")) {
+            polygon.clear();
+            while ((p = skipBlanks(p, end)) < end) {
+                MeshVertex vertex = {};
+                int64_t indices[3];
+                p = obj_detail::parseCorner(p, end, indices);
+                int64_t position = obj_detail::resolveIndex(indices[0], positions.size());
+                int64_t texCoord = obj_detail::resolveIndex(indices[1], texCoords.size());
+                int64_t normal = obj_detail::resolveIndex(indices[2], normals.size());
+                if (position >= 0) vertex.position = positions[position];
+                if (texCoord >= 0) vertex.texCoord = texCoords[texCoord];
+                if (normal >= 0) vertex.normal = normals[normal];
+                polygon.push_back(vertex);
+            }
+            if (currentMaterial < 0)
+                currentMaterial = usedIndex("default");
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                corners.push_back(polygon[0]);
+                corners.push_back(polygon[i - 1]);
+                corners.push_back(polygon[i]);
+                triangleMaterials.push_back(currentMaterial);
+            }
+        }
+    }
+
+    fillMissingNormals(corners);
+
+    // Nomes resolvidos só depois de ler todos os MTL ("usemtl" antes do "mtllib" acha o
+    // material do arquivo); os que não existem entram no fim com os valores padrão
+    std::unordered_map<std::string, int> byName;
+    for (size_t m = 0; m < mesh.materials.size(); ++m)
+        byName.emplace(mesh.materials[m].name, (int)m);
+    std::vector<int> resolved(usedNames.size());
+    for (size_t u = 0; u < usedNames.size(); ++u) {
+        auto found = byName.find(usedNames[u]);
+        if (found != byName.end()) {
+            resolved[u] = found->second;
+            continue;
+        }
+        mesh.materials.emplace_back();
+        mesh.materials.back().name = usedNames[u];
+        resolved[u] = (int)mesh.materials.size() - 1;
+    }
+    for (int& material : triangleMaterials)
+        material = resolved[material];
+
+    // Ordenação estável por material (contagem): cada trecho do arquivo continua contíguo
+    size_t triangleCount = triangleMaterials.size();
+    std::vector<uint32_t> starts(mesh.materials.size() + 1, 0);
+    for (int material : triangleMaterials)
+        ++starts[material + 1];
+    for (size_t m = 0; m < mesh.materials.size(); ++m)
+        starts[m + 1] += starts[m];
+    std::vector<uint32_t> cursor(starts.begin(), starts.end() - 1);
+    std::vector<uint32_t> sortedSlot(triangleCount);
+    std::vector<MeshVertex> sorted(corners.size());
+    for (size_t t = 0; t < triangleCount; ++t) {
+        uint32_t slot = cursor[triangleMaterials[t]]++;
+        sortedSlot[t] = slot;
+        std::copy(corners.begin() + 3 * t, corners.begin() + 3 * t + 3, sorted.begin() + 3 * slot);
+    }
+    indexTriangles(sorted, mesh.vertices, mesh.indices);
+
+    for (size_t m = 0; m < mesh.materials.size(); ++m)
+        if (starts[m + 1] > starts[m])
+            mesh.ranges.push_back({(int)m, 3 * starts[m], 3 * (starts[m + 1] - starts[m])});
+    for (size_t t = 0; t < triangleCount; ++t) {
+        if (t == 0 || triangleMaterials[t] != triangleMaterials[t - 1])
+            mesh.runs.push_back({triangleMaterials[t], 3 * sortedSlot[t], 0});
+        mesh.runs.back().indexCount += 3;
+    }
+    return true;
+}
+
+// OBJ/MTL sintéticos para testes e benchmarks: uma grade de "quads" quadrados, cada um
+// com um material sorteado entre "materialCount" (os "usemtl" trocam a todo momento).
+// Os quads alternam índices positivos e negativos, há um triângulo antes do primeiro
+// "usemtl" (material "default") e o material i tem Kd = (i / materialCount, 0.5, 1) e
+// Ns = i. trianglesPerMaterial recebe quantos triângulos cada material deve ter
+// ("default" por último).
+inline bool writeSyntheticMaterialObj(const std::string& objPath, int materialCount, int quadCount, unsigned seed,
+                                      std::vector<size_t>* trianglesPerMaterial = nullptr) {
+    std::string mtlPath = objPath.substr(0, objPath.find_last_of('.')) + ".mtl";
+    std::string mtlName = mtlPath.substr(mtlPath.find_last_of("/\\") + 1);
+    std::ofstream mtl(mtlPath), obj(objPath);
+    if (!mtl.is_open() || !obj.is_open()) {
+        std::cerr << "Failed to write " << objPath << std::endl;
+        return false;
+    }
+
+    for (int m = 0; m < materialCount; ++m) {
+        mtl << "newmtl synthetic_" << m << "\n"
+            << "Ka 0.1 0.1 0.1\n"
+            << "Kd " << (float)m / materialCount << " 0.5 1\n"
+            << "Ks 0.5 0.5 0.5\n"
+            << "Ns " << m << "\n"
+            << "d 1\nillum 2\n\n";
+    }
+
+    std::vector<size_t> counts(materialCount + 1, 0);
+    obj << "mtllib " << mtlName << "\n"
+        << "v 0 0 -1\nv 1 0 -1\nv 0 1 -1\nvt 0 0\nvt 1 0\nvt 0 1\nvn 0 0 1\n"
+        << "f 1/1/1 2/2/1 3/3/1\n";
+    counts[materialCount] = 1;
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> pick(0, materialCount - 1);
+    int columns = (int)std::ceil(std::sqrt((double)quadCount));
+    int vertexCount = 3;
+    for (int q = 0; q < quadCount; ++q) {
+        float x = (float)(q % columns), y = (float)(q / columns);
+        obj << "v " << x << " " << y << " 0\nv " << x + 1 << " " << y << " 0\nv " << x + 1 << " " << y + 1 << " 0\nv " << x << " " << y + 1 << " 0\n";
+        vertexCount += 4;
+        int material = pick(random);
+        obj << "usemtl synthetic_" << material << "\n";
+        if (q % 2 == 0)
+            obj << "f " << vertexCount - 3 << "//1 " << vertexCount - 2 << "//1 " << vertexCount - 1 << "//1 " << vertexCount << "//1\n";
+        else
+            obj << "f -4//1 -3//1 -2//1 -1//1\n";
+        counts[material] += 2;
+    }
+    if (trianglesPerMaterial)
+        *trianglesPerMaterial = counts;
+    return true;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+// Leitura de OBJ para a CPU, no mesmo formato que os exercícios enviam à GPU:
+// uma lista de triângulos (sem índices) com posição, normal e coordenada de textura
+// por vértice. O parsing segue loadSuzanneModel (inclusive o "1 - v" da textura),
+// para que as ferramentas de CPU vejam exatamente a mesma geometria que o OpenGL.
+// Os números são lidos com NumberParse.h (mesmo resultado que "iss >> float").
+// Não depende de OpenGL.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "NumberParse.h"
+
+struct MeshVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+namespace obj_detail {
+
+// Arquivo inteiro em "text"; false se não abrir
+inline bool readText(const std::string& path, std::string& text) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file.seekg(0, std::ios::end);
+    text.resize((size_t)file.tellg());
+    file.seekg(0, std::ios::beg);
+    file.read(&text[0], (std::streamsize)text.size());
+    return true;
+}
+
+// Palavra-chave da linha em [p, end) (a primeira palavra); p fica depois dela
+inline bool keyword(const char*& p, const char* end, const char* word) {
+    const char* start = skipBlanks(p, end);
+    size_t length = std::strlen(word);
+    if ((size_t)(end - start) < length || std::memcmp(start, word, length) != 0) return false;
+    if (start + length < end && !number_parse_detail::isBlank(start[length])) return false;
+    p = start + length;
+    return true;
+}
+
+// Um vértice de face "v", "v/vt", "v//vn" ou "v/vt/vn" com os índices do arquivo
+// (0 = ausente); p fica no fim da palavra
+inline const char* parseCorner(const char* p, const char* end, int64_t indices[3]) {
+    indices[0] = indices[1] = indices[2] = 0;
+    for (int i = 0; i < 3; ++i) {
+        p = parseInteger(p, end, indices[i]);
+        p = findDelimiter(p, end);
+        if (p >= end || *p != '/') break;
+        ++p;
+    }
+    while (p < end && !number_parse_detail::isBlank(*p)) ++p;
+    return p;
+}
+
+// Índice de OBJ (1..N, ou negativo a partir do fim) para 0..N-1; -1 se ausente ou inválido
+inline int64_t resolveIndex(int64_t index, uint64_t count) {
+    if (index < 0) index += (int64_t)count;
+    else index -= 1;
+    return index >= 0 && (uint64_t)index < count ? index : -1;
+}
+
+} // namespace obj_detail
+
+// Preenche "vertices" com 3 vértices por triângulo; retorna false se o arquivo não abrir.
+// Sem "vn" a normal fica zero (fillMissingNormals, em MeshNormals.h, completa)
+inline bool loadObjTriangles(const std::string& objPath, std::vector<MeshVertex>& vertices, AABB* bounds = nullptr) {
+    std::string text;
+    if (!obj_detail::readText(objPath, text)) {
+        std::cerr << "Failed to open OBJ file: " << objPath << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> texCoords;
+    vertices.clear();
+
+    const char* p = text.data();
+    const char* last = p + text.size();
+    while (p < last) {
+        const char* end = (const char*)std::memchr(p, '\n', (size_t)(last - p));
+        if (!end) end = last;
+
+        if (obj_detail::keyword(p, end, "v")) {
+            glm::vec3 position;
+            parseFloats(p, end, &position.x, 3);
+            positions.push_back(position);
+            if (bounds) bounds->expand(position);
+        } else if (obj_detail::keyword(p, end, "vn")) {
+            glm::vec3 normal;
+            parseFloats(p, end, &normal.x, 3);
+            normals.push_back(normal);
+        } else if (obj_detail::keyword(p, end, "vt")) {
+            glm::vec2 texCoord;
+            parseFloats(p, end, &texCoord.x, 2);
+            texCoord.y = 1.0f - texCoord.y;
+            texCoords.push_back(texCoord);
+        } else if (obj_detail::keyword(p, end, "f")) {
+            while ((p = skipBlanks(p, end)) < end) {
+                MeshVertex vertex = {};
+                int64_t indices[3];
+                p = obj_detail::parseCorner(p, end, indices);
+                int64_t position = obj_detail::resolveIndex(indices[0], positions.size());
+                int64_t texCoord = obj_detail::resolveIndex(indices[1], texCoords.size());
+                int64_t normal = obj_detail::resolveIndex(indices[2], normals.size());
+                if (position >= 0) vertex.position = positions[position];
+                if (texCoord >= 0) vertex.texCoord = texCoords[texCoord];
+                if (normal >= 0) vertex.normal = normals[normal];
+                vertices.push_back(vertex);
+            }
+        }
+        p = end + 1;
+    }
+    return true;
+}
+
+// Lista de triângulos -> vértices únicos + índices (vértices iguais bit a bit viram um só)
+inline void indexTriangles(const std::vector<MeshVertex>& triangles, std::vector<MeshVertex>& vertices, std::vector<uint32_t>& indices) {
+    struct Key {
+        uint32_t words[8];
+        bool operator==(const Key& other) const { return std::memcmp(words, other.words, sizeof(words)) == 0; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t hash = 1469598103934665603ull;
+            for (uint32_t word : key.words)
+                hash = (hash ^ word) * 1099511628211ull;
+            return (size_t)hash;
+        }
+    };
+    static_assert(sizeof(MeshVertex) == sizeof(Key), "MeshVertex layout changed");
+
+    std::unordered_map<Key, uint32_t, KeyHash> unique;
+    unique.reserve(triangles.size());
+    vertices.clear();
+    indices.clear();
+    indices.reserve(triangles.size());
+    for (const MeshVertex& vertex : triangles) {
+        Key key;
+        std::memcpy(key.words, &vertex, sizeof(Key));
+        auto inserted = unique.emplace(key, (uint32_t)vertices.size());
+        if (inserted.second)
+            vertices.push_back(vertex);
+        indices.push_back(inserted.first->second);
+    }
+}
@@ -0,0 +1,587 @@
+#pragma once
+
+// Importação de OBJ maior que a memória, em duas passadas sobre o arquivo:
+//
+//   1. conta os elementos e registra os trechos do arquivo com faces (alinhados em
+//      linhas, cada um cabe no buffer de leitura) com os contadores do início de cada
+//      um; os "v", "vt" e "vn" vão, já convertidos, para arquivos temporários binários;
+//   2. relê só esses trechos e escreve os triângulos (3 MeshVertex cada, como
+//      loadObjTriangles) direto no destino, em blocos de tamanho fixo. Os atributos
+//      vêm de um cache de páginas dos arquivos temporários.
+//
+// O destino sabe o total de vértices antes da segunda passada e pode pré-alocar:
+// ObjBlobWriter grava um arquivo binário (ObjBlobHeader + vértices) e ObjBufferUpload
+// (ObjStreamUpload.h) escreve num buffer GL mapeado. Buffer de leitura, bloco de saída
+// e cache de páginas ficam dentro de ObjStreamOptions::memoryBudget; o resto (lista de
+// trechos, tabelas página -> slot e uma reserva para buffers do stdio) é descontado do
+// cache. Na primeira passada os buffers de escrita dos atributos (512 KB) ocupam o lugar
+// do bloco de saída. Só a lista de trechos cresce com o arquivo (48 bytes a cada
+// readBytes de faces: ~1 MB para 10 GB de faces com o mínimo de 4 MB, 15 KB com
+// 256 MB); se ela não deixar ao menos uma página por atributo, o orçamento é
+// excedido. Aceita polígonos (em leque) e índices negativos; sem "vn" as normais
+// ficam zero (fillMissingNormals precisa da malha inteira). Não depende de OpenGL.
+//
+// Um destino tem:
+//
+//   bool begin(uint64_t vertexCount);
+//   MeshVertex* map(uint64_t firstVertex, size_t count);   // onde escrever o bloco
+//   bool unmap();                                         // bloco escrito
+//   bool end(const ObjStreamStats& stats);
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "NumberParse.h"
+#include "ObjMesh.h"
+
+struct ObjStreamOptions {
+    size_t memoryBudget = size_t(256) << 20;   // leitura + saída + cache de atributos + controle
+    std::string scratchDirectory;              // arquivos temporários (vazio = ao lado do OBJ)
+    size_t cacheLimit = 0;                     // teto do cache de atributos (0 = o resto do
+                                               // orçamento); um teto pequeno força o LRU nos testes
+};
+
+struct ObjStreamStats {
+    uint64_t fileBytes = 0;
+    uint64_t positions = 0, texCoords = 0, normals = 0;
+    uint64_t faces = 0, triangles = 0;
+    uint64_t chunks = 0;          // trechos relidos na segunda passada
+    uint64_t pageLoads = 0;       // páginas de atributos lidas do disco
+    size_t readBytes = 0, outputBytes = 0, cacheBytes = 0;   // divisão do orçamento
+    double countMs = 0.0, streamMs = 0.0;
+    AABB bounds;
+};
+
+namespace obj_stream_detail {
+
+const size_t MinimumBudget = size_t(4) << 20;
+const uint64_t PageShift = 14;   // 16384 elementos por página
+const uint64_t PageElements = uint64_t(1) << PageShift;
+const size_t FixedReserve = size_t(64) << 10;   // buffers do stdio, cantos da face, etc.
+
+inline bool seek(std::FILE* file, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(file, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// Tipo da linha em [p, end): 'v', 't' (vt), 'n' (vn), 'f' ou 0
+inline char lineKind(const char*& p, const char* end) {
+    using number_parse_detail::isBlank;
+    p = skipBlanks(p, end);
+    if (end - p < 2) return 0;
+    if (p[0] == 'f' && isBlank(p[1])) { p += 2; return 'f'; }
+    if (p[0] != 'v') return 0;
+    if (isBlank(p[1])) { p += 2; return 'v'; }
+    if (end - p >= 3 && (p[1] == 't' || p[1] == 'n') && isBlank(p[2])) {
+        char kind = p[1];
+        p += 3;
+        return kind;
+    }
+    return 0;
+}
+
+// Um atributo (2 ou 3 floats por elemento) gravado num arquivo temporário na primeira
+// passada e lido por páginas na segunda, com no máximo "slots" páginas na memória (LRU)
+class AttributeFile {
+public:
+    ~AttributeFile() { close(); }
+
+    bool open(const std::string& filePath, int componentCount) {
+        path = filePath;
+        components = componentCount;
+        file = std::fopen(path.c_str(), "w+b");
+        if (!file) {
+            std::cerr << "Failed to create scratch file: " << path << std::endl;
+            return false;
+        }
+        pending.reserve(PageElements * components);
+        return true;
+    }
+
+    void append(const float* values) {
+        pending.insert(pending.end(), values, values + components);
+        ++count;
+        if (pending.size() >= PageElements * components) flush();
+    }
+
+    // Fim da primeira passada: libera o buffer de escrita e reserva "bytes" de cache
+    bool finishWriting(size_t bytes) {
+        flush();
+        std::vector<float>().swap(pending);
+        if (!file || std::fflush(file) != 0) return false;
+        uint64_t pageCount = (count + PageElements - 1) >> PageShift;
+        size_t slots = (size_t)std::min<uint64_t>(pageCount, std::max<size_t>(1, bytes / (pageBytes() + 2 * sizeof(uint64_t))));
+        storage.assign(slots * PageElements * components, 0.0f);
+        slotPage.assign(slots, UINT64_MAX);
+        slotUse.assign(slots, 0);
+        pageSlot.assign((size_t)pageCount, -1);
+        return !failed;
+    }
+
+    // Elemento "index" (já validado); nullptr se a leitura falhar
+    const float* get(uint64_t index) {
+        uint64_t page = index >> PageShift;
+        int slot = pageSlot[(size_t)page];
+        if (slot < 0) {
+            slot = 0;
+            for (size_t s = 1; s < slotUse.size(); ++s)
+                if (slotUse[s] < slotUse[slot]) slot = (int)s;
+            if (slotPage[slot] != UINT64_MAX) pageSlot[(size_t)slotPage[slot]] = -1;
+            size_t elements = (size_t)std::min<uint64_t>(PageElements, count - (page << PageShift));
+            float* destination = storage.data() + (size_t)slot * PageElements * components;
+            if (!seek(file, (page << PageShift) * components * sizeof(float))
+                || std::fread(destination, sizeof(float) * components, elements, file) != elements) {
+                slotPage[slot] = UINT64_MAX;
+                slotUse[slot] = 0;
+                return nullptr;
+            }
+            slotPage[slot] = page;
+            pageSlot[(size_t)page] = slot;
+            ++loads;
+        }
+        slotUse[slot] = ++clock;
+        return storage.data() + ((size_t)slot * PageElements + (size_t)(index & (PageElements - 1))) * components;
+    }
+
+    void close() {
+        if (file) {
+            std::fclose(file);
+            std::remove(path.c_str());
+            file = nullptr;
+        }
+    }
+
+    size_t pageBytes() const { return PageElements * components * sizeof(float); }
+    size_t pageTableBytes() const { return (size_t)((count + PageElements - 1) >> PageShift) * sizeof(int); }
+    uint64_t fileBytes() const { return count * components * sizeof(float); }
+
+    uint64_t count = 0;
+    uint64_t loads = 0;
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    int components = 3;
+    bool failed = false;
+    std::vector<float> pending;
+    std::vector<float> storage;
+    std::vector<uint64_t> slotPage, slotUse;
+    std::vector<int> pageSlot;
+    uint64_t clock = 0;
+
+    void flush() {
+        if (pending.empty()) return;
+        if (!file || std::fwrite(pending.data(), sizeof(float), pending.size(), file) != pending.size())
+            failed = true;
+        pending.clear();
+    }
+};
+
+// Trecho do OBJ com faces e os contadores no seu início (índices negativos e posição na saída)
+struct Chunk {
+    uint64_t offset;
+    uint64_t positions, texCoords, normals;
+    uint64_t firstTriangle;
+    uint32_t size;
+};
+
+// Lê o arquivo em trechos terminados em '\n' de até buffer.size() bytes e chama
+// visit(offset, begin, end) para cada um
+template <typename Visit>
+bool forEachChunk(std::FILE* file, std::vector<char>& buffer, Visit visit) {
+    uint64_t offset = 0;
+    size_t filled = 0;
+    size_t capacity = buffer.size();
+    while (true) {
+        size_t read = std::fread(buffer.data() + filled, 1, capacity - filled, file);
+        filled += read;
+        bool last = filled < capacity;
+        if (filled == 0) return true;
+        size_t length = filled;
+        if (!last) {
+            const char* newline = nullptr;
+            for (size_t i = filled; i-- > 0;)
+                if (buffer[i] == '\n') { newline = buffer.data() + i; break; }
+            if (!newline) {
+                std::cerr << "OBJ line longer than the read buffer (" << capacity << " bytes)" << std::endl;
+                return false;
+            }
+            length = (size_t)(newline - buffer.data()) + 1;
+        }
+        if (!visit(offset, buffer.data(), buffer.data() + length)) return false;
+        std::memmove(buffer.data(), buffer.data() + length, filled - length);
+        filled -= length;
+        offset += length;
+        if (last && filled == 0) return true;
+    }
+}
+
+inline std::string scratchPath(const std::string& objPath, const std::string& directory, const char* suffix) {
+    std::string name = objPath.substr(objPath.find_last_of("/\\") + 1);
+    if (directory.empty()) return objPath + suffix;
+    char last = directory.back();
+    return directory + (last == '/' || last == '\\' ? "" : "/") + name + suffix;
+}
+
+} // namespace obj_stream_detail
+
+// Importa "objPath" para "sink" sem carregar o arquivo inteiro; retorna false em erro
+// de leitura/escrita (a mensagem vai para std::cerr)
+template <typename Sink>
+bool streamObj(const std::string& objPath, Sink& sink, const ObjStreamOptions& options = ObjStreamOptions(),
+               ObjStreamStats* statsOut = nullptr) {
+    using namespace obj_stream_detail;
+    typedef std::chrono::steady_clock Clock;
+    ObjStreamStats stats;
+
+    std::FILE* file = std::fopen(objPath.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open OBJ file: " << objPath << std::endl;
+        return false;
+    }
+
+    // Divisão do orçamento: 1/8 leitura, 1/8 saída, o resto para o cache de atributos
+    size_t budget = std::max(options.memoryBudget, MinimumBudget);
+    stats.readBytes = std::min(std::max(budget / 8, size_t(64) << 10), size_t(64) << 20);
+    size_t outputVertices = std::max<size_t>(budget / 8 / sizeof(MeshVertex) / 3 * 3, 3);
+    stats.outputBytes = outputVertices * sizeof(MeshVertex);
+    stats.cacheBytes = budget - stats.readBytes - stats.outputBytes;
+    if (options.cacheLimit) stats.cacheBytes = std::min(stats.cacheBytes, options.cacheLimit);
+
+    AttributeFile positions, texCoords, normals;
+    bool ok = positions.open(scratchPath(objPath, options.scratchDirectory, ".v.tmp"), 3)
+           && texCoords.open(scratchPath(objPath, options.scratchDirectory, ".vt.tmp"), 2)
+           && normals.open(scratchPath(objPath, options.scratchDirectory, ".vn.tmp"), 3);
+
+    // Passada 1: contagem, atributos para o disco e trechos com faces
+    auto start = Clock::now();
+    std::vector<char> buffer(stats.readBytes);
+    std::vector<Chunk> chunks;
+    ok = ok && forEachChunk(file, buffer, [&](uint64_t offset, const char* p, const char* end) {
+        Chunk chunk = {offset, positions.count, texCoords.count, normals.count, stats.triangles, (uint32_t)(end - p)};
+        bool hasFaces = false;
+        while (p < end) {
+            const char* lineEnd = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+            if (!lineEnd) lineEnd = end;
+            float values[3];
+            switch (lineKind(p, lineEnd)) {
+            case 'v':
+                parseFloats(p, lineEnd, values, 3);
+                stats.bounds.expand(glm::vec3(values[0], values[1], values[2]));
+                positions.append(values);
+                break;
+            case 't':
+                parseFloats(p, lineEnd, values, 2);
+                values[1] = 1.0f - values[1];
+                texCoords.append(values);
+                break;
+            case 'n':
+                parseFloats(p, lineEnd, values, 3);
+                normals.append(values);
+                break;
+            case 'f': {
+                int corners = countTokens(p, lineEnd);
+                if (corners >= 3) {
+                    ++stats.faces;
+                    stats.triangles += corners - 2;
+                    hasFaces = true;
+                }
+                break;
+            }
+            }
+            p = lineEnd + 1;
+        }
+        if (hasFaces) chunks.push_back(chunk);
+        stats.fileBytes = offset + chunk.size;
+        return true;
+    });
+
+    // O que fica na memória fora do cache na segunda passada sai da parte dele
+    size_t overhead = chunks.capacity() * sizeof(Chunk) + positions.pageTableBytes() + texCoords.pageTableBytes()
+                    + normals.pageTableBytes() + FixedReserve;
+    stats.cacheBytes -= std::min(stats.cacheBytes, overhead);
+
+    // O cache é dividido pelo tamanho de cada arquivo temporário (ao menos uma página cada)
+    uint64_t attributeBytes = positions.fileBytes() + texCoords.fileBytes() + normals.fileBytes();
+    size_t spare = stats.cacheBytes - std::min(stats.cacheBytes, positions.pageBytes() * 2 + texCoords.pageBytes());
+    auto share = [&](const AttributeFile& attribute) {
+        return attribute.pageBytes() + (attributeBytes ? (size_t)((double)spare * attribute.fileBytes() / attributeBytes) : 0);
+    };
+    ok = ok && positions.finishWriting(share(positions)) && texCoords.finishWriting(share(texCoords))
+            && normals.finishWriting(share(normals));
+    stats.positions = positions.count;
+    stats.texCoords = texCoords.count;
+    stats.normals = normals.count;
+    stats.chunks = chunks.size();
+    stats.countMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    // Passada 2: triângulos em blocos de outputVertices direto no destino
+    start = Clock::now();
+    uint64_t vertexCount = stats.triangles * 3;
+    ok = ok && sink.begin(vertexCount);
+    uint64_t blockFirst = 0, written = 0;
+    MeshVertex* block = nullptr;
+    size_t blockSize = 0, blockUsed = 0;
+    struct Corner { int64_t position, texCoord, normal; };
+    std::vector<Corner> corners;
+
+    auto emit = [&](const Corner& corner) -> bool {
+        if (blockUsed == blockSize) {
+            if (block && !sink.unmap()) return false;
+            blockFirst += blockUsed;
+            blockSize = (size_t)std::min<uint64_t>(outputVertices, vertexCount - blockFirst);
+            blockUsed = 0;
+            block = blockSize ? sink.map(blockFirst, blockSize) : nullptr;
+            if (!block) {
+                std::cerr << "OBJ stream: more triangles than counted, or the sink failed to map" << std::endl;
+                return false;
+            }
+        }
+        MeshVertex& vertex = block[blockUsed++];
+        vertex = MeshVertex();
+        const float* values;
+        if (corner.position >= 0) {
+            if (!(values = positions.get((uint64_t)corner.position))) return false;
+            vertex.position = glm::vec3(values[0], values[1], values[2]);
+        }
+        if (corner.texCoord >= 0) {
+            if (!(values = texCoords.get((uint64_t)corner.texCoord))) return false;
+            vertex.texCoord = glm::vec2(values[0], values[1]);
+        }
+        if (corner.normal >= 0) {
+            if (!(values = normals.get((uint64_t)corner.normal))) return false;
+            vertex.normal = glm::vec3(values[0], values[1], values[2]);
+        }
+        ++written;
+        return true;
+    };
+
+    for (size_t c = 0; ok && c < chunks.size(); ++c) {
+        const Chunk& chunk = chunks[c];
+        if (!seek(file, chunk.offset) || std::fread(buffer.data(), 1, chunk.size, file) != chunk.size) {
+            std::cerr << "Failed to re-read OBJ file: " << objPath << std::endl;
+            ok = false;
+            break;
+        }
+        uint64_t positionCount = chunk.positions, texCoordCount = chunk.texCoords, normalCount = chunk.normals;
+        const char* p = buffer.data();
+        const char* end = p + chunk.size;
+        while (ok && p < end) {
+            const char* lineEnd = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+            if (!lineEnd) lineEnd = end;
+            switch (lineKind(p, lineEnd)) {
+            case 'v': ++positionCount; break;
+            case 't': ++texCoordCount; break;
+            case 'n': ++normalCount; break;
+            case 'f':
+                corners.clear();
+                while ((p = skipBlanks(p, lineEnd)) < lineEnd) {
+                    int64_t indices[3];
+                    p = obj_detail::parseCorner(p, lineEnd, indices);
+                    corners.push_back({obj_detail::resolveIndex(indices[0], positionCount),
+                                       obj_detail::resolveIndex(indices[1], texCoordCount),
+                                       obj_detail::resolveIndex(indices[2], normalCount)});
+                }
+                for (size_t k = 1; ok && k + 1 < corners.size(); ++k)
+                    ok = emit(corners[0]) && emit(corners[k]) && emit(corners[k + 1]);
+                break;
+            }
+            p = lineEnd + 1;
+        }
+    }
+    if (ok && block) ok = sink.unmap();
+    if (ok && written != vertexCount) {
+        std::cerr << "OBJ stream: counted " << vertexCount << " vertices but wrote " << written << std::endl;
+        ok = false;
+    }
+    stats.pageLoads = positions.loads + texCoords.loads + normals.loads;
+    stats.streamMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    ok = ok && sink.end(stats);
+
+    std::fclose(file);
+    if (statsOut) *statsOut = stats;
+    return ok;
+}
+
+// Cabeçalho do arquivo gravado por ObjBlobWriter; os vértices (MeshVertex) vêm logo depois
+struct ObjBlobHeader {
+    char magic[4] = {'C', 'G', 'V', 'B'};
+    uint32_t version = 1;
+    uint32_t vertexSize = sizeof(MeshVertex);
+    uint32_t reserved = 0;
+    uint64_t vertexCount = 0;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// Destino em arquivo: o bloco de saída é um buffer próprio gravado a cada unmap()
+class ObjBlobWriter {
+public:
+    explicit ObjBlobWriter(const std::string& blobPath) : path(blobPath) {}
+    ~ObjBlobWriter() { if (file) std::fclose(file); }
+
+    bool begin(uint64_t vertexCount) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Failed to create blob file: " << path << std::endl;
+            return false;
+        }
+        header.vertexCount = vertexCount;
+        return std::fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+
+    MeshVertex* map(uint64_t, size_t count) {
+        block.resize(count);
+        return block.data();
+    }
+
+    bool unmap() {
+        return std::fwrite(block.data(), sizeof(MeshVertex), block.size(), file) == block.size();
+    }
+
+    // Regrava o cabeçalho com a caixa envolvente
+    bool end(const ObjStreamStats& stats) {
+        bool empty = stats.positions == 0;
+        for (int i = 0; i < 3; ++i) {
+            header.boundsMin[i] = empty ? 0.0f : stats.bounds.min[i];
+            header.boundsMax[i] = empty ? 0.0f : stats.bounds.max[i];
+        }
+        bool ok = obj_stream_detail::seek(file, 0) && std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = std::fclose(file) == 0 && ok;
+        file = nullptr;
+        return ok;
+    }
+
+private:
+    std::string path;
+    std::FILE* file = nullptr;
+    ObjBlobHeader header;
+    std::vector<MeshVertex> block;
+};
+
+namespace obj_stream_detail {
+
+inline char* appendUnsigned(char* p, uint64_t value) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) *p++ = digits[--count];
+    return p;
+}
+
+// Valor com 6 casas decimais (snprintf seria o gargalo da geração)
+inline char* appendFixed(char* p, float value) {
+    if (value < 0.0f) {
+        *p++ = '-';
+        value = -value;
+    }
+    uint64_t scaled = (uint64_t)std::llround((double)value * 1e6);
+    p = appendUnsigned(p, scaled / 1000000);
+    *p++ = '.';
+    uint64_t fraction = scaled % 1000000;
+    for (uint64_t digit = 100000; digit; digit /= 10)
+        *p++ = char('0' + fraction / digit % 10);
+    return p;
+}
+
+} // namespace obj_stream_detail
+
+// OBJ sintético no formato das exportações de fotogrametria: um terreno em grade, todos
+// os "v", depois "vt", "vn" e por fim os triângulos "f a/a/a b/b/b c/c/c". A grade é
+// escolhida para o arquivo ter ~targetBytes; retorna false se não puder escrever
+inline bool writeSyntheticStreamObj(const std::string& objPath, uint64_t targetBytes, uint64_t* triangleCount = nullptr) {
+    using obj_stream_detail::appendFixed;
+    using obj_stream_detail::appendUnsigned;
+    std::FILE* file = std::fopen(objPath.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to create OBJ file: " << objPath << std::endl;
+        return false;
+    }
+
+    // ~90 bytes de atributos por vértice e 2 x (9 d + 11) de faces por célula, com d
+    // dígitos por índice (estimado pelo índice do meio)
+    uint64_t side = 2;
+    double bytesPerCell = 200.0;
+    for (int iteration = 0; iteration < 3; ++iteration) {
+        side = std::max<uint64_t>(2, (uint64_t)std::sqrt((double)targetBytes / bytesPerCell));
+        int digits = (int)std::floor(std::log10((double)(side * side / 2 + 1))) + 1;
+        bytesPerCell = 90.0 + 2.0 * (9 * digits + 11);
+    }
+    std::vector<char> buffer(size_t(4) << 20);
+    char* p = buffer.data();
+    bool ok = true;
+    auto reserve = [&](size_t bytes) {
+        if ((size_t)(p - buffer.data()) + bytes > buffer.size()) {
+            size_t length = (size_t)(p - buffer.data());
+            ok = ok && std::fwrite(buffer.data(), 1, length, file) == length;
+            p = buffer.data();
+        }
+    };
+    auto height = [](float x, float z) { return 4.0f * std::sin(x * 0.05f) * std::cos(z * 0.07f); };
+
+    p += std::snprintf(p, 128, "# synthetic terrain %llux%llu\n", (unsigned long long)side, (unsigned long long)side);
+    for (uint64_t j = 0; j < side; ++j)
+        for (uint64_t i = 0; i < side; ++i) {
+            reserve(64);
+            float x = i * 0.5f, z = j * 0.5f;
+            *p++ = 'v'; *p++ = ' ';
+            p = appendFixed(p, x); *p++ = ' ';
+            p = appendFixed(p, height(x, z)); *p++ = ' ';
+            p = appendFixed(p, z); *p++ = '\n';
+        }
+    for (uint64_t j = 0; j < side; ++j)
+        for (uint64_t i = 0; i < side; ++i) {
+            reserve(64);
+            *p++ = 'v'; *p++ = 't'; *p++ = ' ';
+            p = appendFixed(p, (float)i / (side - 1)); *p++ = ' ';
+            p = appendFixed(p, (float)j / (side - 1)); *p++ = '\n';
+        }
+    for (uint64_t j = 0; j < side; ++j)
+        for (uint64_t i = 0; i < side; ++i) {
+            reserve(64);
+            float x = i * 0.5f, z = j * 0.5f;
+            float dx = 0.2f * std::cos(x * 0.05f) * std::cos(z * 0.07f);
+            float dz = -0.28f * std::sin(x * 0.05f) * std::sin(z * 0.07f);
+            glm::vec3 normal = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+            *p++ = 'v'; *p++ = 'n'; *p++ = ' ';
+            p = appendFixed(p, normal.x); *p++ = ' ';
+            p = appendFixed(p, normal.y); *p++ = ' ';
+            p = appendFixed(p, normal.z); *p++ = '\n';
+        }
+    auto corner = [&](uint64_t index) {
+        *p++ = ' ';
+        for (int k = 0; k < 3; ++k) {
+            if (k) *p++ = '/';
+            p = appendUnsigned(p, index);
+        }
+    };
+    for (uint64_t j = 0; j + 1 < side; ++j)
+        for (uint64_t i = 0; i + 1 < side; ++i) {
+            reserve(256);
+            uint64_t a = j * side + i + 1, b = a + 1, c = a + side + 1, d = a + side;
+            *p++ = 'f'; corner(a); corner(d); corner(c); *p++ = '\n';
+            *p++ = 'f'; corner(a); corner(c); corner(b); *p++ = '\n';
+        }
+    reserve(buffer.size());
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) std::cerr << "Failed to write OBJ file: " << objPath << std::endl;
+    if (triangleCount) *triangleCount = (side - 1) * (side - 1) * 2;
+    return ok;
+}
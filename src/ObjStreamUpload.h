@@ -0,0 +1,62 @@
+#pragma once
+
+// Destino de streamObj (ObjStream.h) num GL_ARRAY_BUFFER: o buffer é alocado uma vez com
+// o total de vértices e cada bloco é escrito direto num intervalo mapeado com
+// glMapBufferRange (sem cópia intermediária na CPU). O formato é o de MeshVertex:
+//
+//   ObjBufferUpload upload;
+//   if (streamObj(path, upload, options)) {
+//       glBindBuffer(GL_ARRAY_BUFFER, upload.buffer());
+//       ...                                  // atributos 0/1/2 como no MeshVertex
+//       glDrawArrays(GL_TRIANGLES, 0, (GLsizei)upload.vertexCount());
+//   }
+//
+// O chamador é dono do buffer (glDeleteBuffers).
+
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include "ObjStream.h"
+
+class ObjBufferUpload {
+public:
+    bool begin(uint64_t vertexCount) {
+        count = vertexCount;
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        // Descarta erros anteriores para que o teste abaixo veja só o do glBufferData
+        while (glGetError() != GL_NO_ERROR) {}
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexCount * sizeof(MeshVertex)), nullptr, GL_STATIC_DRAW);
+        if (glGetError() == GL_OUT_OF_MEMORY) {
+            std::cerr << "Failed to allocate a " << vertexCount * sizeof(MeshVertex) << " byte vertex buffer" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    MeshVertex* map(uint64_t firstVertex, size_t vertexCount) {
+        return (MeshVertex*)glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)(firstVertex * sizeof(MeshVertex)),
+                                             (GLsizeiptr)(vertexCount * sizeof(MeshVertex)),
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    bool unmap() {
+        if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE) return true;
+        std::cerr << "Vertex buffer contents lost while mapped" << std::endl;
+        return false;
+    }
+
+    bool end(const ObjStreamStats&) {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    GLuint buffer() const { return vbo; }
+    uint64_t vertexCount() const { return count; }
+
+private:
+    GLuint vbo = 0;
+    uint64_t count = 0;
+};
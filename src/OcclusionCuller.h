@@ -0,0 +1,487 @@
+#pragma once
+
+// Occlusion culling por software com pirâmide de profundidade (Hi-Z).
+//
+//   occlusion.beginFrame(projection * view);
+//   occlusion.addOccluderBox(wallBounds);          // ou addOccluder(triângulos, model)
+//   occlusion.renderOccluders();
+//   occlusion.cull(candidatos, boundsDeMundo, visiveis);
+//
+// Os oclusores (poucos triângulos: paredes, versões simplificadas das malhas) são
+// rasterizados só em profundidade num buffer de baixa resolução, em tiles divididos
+// entre as threads (ThreadPool) e blocos 8x8 testados de 4 em 4 pixels (float4).
+// A rasterização é conservadora: um pixel só recebe o oclusor se estiver totalmente
+// coberto, e com a maior profundidade do triângulo dentro dele. Assim o teste nunca
+// esconde um objeto que apareceria na imagem final.
+//
+// Depois são montadas duas pirâmides (máximo e mínimo de 2x2). Cada objeto projeta
+// seu AABB num retângulo de tela com a profundidade do canto mais próximo e é testado
+// a partir do nível em que o retângulo cobre no máximo 4x4 texels: está oculto onde
+// fica atrás do máximo, visível assim que fica na frente do mínimo, e desce de nível
+// nos casos intermediários. Não depende de OpenGL.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "ParallelFor.h"
+#include "Simd.h"
+
+struct OcclusionStats {
+    int occluderTriangles = 0;
+    int tested = 0;
+    int occluded = 0;
+    double rasterMs = 0.0;
+    double pyramidMs = 0.0;
+    double testMs = 0.0;
+
+    double totalMs() const { return rasterMs + pyramidMs + testMs; }
+    double occludedPercent() const { return tested ? 100.0 * occluded / tested : 0.0; }
+};
+
+class OcclusionCuller {
+public:
+    static constexpr int TileWidth = 64;
+    static constexpr int TileHeight = 32;
+    static constexpr int BlockSize = 8;
+    static constexpr int TrianglesPerBatch = 128;
+    static constexpr int MaxRefineLevels = 3;
+
+    OcclusionCuller(int width = 256, int height = 128, ThreadPool& pool = ThreadPool::global()) : pool(pool) {
+        resize(width, height);
+    }
+
+    void resize(int newWidth, int newHeight) {
+        width = newWidth;
+        height = newHeight;
+        tilesX = (width + TileWidth - 1) / TileWidth;
+        tilesY = (height + TileHeight - 1) / TileHeight;
+        stride = tilesX * TileWidth;
+        depth.assign((size_t)stride * tilesY * TileHeight, 1.0f);
+
+        maxLevels.clear();
+        minLevels.clear();
+        levelSizes.clear();
+        int w = width, h = height;
+        for (;;) {
+            levelSizes.push_back(glm::ivec2(w, h));
+            maxLevels.push_back(std::vector<float>((size_t)w * h, 1.0f));
+            minLevels.push_back(std::vector<float>((size_t)w * h, 1.0f));
+            if (w == 1 && h == 1) break;
+            w = std::max(1, (w + 1) / 2);
+            h = std::max(1, (h + 1) / 2);
+        }
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const OcclusionStats& stats() const { return frameStats; }
+
+    void beginFrame(const glm::mat4& newViewProjection) {
+        viewProjection = newViewProjection;
+        occluderClip.clear();
+        frameStats = OcclusionStats();
+    }
+
+    // Triângulos soltos (3 posições por triângulo) no espaço do objeto
+    void addOccluder(const std::vector<glm::vec3>& positions, const glm::mat4& model) {
+        glm::mat4 mvp = viewProjection * model;
+        for (size_t i = 0; i + 2 < positions.size(); i += 3)
+            for (int k = 0; k < 3; ++k)
+                occluderClip.push_back(mvp * glm::vec4(positions[i + k], 1.0f));
+    }
+
+    // Caixa sólida em coordenadas de mundo (12 triângulos)
+    void addOccluderBox(const AABB& box) {
+        static const int faces[12][3] = {
+            {0, 1, 3}, {0, 3, 2}, {4, 6, 7}, {4, 7, 5},   // -x, +x
+            {0, 4, 5}, {0, 5, 1}, {2, 3, 7}, {2, 7, 6},   // -y, +y
+            {0, 2, 6}, {0, 6, 4}, {1, 5, 7}, {1, 7, 3},   // -z, +z
+        };
+        glm::vec4 corners[8];
+        for (int c = 0; c < 8; ++c) {
+            glm::vec3 p((c & 4) ? box.max.x : box.min.x, (c & 2) ? box.max.y : box.min.y, (c & 1) ? box.max.z : box.min.z);
+            corners[c] = viewProjection * glm::vec4(p, 1.0f);
+        }
+        for (const int* face : faces)
+            for (int k = 0; k < 3; ++k)
+                occluderClip.push_back(corners[face[k]]);
+    }
+
+    // Rasteriza os oclusores e monta as pirâmides
+    void renderOccluders() {
+        auto start = std::chrono::steady_clock::now();
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        int triangleCount = (int)(occluderClip.size() / 3);
+        int batchCount = (triangleCount + TrianglesPerBatch - 1) / TrianglesPerBatch;
+        if ((int)batches.size() < batchCount)
+            batches.resize(batchCount);
+        pool.parallelFor(batchCount, [&](int batch, int) {
+            setupBatch(batches[batch], batch * TrianglesPerBatch, std::min(triangleCount, (batch + 1) * TrianglesPerBatch));
+        });
+        pool.parallelFor(tilesX * tilesY, [&](int tile, int) {
+            for (int b = 0; b < batchCount; ++b)
+                for (int index : batches[b].bins[tile])
+                    rasterTriangle(batches[b].triangles[index], tile);
+        });
+        auto rasterEnd = std::chrono::steady_clock::now();
+
+        buildPyramid();
+        auto pyramidEnd = std::chrono::steady_clock::now();
+        frameStats.occluderTriangles = triangleCount;
+        frameStats.rasterMs += std::chrono::duration<double, std::milli>(rasterEnd - start).count();
+        frameStats.pyramidMs += std::chrono::duration<double, std::milli>(pyramidEnd - rasterEnd).count();
+    }
+
+    // Conservador: false só quando o AABB está garantidamente atrás dos oclusores
+    // (ou fora da tela)
+    bool isVisible(const AABB& box) const {
+        // Os 8 cantos em clip space, 4 por vez
+        float4 cx[2], cy[2], cz[2], cw[2];
+        for (int half = 0; half < 2; ++half) {
+            float4 x(box.min.x, box.max.x, box.min.x, box.max.x);
+            float4 y(box.min.y, box.min.y, box.max.y, box.max.y);
+            float4 z(half ? box.max.z : box.min.z);
+            const glm::mat4& m = viewProjection;
+            cx[half] = float4(m[0][0]) * x + float4(m[1][0]) * y + float4(m[2][0]) * z + float4(m[3][0]);
+            cy[half] = float4(m[0][1]) * x + float4(m[1][1]) * y + float4(m[2][1]) * z + float4(m[3][1]);
+            cz[half] = float4(m[0][2]) * x + float4(m[1][2]) * y + float4(m[2][2]) * z + float4(m[3][2]);
+            cw[half] = float4(m[0][3]) * x + float4(m[1][3]) * y + float4(m[2][3]) * z + float4(m[3][3]);
+        }
+        // Algum canto antes do plano near: a caixa chega até a câmera
+        if (movemask((cz[0] < -cw[0]) | (cz[1] < -cw[1])))
+            return true;
+
+        float4 minX(1e30f), maxX(-1e30f), minY(1e30f), maxY(-1e30f), minZ(1e30f);
+        for (int half = 0; half < 2; ++half) {
+            float4 invW = float4(1.0f) / cw[half];
+            float4 sx = (cx[half] * invW * 0.5f + 0.5f) * (float)width;
+            float4 sy = (float4(0.5f) - cy[half] * invW * 0.5f) * (float)height;
+            float4 sz = cz[half] * invW * 0.5f + 0.5f;
+            minX = min(minX, sx); maxX = max(maxX, sx);
+            minY = min(minY, sy); maxY = max(maxY, sy);
+            minZ = min(minZ, sz);
+        }
+        float rect[5];
+        rect[0] = std::min(std::min(minX[0], minX[1]), std::min(minX[2], minX[3]));
+        rect[1] = std::max(std::max(maxX[0], maxX[1]), std::max(maxX[2], maxX[3]));
+        rect[2] = std::min(std::min(minY[0], minY[1]), std::min(minY[2], minY[3]));
+        rect[3] = std::max(std::max(maxY[0], maxY[1]), std::max(maxY[2], maxY[3]));
+        rect[4] = std::min(std::min(minZ[0], minZ[1]), std::min(minZ[2], minZ[3]));
+
+        int px0 = std::max(0, (int)std::floor(rect[0]));
+        int px1 = std::min(width - 1, (int)std::floor(rect[1]));
+        int py0 = std::max(0, (int)std::floor(rect[2]));
+        int py1 = std::min(height - 1, (int)std::floor(rect[3]));
+        if (px0 > px1 || py0 > py1)
+            return false;
+        float nearest = rect[4];
+        if (nearest <= 0.0f)
+            return true;
+
+        // Nível em que o retângulo tem no máximo 2 texels de largura (size >> level <= 2);
+        // sem alinhamento com a grade do nível ele pode tocar até 4x4 texels
+        int size = std::max(px1 - px0, py1 - py0) + 1;
+        int level = 0;
+        while ((size >> level) > 2 && level + 1 < (int)levelSizes.size())
+            ++level;
+        int pixelRect[4] = {px0, py0, px1, py1};
+        return visibleIn(level, px0 >> level, py0 >> level, px1 >> level, py1 >> level, pixelRect, nearest, MaxRefineLevels);
+    }
+
+    // Filtra "candidates" (índices em worldBounds), mantendo a ordem
+    void cull(const std::vector<int>& candidates, const std::vector<AABB>& worldBounds, std::vector<int>& visible) {
+        auto start = std::chrono::steady_clock::now();
+        const int chunk = 64;
+        int count = (int)candidates.size();
+        flags.resize(count);
+        pool.parallelFor((count + chunk - 1) / chunk, [&](int c, int) {
+            int end = std::min(count, (c + 1) * chunk);
+            for (int i = c * chunk; i < end; ++i)
+                flags[i] = isVisible(worldBounds[candidates[i]]) ? 1 : 0;
+        });
+        visible.clear();
+        for (int i = 0; i < count; ++i)
+            if (flags[i])
+                visible.push_back(candidates[i]);
+        frameStats.tested += count;
+        frameStats.occluded += count - (int)visible.size();
+        frameStats.testMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Profundidade dos oclusores (nível 0), linha 0 no topo; para depuração
+    const std::vector<float>& depthLevel(int level, bool farthest = true) const {
+        return farthest ? maxLevels[level] : minLevels[level];
+    }
+    glm::ivec2 levelSize(int level) const { return levelSizes[level]; }
+    int levelCount() const { return (int)levelSizes.size(); }
+
+private:
+    struct Triangle {
+        float edgeA[3], edgeB[3], edgeC[3];   // já deslocadas para o canto mais desfavorável do pixel
+        float z0, dzdx, dzdy;                 // z(x, y) no centro do pixel, mais a folga até o canto
+        int minX, minY, maxX, maxY;
+    };
+
+    struct Batch {
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<int>> bins;
+    };
+
+    ThreadPool& pool;
+    int width = 0, height = 0;
+    int tilesX = 0, tilesY = 0, stride = 0;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    std::vector<glm::vec4> occluderClip;
+    std::vector<Batch> batches;
+    std::vector<float> depth;
+    std::vector<std::vector<float>> maxLevels;
+    std::vector<std::vector<float>> minLevels;
+    std::vector<glm::ivec2> levelSizes;
+    std::vector<unsigned char> flags;
+    OcclusionStats frameStats;
+
+    // Near e guard band (x, y dentro de +-4w), como no SoftwareRasterizer
+    static float planeDistance(const glm::vec4& c, int plane) {
+        const float guard = 4.0f;
+        switch (plane) {
+        case 0: return c.z + c.w;
+        case 1: return guard * c.w - c.x;
+        case 2: return guard * c.w + c.x;
+        case 3: return guard * c.w - c.y;
+        default: return guard * c.w + c.y;
+        }
+    }
+
+    static int clipPolygon(glm::vec4* polygon, int count) {
+        glm::vec4 scratch[12];
+        for (int plane = 0; plane < 5 && count >= 3; ++plane) {
+            float d[12];
+            bool allInside = true, allOutside = true;
+            for (int i = 0; i < count; ++i) {
+                d[i] = planeDistance(polygon[i], plane);
+                allInside = allInside && d[i] >= 0.0f;
+                allOutside = allOutside && d[i] < 0.0f;
+            }
+            if (allInside) continue;
+            if (allOutside) return 0;
+            int out = 0;
+            for (int i = 0; i < count; ++i) {
+                int j = (i + 1) % count;
+                if (d[i] >= 0.0f)
+                    scratch[out++] = polygon[i];
+                if ((d[i] >= 0.0f) != (d[j] >= 0.0f))
+                    scratch[out++] = polygon[i] + (polygon[j] - polygon[i]) * (d[i] / (d[i] - d[j]));
+            }
+            count = out;
+            std::copy(scratch, scratch + count, polygon);
+        }
+        return count >= 3 ? count : 0;
+    }
+
+    void setupBatch(Batch& batch, int firstTriangle, int endTriangle) {
+        batch.triangles.clear();
+        batch.bins.resize(tilesX * tilesY);
+        for (std::vector<int>& bin : batch.bins)
+            bin.clear();
+        glm::vec4 polygon[12];
+        for (int t = firstTriangle; t < endTriangle; ++t) {
+            for (int k = 0; k < 3; ++k)
+                polygon[k] = occluderClip[t * 3 + k];
+            int count = clipPolygon(polygon, 3);
+            for (int k = 1; k + 1 < count; ++k)
+                setupTriangle(batch, polygon[0], polygon[k], polygon[k + 1]);
+        }
+    }
+
+    void setupTriangle(Batch& batch, const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2) {
+        const glm::vec4* c[3] = {&c0, &c1, &c2};
+        float sx[3], sy[3], sz[3];
+        for (int k = 0; k < 3; ++k) {
+            float invW = 1.0f / c[k]->w;
+            sx[k] = (c[k]->x * invW * 0.5f + 0.5f) * width;
+            sy[k] = (0.5f - c[k]->y * invW * 0.5f) * height;
+            sz[k] = c[k]->z * invW * 0.5f + 0.5f;
+        }
+        Triangle tri;
+        for (int k = 0; k < 3; ++k) {
+            int a = (k + 1) % 3, b = (k + 2) % 3;
+            tri.edgeA[k] = sy[a] - sy[b];
+            tri.edgeB[k] = sx[b] - sx[a];
+            tri.edgeC[k] = sx[a] * sy[b] - sy[a] * sx[b];
+        }
+        float area2 = tri.edgeA[0] * sx[0] + tri.edgeB[0] * sy[0] + tri.edgeC[0];
+        if (std::fabs(area2) < 1e-6f) return;
+        float sign = area2 < 0.0f ? -1.0f : 1.0f;
+        area2 *= sign;
+        for (int k = 0; k < 3; ++k) {
+            tri.edgeA[k] *= sign;
+            tri.edgeB[k] *= sign;
+            tri.edgeC[k] *= sign;
+        }
+
+        // Plano de profundidade: z = z0 + b1 * (z1 - z0) + b2 * (z2 - z0), com b_k = E_k / área
+        float invArea = 1.0f / area2;
+        tri.dzdx = (tri.edgeA[1] * (sz[1] - sz[0]) + tri.edgeA[2] * (sz[2] - sz[0])) * invArea;
+        tri.dzdy = (tri.edgeB[1] * (sz[1] - sz[0]) + tri.edgeB[2] * (sz[2] - sz[0])) * invArea;
+        // z na origem da tela (0, 0), mais meia largura de pixel na direção em que z cresce
+        tri.z0 = sz[0] - tri.dzdx * sx[0] - tri.dzdy * sy[0] + 0.5f * (std::fabs(tri.dzdx) + std::fabs(tri.dzdy));
+        // Cobertura total do pixel: a aresta precisa passar também pelo canto mais desfavorável
+        for (int k = 0; k < 3; ++k)
+            tri.edgeC[k] -= 0.5f * (std::fabs(tri.edgeA[k]) + std::fabs(tri.edgeB[k]));
+
+        float minSx = std::min(sx[0], std::min(sx[1], sx[2])), maxSx = std::max(sx[0], std::max(sx[1], sx[2]));
+        float minSy = std::min(sy[0], std::min(sy[1], sy[2])), maxSy = std::max(sy[0], std::max(sy[1], sy[2]));
+        tri.minX = std::max(0, (int)std::ceil(minSx - 0.5f));
+        tri.maxX = std::min(width - 1, (int)std::floor(maxSx - 0.5f));
+        tri.minY = std::max(0, (int)std::ceil(minSy - 0.5f));
+        tri.maxY = std::min(height - 1, (int)std::floor(maxSy - 0.5f));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+        int index = (int)batch.triangles.size();
+        batch.triangles.push_back(tri);
+        for (int ty = tri.minY / TileHeight; ty <= tri.maxY / TileHeight; ++ty)
+            for (int tx = tri.minX / TileWidth; tx <= tri.maxX / TileWidth; ++tx)
+                batch.bins[ty * tilesX + tx].push_back(index);
+    }
+
+    void rasterTriangle(const Triangle& tri, int tile) {
+        int tileX = (tile % tilesX) * TileWidth;
+        int tileY = (tile / tilesX) * TileHeight;
+        int x0 = std::max(tri.minX, tileX) & ~(BlockSize - 1);
+        int y0 = std::max(tri.minY, tileY) & ~(BlockSize - 1);
+        int x1 = std::min(tri.maxX, tileX + TileWidth - 1);
+        int y1 = std::min(tri.maxY, tileY + TileHeight - 1);
+        const float4 laneOffset(0.5f, 1.5f, 2.5f, 3.5f);
+        const float4 zero(0.0f);
+        const float4 widthLimit((float)width);
+        float4 edgeA[3], edgeB[3], edgeC[3];
+        for (int k = 0; k < 3; ++k) {
+            edgeA[k] = float4(tri.edgeA[k]);
+            edgeB[k] = float4(tri.edgeB[k]);
+            edgeC[k] = float4(tri.edgeC[k]);
+        }
+        const float4 z0(tri.z0), dzdx(tri.dzdx), dzdy(tri.dzdy);
+
+        for (int by = y0; by <= y1; by += BlockSize) {
+            for (int bx = x0; bx <= x1; bx += BlockSize) {
+                // Descarta o bloco inteiro se o canto "mais dentro" de alguma aresta está fora
+                bool outside = false;
+                for (int k = 0; k < 3 && !outside; ++k) {
+                    float cx = bx + 0.5f + (tri.edgeA[k] > 0.0f ? BlockSize - 1 : 0);
+                    float cy = by + 0.5f + (tri.edgeB[k] > 0.0f ? BlockSize - 1 : 0);
+                    outside = tri.edgeA[k] * cx + tri.edgeB[k] * cy + tri.edgeC[k] < 0.0f;
+                }
+                if (outside) continue;
+                int rowEnd = std::min(BlockSize, height - by);
+                for (int row = 0; row < rowEnd; ++row) {
+                    int py = by + row;
+                    float4 fy((float)py + 0.5f);
+                    float4 rowEdge[3];
+                    for (int k = 0; k < 3; ++k)
+                        rowEdge[k] = edgeB[k] * fy + edgeC[k];
+                    float4 rowZ = z0 + dzdy * fy;
+                    for (int group = 0; group < BlockSize; group += 4) {
+                        int px = bx + group;
+                        float4 fx = float4((float)px) + laneOffset;
+                        float4 mask = (fx < widthLimit) & (edgeA[0] * fx + rowEdge[0] >= zero) &
+                                      (edgeA[1] * fx + rowEdge[1] >= zero) & (edgeA[2] * fx + rowEdge[2] >= zero);
+                        if (!movemask(mask)) continue;
+                        float4 z = rowZ + dzdx * fx;
+                        float* depthRow = &depth[(size_t)py * stride + px];
+                        float4 stored = float4::load(depthRow);
+                        select(mask, min(z, stored), stored).store(depthRow);
+                    }
+                }
+            }
+        }
+    }
+
+    void buildPyramid() {
+        std::vector<float>& base = maxLevels[0];
+        for (int y = 0; y < height; ++y)
+            std::copy(&depth[(size_t)y * stride], &depth[(size_t)y * stride] + width, &base[(size_t)y * width]);
+        minLevels[0] = base;
+        for (int level = 1; level < (int)levelSizes.size(); ++level) {
+            glm::ivec2 src = levelSizes[level - 1], dst = levelSizes[level];
+            const int rowsPerTask = 16;
+            pool.parallelFor((dst.y + rowsPerTask - 1) / rowsPerTask, [&](int task, int) {
+                int yEnd = std::min(dst.y, (task + 1) * rowsPerTask);
+                for (int y = task * rowsPerTask; y < yEnd; ++y)
+                    reduceRow(level, src, dst, y);
+            });
+        }
+    }
+
+    // Uma linha do nível "level" a partir de duas linhas do anterior (máximo e mínimo de 2x2)
+    void reduceRow(int level, glm::ivec2 src, glm::ivec2 dst, int y) {
+        int y0 = std::min(y * 2, src.y - 1), y1 = std::min(y * 2 + 1, src.y - 1);
+        const float* maxRow0 = &maxLevels[level - 1][(size_t)y0 * src.x];
+        const float* maxRow1 = &maxLevels[level - 1][(size_t)y1 * src.x];
+        const float* minRow0 = &minLevels[level - 1][(size_t)y0 * src.x];
+        const float* minRow1 = &minLevels[level - 1][(size_t)y1 * src.x];
+        float* maxOut = &maxLevels[level][(size_t)y * dst.x];
+        float* minOut = &minLevels[level][(size_t)y * dst.x];
+        int x = 0;
+        // 4 texels de saída (8 de entrada por linha) por vez
+        for (; x + 4 <= dst.x && x * 2 + 8 <= src.x; x += 4) {
+            float4 maxA = max(float4::load(maxRow0 + x * 2), float4::load(maxRow1 + x * 2));
+            float4 maxB = max(float4::load(maxRow0 + x * 2 + 4), float4::load(maxRow1 + x * 2 + 4));
+            max(evenLanes(maxA, maxB), oddLanes(maxA, maxB)).store(maxOut + x);
+            float4 minA = min(float4::load(minRow0 + x * 2), float4::load(minRow1 + x * 2));
+            float4 minB = min(float4::load(minRow0 + x * 2 + 4), float4::load(minRow1 + x * 2 + 4));
+            min(evenLanes(minA, minB), oddLanes(minA, minB)).store(minOut + x);
+        }
+        for (; x < dst.x; ++x) {
+            int x0 = std::min(x * 2, src.x - 1), x1 = std::min(x * 2 + 1, src.x - 1);
+            maxOut[x] = std::max(std::max(maxRow0[x0], maxRow0[x1]), std::max(maxRow1[x0], maxRow1[x1]));
+            minOut[x] = std::min(std::min(minRow0[x0], minRow0[x1]), std::min(minRow1[x0], minRow1[x1]));
+        }
+    }
+
+    // true se algum texel do retângulo (no nível "level") pode mostrar o objeto
+    bool visibleIn(int level, int tx0, int ty0, int tx1, int ty1, const int* pixelRect, float nearest, int refineLeft) const {
+        const glm::ivec2 size = levelSizes[level];
+        const std::vector<float>& maxDepth = maxLevels[level];
+        const std::vector<float>& minDepth = minLevels[level];
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                size_t i = (size_t)ty * size.x + tx;
+                if (nearest > maxDepth[i]) continue;                 // atrás de tudo neste texel
+                if (nearest <= minDepth[i] || level == 0 || refineLeft == 0) return true;
+                // Caso intermediário: olha os 2x2 filhos que o retângulo cobre
+                int child = level - 1;
+                int cx0 = std::max(tx * 2, pixelRect[0] >> child), cx1 = std::min(tx * 2 + 1, pixelRect[2] >> child);
+                int cy0 = std::max(ty * 2, pixelRect[1] >> child), cy1 = std::min(ty * 2 + 1, pixelRect[3] >> child);
+                if (visibleIn(child, cx0, cy0, cx1, cy1, pixelRect, nearest, refineLeft - 1))
+                    return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Cena de teste: duas paredes com uma fresta no meio e uma grade de Suzannes atrás
+// delas (mais uma fileira na frente). Usada pelo M5 (--occlusion-scene) e pelo
+// benchmark "occlusion".
+inline void buildOcclusionTestScene(std::vector<AABB>& walls, std::vector<glm::vec3>& objectPositions) {
+    walls.clear();
+    objectPositions.clear();
+    AABB left, right;
+    left.min = glm::vec3(-30.0f, -6.0f, -4.5f);
+    left.max = glm::vec3(-0.8f, 8.0f, -4.0f);
+    right.min = glm::vec3(0.8f, -6.0f, -4.5f);
+    right.max = glm::vec3(30.0f, 8.0f, -4.0f);
+    walls.push_back(left);
+    walls.push_back(right);
+    for (int z = 0; z < 12; ++z)
+        for (int y = -1; y <= 1; ++y)
+            for (int x = -8; x <= 8; ++x)
+                objectPositions.push_back(glm::vec3(x * 2.5f, y * 2.5f, -7.0f - z * 3.0f));
+    for (int x = -3; x <= 3; ++x)
+        objectPositions.push_back(glm::vec3(x * 2.5f, -1.5f, -1.0f));
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// Pool de threads persistente para laços paralelos nas ferramentas de CPU
+// (rasterizador por software, ray tracer, culling...).
+//
+//   ThreadPool::global().parallelFor(tileCount, [&](int tile, int worker) { ... });
+//
+// Os índices são distribuídos dinamicamente (contador atômico), então tarefas de
+// custo desigual, como tiles com muitos triângulos, se equilibram sozinhas. A thread
+// que chama também trabalha; "worker" vai de 0 a threadCount() - 1 e serve para
+// indexar dados por thread sem locks.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = 0) {
+        if (threads <= 0)
+            threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int i = 1; i < threads; ++i)
+            workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            ++generation;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers)
+            t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int threadCount() const { return (int)workers.size() + 1; }
+
+    // Executa body(index, worker) para index em [0, count); retorna quando todos terminam
+    void parallelFor(int count, const std::function<void(int, int)>& body) {
+        if (count <= 0) return;
+        if (workers.empty() || count == 1) {
+            for (int i = 0; i < count; ++i) body(i, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &body;
+            jobCount = count;
+            next.store(0);
+            active = (int)workers.size();
+            ++generation;
+        }
+        wake.notify_all();
+        runJob(body, count, 0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return active == 0; });
+        job = nullptr;
+    }
+
+    // Pool compartilhado, com uma thread por núcleo
+    static ThreadPool& global() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(int, int)>* job = nullptr;
+    int jobCount = 0;
+    std::atomic<int> next{0};
+    int active = 0;
+    unsigned generation = 0;
+    bool stopping = false;
+
+    void runJob(const std::function<void(int, int)>& body, int count, int worker) {
+        for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            body(i, worker);
+    }
+
+    void workerLoop(int worker) {
+        unsigned seen = 0;
+        for (;;) {
+            const std::function<void(int, int)>* body;
+            int count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seen; });
+                seen = generation;
+                if (stopping) return;
+                body = job;
+                count = jobCount;
+            }
+            runJob(*body, count, worker);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (--active == 0)
+                    done.notify_one();
+            }
+        }
+    }
+};
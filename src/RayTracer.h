@@ -0,0 +1,289 @@
+#pragma once
+
+// Ray caster na CPU para imagens de referência: a mesma cena do SoftwareRasterizer
+// (MeshVertex, SoftLight, SoftMaterial, SoftTexture) e o mesmo Phong de três luzes,
+// mas com raios primários contra uma TriangleBvh, várias amostras por pixel e,
+// opcionalmente, raios de sombra até cada luz (que o OpenGL dos exercícios não tem).
+//
+//   RayTracer tracer(800, 800);
+//   tracer.setCamera(view, projection, viewPos);
+//   tracer.setLights(lights);
+//   tracer.setScene(vertices, &texture);    // constrói a BVH
+//   tracer.render(4, true);                 // 4 amostras por pixel, com sombras
+//   std::vector<unsigned char> rgba = tracer.readRgba8();
+//
+// A imagem é dividida em tiles 16x16 distribuídos no ThreadPool; dentro do tile, cada
+// quad 2x2 de pixels é um pacote de 4 raios (RayPacket4). Os deslocamentos das amostras
+// são fixos (sequência R2), então o resultado não depende do número de threads.
+// O nível de mipmap vem de um cone de raio: a largura do pixel na distância do acerto,
+// corrigida pela inclinação da superfície, convertida em texels pela razão área UV /
+// área do triângulo.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ObjMesh.h"
+#include "ParallelFor.h"
+#include "Simd.h"
+#include "SoftwareRasterizer.h"
+#include "TriangleBvh.h"
+
+struct RayTraceStats {
+    long long primaryRays = 0;
+    long long shadowRays = 0;
+    double renderMs = 0.0;
+
+    double mraysPerSecond() const {
+        return renderMs > 0.0 ? (primaryRays + shadowRays) / (renderMs * 1000.0) : 0.0;
+    }
+};
+
+class RayTracer {
+public:
+    static const int TileSize = 16;
+
+    RayTracer(int width, int height, ThreadPool& pool = ThreadPool::global()) : pool(pool) {
+        resize(width, height);
+    }
+
+    void resize(int newWidth, int newHeight) {
+        fbWidth = newWidth;
+        fbHeight = newHeight;
+        tilesX = (fbWidth + TileSize - 1) / TileSize;
+        tilesY = (fbHeight + TileSize - 1) / TileSize;
+        color.assign((size_t)fbWidth * fbHeight, 0);
+    }
+
+    int width() const { return fbWidth; }
+    int height() const { return fbHeight; }
+    const RayTraceStats& stats() const { return frameStats; }
+    const TriangleBvh& bvh() const { return sceneBvh; }
+
+    // Base da câmera tirada das mesmas matrizes que o rasterizador usa
+    void setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position) {
+        glm::mat4 invView = glm::inverse(view);
+        cameraRight = glm::vec3(invView[0]);
+        cameraUp = glm::vec3(invView[1]);
+        cameraForward = -glm::vec3(invView[2]);
+        tanHalfX = 1.0f / projection[0][0];
+        tanHalfY = 1.0f / projection[1][1];
+        viewPos = position;
+    }
+
+    void setLights(const std::vector<SoftLight>& newLights) { lights = newLights; }
+    void setMaterial(const SoftMaterial& newMaterial) { material = newMaterial; }
+    void setBackground(const glm::vec3& newBackground) { background = newBackground; }
+
+    // Malha já em coordenadas de mundo (model identidade, como no Vivencial2)
+    void setScene(const std::vector<MeshVertex>& newVertices, const SoftTexture* newTexture) {
+        vertices = &newVertices;
+        texture = newTexture && !newTexture->empty() ? newTexture : nullptr;
+        sceneBvh.build(newVertices, pool);
+
+        int count = (int)(newVertices.size() / 3);
+        lodBase.assign(count, 0.0f);
+        if (!texture) return;
+        float texels = (float)texture->width() * texture->height();
+        for (int i = 0; i < count; ++i) {
+            const MeshVertex* v = &newVertices[i * 3];
+            glm::vec2 t1 = v[1].texCoord - v[0].texCoord, t2 = v[2].texCoord - v[0].texCoord;
+            float uvArea = std::fabs(t1.x * t2.y - t1.y * t2.x);
+            float worldArea = glm::length(glm::cross(v[1].position - v[0].position, v[2].position - v[0].position));
+            lodBase[i] = uvArea > 0.0f && worldArea > 0.0f ? 0.5f * std::log2(texels * uvArea / worldArea) : 0.0f;
+        }
+    }
+
+    void render(int samplesPerPixel = 1, bool shadows = false) {
+        auto start = std::chrono::steady_clock::now();
+        frameStats = RayTraceStats();
+        if (!vertices) return;
+        samplesPerPixel = std::max(1, samplesPerPixel);
+        std::vector<RayTraceStats> workerStats(pool.threadCount());
+        pool.parallelFor(tilesX * tilesY, [&](int tile, int worker) {
+            renderTile(tile, samplesPerPixel, shadows, workerStats[worker]);
+        });
+        for (const RayTraceStats& s : workerStats) {
+            frameStats.primaryRays += s.primaryRays;
+            frameStats.shadowRays += s.shadowRays;
+        }
+        frameStats.renderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Cor em RGBA8, linha 0 no topo da imagem
+    std::vector<unsigned char> readRgba8() const {
+        std::vector<unsigned char> out(color.size() * 4);
+        for (size_t i = 0; i < color.size(); ++i) {
+            out[i * 4] = (unsigned char)(color[i] & 0xFF);
+            out[i * 4 + 1] = (unsigned char)((color[i] >> 8) & 0xFF);
+            out[i * 4 + 2] = (unsigned char)((color[i] >> 16) & 0xFF);
+            out[i * 4 + 3] = (unsigned char)(color[i] >> 24);
+        }
+        return out;
+    }
+
+private:
+    ThreadPool& pool;
+    int fbWidth = 0, fbHeight = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<uint32_t> color;
+    glm::vec3 cameraRight = glm::vec3(1, 0, 0), cameraUp = glm::vec3(0, 1, 0), cameraForward = glm::vec3(0, 0, -1);
+    float tanHalfX = 1.0f, tanHalfY = 1.0f;
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    glm::vec3 background = glm::vec3(0.08f);
+    std::vector<SoftLight> lights;
+    SoftMaterial material;
+    const std::vector<MeshVertex>* vertices = nullptr;
+    const SoftTexture* texture = nullptr;
+    TriangleBvh sceneBvh;
+    std::vector<float> lodBase;    // 0.5 * log2(texels * área UV / área do triângulo)
+    RayTraceStats frameStats;
+
+    static uint32_t packColor(const glm::vec3& c) {
+        auto channel = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return channel(c.r) | (channel(c.g) << 8) | (channel(c.b) << 16) | 0xFF000000u;
+    }
+
+    // Sequência R2: amostra 0 no centro do pixel
+    static glm::vec2 sampleOffset(int sample) {
+        float x = 0.5f + sample * 0.7548776662f, y = 0.5f + sample * 0.5698402910f;
+        return glm::vec2(x - std::floor(x), y - std::floor(y));
+    }
+
+    void renderTile(int tile, int samples, bool shadows, RayTraceStats& tileStats) {
+        int x0 = (tile % tilesX) * TileSize, y0 = (tile / tilesX) * TileSize;
+        int x1 = std::min(fbWidth, x0 + TileSize), y1 = std::min(fbHeight, y0 + TileSize);
+        float spread = 2.0f * tanHalfY / fbHeight;    // ângulo de um pixel, para o cone
+
+        for (int y = y0; y < y1; y += 2) {
+            for (int x = x0; x < x1; x += 2) {
+                glm::vec3 sum[4] = {glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(0.0f)};
+                for (int s = 0; s < samples; ++s) {
+                    glm::vec2 offset = sampleOffset(s);
+                    alignas(16) float dx[4], dy[4], dz[4], tMax[4];
+                    for (int lane = 0; lane < 4; ++lane) {
+                        int px = x + (lane & 1), py = y + (lane >> 1);
+                        float ndcX = 2.0f * (px + offset.x) / fbWidth - 1.0f;
+                        float ndcY = 1.0f - 2.0f * (py + offset.y) / fbHeight;
+                        glm::vec3 d = glm::normalize(cameraForward + cameraRight * (ndcX * tanHalfX) + cameraUp * (ndcY * tanHalfY));
+                        dx[lane] = d.x;
+                        dy[lane] = d.y;
+                        dz[lane] = d.z;
+                        bool inside = px < x1 && py < y1;
+                        tMax[lane] = inside ? FLT_MAX : -1.0f;
+                        tileStats.primaryRays += inside;
+                    }
+                    RayPacket4 packet;
+                    packet.ox = float4(viewPos.x);
+                    packet.oy = float4(viewPos.y);
+                    packet.oz = float4(viewPos.z);
+                    packet.dx = float4::load(dx);
+                    packet.dy = float4::load(dy);
+                    packet.dz = float4::load(dz);
+                    packet.tMax = float4::load(tMax);
+                    RayHit4 hit;
+                    sceneBvh.intersect(packet, hit);
+                    shadePacket(packet, hit, tMax, shadows, spread, sum, tileStats);
+                }
+                for (int lane = 0; lane < 4; ++lane) {
+                    int px = x + (lane & 1), py = y + (lane >> 1);
+                    if (px < x1 && py < y1)
+                        color[(size_t)py * fbWidth + px] = packColor(sum[lane] / (float)samples);
+                }
+            }
+        }
+    }
+
+    // Soma a cor de cada lane (já limitada a [0, 1], como o framebuffer do GL) em "sum"
+    void shadePacket(const RayPacket4& packet, const RayHit4& hit, const float* initialTMax, bool shadows,
+                     float spread, glm::vec3* sum, RayTraceStats& tileStats) const {
+        bool active[4];
+        glm::vec3 hitPos[4], geomNormal[4], normal[4], viewDir[4], vColor[4], lighting[4];
+        for (int lane = 0; lane < 4; ++lane) {
+            active[lane] = initialTMax[lane] >= 0.0f && hit.triangle[lane] >= 0;
+            if (initialTMax[lane] >= 0.0f && !active[lane])
+                sum[lane] += background;
+            if (!active[lane]) continue;
+            const MeshVertex* v = &(*vertices)[hit.triangle[lane] * 3];
+            float b1 = hit.u[lane], b2 = hit.v[lane], b0 = 1.0f - b1 - b2;
+            hitPos[lane] = viewPos + glm::vec3(packet.dx[lane], packet.dy[lane], packet.dz[lane]) * hit.t[lane];
+            geomNormal[lane] = glm::normalize(glm::cross(v[1].position - v[0].position, v[2].position - v[0].position));
+            vColor[lane] = v[0].normal * b0 + v[1].normal * b1 + v[2].normal * b2;
+            normal[lane] = glm::normalize(vColor[lane]);
+            viewDir[lane] = glm::normalize(viewPos - hitPos[lane]);
+            lighting[lane] = glm::vec3(material.ka);
+        }
+
+        for (const SoftLight& light : lights) {
+            if (!light.enabled) continue;
+            bool lit[4] = {true, true, true, true};
+            if (shadows)
+                traceShadows(light, active, hitPos, geomNormal, lit, tileStats);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (!active[lane] || !lit[lane]) continue;
+                glm::vec3 toLight = light.position - hitPos[lane];
+                float distance = glm::length(toLight);
+                toLight /= distance;
+                float attenuation = 1.0f / (1.0f + 0.1f * distance + 0.01f * distance * distance);
+                float nDotL = glm::dot(normal[lane], toLight);
+                float diff = std::max(nDotL, 0.0f);
+                glm::vec3 reflectDir = normal[lane] * (2.0f * nDotL) - toLight;
+                float spec = std::pow(std::max(glm::dot(viewDir[lane], reflectDir), 0.0f), material.shininess);
+                lighting[lane] += light.color * ((diff * material.kd + spec * material.ks) * attenuation * light.intensity);
+            }
+        }
+
+        for (int lane = 0; lane < 4; ++lane) {
+            if (!active[lane]) continue;
+            glm::vec3 result = lighting[lane] * vColor[lane];
+            if (texture) {
+                int prim = hit.triangle[lane];
+                const MeshVertex* v = &(*vertices)[prim * 3];
+                float b1 = hit.u[lane], b2 = hit.v[lane], b0 = 1.0f - b1 - b2;
+                glm::vec2 uv = v[0].texCoord * b0 + v[1].texCoord * b1 + v[2].texCoord * b2;
+                glm::vec3 dir(packet.dx[lane], packet.dy[lane], packet.dz[lane]);
+                float cosine = std::max(std::fabs(glm::dot(dir, geomNormal[lane])), 1e-3f);
+                float lod = lodBase[prim] + std::log2(hit.t[lane] * spread / cosine);
+                result *= texture->sample(uv.x, uv.y, lod);
+            }
+            sum[lane] += glm::clamp(result, 0.0f, 1.0f);
+        }
+    }
+
+    // Um pacote de raios de sombra até a luz; lit[lane] fica falso onde algo bloqueia
+    void traceShadows(const SoftLight& light, const bool* active, const glm::vec3* hitPos, const glm::vec3* geomNormal,
+                      bool* lit, RayTraceStats& tileStats) const {
+        alignas(16) float ox[4], oy[4], oz[4], dx[4], dy[4], dz[4], tMax[4];
+        bool any = false;
+        for (int lane = 0; lane < 4; ++lane) {
+            glm::vec3 origin = viewPos, toLight = cameraForward;
+            float distance = -1.0f;
+            if (active[lane]) {
+                toLight = light.position - hitPos[lane];
+                distance = glm::length(toLight);
+                toLight /= distance;
+                // Sai da superfície pelo lado da luz, para não acertar o próprio triângulo
+                float side = glm::dot(geomNormal[lane], toLight) >= 0.0f ? 1.0f : -1.0f;
+                origin = hitPos[lane] + geomNormal[lane] * (side * 1e-4f);
+                tileStats.shadowRays++;
+                any = true;
+            }
+            ox[lane] = origin.x; oy[lane] = origin.y; oz[lane] = origin.z;
+            dx[lane] = toLight.x; dy[lane] = toLight.y; dz[lane] = toLight.z;
+            tMax[lane] = distance;
+        }
+        if (!any) return;
+        RayPacket4 shadow;
+        shadow.ox = float4::load(ox); shadow.oy = float4::load(oy); shadow.oz = float4::load(oz);
+        shadow.dx = float4::load(dx); shadow.dy = float4::load(dy); shadow.dz = float4::load(dz);
+        shadow.tMax = float4::load(tMax);
+        RayHit4 blocked;
+        sceneBvh.intersect(shadow, blocked, true);
+        for (int lane = 0; lane < 4; ++lane)
+            lit[lane] = blocked.triangle[lane] < 0;
+    }
+};
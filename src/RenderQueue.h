@@ -0,0 +1,223 @@
+#pragma once
+
+// Fila de desenho com chaves de ordenação de 64 bits.
+//
+// Cada desenho vira um RenderPacket (programa, VAO, textura, faixa de vértices e as
+// matrizes do objeto) com uma chave; sort() ordena as chaves com radix sort e submit()
+// percorre os pacotes nessa ordem pulando os binds iguais ao anterior. Com a chave
+// abaixo, pacotes com o mesmo estado ficam juntos e, dentro de cada grupo, vão da
+// frente para trás (bom para o teste de profundidade).
+//
+//   bits 63..60  passe (4 bits)
+//   bits 59..52  programa (8 bits)
+//   bits 51..40  material/textura (12 bits)
+//   bits 39..28  VAO (12 bits)
+//   bits 27..4   profundidade na câmera, quantizada em [near, far] (24 bits)
+//
+// Programas, texturas e VAOs entram na chave por ids densos, na ordem em que aparecem
+// (o nome GL pode ser grande); se houver mais objetos do que cabe no campo os ids se
+// repetem, o que só piora o agrupamento.
+//
+//   queue.clear();
+//   queue.setDepthRange(0.1f, 100.0f);
+//   queue.add(pass, packet, viewDepth);
+//   queue.sort();
+//   GlRenderBackend backend;
+//   queue.submit(backend);
+//
+// submit() recebe o backend como parâmetro de template: GlRenderBackend faz as chamadas
+// GL; os benchmarks usam um backend que só conta, para medir a fila sem GPU, e o
+// "DrawBench --queue N" mede o envio com o GlRenderBackend.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+struct RenderPacket {
+    GLuint program = 0;
+    GLuint vao = 0;
+    GLuint texture = 0;
+    GLint first = 0;
+    GLsizei count = 0;
+    glm::mat4 model = glm::mat4(1.0f);
+    glm::mat3 normalMatrix = glm::mat3(1.0f);
+};
+
+struct RenderQueueStats {
+    int draws = 0;
+    int programChanges = 0;
+    int vaoChanges = 0;
+    int textureChanges = 0;
+    double sortMs = 0.0;      // chaves já montadas em add(); só a ordenação
+    double submitMs = 0.0;
+
+    int stateChanges() const { return programChanges + vaoChanges + textureChanges; }
+};
+
+class RenderQueue {
+public:
+    static const int PassBits = 4, ProgramBits = 8, MaterialBits = 12, VaoBits = 12, DepthBits = 24;
+
+    void clear() {
+        packets.clear();
+        keys.clear();
+        order.clear();
+    }
+
+    void setDepthRange(float nearZ, float farZ) {
+        depthNear = nearZ;
+        depthScale = (float)((1u << DepthBits) - 1) / std::max(farZ - nearZ, 1e-6f);
+    }
+
+    void add(int pass, const RenderPacket& packet, float viewDepth) {
+        float depth = std::min(std::max((viewDepth - depthNear) * depthScale, 0.0f), (float)((1u << DepthBits) - 1));
+        uint64_t key = (uint64_t)(pass & ((1 << PassBits) - 1)) << 60
+                     | (uint64_t)programIds.get(packet.program, ProgramBits) << 52
+                     | (uint64_t)materialIds.get(packet.texture, MaterialBits) << 40
+                     | (uint64_t)vaoIds.get(packet.vao, VaoBits) << 28
+                     | (uint64_t)depth << 4;
+        keys.push_back(key);
+        packets.push_back(packet);
+    }
+
+    size_t size() const { return packets.size(); }
+
+    // Radix sort LSD de 8 bits por passada; passadas em que todas as chaves têm o mesmo
+    // byte (campos não usados, poucos programas) são puladas
+    void sort() {
+        auto start = std::chrono::steady_clock::now();
+        size_t count = keys.size();
+        order.resize(count);
+        for (size_t i = 0; i < count; ++i) order[i] = (uint32_t)i;
+        sortedKeys = keys;
+        scratchKeys.resize(count);
+        scratchOrder.resize(count);
+
+        for (int shift = 0; shift < 64; shift += 8) {
+            size_t histogram[256] = {};
+            for (size_t i = 0; i < count; ++i)
+                ++histogram[(sortedKeys[i] >> shift) & 0xFF];
+            if (count == 0 || histogram[(sortedKeys[0] >> shift) & 0xFF] == count)
+                continue;
+            size_t offset = 0;
+            for (int b = 0; b < 256; ++b) {
+                size_t bucket = histogram[b];
+                histogram[b] = offset;
+                offset += bucket;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                size_t destination = histogram[(sortedKeys[i] >> shift) & 0xFF]++;
+                scratchKeys[destination] = sortedKeys[i];
+                scratchOrder[destination] = order[i];
+            }
+            sortedKeys.swap(scratchKeys);
+            order.swap(scratchOrder);
+        }
+        lastStats.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Na ordem de sort() (ou na de inserção, se sort() não foi chamado)
+    template <class Backend>
+    void submit(Backend& backend) {
+        auto start = std::chrono::steady_clock::now();
+        bool sorted = order.size() == packets.size();
+        GLuint program = 0, vao = 0, texture = 0;
+        bool first = true;
+        lastStats.draws = (int)packets.size();
+        lastStats.programChanges = lastStats.vaoChanges = lastStats.textureChanges = 0;
+        for (size_t i = 0; i < packets.size(); ++i) {
+            const RenderPacket& packet = packets[sorted ? order[i] : i];
+            if (first || packet.program != program) {
+                backend.useProgram(packet.program);
+                program = packet.program;
+                ++lastStats.programChanges;
+            }
+            if (first || packet.texture != texture) {
+                backend.bindTexture(packet.texture);
+                texture = packet.texture;
+                ++lastStats.textureChanges;
+            }
+            if (first || packet.vao != vao) {
+                backend.bindVertexArray(packet.vao);
+                vao = packet.vao;
+                ++lastStats.vaoChanges;
+            }
+            backend.draw(packet);
+            first = false;
+        }
+        backend.finish();
+        lastStats.submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // i-ésimo pacote na ordem de submit(), para outros passes desenharem na mesma ordem
+    const RenderPacket& packet(size_t i) const { return packets[order.size() == packets.size() ? order[i] : i]; }
+
+    const RenderQueueStats& stats() const { return lastStats; }
+    const std::vector<uint64_t>& sortedKeyList() const { return sortedKeys; }
+
+private:
+    // Nome GL -> id denso (guardado + 1; 0 = ainda sem id)
+    // 0 marca nome ainda sem id; com 32 bits o contador não volta a 0 (o que deixaria
+    // um nome sem id), e só a máscara do campo faz os ids se repetirem
+    struct IdTable {
+        std::vector<uint32_t> ids;
+        uint32_t next = 0;
+
+        uint32_t get(GLuint name, int bits) {
+            if (name >= ids.size())
+                ids.resize(name + 1, 0);
+            if (!ids[name])
+                ids[name] = ++next;
+            return (uint32_t)(ids[name] - 1) & ((1u << bits) - 1);
+        }
+    };
+
+    std::vector<RenderPacket> packets;
+    std::vector<uint64_t> keys, sortedKeys, scratchKeys;
+    std::vector<uint32_t> order, scratchOrder;
+    IdTable programIds, materialIds, vaoIds;
+    float depthNear = 0.1f;
+    float depthScale = 1.0f;
+    RenderQueueStats lastStats;
+};
+
+// Backend GL: textura na unidade 0 e uniforms "model"/"normalMatrix" de cada programa,
+// com as localizações guardadas (em vez de um glGetUniformLocation por desenho)
+class GlRenderBackend {
+public:
+    void useProgram(GLuint program) {
+        glUseProgram(program);
+        auto found = std::find_if(locations.begin(), locations.end(), [&](const ProgramLocations& l) { return l.program == program; });
+        if (found == locations.end()) {
+            locations.push_back({program, glGetUniformLocation(program, "model"), glGetUniformLocation(program, "normalMatrix")});
+            found = locations.end() - 1;
+        }
+        current = *found;
+    }
+
+    void bindTexture(GLuint texture) { glBindTexture(GL_TEXTURE_2D, texture); }
+    void bindVertexArray(GLuint vao) { glBindVertexArray(vao); }
+
+    void draw(const RenderPacket& packet) {
+        glUniformMatrix4fv(current.model, 1, GL_FALSE, glm::value_ptr(packet.model));
+        glUniformMatrix3fv(current.normalMatrix, 1, GL_FALSE, glm::value_ptr(packet.normalMatrix));
+        glDrawArrays(GL_TRIANGLES, packet.first, packet.count);
+    }
+
+    void finish() { glBindVertexArray(0); }
+
+private:
+    struct ProgramLocations {
+        GLuint program;
+        GLint model;
+        GLint normalMatrix;
+    };
+    std::vector<ProgramLocations> locations;
+    ProgramLocations current = {0, -1, -1};
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+// Hierarquia de transformações com propagação de "dirty flag".
+// Os nós ficam num vetor plano em ordem topológica (pai sempre antes do filho),
+// então update() percorre o vetor uma vez e só recalcula as matrizes de mundo
+// (e de normal) dos nós cuja transformação local ou a de algum ancestral mudou.
+// Não depende de OpenGL.
+
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "NormalMatrix.h"
+
+struct Transform {
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);   // graus, aplicada como nos exercícios: X, depois Y, depois Z
+    glm::vec3 scale = glm::vec3(1.0f);
+};
+
+// Equivale a translate(T) * rotate(X) * rotate(Y) * rotate(Z) * scale(S), sem as multiplicações de matriz
+inline glm::mat4 composeTRS(const Transform& t) {
+    float cx = std::cos(glm::radians(t.rotation.x)), sx = std::sin(glm::radians(t.rotation.x));
+    float cy = std::cos(glm::radians(t.rotation.y)), sy = std::sin(glm::radians(t.rotation.y));
+    float cz = std::cos(glm::radians(t.rotation.z)), sz = std::sin(glm::radians(t.rotation.z));
+
+    glm::mat4 m(1.0f);
+    m[0][0] = cy * cz * t.scale.x;
+    m[0][1] = (sx * sy * cz + cx * sz) * t.scale.x;
+    m[0][2] = (-cx * sy * cz + sx * sz) * t.scale.x;
+    m[0][3] = 0.0f;
+    m[1][0] = -cy * sz * t.scale.y;
+    m[1][1] = (-sx * sy * sz + cx * cz) * t.scale.y;
+    m[1][2] = (cx * sy * sz + sx * cz) * t.scale.y;
+    m[1][3] = 0.0f;
+    m[2][0] = sy * t.scale.z;
+    m[2][1] = -sx * cy * t.scale.z;
+    m[2][2] = cx * cy * t.scale.z;
+    m[2][3] = 0.0f;
+    m[3] = glm::vec4(t.translation, 1.0f);
+    return m;
+}
+
+class SceneGraph {
+public:
+    // O pai precisa existir (índice menor), o que mantém a ordem topológica
+    int addNode(int parent, const Transform& local = Transform()) {
+        int index = (int)locals.size();
+        locals.push_back(local);
+        parents.push_back(parent);
+        worlds.push_back(glm::mat4(1.0f));
+        normals.push_back(glm::mat3(1.0f));
+        dirty.push_back(1);
+        changed.push_back(0);
+        if (index < firstDirty) firstDirty = index;
+        return index;
+    }
+
+    const Transform& getLocal(int node) const { return locals[node]; }
+
+    void setLocal(int node, const Transform& local) {
+        locals[node] = local;
+        markDirty(node);
+    }
+
+    void setTranslation(int node, const glm::vec3& translation) {
+        if (locals[node].translation == translation) return;
+        locals[node].translation = translation;
+        markDirty(node);
+    }
+
+    void setRotation(int node, const glm::vec3& rotation) {
+        if (locals[node].rotation == rotation) return;
+        locals[node].rotation = rotation;
+        markDirty(node);
+    }
+
+    void setScale(int node, const glm::vec3& scale) {
+        if (locals[node].scale == scale) return;
+        locals[node].scale = scale;
+        markDirty(node);
+    }
+
+    // Recalcula as matrizes dos nós sujos e de seus descendentes.
+    // Devolve o número de matrizes recalculadas; os nós alterados ficam em changedNodes().
+    int update() {
+        changedList.clear();
+        if (firstDirty >= (int)locals.size())
+            return 0;
+
+        int count = (int)locals.size();
+        for (int i = firstDirty; i < count; ++i) {
+            int parent = parents[i];
+            bool parentChanged = parent >= 0 && changed[parent];
+            if (!dirty[i] && !parentChanged) {
+                changed[i] = 0;
+                continue;
+            }
+            glm::mat4 local = composeTRS(locals[i]);
+            worlds[i] = parent >= 0 ? worlds[parent] * local : local;
+            normals[i] = computeNormalMatrix(worlds[i]);
+            dirty[i] = 0;
+            changed[i] = 1;
+            changedList.push_back(i);
+        }
+        // Limpa as marcas para o próximo quadro
+        for (int i : changedList)
+            changed[i] = 0;
+        firstDirty = count;
+        return (int)changedList.size();
+    }
+
+    const glm::mat4& world(int node) const { return worlds[node]; }
+    const glm::mat3& normalMatrix(int node) const { return normals[node]; }
+    const std::vector<glm::mat4>& worldMatrices() const { return worlds; }
+    const std::vector<int>& changedNodes() const { return changedList; }
+    int parentOf(int node) const { return parents[node]; }
+    size_t size() const { return locals.size(); }
+
+private:
+    std::vector<Transform> locals;
+    std::vector<int> parents;
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat3> normals;
+    std::vector<unsigned char> dirty;
+    std::vector<unsigned char> changed;
+    std::vector<int> changedList;
+    int firstDirty = 0;
+
+    void markDirty(int node) {
+        dirty[node] = 1;
+        if (node < firstDirty) firstDirty = node;
+    }
+};
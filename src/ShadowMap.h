@@ -0,0 +1,229 @@
+#pragma once
+
+// Shadow map da key light, filtrado com PCF.
+//
+//   ShadowMap shadowMap;
+//   shadowMap.init(2048);
+//   shadowMap.setLight(keyLight.position, sceneBounds);
+//   if (shadowMap.needsUpdate(sceneVersion)) {
+//       shadowMap.begin(sceneVersion);
+//       shadowMap.drawDepth(depthVAO, model, nVertices);    // VAO só com posições
+//       shadowMap.end(headless.framebuffer(), width, height);
+//   }
+//   shadowMap.bind(1);                                      // sampler2DShadow na unidade 1
+//
+// O passe de profundidade usa um programa próprio que só lê a posição (atributo 0), e os
+// VAOs de profundidade apontam para um VBO só de posições (12 bytes por vértice em vez
+// dos 32 do Vertex), num FBO sem cor. O mapa fica em cache: só é redesenhado quando a
+// luz se move, os limites da cena mudam ou a versão da cena passada pelo exercício muda
+// (objetos se moveram). forceUpdate(true) redesenha todo quadro, para medir o passe.
+//
+// A textura tem GL_TEXTURE_COMPARE_MODE e filtro linear: cada amostra de sampler2DShadow
+// já compara e interpola 2x2 texels no hardware, e o shader soma 3x3 dessas amostras
+// deslocadas de um texel, cobrindo ~4x4 texels com 9 leituras.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "Bounds.h"
+
+class ShadowMap {
+public:
+    // Pode ser chamado no meio do laço: restaura a textura e o framebuffer ligados
+    bool init(int mapSize) {
+        size = mapSize;
+        GLint previousTexture = 0, previousFramebuffer = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+        glGenTextures(1, &depthTexture);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, size, size, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        // Fora do mapa conta como iluminado (profundidade 1)
+        float border[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, border);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D, (GLuint)previousTexture);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)previousFramebuffer);
+        if (!complete) {
+            std::cerr << "Shadow map framebuffer is incomplete" << std::endl;
+            return false;
+        }
+
+        program = createDepthProgram();
+        modelLocation = glGetUniformLocation(program, "model");
+        lightSpaceLocation = glGetUniformLocation(program, "lightSpace");
+        return program != 0;
+    }
+
+    void shutdown() {
+        if (program) glDeleteProgram(program);
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (depthTexture) glDeleteTextures(1, &depthTexture);
+        program = fbo = depthTexture = 0;
+    }
+
+    int mapSize() const { return size; }
+    int updateCount() const { return updates; }
+    const glm::mat4& lightSpace() const { return lightViewProjection; }
+
+    // Projeção perspectiva da luz pontual olhando para o centro da cena, com o ângulo
+    // e os planos justos aos cantos dos limites (no máximo 150 graus de abertura)
+    void setLight(const glm::vec3& position, const AABB& sceneBounds) {
+        if (valid && position == lightPosition && sceneBounds.min == bounds.min && sceneBounds.max == bounds.max)
+            return;
+        lightPosition = position;
+        bounds = sceneBounds;
+        valid = false;
+
+        glm::vec3 center = sceneBounds.center();
+        glm::vec3 forward = center - position;
+        if (glm::dot(forward, forward) < 1e-8f) forward = glm::vec3(0.0f, -1.0f, 0.0f);
+        glm::vec3 up = std::fabs(glm::normalize(forward).y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::mat4 view = glm::lookAt(position, position + forward, up);
+
+        float nearZ = FLT_MAX, farZ = 0.0f, maxTan = 0.0f;
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec3 p(corner & 1 ? sceneBounds.max.x : sceneBounds.min.x,
+                        corner & 2 ? sceneBounds.max.y : sceneBounds.min.y,
+                        corner & 4 ? sceneBounds.max.z : sceneBounds.min.z);
+            glm::vec3 v = glm::vec3(view * glm::vec4(p, 1.0f));
+            float depth = -v.z;
+            farZ = std::max(farZ, depth);
+            if (depth > 1e-3f) {
+                nearZ = std::min(nearZ, depth);
+                maxTan = std::max(maxTan, std::max(std::fabs(v.x), std::fabs(v.y)) / depth);
+            } else {
+                maxTan = FLT_MAX;   // luz dentro dos limites (ou cantos atrás dela)
+            }
+        }
+        // Uma face da caixa pode estar mais perto da luz que qualquer canto
+        glm::vec3 closest = glm::clamp(position, sceneBounds.min, sceneBounds.max);
+        nearZ = std::max(0.05f, std::min(nearZ, glm::length(closest - position)) * 0.5f);
+        farZ = std::max(farZ * 1.01f, nearZ * 2.0f);
+        float halfAngle = std::min(std::atan(maxTan) * 1.02f, glm::radians(75.0f));
+        lightViewProjection = glm::perspective(2.0f * halfAngle, 1.0f, nearZ, farZ) * view;
+    }
+
+    void forceUpdate(bool always) { alwaysUpdate = always; }
+
+    bool needsUpdate(uint64_t sceneVersion) const {
+        return alwaysUpdate || !valid || sceneVersion != renderedVersion;
+    }
+
+    // Liga o FBO e o programa de profundidade; depois, drawDepth para cada objeto
+    void begin(uint64_t sceneVersion) {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, size, size);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        // Bias proporcional à inclinação, contra o "shadow acne"
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+        glUseProgram(program);
+        glUniformMatrix4fv(lightSpaceLocation, 1, GL_FALSE, glm::value_ptr(lightViewProjection));
+        renderedVersion = sceneVersion;
+    }
+
+    void drawDepth(GLuint depthVAO, const glm::mat4& model, int vertexCount) {
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+        glBindVertexArray(depthVAO);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    }
+
+    // Volta para o framebuffer da cena (headless.framebuffer(), 0 com janela)
+    void end(GLuint sceneFramebuffer, int viewportWidth, int viewportHeight) {
+        glBindVertexArray(0);
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glUseProgram((GLuint)previousProgram);
+        glBindFramebuffer(GL_FRAMEBUFFER, sceneFramebuffer);
+        glViewport(0, 0, viewportWidth, viewportHeight);
+        valid = true;
+        ++updates;
+    }
+
+    void bind(int unit) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+private:
+    int size = 0;
+    GLuint depthTexture = 0;
+    GLuint fbo = 0;
+    GLuint program = 0;
+    GLint modelLocation = -1;
+    GLint lightSpaceLocation = -1;
+    GLint previousProgram = 0;
+
+    glm::vec3 lightPosition = glm::vec3(0.0f);
+    AABB bounds;
+    glm::mat4 lightViewProjection = glm::mat4(1.0f);
+    bool valid = false;
+    bool alwaysUpdate = false;
+    uint64_t renderedVersion = 0;
+    int updates = 0;
+
+    static GLuint createDepthProgram() {
+        const GLchar* vertexSource = R"(
+#version 400
+layout (location = 0) in vec3 position;
+uniform mat4 model;
+uniform mat4 lightSpace;
+void main()
+{
+    gl_Position = lightSpace * model * vec4(position, 1.0);
+})";
+        const GLchar* fragmentSource = R"(
+#version 400
+void main()
+{
+})";
+        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &vertexSource, NULL);
+        glCompileShader(vertexShader);
+        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+        glCompileShader(fragmentShader);
+
+        GLuint shaderProgram = glCreateProgram();
+        glAttachShader(shaderProgram, vertexShader);
+        glAttachShader(shaderProgram, fragmentShader);
+        glLinkProgram(shaderProgram);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        GLint success;
+        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            GLchar infoLog[512];
+            glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::SHADOW_DEPTH::LINKING_FAILED\n" << infoLog << std::endl;
+            glDeleteProgram(shaderProgram);
+            return 0;
+        }
+        return shaderProgram;
+    }
+};
@@ -0,0 +1,326 @@
+#pragma once
+
+// Geração de formas paramétricas indexadas: esfera UV, icosfera, cubo, cilindro, toro
+// e plano, no formato MeshVertex (posição, normal, UV: 32 bytes) com índices de 32 bits.
+// Não depende de OpenGL.
+//
+// Cada vértice é calculado uma vez e compartilhado pelos triângulos vizinhos (a versão
+// antiga do SpherePhong gerava 6 vértices de 11 floats por quadrado, com seno e cosseno
+// recalculados em cada canto). Os senos/cossenos de cada anel e de cada segmento vêm
+// de tabelas (AngleTable), então uma grade de R x S pontos faz R + S chamadas de
+// sin/cos em vez de 4 * R * S. A costura de UV (u = 0 e u = 1) tem vértices duplicados.
+//
+// Triângulos em sentido anti-horário vistos de fora.
+//
+//   ShapeMesh sphere = generateUvSphere(0.5f, 16, 16);
+//   ShapeCache cache;
+//   const ShapeMesh& ico = cache.get(ShapeDesc::icosphere(1.0f, 3));   // gerada uma vez só
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ObjMesh.h"
+
+struct ShapeMesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+
+    size_t bytes() const { return vertices.size() * sizeof(MeshVertex) + indices.size() * sizeof(uint32_t); }
+    size_t triangleCount() const { return indices.size() / 3; }
+};
+
+// sin/cos de count + 1 ângulos igualmente espaçados em [start, start + range]
+struct AngleTable {
+    std::vector<float> sin, cos;
+
+    AngleTable(int count, float range, float start = 0.0f) : sin(count + 1), cos(count + 1) {
+        for (int i = 0; i <= count; ++i) {
+            float angle = start + range * i / count;
+            sin[i] = std::sin(angle);
+            cos[i] = std::cos(angle);
+        }
+        // Fecha o círculo exatamente (sem o erro de sin(2 * pi) != 0)
+        if (std::fabs(range - 6.28318531f) < 1e-6f) {
+            sin[count] = sin[0];
+            cos[count] = cos[0];
+        }
+    }
+};
+
+namespace shape_detail {
+
+const float Pi = 3.14159265358979f;
+
+// Índices de uma grade (rows + 1) x (columns + 1) começando em "first". Anti-horário
+// quando (direção das colunas) x (direção das linhas) aponta para fora; flip inverte.
+inline void gridIndices(std::vector<uint32_t>& indices, uint32_t first, int rows, int columns, bool flip = false) {
+    uint32_t stride = (uint32_t)columns + 1;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < columns; ++c) {
+            uint32_t i0 = first + r * stride + c, i1 = i0 + 1, i2 = i0 + stride, i3 = i2 + 1;
+            if (flip)
+                indices.insert(indices.end(), {i0, i2, i1, i1, i2, i3});
+            else
+                indices.insert(indices.end(), {i0, i1, i2, i1, i3, i2});
+        }
+    }
+}
+
+inline MeshVertex vertex(const glm::vec3& position, const glm::vec3& normal, const glm::vec2& texCoord) {
+    MeshVertex v;
+    v.position = position;
+    v.normal = normal;
+    v.texCoord = texCoord;
+    return v;
+}
+
+} // namespace shape_detail
+
+// rings: divisões de polo a polo; segments: em volta do eixo Y
+inline ShapeMesh generateUvSphere(float radius, int rings, int segments) {
+    using namespace shape_detail;
+    rings = std::max(rings, 2);
+    segments = std::max(segments, 3);
+    AngleTable theta(rings, Pi), phi(segments, 2.0f * Pi);
+    theta.sin[rings] = 0.0f;       // polo sul exato (sin(pi) sai negativo em float)
+    ShapeMesh mesh;
+    mesh.vertices.reserve((size_t)(rings + 1) * (segments + 1));
+    mesh.indices.reserve((size_t)(rings - 1) * segments * 6);
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= segments; ++s) {
+            glm::vec3 normal(phi.cos[s] * theta.sin[r], theta.cos[r], phi.sin[s] * theta.sin[r]);
+            mesh.vertices.push_back(vertex(normal * radius, normal, glm::vec2((float)s / segments, (float)r / rings)));
+        }
+    }
+    // Nos polos os dois vértices de cima (ou de baixo) do quadrado coincidem: um triângulo
+    // só por quadrado, sem os de área zero
+    uint32_t stride = (uint32_t)segments + 1, south = (uint32_t)(rings - 1) * stride;
+    for (uint32_t s = 0; s < (uint32_t)segments; ++s)
+        mesh.indices.insert(mesh.indices.end(), {s + 1, stride + s + 1, stride + s});
+    gridIndices(mesh.indices, stride, rings - 2, segments);
+    for (uint32_t s = 0; s < (uint32_t)segments; ++s)
+        mesh.indices.insert(mesh.indices.end(), {south + s, south + s + 1, south + stride + s});
+    return mesh;
+}
+
+// Icosaedro com cada triângulo dividido em 4 por nível (20 * 4^n triângulos, vértices
+// bem distribuídos, sem concentração nos polos). Os vértices dos meios das arestas são
+// compartilhados; a UV é esférica e a costura não é duplicada.
+inline ShapeMesh generateIcosphere(float radius, int subdivisions) {
+    using namespace shape_detail;
+    const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+    std::vector<glm::vec3> points = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    std::vector<uint32_t> faces = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+    for (glm::vec3& p : points)
+        p = glm::normalize(p);
+
+    std::unordered_map<uint64_t, uint32_t> midpoints;
+    std::vector<uint32_t> next;
+    auto midpoint = [&](uint32_t a, uint32_t b) {
+        uint64_t key = a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+        auto found = midpoints.find(key);
+        if (found != midpoints.end()) return found->second;
+        points.push_back(glm::normalize(points[a] + points[b]));
+        uint32_t index = (uint32_t)points.size() - 1;
+        midpoints.emplace(key, index);
+        return index;
+    };
+    for (int level = 0; level < subdivisions; ++level) {
+        midpoints.clear();
+        midpoints.reserve(faces.size() / 2);
+        next.clear();
+        next.reserve(faces.size() * 4);
+        for (size_t f = 0; f < faces.size(); f += 3) {
+            uint32_t a = faces[f], b = faces[f + 1], c = faces[f + 2];
+            uint32_t ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            next.insert(next.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+        faces.swap(next);
+    }
+
+    ShapeMesh mesh;
+    mesh.vertices.reserve(points.size());
+    for (const glm::vec3& n : points) {
+        glm::vec2 uv(std::atan2(n.z, n.x) / (2.0f * Pi) + 0.5f, std::acos(std::max(-1.0f, std::min(1.0f, n.y))) / Pi);
+        mesh.vertices.push_back(vertex(n * radius, n, uv));
+    }
+    mesh.indices = std::move(faces);
+    return mesh;
+}
+
+// Cubo de lado "size" centrado na origem, cada face uma grade de subdivisions x subdivisions
+// (vértices próprios por face, para as normais ficarem retas)
+inline ShapeMesh generateCube(float size, int subdivisions) {
+    using namespace shape_detail;
+    subdivisions = std::max(subdivisions, 1);
+    // normal, eixo u e eixo v de cada face (u x v = normal)
+    const glm::vec3 faces[6][3] = {
+        {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}}, {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+        {{0, 1, 0}, {1, 0, 0}, {0, 0, -1}}, {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}},
+        {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}}, {{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}}};
+    float half = size * 0.5f;
+    ShapeMesh mesh;
+    size_t perFace = (size_t)(subdivisions + 1) * (subdivisions + 1);
+    mesh.vertices.reserve(perFace * 6);
+    mesh.indices.reserve((size_t)subdivisions * subdivisions * 36);
+    for (const auto& face : faces) {
+        uint32_t first = (uint32_t)mesh.vertices.size();
+        for (int v = 0; v <= subdivisions; ++v) {
+            for (int u = 0; u <= subdivisions; ++u) {
+                glm::vec2 uv((float)u / subdivisions, (float)v / subdivisions);
+                glm::vec3 position = (face[0] + face[1] * (uv.x * 2.0f - 1.0f) + face[2] * (uv.y * 2.0f - 1.0f)) * half;
+                mesh.vertices.push_back(vertex(position, face[0], uv));
+            }
+        }
+        gridIndices(mesh.indices, first, subdivisions, subdivisions);
+    }
+    return mesh;
+}
+
+// Cilindro em volta do eixo Y, de -height/2 a height/2, com tampas
+inline ShapeMesh generateCylinder(float radius, float height, int segments, int stacks) {
+    using namespace shape_detail;
+    segments = std::max(segments, 3);
+    stacks = std::max(stacks, 1);
+    AngleTable phi(segments, 2.0f * Pi);
+    ShapeMesh mesh;
+    mesh.vertices.reserve((size_t)(stacks + 1) * (segments + 1) + 2 * (segments + 2));
+    mesh.indices.reserve((size_t)stacks * segments * 6 + (size_t)segments * 6);
+    for (int k = 0; k <= stacks; ++k) {
+        float y = height * ((float)k / stacks - 0.5f);
+        for (int s = 0; s <= segments; ++s) {
+            glm::vec3 normal(phi.cos[s], 0.0f, phi.sin[s]);
+            mesh.vertices.push_back(vertex(glm::vec3(normal.x * radius, y, normal.z * radius), normal,
+                                           glm::vec2((float)s / segments, (float)k / stacks)));
+        }
+    }
+    // Linhas de baixo para cima (na esfera vão de cima para baixo)
+    gridIndices(mesh.indices, 0, stacks, segments, true);
+
+    for (int side = 0; side < 2; ++side) {
+        float ny = side ? 1.0f : -1.0f;
+        uint32_t center = (uint32_t)mesh.vertices.size();
+        mesh.vertices.push_back(vertex(glm::vec3(0.0f, ny * height * 0.5f, 0.0f), glm::vec3(0.0f, ny, 0.0f), glm::vec2(0.5f)));
+        for (int s = 0; s <= segments; ++s)
+            mesh.vertices.push_back(vertex(glm::vec3(phi.cos[s] * radius, ny * height * 0.5f, phi.sin[s] * radius), glm::vec3(0.0f, ny, 0.0f),
+                                           glm::vec2(0.5f + 0.5f * phi.cos[s], 0.5f + 0.5f * phi.sin[s])));
+        for (int s = 0; s < segments; ++s) {
+            uint32_t a = center + 1 + s, b = a + 1;
+            if (side)
+                mesh.indices.insert(mesh.indices.end(), {center, b, a});
+            else
+                mesh.indices.insert(mesh.indices.end(), {center, a, b});
+        }
+    }
+    return mesh;
+}
+
+// Toro em volta do eixo Y: rings em volta do eixo, segments em volta do tubo
+inline ShapeMesh generateTorus(float majorRadius, float minorRadius, int rings, int segments) {
+    using namespace shape_detail;
+    rings = std::max(rings, 3);
+    segments = std::max(segments, 3);
+    AngleTable around(rings, 2.0f * Pi), tube(segments, 2.0f * Pi);
+    ShapeMesh mesh;
+    mesh.vertices.reserve((size_t)(rings + 1) * (segments + 1));
+    mesh.indices.reserve((size_t)rings * segments * 6);
+    for (int r = 0; r <= rings; ++r) {
+        for (int s = 0; s <= segments; ++s) {
+            glm::vec3 normal(around.cos[r] * tube.cos[s], tube.sin[s], around.sin[r] * tube.cos[s]);
+            glm::vec3 center(around.cos[r] * majorRadius, 0.0f, around.sin[r] * majorRadius);
+            mesh.vertices.push_back(vertex(center + normal * minorRadius, normal, glm::vec2((float)r / rings, (float)s / segments)));
+        }
+    }
+    gridIndices(mesh.indices, 0, rings, segments);
+    return mesh;
+}
+
+// Plano XZ (normal +Y) de width x depth centrado na origem
+inline ShapeMesh generatePlane(float width, float depth, int segmentsX, int segmentsZ) {
+    using namespace shape_detail;
+    segmentsX = std::max(segmentsX, 1);
+    segmentsZ = std::max(segmentsZ, 1);
+    ShapeMesh mesh;
+    mesh.vertices.reserve((size_t)(segmentsX + 1) * (segmentsZ + 1));
+    mesh.indices.reserve((size_t)segmentsX * segmentsZ * 6);
+    for (int z = 0; z <= segmentsZ; ++z) {
+        for (int x = 0; x <= segmentsX; ++x) {
+            glm::vec2 uv((float)x / segmentsX, (float)z / segmentsZ);
+            mesh.vertices.push_back(vertex(glm::vec3((uv.x - 0.5f) * width, 0.0f, (uv.y - 0.5f) * depth), glm::vec3(0.0f, 1.0f, 0.0f), uv));
+        }
+    }
+    gridIndices(mesh.indices, 0, segmentsZ, segmentsX, true);
+    return mesh;
+}
+
+// Parâmetros de uma forma; também é a chave do cache
+struct ShapeDesc {
+    enum Type { UvSphere, Icosphere, Cube, Cylinder, Torus, Plane };
+    Type type = UvSphere;
+    float a = 1.0f, b = 1.0f;      // raio / tamanho (e altura, raio menor, profundidade)
+    int n = 16, m = 16;            // anéis / segmentos / subdivisões
+
+    static ShapeDesc uvSphere(float radius, int rings, int segments) { return {UvSphere, radius, 0.0f, rings, segments}; }
+    static ShapeDesc icosphere(float radius, int subdivisions) { return {Icosphere, radius, 0.0f, subdivisions, 0}; }
+    static ShapeDesc cube(float size, int subdivisions) { return {Cube, size, 0.0f, subdivisions, 0}; }
+    static ShapeDesc cylinder(float radius, float height, int segments, int stacks) { return {Cylinder, radius, height, segments, stacks}; }
+    static ShapeDesc torus(float majorRadius, float minorRadius, int rings, int segments) { return {Torus, majorRadius, minorRadius, rings, segments}; }
+    static ShapeDesc plane(float width, float depth, int segmentsX, int segmentsZ) { return {Plane, width, depth, segmentsX, segmentsZ}; }
+
+    bool operator<(const ShapeDesc& other) const { return std::tie(type, a, b, n, m) < std::tie(other.type, other.a, other.b, other.n, other.m); }
+};
+
+inline ShapeMesh generateShape(const ShapeDesc& desc) {
+    switch (desc.type) {
+        case ShapeDesc::Icosphere: return generateIcosphere(desc.a, desc.n);
+        case ShapeDesc::Cube: return generateCube(desc.a, desc.n);
+        case ShapeDesc::Cylinder: return generateCylinder(desc.a, desc.b, desc.n, desc.m);
+        case ShapeDesc::Torus: return generateTorus(desc.a, desc.b, desc.n, desc.m);
+        case ShapeDesc::Plane: return generatePlane(desc.a, desc.b, desc.n, desc.m);
+        default: return generateUvSphere(desc.a, desc.n, desc.m);
+    }
+}
+
+// Malhas geradas guardadas pelos parâmetros: pedir a mesma forma de novo não gera nada.
+// As referências continuam válidas até clear().
+class ShapeCache {
+public:
+    const ShapeMesh& get(const ShapeDesc& desc) {
+        auto found = meshes.find(desc);
+        if (found != meshes.end()) {
+            ++hitCount;
+            return *found->second;
+        }
+        ++missCount;
+        auto inserted = meshes.emplace(desc, std::make_unique<ShapeMesh>(generateShape(desc)));
+        cachedBytes += inserted.first->second->bytes();
+        return *inserted.first->second;
+    }
+
+    void clear() {
+        meshes.clear();
+        cachedBytes = 0;
+    }
+
+    size_t size() const { return meshes.size(); }
+    size_t bytes() const { return cachedBytes; }
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+private:
+    std::map<ShapeDesc, std::unique_ptr<ShapeMesh>> meshes;
+    size_t cachedBytes = 0;
+    int hitCount = 0, missCount = 0;
+};
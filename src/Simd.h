@@ -0,0 +1,105 @@
+#pragma once
+
+// float4 mínimo para os laços de CPU que processam 4 pixels ou raios por vez
+// (rasterizador por software, Hi-Z, ray tracer). SSE2 em x86 (sempre presente em
+// x86-64); nos demais alvos cai para uma implementação escalar com a mesma interface.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CG_SIMD_SSE2 1
+#endif
+
+#ifdef CG_SIMD_SSE2
+
+struct float4 {
+    __m128 v;
+    float4() {}
+    float4(__m128 value) : v(value) {}
+    explicit float4(float s) : v(_mm_set1_ps(s)) {}
+    float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+    static float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    float operator[](int i) const { alignas(16) float t[4]; _mm_store_ps(t, v); return t[i]; }
+};
+
+inline float4 operator+(float4 a, float4 b) { return _mm_add_ps(a.v, b.v); }
+inline float4 operator-(float4 a, float4 b) { return _mm_sub_ps(a.v, b.v); }
+inline float4 operator*(float4 a, float4 b) { return _mm_mul_ps(a.v, b.v); }
+inline float4 operator/(float4 a, float4 b) { return _mm_div_ps(a.v, b.v); }
+inline float4 operator-(float4 a) { return _mm_sub_ps(_mm_setzero_ps(), a.v); }
+inline float4 min(float4 a, float4 b) { return _mm_min_ps(a.v, b.v); }
+inline float4 max(float4 a, float4 b) { return _mm_max_ps(a.v, b.v); }
+inline float4 sqrt(float4 a) { return _mm_sqrt_ps(a.v); }
+inline float4 operator<(float4 a, float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+inline float4 operator<=(float4 a, float4 b) { return _mm_cmple_ps(a.v, b.v); }
+inline float4 operator>(float4 a, float4 b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline float4 operator>=(float4 a, float4 b) { return _mm_cmpge_ps(a.v, b.v); }
+inline float4 operator==(float4 a, float4 b) { return _mm_cmpeq_ps(a.v, b.v); }
+inline float4 operator&(float4 a, float4 b) { return _mm_and_ps(a.v, b.v); }
+inline float4 operator|(float4 a, float4 b) { return _mm_or_ps(a.v, b.v); }
+inline float4 andNot(float4 mask, float4 a) { return _mm_andnot_ps(mask.v, a.v); }   // a & ~mask
+// Seleciona "a" onde a máscara está ligada, "b" no resto
+inline float4 select(float4 mask, float4 a, float4 b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+// Um bit por faixa (bit i = faixa i)
+inline int movemask(float4 mask) { return _mm_movemask_ps(mask.v); }
+// (a0, a2, b0, b2) e (a1, a3, b1, b3): pares vizinhos de 8 floats, para reduções 2x2
+inline float4 evenLanes(float4 a, float4 b) { return _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(2, 0, 2, 0)); }
+inline float4 oddLanes(float4 a, float4 b) { return _mm_shuffle_ps(a.v, b.v, _MM_SHUFFLE(3, 1, 3, 1)); }
+
+#else
+
+struct float4 {
+    float f[4];
+    float4() {}
+    explicit float4(float s) { f[0] = f[1] = f[2] = f[3] = s; }
+    float4(float a, float b, float c, float d) { f[0] = a; f[1] = b; f[2] = c; f[3] = d; }
+    static float4 load(const float* p) { return float4(p[0], p[1], p[2], p[3]); }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = f[i]; }
+    float operator[](int i) const { return f[i]; }
+};
+
+namespace simd_detail {
+inline float bits(bool b) { uint32_t u = b ? 0xFFFFFFFFu : 0u; float r; std::memcpy(&r, &u, 4); return r; }
+inline uint32_t raw(float x) { uint32_t u; std::memcpy(&u, &x, 4); return u; }
+inline float fromRaw(uint32_t u) { float r; std::memcpy(&r, &u, 4); return r; }
+}
+
+#define CG_SIMD_LANES(expr) float4 r; for (int i = 0; i < 4; ++i) r.f[i] = (expr); return r
+inline float4 operator+(float4 a, float4 b) { CG_SIMD_LANES(a.f[i] + b.f[i]); }
+inline float4 operator-(float4 a, float4 b) { CG_SIMD_LANES(a.f[i] - b.f[i]); }
+inline float4 operator*(float4 a, float4 b) { CG_SIMD_LANES(a.f[i] * b.f[i]); }
+inline float4 operator/(float4 a, float4 b) { CG_SIMD_LANES(a.f[i] / b.f[i]); }
+inline float4 operator-(float4 a) { CG_SIMD_LANES(-a.f[i]); }
+inline float4 min(float4 a, float4 b) { CG_SIMD_LANES(b.f[i] < a.f[i] ? b.f[i] : a.f[i]); }
+inline float4 max(float4 a, float4 b) { CG_SIMD_LANES(b.f[i] > a.f[i] ? b.f[i] : a.f[i]); }
+inline float4 sqrt(float4 a) { CG_SIMD_LANES(std::sqrt(a.f[i])); }
+inline float4 operator<(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::bits(a.f[i] < b.f[i])); }
+inline float4 operator<=(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::bits(a.f[i] <= b.f[i])); }
+inline float4 operator>(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::bits(a.f[i] > b.f[i])); }
+inline float4 operator>=(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::bits(a.f[i] >= b.f[i])); }
+inline float4 operator==(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::bits(a.f[i] == b.f[i])); }
+inline float4 operator&(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::fromRaw(simd_detail::raw(a.f[i]) & simd_detail::raw(b.f[i]))); }
+inline float4 operator|(float4 a, float4 b) { CG_SIMD_LANES(simd_detail::fromRaw(simd_detail::raw(a.f[i]) | simd_detail::raw(b.f[i]))); }
+inline float4 andNot(float4 mask, float4 a) { CG_SIMD_LANES(simd_detail::fromRaw(~simd_detail::raw(mask.f[i]) & simd_detail::raw(a.f[i]))); }
+inline float4 select(float4 mask, float4 a, float4 b) { CG_SIMD_LANES(simd_detail::raw(mask.f[i]) ? a.f[i] : b.f[i]); }
+inline int movemask(float4 mask) {
+    int m = 0;
+    for (int i = 0; i < 4; ++i) m |= (simd_detail::raw(mask.f[i]) >> 31) << i;
+    return m;
+}
+inline float4 evenLanes(float4 a, float4 b) { return float4(a.f[0], a.f[2], b.f[0], b.f[2]); }
+inline float4 oddLanes(float4 a, float4 b) { return float4(a.f[1], a.f[3], b.f[1], b.f[3]); }
+#undef CG_SIMD_LANES
+
+#endif
+
+inline float4 operator+(float4 a, float b) { return a + float4(b); }
+inline float4 operator*(float4 a, float b) { return a * float4(b); }
+inline float4 operator-(float4 a, float b) { return a - float4(b); }
+inline float4 clamp01(float4 a) { return min(max(a, float4(0.0f)), float4(1.0f)); }
+// a * b + c (sem FMA: o resultado é o mesmo que a conta escalar)
+inline float4 madd(float4 a, float4 b, float4 c) { return a * b + c; }
@@ -0,0 +1,232 @@
+// Renderização por software (sem GPU) da cena do Vivencial2: Suzanne texturizada com
+// as três luzes, gravada em PNG e, opcionalmente, comparada com a imagem do OpenGL.
+//
+// Uso: SoftRender [--obj arquivo.obj] [--tex textura.png] [--size LxA] [--out saida.png]
+//                 [--threads N] [--frames N] [--compare referencia.png] [--diff diff.png]
+//                 [--raytrace] [--spp N] [--shadows]
+//
+// Com --raytrace a imagem sai do RayTracer (BVH de triângulos, pacotes de 4 raios),
+// com N amostras por pixel e, com --shadows, raios de sombra para as três luzes.
+//
+// Referência do GL: ./Vivencial2 --headless 800x800 --frames 1 --png ref.png
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include "MeshNormals.h"
+#include "ObjMesh.h"
+#include "RayTracer.h"
+#include "SoftwareRasterizer.h"
+
+using namespace std;
+using namespace glm;
+
+typedef chrono::steady_clock Clock;
+
+struct Options {
+    string objPath = "../assets/Modelos3D/Suzanne.obj";
+    string texturePath = "../assets/Modelos3D/Suzanne.png";
+    string outPath = "soft.png";
+    string comparePath;
+    string diffPath;
+    int width = 800;
+    int height = 800;
+    int threads = 0;
+    int frames = 1;
+    bool rayTrace = false;
+    int samplesPerPixel = 1;
+    bool shadows = false;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--obj" && hasValue) options.objPath = argv[++i];
+        else if (arg == "--tex" && hasValue) options.texturePath = argv[++i];
+        else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+        else if (arg == "--compare" && hasValue) options.comparePath = argv[++i];
+        else if (arg == "--diff" && hasValue) options.diffPath = argv[++i];
+        else if (arg == "--threads" && hasValue) options.threads = stoi(argv[++i]);
+        else if (arg == "--frames" && hasValue) options.frames = max(1, stoi(argv[++i]));
+        else if (arg == "--raytrace") options.rayTrace = true;
+        else if (arg == "--spp" && hasValue) options.samplesPerPixel = max(1, stoi(argv[++i]));
+        else if (arg == "--shadows") options.shadows = true;
+        else if (arg == "--size" && hasValue) {
+            if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0) {
+                cerr << "Invalid --size, expected WIDTHxHEIGHT" << endl;
+                return false;
+            }
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Mesmas luzes de setupLights no Vivencial2
+vector<SoftLight> setupLights(vec3 objectPosition, float objectScale) {
+    vector<SoftLight> lights(3);
+    lights[0].position = objectPosition + vec3(2.0f, 2.0f, 2.0f) * objectScale;
+    lights[0].color = vec3(1.0f, 1.0f, 1.0f);
+    lights[0].intensity = 1.0f;
+    lights[1].position = objectPosition + vec3(-2.0f, 1.0f, 1.0f) * objectScale;
+    lights[1].color = vec3(0.8f, 0.8f, 0.9f);
+    lights[1].intensity = 0.5f;
+    lights[2].position = objectPosition + vec3(0.0f, 1.0f, -2.0f) * objectScale;
+    lights[2].color = vec3(0.7f, 0.7f, 1.0f);
+    lights[2].intensity = 0.3f;
+    return lights;
+}
+
+// RMSE / PSNR por canal RGB e fração de pixels com alguma diferença acima de 8/255
+bool compareImages(const vector<unsigned char>& image, int width, int height, const Options& options) {
+    int refWidth, refHeight, refChannels;
+    unsigned char* reference = stbi_load(options.comparePath.c_str(), &refWidth, &refHeight, &refChannels, 4);
+    if (!reference) {
+        cerr << "Failed to load reference image: " << options.comparePath << endl;
+        return false;
+    }
+    if (refWidth != width || refHeight != height) {
+        cerr << "Reference is " << refWidth << "x" << refHeight << ", expected " << width << "x" << height << endl;
+        stbi_image_free(reference);
+        return false;
+    }
+
+    double squaredError = 0.0;
+    size_t differing = 0;
+    vector<unsigned char> diff(options.diffPath.empty() ? 0 : (size_t)width * height * 4);
+    for (size_t i = 0; i < (size_t)width * height; ++i) {
+        int maxDelta = 0;
+        for (int c = 0; c < 3; ++c) {
+            int delta = abs((int)image[i * 4 + c] - (int)reference[i * 4 + c]);
+            squaredError += (double)delta * delta;
+            maxDelta = max(maxDelta, delta);
+            if (!diff.empty())
+                diff[i * 4 + c] = (unsigned char)min(255, delta * 4);
+        }
+        if (!diff.empty())
+            diff[i * 4 + 3] = 255;
+        if (maxDelta > 8)
+            ++differing;
+    }
+    stbi_image_free(reference);
+
+    double rmse = sqrt(squaredError / ((double)width * height * 3));
+    double psnr = rmse > 0.0 ? 20.0 * log10(255.0 / rmse) : INFINITY;
+    cout << "Compare with " << options.comparePath << ": RMSE " << rmse << ", PSNR " << psnr << " dB, "
+         << 100.0 * differing / ((double)width * height) << "% pixels differ by more than 8/255" << endl;
+    if (!diff.empty() && stbi_write_png(options.diffPath.c_str(), width, height, 4, diff.data(), width * 4))
+        cout << "Difference image (x4) written to " << options.diffPath << endl;
+    return true;
+}
+
+vector<unsigned char> rasterizeScene(const Options& options, const vector<MeshVertex>& vertices, const SoftTexture& texture,
+                                     ThreadPool& pool, const mat4& view, const mat4& projection, vec3 viewPos) {
+    SoftwareRasterizer raster(options.width, options.height, pool);
+    raster.setCamera(view, projection, viewPos);
+    raster.setLights(setupLights(vec3(0.0f), 1.0f));
+    raster.setMaterial(SoftMaterial());
+
+    mat4 model = mat4(1.0f);
+    double totalMs = 0.0, bestMs = INFINITY;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        Clock::time_point start = Clock::now();
+        raster.clear(vec3(0.08f));
+        raster.draw(vertices, model, &texture);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        totalMs += ms;
+        bestMs = min(bestMs, ms);
+    }
+
+    const SoftRasterStats& stats = raster.stats();
+    cout << "Rendered " << stats.trianglesIn << " triangles at " << options.width << "x" << options.height
+         << " with " << pool.threadCount() << " thread(s)" << endl;
+    cout << "  frame: " << totalMs / options.frames << " ms average, " << bestMs << " ms best over " << options.frames << " frame(s)" << endl;
+    cout << "  last frame: setup " << stats.setupMs << " ms, raster " << stats.rasterMs << " ms, "
+         << stats.trianglesSetup << " triangles binned into " << stats.binEntries << " tile entries, "
+         << stats.pixelsShaded << " pixels shaded" << endl;
+    return raster.readRgba8();
+}
+
+vector<unsigned char> rayTraceScene(const Options& options, const vector<MeshVertex>& vertices, const SoftTexture& texture,
+                                    ThreadPool& pool, const mat4& view, const mat4& projection, vec3 viewPos) {
+    RayTracer tracer(options.width, options.height, pool);
+    tracer.setCamera(view, projection, viewPos);
+    tracer.setLights(setupLights(vec3(0.0f), 1.0f));
+    tracer.setMaterial(SoftMaterial());
+    tracer.setBackground(vec3(0.08f));
+    tracer.setScene(vertices, &texture);
+    cout << "BVH: " << tracer.bvh().triangleCount() << " triangles, " << tracer.bvh().getNodes().size()
+         << " nodes, built in " << tracer.bvh().lastBuildMs() << " ms" << endl;
+
+    double totalMs = 0.0, bestMs = INFINITY, bestRate = 0.0;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        tracer.render(options.samplesPerPixel, options.shadows);
+        totalMs += tracer.stats().renderMs;
+        bestMs = min(bestMs, tracer.stats().renderMs);
+        bestRate = max(bestRate, tracer.stats().mraysPerSecond());
+    }
+
+    const RayTraceStats& stats = tracer.stats();
+    cout << "Ray traced " << options.width << "x" << options.height << " at " << options.samplesPerPixel << " spp"
+         << (options.shadows ? " with shadows" : "") << " using " << pool.threadCount() << " thread(s)" << endl;
+    cout << "  frame: " << totalMs / options.frames << " ms average, " << bestMs << " ms best over " << options.frames << " frame(s)" << endl;
+    cout << "  rays: " << stats.primaryRays << " primary, " << stats.shadowRays << " shadow, "
+         << bestRate << " Mrays/s best" << endl;
+    return tracer.readRgba8();
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    vector<MeshVertex> vertices;
+    if (!loadObjTriangles(options.objPath, vertices))
+        return 1;
+    fillMissingNormals(vertices);
+
+    SoftTexture texture;
+    int texWidth, texHeight, texChannels;
+    unsigned char* texData = stbi_load(options.texturePath.c_str(), &texWidth, &texHeight, &texChannels, 0);
+    if (texData) {
+        texture.load(texData, texWidth, texHeight, texChannels);
+        stbi_image_free(texData);
+    } else {
+        std::cout << "Texture failed to load at path: " << options.texturePath << std::endl;
+    }
+
+    ThreadPool pool(options.threads);
+    vec3 viewPos = vec3(0.0f, 0.0f, 3.0f);
+    mat4 projection = perspective(radians(45.0f), (float)options.width / (float)options.height, 0.1f, 100.0f);
+    mat4 view = lookAt(viewPos, vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    vector<unsigned char> image = options.rayTrace
+        ? rayTraceScene(options, vertices, texture, pool, view, projection, viewPos)
+        : rasterizeScene(options, vertices, texture, pool, view, projection, viewPos);
+
+    if (!stbi_write_png(options.outPath.c_str(), options.width, options.height, 4, image.data(), options.width * 4)) {
+        cerr << "Failed to write " << options.outPath << endl;
+        return 1;
+    }
+    cout << "Image written to " << options.outPath << endl;
+
+    if (!options.comparePath.empty() && !compareImages(image, options.width, options.height, options))
+        return 1;
+    return 0;
+}
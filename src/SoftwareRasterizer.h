@@ -0,0 +1,671 @@
+#pragma once
+
+// Rasterizador por software para nós sem GPU: desenha as mesmas malhas (MeshVertex)
+// com o mesmo Phong de três luzes dos exercícios (Vivencial2/M5) num framebuffer em
+// memória, que pode ser gravado em PNG e comparado com a referência do OpenGL.
+//
+//   SoftwareRasterizer raster(800, 800);
+//   raster.setCamera(view, projection, viewPos);
+//   raster.setLights(lights);
+//   raster.clear(glm::vec3(0.08f));
+//   raster.draw(vertices, model, &texture);
+//   std::vector<unsigned char> rgba = raster.readRgba8();
+//
+// Cada draw tem duas fases paralelas (ThreadPool):
+//   1. vértices + setup: os triângulos são divididos em lotes; cada lote transforma,
+//      recorta contra o plano near (e uma guard band), calcula as funções de aresta
+//      e distribui os triângulos nos bins dos tiles 64x64 que o AABB dele cobre;
+//   2. rasterização: cada tile é de uma única thread por vez, que percorre os bins
+//      de todos os lotes em ordem de submissão (o resultado não depende do número
+//      de threads) em blocos 8x8, testados de 4 em 4 pixels com float4 (Simd.h).
+//
+// Regras seguidas para bater com o GL: centros de pixel em .5, vértices com 8 bits
+// de subpixel, regra top-left, profundidade GL_LESS, interpolação com correção de
+// perspectiva e textura com mipmaps trilineares em GL_REPEAT. Sem face culling
+// (os exercícios não ligam GL_CULL_FACE). A cor de vértice é a normal do objeto,
+// porque os VAOs dos exercícios ligam o atributo 1 (color) ao offset da normal.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "NormalMatrix.h"
+#include "ObjMesh.h"
+#include "ParallelFor.h"
+#include "Simd.h"
+
+struct SoftLight {
+    glm::vec3 position;
+    glm::vec3 color;
+    float intensity = 1.0f;
+    bool enabled = true;
+};
+
+struct SoftMaterial {
+    float ka = 0.1f;
+    float kd = 0.7f;
+    float ks = 0.5f;
+    float shininess = 32.0f;
+};
+
+// Textura RGBA8 com a cadeia de mipmaps (filtro caixa 2x2, como o glGenerateMipmap)
+class SoftTexture {
+public:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<unsigned char> rgba;
+    };
+
+    // "channels" como o stbi_load devolve (1, 3 ou 4)
+    void load(const unsigned char* data, int width, int height, int channels) {
+        levels.assign(1, Level());
+        Level& base = levels[0];
+        base.width = width;
+        base.height = height;
+        base.rgba.resize((size_t)width * height * 4);
+        for (size_t i = 0; i < (size_t)width * height; ++i) {
+            const unsigned char* src = data + i * channels;
+            unsigned char* dst = &base.rgba[i * 4];
+            // GL_RED devolve (r, 0, 0, 1) na amostragem
+            dst[0] = src[0];
+            dst[1] = channels >= 3 ? src[1] : 0;
+            dst[2] = channels >= 3 ? src[2] : 0;
+            dst[3] = channels == 4 ? src[3] : 255;
+        }
+        while (levels.back().width > 1 || levels.back().height > 1) {
+            const Level& prev = levels.back();
+            Level next;
+            next.width = std::max(1, prev.width / 2);
+            next.height = std::max(1, prev.height / 2);
+            next.rgba.resize((size_t)next.width * next.height * 4);
+            for (int y = 0; y < next.height; ++y) {
+                for (int x = 0; x < next.width; ++x) {
+                    int x0 = std::min(x * 2, prev.width - 1), x1 = std::min(x * 2 + 1, prev.width - 1);
+                    int y0 = std::min(y * 2, prev.height - 1), y1 = std::min(y * 2 + 1, prev.height - 1);
+                    for (int c = 0; c < 4; ++c) {
+                        int sum = prev.rgba[((size_t)y0 * prev.width + x0) * 4 + c] + prev.rgba[((size_t)y0 * prev.width + x1) * 4 + c] +
+                                  prev.rgba[((size_t)y1 * prev.width + x0) * 4 + c] + prev.rgba[((size_t)y1 * prev.width + x1) * 4 + c];
+                        next.rgba[((size_t)y * next.width + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            levels.push_back(std::move(next));
+        }
+    }
+
+    bool empty() const { return levels.empty(); }
+    int width() const { return levels.empty() ? 0 : levels[0].width; }
+    int height() const { return levels.empty() ? 0 : levels[0].height; }
+    int levelCount() const { return (int)levels.size(); }
+
+    // GL_LINEAR_MIPMAP_LINEAR (lod <= 0 vira GL_LINEAR no nível 0)
+    glm::vec3 sample(float u, float v, float lod) const {
+        if (lod <= 0.0f || levels.size() == 1)
+            return bilinear(levels[0], u, v);
+        lod = std::min(lod, (float)(levels.size() - 1));
+        int level = (int)lod;
+        float t = lod - level;
+        glm::vec3 a = bilinear(levels[level], u, v);
+        if (t == 0.0f) return a;
+        glm::vec3 b = bilinear(levels[std::min(level + 1, (int)levels.size() - 1)], u, v);
+        return a + (b - a) * t;
+    }
+
+private:
+    std::vector<Level> levels;
+
+    static glm::vec3 bilinear(const Level& level, float u, float v) {
+        float x = u * level.width - 0.5f;
+        float y = v * level.height - 0.5f;
+        float fx = std::floor(x), fy = std::floor(y);
+        float tx = x - fx, ty = y - fy;
+        int x0 = wrap((int)fx, level.width), x1 = wrap((int)fx + 1, level.width);
+        int y0 = wrap((int)fy, level.height), y1 = wrap((int)fy + 1, level.height);
+        const unsigned char* p00 = &level.rgba[((size_t)y0 * level.width + x0) * 4];
+        const unsigned char* p10 = &level.rgba[((size_t)y0 * level.width + x1) * 4];
+        const unsigned char* p01 = &level.rgba[((size_t)y1 * level.width + x0) * 4];
+        const unsigned char* p11 = &level.rgba[((size_t)y1 * level.width + x1) * 4];
+        glm::vec3 result;
+        for (int c = 0; c < 3; ++c) {
+            float top = p00[c] + (p10[c] - p00[c]) * tx;
+            float bottom = p01[c] + (p11[c] - p01[c]) * tx;
+            result[c] = (top + (bottom - top) * ty) * (1.0f / 255.0f);
+        }
+        return result;
+    }
+
+    // GL_REPEAT
+    static int wrap(int i, int size) {
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+};
+
+struct SoftRasterStats {
+    int trianglesIn = 0;
+    int trianglesSetup = 0;      // depois de recorte e descarte (degenerados / fora da tela)
+    int binEntries = 0;          // pares (triângulo, tile)
+    long long pixelsShaded = 0;
+    double setupMs = 0.0;
+    double rasterMs = 0.0;
+};
+
+class SoftwareRasterizer {
+public:
+    static const int TileSize = 64;
+    static const int BlockSize = 8;
+    static const int TrianglesPerBatch = 256;
+
+    SoftwareRasterizer(int width, int height, ThreadPool& pool = ThreadPool::global()) : pool(pool) {
+        resize(width, height);
+    }
+
+    void resize(int newWidth, int newHeight) {
+        fbWidth = newWidth;
+        fbHeight = newHeight;
+        // Linhas e colunas completadas até múltiplos do tile: blocos nunca saem da memória
+        tilesX = (fbWidth + TileSize - 1) / TileSize;
+        tilesY = (fbHeight + TileSize - 1) / TileSize;
+        stride = tilesX * TileSize;
+        color.assign((size_t)stride * tilesY * TileSize, 0);
+        depth.assign(color.size(), 1.0f);
+        workerPixels.assign(pool.threadCount(), 0);
+    }
+
+    int width() const { return fbWidth; }
+    int height() const { return fbHeight; }
+    const SoftRasterStats& stats() const { return frameStats; }
+
+    void setCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& position) {
+        viewProjection = projection * view;
+        viewPos = position;
+    }
+
+    void setLights(const std::vector<SoftLight>& newLights) { lights = newLights; }
+    void setMaterial(const SoftMaterial& newMaterial) { material = newMaterial; }
+
+    // glClearColor + glClear(COLOR | DEPTH); zera as estatísticas do quadro
+    void clear(const glm::vec3& clearColor) {
+        std::fill(color.begin(), color.end(), packColor(clearColor.r, clearColor.g, clearColor.b));
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        frameStats = SoftRasterStats();
+    }
+
+    // Equivalente a drawModel + glDrawArrays(GL_TRIANGLES) nos exercícios
+    void draw(const std::vector<MeshVertex>& vertices, const glm::mat4& model, const SoftTexture* texture) {
+        auto start = std::chrono::steady_clock::now();
+        int triangleCount = (int)(vertices.size() / 3);
+        int batchCount = (triangleCount + TrianglesPerBatch - 1) / TrianglesPerBatch;
+        if (batchCount == 0) return;
+        if ((int)batches.size() < batchCount)
+            batches.resize(batchCount);
+
+        DrawState state;
+        state.mvp = viewProjection * model;
+        state.model = model;
+        state.normalMatrix = computeNormalMatrix(model);
+        state.vertices = &vertices;
+        state.texture = texture && !texture->empty() ? texture : nullptr;
+
+        pool.parallelFor(batchCount, [&](int batch, int) {
+            setupBatch(state, batches[batch], batch * TrianglesPerBatch,
+                       std::min(triangleCount, (batch + 1) * TrianglesPerBatch));
+        });
+        auto setupEnd = std::chrono::steady_clock::now();
+
+        std::fill(workerPixels.begin(), workerPixels.end(), 0);
+        pool.parallelFor(tilesX * tilesY, [&](int tile, int worker) {
+            rasterTile(state, tile, batchCount, worker);
+        });
+        auto rasterEnd = std::chrono::steady_clock::now();
+
+        frameStats.trianglesIn += triangleCount;
+        for (int b = 0; b < batchCount; ++b) {
+            frameStats.trianglesSetup += (int)batches[b].triangles.size();
+            for (const std::vector<int>& bin : batches[b].bins)
+                frameStats.binEntries += (int)bin.size();
+        }
+        for (long long pixels : workerPixels)
+            frameStats.pixelsShaded += pixels;
+        frameStats.setupMs += std::chrono::duration<double, std::milli>(setupEnd - start).count();
+        frameStats.rasterMs += std::chrono::duration<double, std::milli>(rasterEnd - setupEnd).count();
+    }
+
+    // Cor em RGBA8, linha 0 no topo da imagem (como o PNG do modo headless)
+    std::vector<unsigned char> readRgba8() const {
+        std::vector<unsigned char> out((size_t)fbWidth * fbHeight * 4);
+        for (int y = 0; y < fbHeight; ++y) {
+            for (int x = 0; x < fbWidth; ++x) {
+                uint32_t c = color[(size_t)y * stride + x];
+                unsigned char* dst = &out[((size_t)y * fbWidth + x) * 4];
+                dst[0] = (unsigned char)(c & 0xFF);
+                dst[1] = (unsigned char)((c >> 8) & 0xFF);
+                dst[2] = (unsigned char)((c >> 16) & 0xFF);
+                dst[3] = (unsigned char)(c >> 24);
+            }
+        }
+        return out;
+    }
+
+private:
+    // Atributos interpolados, na ordem em que o fragment shader os usa
+    enum {
+        AttrFragPos = 0,     // 3: model * position
+        AttrNormal = 3,      // 3: normalMatrix * normal
+        AttrTexCoord = 6,    // 2
+        AttrColor = 8,       // 3: vColor (normal do objeto, ver comentário no topo)
+        AttrCount = 11
+    };
+
+    struct ClipVertex {
+        glm::vec4 clip;
+        float attr[AttrCount];
+    };
+
+    struct Triangle {
+        // Funções de aresta E_k(x, y) = a*x + b*y + c, positivas dentro do triângulo.
+        // Com vértices em 1/256 de pixel e double, os coeficientes são exatos, e
+        // arestas compartilhadas dão valores opostos: nenhum pixel é pintado duas vezes.
+        double edgeA[3], edgeB[3], edgeC[3];
+        bool topLeft[3];
+        int minX, minY, maxX, maxY;
+        float invArea;                       // 1 / (2 * área), para baricêntricas
+        float z0, dz1, dz2;                  // profundidade [0, 1], linear na tela
+        float q[3];                          // 1 / w por vértice
+        float attr0[AttrCount], attrD1[AttrCount], attrD2[AttrCount];
+        float uvGradient[6];                 // d(u/w)/dx, d(v/w)/dx, d(1/w)/dx e o mesmo em y
+    };
+
+    struct Batch {
+        std::vector<Triangle> triangles;
+        std::vector<std::vector<int>> bins;  // um por tile, índices em "triangles"
+    };
+
+    struct DrawState {
+        glm::mat4 mvp;
+        glm::mat4 model;
+        glm::mat3 normalMatrix;
+        const std::vector<MeshVertex>* vertices;
+        const SoftTexture* texture;
+    };
+
+    ThreadPool& pool;
+    int fbWidth = 0, fbHeight = 0;
+    int tilesX = 0, tilesY = 0;
+    int stride = 0;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+    std::vector<Batch> batches;
+    std::vector<long long> workerPixels;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+    glm::vec3 viewPos = glm::vec3(0.0f);
+    std::vector<SoftLight> lights;
+    SoftMaterial material;
+    SoftRasterStats frameStats;
+
+    static uint32_t packColor(float r, float g, float b) {
+        auto channel = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+        return channel(r) | (channel(g) << 8) | (channel(b) << 16) | 0xFF000000u;
+    }
+
+    // ---- Fase 1: vértices, recorte e binning ----
+
+    void setupBatch(const DrawState& state, Batch& batch, int firstTriangle, int endTriangle) {
+        batch.triangles.clear();
+        batch.bins.resize(tilesX * tilesY);
+        for (std::vector<int>& bin : batch.bins)
+            bin.clear();
+
+        const std::vector<MeshVertex>& vertices = *state.vertices;
+        ClipVertex polygon[12], scratch[12];
+        for (int t = firstTriangle; t < endTriangle; ++t) {
+            for (int k = 0; k < 3; ++k)
+                transformVertex(state, vertices[t * 3 + k], polygon[k]);
+            int count = clipPolygon(polygon, scratch, 3);
+            for (int k = 1; k + 1 < count; ++k)
+                setupTriangle(state, batch, polygon[0], polygon[k], polygon[k + 1]);
+        }
+    }
+
+    static void transformVertex(const DrawState& state, const MeshVertex& v, ClipVertex& out) {
+        glm::vec4 p(v.position, 1.0f);
+        out.clip = state.mvp * p;
+        glm::vec3 fragPos = glm::vec3(state.model * p);
+        glm::vec3 normal = state.normalMatrix * v.normal;
+        for (int i = 0; i < 3; ++i) {
+            out.attr[AttrFragPos + i] = fragPos[i];
+            out.attr[AttrNormal + i] = normal[i];
+            out.attr[AttrColor + i] = v.normal[i];
+        }
+        out.attr[AttrTexCoord] = v.texCoord.x;
+        out.attr[AttrTexCoord + 1] = v.texCoord.y;
+    }
+
+    // Distância com sinal ao plano p (>= 0 dentro): near e guard band em x/y.
+    // A guard band mantém as coordenadas de tela pequenas o bastante para o setup exato.
+    static float planeDistance(const glm::vec4& c, int plane) {
+        const float guard = 8.0f;
+        switch (plane) {
+        case 0: return c.z + c.w;
+        case 1: return guard * c.w - c.x;
+        case 2: return guard * c.w + c.x;
+        case 3: return guard * c.w - c.y;
+        default: return guard * c.w + c.y;
+        }
+    }
+
+    // Sutherland-Hodgman; retorna o número de vértices em "polygon" (0 se sumiu)
+    static int clipPolygon(ClipVertex* polygon, ClipVertex* scratch, int count) {
+        for (int plane = 0; plane < 5 && count >= 3; ++plane) {
+            float d[12];
+            bool allInside = true, allOutside = true;
+            for (int i = 0; i < count; ++i) {
+                d[i] = planeDistance(polygon[i].clip, plane);
+                allInside = allInside && d[i] >= 0.0f;
+                allOutside = allOutside && d[i] < 0.0f;
+            }
+            if (allInside) continue;
+            if (allOutside) return 0;
+            int out = 0;
+            for (int i = 0; i < count; ++i) {
+                int j = (i + 1) % count;
+                if (d[i] >= 0.0f)
+                    scratch[out++] = polygon[i];
+                if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+                    float t = d[i] / (d[i] - d[j]);
+                    ClipVertex& v = scratch[out++];
+                    v.clip = polygon[i].clip + (polygon[j].clip - polygon[i].clip) * t;
+                    for (int a = 0; a < AttrCount; ++a)
+                        v.attr[a] = polygon[i].attr[a] + (polygon[j].attr[a] - polygon[i].attr[a]) * t;
+                }
+            }
+            count = out;
+            std::copy(scratch, scratch + count, polygon);
+        }
+        return count >= 3 ? count : 0;
+    }
+
+    void setupTriangle(const DrawState& state, Batch& batch, const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+        const ClipVertex* v[3] = {&v0, &v1, &v2};
+        double sx[3], sy[3];
+        float z[3], q[3];
+        for (int k = 0; k < 3; ++k) {
+            q[k] = 1.0f / v[k]->clip.w;
+            float ndcX = v[k]->clip.x * q[k], ndcY = v[k]->clip.y * q[k];
+            // Janela do GL com y para baixo (linha 0 no topo), em 1/256 de pixel
+            sx[k] = std::round((ndcX * 0.5 + 0.5) * fbWidth * 256.0) / 256.0;
+            sy[k] = std::round((0.5 - ndcY * 0.5) * fbHeight * 256.0) / 256.0;
+            z[k] = v[k]->clip.z * q[k] * 0.5f + 0.5f;
+        }
+
+        Triangle tri;
+        // Aresta k é a oposta ao vértice k: (k+1) -> (k+2)
+        for (int k = 0; k < 3; ++k) {
+            int a = (k + 1) % 3, b = (k + 2) % 3;
+            tri.edgeA[k] = sy[a] - sy[b];
+            tri.edgeB[k] = sx[b] - sx[a];
+            tri.edgeC[k] = sx[a] * sy[b] - sy[a] * sx[b];
+        }
+        double area2 = tri.edgeA[0] * sx[0] + tri.edgeB[0] * sy[0] + tri.edgeC[0];
+        if (area2 == 0.0) return;
+        if (area2 < 0.0) {
+            // Sem culling: vira as arestas para que o interior seja sempre positivo
+            for (int k = 0; k < 3; ++k) {
+                tri.edgeA[k] = -tri.edgeA[k];
+                tri.edgeB[k] = -tri.edgeB[k];
+                tri.edgeC[k] = -tri.edgeC[k];
+            }
+            area2 = -area2;
+        }
+        for (int k = 0; k < 3; ++k)
+            tri.topLeft[k] = tri.edgeA[k] > 0.0 || (tri.edgeA[k] == 0.0 && tri.edgeB[k] > 0.0);
+
+        // Pixels cujo centro (x + 0.5) cai no AABB do triângulo
+        double minSx = std::min(sx[0], std::min(sx[1], sx[2])), maxSx = std::max(sx[0], std::max(sx[1], sx[2]));
+        double minSy = std::min(sy[0], std::min(sy[1], sy[2])), maxSy = std::max(sy[0], std::max(sy[1], sy[2]));
+        tri.minX = std::max(0, (int)std::ceil(minSx - 0.5));
+        tri.maxX = std::min(fbWidth - 1, (int)std::floor(maxSx - 0.5));
+        tri.minY = std::max(0, (int)std::ceil(minSy - 0.5));
+        tri.maxY = std::min(fbHeight - 1, (int)std::floor(maxSy - 0.5));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+        tri.invArea = (float)(1.0 / area2);
+        tri.z0 = z[0];
+        tri.dz1 = z[1] - z[0];
+        tri.dz2 = z[2] - z[0];
+        for (int k = 0; k < 3; ++k)
+            tri.q[k] = q[k];
+        for (int a = 0; a < AttrCount; ++a) {
+            tri.attr0[a] = v0.attr[a];
+            tri.attrD1[a] = v1.attr[a] - v0.attr[a];
+            tri.attrD2[a] = v2.attr[a] - v0.attr[a];
+        }
+
+        // Gradientes de tela de u/w, v/w e 1/w (b1 e b2 são lineares em x e y),
+        // usados para escolher o nível de mipmap como o GL faz com as derivadas
+        if (state.texture) {
+            double b1dx = tri.edgeA[1] / area2, b2dx = tri.edgeA[2] / area2;
+            double b1dy = tri.edgeB[1] / area2, b2dy = tri.edgeB[2] / area2;
+            float uq[3], vq[3];
+            for (int k = 0; k < 3; ++k) {
+                uq[k] = v[k]->attr[AttrTexCoord] * q[k];
+                vq[k] = v[k]->attr[AttrTexCoord + 1] * q[k];
+            }
+            tri.uvGradient[0] = (float)(b1dx * (uq[1] - uq[0]) + b2dx * (uq[2] - uq[0]));
+            tri.uvGradient[1] = (float)(b1dx * (vq[1] - vq[0]) + b2dx * (vq[2] - vq[0]));
+            tri.uvGradient[2] = (float)(b1dx * (q[1] - q[0]) + b2dx * (q[2] - q[0]));
+            tri.uvGradient[3] = (float)(b1dy * (uq[1] - uq[0]) + b2dy * (uq[2] - uq[0]));
+            tri.uvGradient[4] = (float)(b1dy * (vq[1] - vq[0]) + b2dy * (vq[2] - vq[0]));
+            tri.uvGradient[5] = (float)(b1dy * (q[1] - q[0]) + b2dy * (q[2] - q[0]));
+        }
+
+        int index = (int)batch.triangles.size();
+        batch.triangles.push_back(tri);
+        for (int ty = tri.minY / TileSize; ty <= tri.maxY / TileSize; ++ty)
+            for (int tx = tri.minX / TileSize; tx <= tri.maxX / TileSize; ++tx)
+                batch.bins[ty * tilesX + tx].push_back(index);
+    }
+
+    // ---- Fase 2: rasterização por tile ----
+
+    void rasterTile(const DrawState& state, int tile, int batchCount, int worker) {
+        int tileX = (tile % tilesX) * TileSize;
+        int tileY = (tile / tilesX) * TileSize;
+        for (int b = 0; b < batchCount; ++b) {
+            const Batch& batch = batches[b];
+            for (int index : batch.bins[tile])
+                workerPixels[worker] += rasterTriangle(state, batch.triangles[index], tileX, tileY);
+        }
+    }
+
+    long long rasterTriangle(const DrawState& state, const Triangle& tri, int tileX, int tileY) {
+        int x0 = std::max(tri.minX, tileX) & ~(BlockSize - 1);
+        int y0 = std::max(tri.minY, tileY) & ~(BlockSize - 1);
+        int x1 = std::min(tri.maxX, tileX + TileSize - 1);
+        int y1 = std::min(tri.maxY, tileY + TileSize - 1);
+        long long shaded = 0;
+
+        for (int by = y0; by <= y1; by += BlockSize) {
+            for (int bx = x0; bx <= x1; bx += BlockSize) {
+                // Descarta o bloco se algum canto "mais dentro" de uma aresta já está fora
+                double cx = bx + 0.5, cy = by + 0.5;
+                double e[3];
+                bool outside = false;
+                for (int k = 0; k < 3 && !outside; ++k) {
+                    e[k] = tri.edgeA[k] * cx + tri.edgeB[k] * cy + tri.edgeC[k];
+                    double best = e[k] + std::max(0.0, tri.edgeA[k]) * (BlockSize - 1) + std::max(0.0, tri.edgeB[k]) * (BlockSize - 1);
+                    outside = best < 0.0;
+                }
+                if (!outside)
+                    shaded += rasterBlock(state, tri, bx, by, e);
+            }
+        }
+        return shaded;
+    }
+
+    long long rasterBlock(const DrawState& state, const Triangle& tri, int bx, int by, const double* blockEdge) {
+        const float4 laneOffset(0.0f, 1.0f, 2.0f, 3.0f);
+        const float4 zero(0.0f), one(1.0f);
+        float4 edgeBase[3], stepX[3], stepY[3], topLeft[3];
+        for (int k = 0; k < 3; ++k) {
+            edgeBase[k] = float4((float)blockEdge[k]);
+            stepX[k] = float4((float)tri.edgeA[k]);
+            stepY[k] = float4((float)tri.edgeB[k]);
+            topLeft[k] = tri.topLeft[k] ? (zero == zero) : (zero < zero);
+        }
+        const float4 widthLimit((float)fbWidth);
+        long long shaded = 0;
+
+        for (int row = 0; row < BlockSize; ++row) {
+            int py = by + row;
+            if (py >= fbHeight) break;
+            float4 fy((float)row);
+            for (int group = 0; group < BlockSize; group += 4) {
+                int px = bx + group;
+                float4 fx = laneOffset + (float)group;
+                float4 edge[3];
+                float4 mask = float4((float)px) + laneOffset < widthLimit;
+                for (int k = 0; k < 3; ++k) {
+                    // Soma em float na mesma ordem para os dois triângulos de uma aresta:
+                    // os valores continuam exatamente opostos
+                    edge[k] = edgeBase[k] + stepX[k] * fx + stepY[k] * fy;
+                    mask = mask & ((edge[k] > zero) | ((edge[k] == zero) & topLeft[k]));
+                }
+                if (!movemask(mask)) continue;
+
+                float4 b1 = edge[1] * tri.invArea;
+                float4 b2 = edge[2] * tri.invArea;
+                float4 z = float4(tri.z0) + b1 * tri.dz1 + b2 * tri.dz2;
+                float* depthRow = &depth[(size_t)py * stride + px];
+                float4 stored = float4::load(depthRow);
+                mask = mask & (z < stored) & (z >= zero) & (z <= one);
+                int bits = movemask(mask);
+                if (!bits) continue;
+                select(mask, z, stored).store(depthRow);
+
+                float4 r, g, b;
+                shade(state, tri, b1, b2, r, g, b);
+                alignas(16) float rs[4], gs[4], bs[4];
+                r.store(rs);
+                g.store(gs);
+                b.store(bs);
+                uint32_t* colorRow = &color[(size_t)py * stride + px];
+                for (int lane = 0; lane < 4; ++lane) {
+                    if (bits & (1 << lane)) {
+                        colorRow[lane] = packColor(rs[lane], gs[lane], bs[lane]);
+                        ++shaded;
+                    }
+                }
+            }
+        }
+        return shaded;
+    }
+
+    // Fragment shader do Vivencial2, 4 pixels por vez
+    void shade(const DrawState& state, const Triangle& tri, float4 b1, float4 b2, float4& outR, float4& outG, float4& outB) const {
+        // Baricêntricas com correção de perspectiva
+        float4 q = float4(tri.q[0]) + b1 * (tri.q[1] - tri.q[0]) + b2 * (tri.q[2] - tri.q[0]);
+        float4 invQ = float4(1.0f) / q;
+        float4 p1 = b1 * tri.q[1] * invQ;
+        float4 p2 = b2 * tri.q[2] * invQ;
+        float4 attr[AttrCount];
+        for (int a = 0; a < AttrCount; ++a)
+            attr[a] = float4(tri.attr0[a]) + p1 * tri.attrD1[a] + p2 * tri.attrD2[a];
+
+        float4 fragX = attr[AttrFragPos], fragY = attr[AttrFragPos + 1], fragZ = attr[AttrFragPos + 2];
+        float4 nx = attr[AttrNormal], ny = attr[AttrNormal + 1], nz = attr[AttrNormal + 2];
+        float4 invLen = float4(1.0f) / sqrt(nx * nx + ny * ny + nz * nz);
+        nx = nx * invLen; ny = ny * invLen; nz = nz * invLen;
+
+        float4 vx = float4(viewPos.x) - fragX, vy = float4(viewPos.y) - fragY, vz = float4(viewPos.z) - fragZ;
+        invLen = float4(1.0f) / sqrt(vx * vx + vy * vy + vz * vz);
+        vx = vx * invLen; vy = vy * invLen; vz = vz * invLen;
+
+        float4 r(material.ka), g(material.ka), b(material.ka);
+        const float4 zero(0.0f);
+        for (const SoftLight& light : lights) {
+            if (!light.enabled) continue;
+            float4 lx = float4(light.position.x) - fragX, ly = float4(light.position.y) - fragY, lz = float4(light.position.z) - fragZ;
+            float4 distance = sqrt(lx * lx + ly * ly + lz * lz);
+            float4 invDistance = float4(1.0f) / distance;
+            lx = lx * invDistance; ly = ly * invDistance; lz = lz * invDistance;
+            float4 attenuation = float4(1.0f) / (float4(1.0f) + distance * 0.1f + distance * distance * 0.01f);
+
+            float4 nDotL = nx * lx + ny * ly + nz * lz;
+            float4 diff = max(nDotL, zero);
+            // reflect(-L, N) = 2 * dot(N, L) * N - L
+            float4 rx = nx * nDotL * 2.0f - lx, ry = ny * nDotL * 2.0f - ly, rz = nz * nDotL * 2.0f - lz;
+            float4 spec = power(max(vx * rx + vy * ry + vz * rz, zero), material.shininess);
+
+            float4 amount = (diff * material.kd + spec * material.ks) * attenuation * light.intensity;
+            r = r + amount * light.color.r;
+            g = g + amount * light.color.g;
+            b = b + amount * light.color.b;
+        }
+
+        r = r * attr[AttrColor];
+        g = g * attr[AttrColor + 1];
+        b = b * attr[AttrColor + 2];
+
+        if (state.texture) {
+            alignas(16) float u[4], v[4], lod[4];
+            attr[AttrTexCoord].store(u);
+            attr[AttrTexCoord + 1].store(v);
+            textureLod(state.texture, tri, q, attr[AttrTexCoord], attr[AttrTexCoord + 1]).store(lod);
+            alignas(16) float tr[4], tg[4], tb[4];
+            for (int lane = 0; lane < 4; ++lane) {
+                glm::vec3 texel = state.texture->sample(u[lane], v[lane], lod[lane]);
+                tr[lane] = texel.r;
+                tg[lane] = texel.g;
+                tb[lane] = texel.b;
+            }
+            r = r * float4::load(tr);
+            g = g * float4::load(tg);
+            b = b * float4::load(tb);
+        }
+        outR = r;
+        outG = g;
+        outB = b;
+    }
+
+    // lambda = log2(max(|d(uv)/dx|, |d(uv)/dy|) em texels), com as derivadas exatas de
+    // u = (u/w) / (1/w): du/dx = (d(u/w)/dx - u * d(1/w)/dx) / (1/w)
+    static float4 textureLod(const SoftTexture* texture, const Triangle& tri, float4 q, float4 u, float4 v) {
+        float4 invQ = float4(1.0f) / q;
+        float4 w((float)texture->width()), h((float)texture->height());
+        float4 dudx = (float4(tri.uvGradient[0]) - u * tri.uvGradient[2]) * invQ * w;
+        float4 dvdx = (float4(tri.uvGradient[1]) - v * tri.uvGradient[2]) * invQ * h;
+        float4 dudy = (float4(tri.uvGradient[3]) - u * tri.uvGradient[5]) * invQ * w;
+        float4 dvdy = (float4(tri.uvGradient[4]) - v * tri.uvGradient[5]) * invQ * h;
+        float4 rho2 = max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+        alignas(16) float values[4];
+        rho2.store(values);
+        for (float& value : values)
+            value = value > 0.0f ? 0.5f * std::log2(value) : 0.0f;
+        return float4::load(values);
+    }
+
+    // pow(x, e) para x >= 0; expoente inteiro (o caso dos exercícios) fica em SIMD
+    static float4 power(float4 x, float exponent) {
+        int n = (int)exponent;
+        if ((float)n == exponent && n >= 0 && n <= 256) {
+            float4 result(1.0f);
+            while (n) {
+                if (n & 1) result = result * x;
+                x = x * x;
+                n >>= 1;
+            }
+            return result;
+        }
+        alignas(16) float values[4];
+        x.store(values);
+        for (float& value : values)
+            value = std::pow(value, exponent);
+        return float4::load(values);
+    }
+};
@@ -0,0 +1,355 @@
+#pragma once
+
+// Grade uniforme "solta" com hash espacial para picking e consultas de proximidade.
+// Cada objeto fica na célula que contém o centro do seu AABB; as consultas
+// expandem a busca pela maior meia-extensão dos objetos atuais. Mover um objeto é O(1)
+// amortizado (troca com o último elemento da célula antiga) mais O(log n) quando a
+// extensão ou a célula muda: a maior extensão e a região ocupada vêm de contagens
+// ordenadas, então encolhem quando o objeto maior ou o mais afastado sai.
+// insert/move/remove retornam false para ids inválidos (move e remove só valem para
+// objetos inseridos). Não depende de OpenGL.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <map>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Bounds.h"
+
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize = 2.0f) : cellSize(cellSize), invCellSize(1.0f / cellSize) {}
+
+    void clear() {
+        cells.clear();
+        objects.clear();
+        extentCounts.clear();
+        for (std::map<int, int>& counts : axisCounts)
+            counts.clear();
+        maxHalfExtent = 0.0f;
+        occupiedMin = glm::ivec3(INT32_MAX);
+        occupiedMax = glm::ivec3(INT32_MIN);
+    }
+
+    bool insert(int id, const AABB& bounds) {
+        if (id < 0) return false;
+        if (id >= (int)objects.size())
+            objects.resize(id + 1);
+        if (objects[id].active)
+            remove(id);
+        Object& obj = objects[id];
+        obj.bounds = bounds;
+        obj.cell = cellOf(bounds.center());
+        obj.active = true;
+        obj.halfExtent = halfExtentOf(bounds);
+        addExtent(obj.halfExtent);
+        addToCell(id, obj.cell);
+        return true;
+    }
+
+    bool move(int id, const AABB& bounds) {
+        if (!isActive(id)) return false;
+        Object& obj = objects[id];
+        obj.bounds = bounds;
+        float halfExtent = halfExtentOf(bounds);
+        if (halfExtent != obj.halfExtent) {
+            removeExtent(obj.halfExtent);
+            obj.halfExtent = halfExtent;
+            addExtent(halfExtent);
+        }
+        glm::ivec3 cell = cellOf(bounds.center());
+        if (cell == obj.cell)
+            return true;
+        removeFromCell(id);
+        obj.cell = cell;
+        addToCell(id, cell);
+        return true;
+    }
+
+    bool remove(int id) {
+        if (!isActive(id)) return false;
+        removeFromCell(id);
+        removeExtent(objects[id].halfExtent);
+        objects[id].active = false;
+        return true;
+    }
+
+    bool isActive(int id) const { return id >= 0 && id < (int)objects.size() && objects[id].active; }
+
+    // Objeto mais próximo atingido pelo raio (-1 se nenhum)
+    int raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance = 1000.0f, float* hitDistance = nullptr) const {
+        int best = -1;
+        float bestT = maxDistance;
+        if (objects.empty() || occupiedMin.x > occupiedMax.x)
+            return -1;
+
+        glm::vec3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        // Recorta o raio à região ocupada (expandida pela folga da grade solta)
+        int ring = looseRing();
+        AABB world;
+        world.min = glm::vec3(occupiedMin.x - ring, occupiedMin.y - ring, occupiedMin.z - ring) * cellSize;
+        world.max = glm::vec3(occupiedMax.x + 1 + ring, occupiedMax.y + 1 + ring, occupiedMax.z + 1 + ring) * cellSize;
+        float tEnter, tExit;
+        if (!rayAABB(origin, invDir, world, maxDistance, tEnter, tExit))
+            return -1;
+
+        glm::vec3 p = origin + direction * tEnter;
+        glm::ivec3 cell = cellOf(p);
+        glm::ivec3 step(direction.x >= 0 ? 1 : -1, direction.y >= 0 ? 1 : -1, direction.z >= 0 ? 1 : -1);
+        glm::vec3 tMax, tDelta;
+        for (int a = 0; a < 3; ++a) {
+            if (direction[a] == 0.0f) {
+                tMax[a] = FLT_MAX;
+                tDelta[a] = FLT_MAX;
+                continue;
+            }
+            float boundary = (cellCoord(cell, a) + (cellCoord(step, a) > 0 ? 1 : 0)) * cellSize;
+            tMax[a] = (boundary - origin[a]) * invDir[a];
+            tDelta[a] = cellSize * std::fabs(invDir[a]);
+        }
+
+        ++stamp;
+        float tCell = tEnter;
+        while (tCell <= std::min(bestT, tExit)) {
+            forEachInRing(cell, ring, [&](int id) {
+                float t, tFar;
+                if (rayAABB(origin, invDir, objects[id].bounds, bestT, t, tFar) && t < bestT) {
+                    bestT = t;
+                    best = id;
+                }
+            });
+            int axis = 0;
+            if (tMax.y < tMax[axis]) axis = 1;
+            if (tMax.z < tMax[axis]) axis = 2;
+            tCell = tMax[axis];
+            tMax[axis] += tDelta[axis];
+            if (axis == 0) cell.x += step.x;
+            else if (axis == 1) cell.y += step.y;
+            else cell.z += step.z;
+        }
+
+        if (hitDistance && best >= 0)
+            *hitDistance = bestT;
+        return best;
+    }
+
+    // Objetos cujo AABB intersecta a esfera (center, radius)
+    void queryRadius(const glm::vec3& center, float radius, std::vector<int>& out) const {
+        out.clear();
+        float reach = radius + maxHalfExtent;
+        glm::ivec3 lo = cellOf(center - glm::vec3(reach));
+        glm::ivec3 hi = cellOf(center + glm::vec3(reach));
+        lo = glm::ivec3(std::max(lo.x, occupiedMin.x), std::max(lo.y, occupiedMin.y), std::max(lo.z, occupiedMin.z));
+        hi = glm::ivec3(std::min(hi.x, occupiedMax.x), std::min(hi.y, occupiedMax.y), std::min(hi.z, occupiedMax.z));
+        float r2 = radius * radius;
+        for (int z = lo.z; z <= hi.z; ++z)
+            for (int y = lo.y; y <= hi.y; ++y)
+                for (int x = lo.x; x <= hi.x; ++x) {
+                    auto it = cells.find(key(glm::ivec3(x, y, z)));
+                    if (it == cells.end()) continue;
+                    for (int id : it->second) {
+                        if (distanceSquared(center, objects[id].bounds) <= r2)
+                            out.push_back(id);
+                    }
+                }
+    }
+
+    // k objetos mais próximos de "point" (distância ao AABB), ordenados do mais perto ao mais longe
+    void queryNearest(const glm::vec3& point, int k, std::vector<int>& out) const {
+        out.clear();
+        if (k <= 0 || occupiedMin.x > occupiedMax.x) return;
+
+        typedef std::pair<float, int> Candidate;
+        std::priority_queue<Candidate> heap; // max-heap: topo é o pior dos k melhores
+        glm::ivec3 origin = cellOf(point);
+        int maxRing = 0;
+        for (int a = 0; a < 3; ++a)
+            maxRing = std::max(maxRing, std::max(std::abs(cellCoord(origin, a) - cellCoord(occupiedMin, a)),
+                                                 std::abs(cellCoord(origin, a) - cellCoord(occupiedMax, a))));
+
+        for (int r = 0; r <= maxRing; ++r) {
+            forEachOnShell(origin, r, [&](int id) {
+                float d2 = distanceSquared(point, objects[id].bounds);
+                if ((int)heap.size() < k)
+                    heap.push(Candidate(d2, id));
+                else if (d2 < heap.top().first) {
+                    heap.pop();
+                    heap.push(Candidate(d2, id));
+                }
+            });
+            // Objetos em anéis seguintes estão a pelo menos r*cellSize - folga do ponto
+            float guaranteed = r * cellSize - maxHalfExtent;
+            if ((int)heap.size() == k && guaranteed > 0.0f && heap.top().first <= guaranteed * guaranteed)
+                break;
+        }
+
+        out.resize(heap.size());
+        for (int i = (int)heap.size() - 1; i >= 0; --i) {
+            out[i] = heap.top().second;
+            heap.pop();
+        }
+    }
+
+    const AABB& getBounds(int id) const { return objects[id].bounds; }
+    size_t cellCount() const { return cells.size(); }
+    float getCellSize() const { return cellSize; }
+    float getMaxHalfExtent() const { return maxHalfExtent; }
+    AABB occupiedBounds() const {   // células ocupadas, em unidades de mundo (vazio: min > max)
+        AABB box;
+        box.min = glm::vec3(occupiedMin.x, occupiedMin.y, occupiedMin.z) * cellSize;
+        box.max = glm::vec3(occupiedMax.x + 1.0f, occupiedMax.y + 1.0f, occupiedMax.z + 1.0f) * cellSize;
+        return box;
+    }
+
+    static bool rayAABB(const glm::vec3& origin, const glm::vec3& invDir, const AABB& box, float maxT, float& tEnter, float& tExit) {
+        float t0 = 0.0f, t1 = maxT;
+        for (int a = 0; a < 3; ++a) {
+            float tNear = (box.min[a] - origin[a]) * invDir[a];
+            float tFar = (box.max[a] - origin[a]) * invDir[a];
+            if (tNear > tFar) std::swap(tNear, tFar);
+            // NaN (0 * inf) quando a origem está no plano: não restringe o eixo
+            if (tNear == tNear) t0 = std::max(t0, tNear);
+            if (tFar == tFar) t1 = std::min(t1, tFar);
+            if (t0 > t1) return false;
+        }
+        tEnter = t0;
+        tExit = t1;
+        return true;
+    }
+
+private:
+    struct Object {
+        AABB bounds;
+        glm::ivec3 cell;
+        int slot = -1;      // posição dentro do vetor da célula
+        float halfExtent = 0.0f;
+        bool active = false;
+    };
+
+    float cellSize;
+    float invCellSize;
+    float maxHalfExtent = 0.0f;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    std::vector<Object> objects;
+    std::map<float, int> extentCounts;   // meia-extensão -> objetos; a maior é maxHalfExtent
+    std::map<int, int> axisCounts[3];    // coordenada de célula -> objetos, por eixo
+    glm::ivec3 occupiedMin = glm::ivec3(INT32_MAX);
+    glm::ivec3 occupiedMax = glm::ivec3(INT32_MIN);
+    mutable std::vector<unsigned> visitStamp;
+    mutable unsigned stamp = 0;
+
+    static int cellCoord(const glm::ivec3& c, int axis) { return axis == 0 ? c.x : (axis == 1 ? c.y : c.z); }
+
+    glm::ivec3 cellOf(const glm::vec3& p) const {
+        return glm::ivec3((int)std::floor(p.x * invCellSize), (int)std::floor(p.y * invCellSize), (int)std::floor(p.z * invCellSize));
+    }
+
+    static uint64_t key(const glm::ivec3& c) {
+        // 21 bits por eixo (coordenadas de célula em [-2^20, 2^20))
+        const uint64_t mask = (1ull << 21) - 1;
+        return ((uint64_t)(c.x & mask)) | ((uint64_t)(c.y & mask) << 21) | ((uint64_t)(c.z & mask) << 42);
+    }
+
+    int looseRing() const { return (int)std::ceil(maxHalfExtent * invCellSize); }
+
+    static float halfExtentOf(const AABB& bounds) {
+        glm::vec3 e = bounds.extents();
+        return std::max(e.x, std::max(e.y, e.z));
+    }
+
+    void addExtent(float halfExtent) {
+        ++extentCounts[halfExtent];
+        maxHalfExtent = extentCounts.rbegin()->first;
+    }
+
+    void removeExtent(float halfExtent) {
+        auto it = extentCounts.find(halfExtent);
+        if (--it->second == 0)
+            extentCounts.erase(it);
+        maxHalfExtent = extentCounts.empty() ? 0.0f : extentCounts.rbegin()->first;
+    }
+
+    void updateOccupied() {
+        if (axisCounts[0].empty()) {
+            occupiedMin = glm::ivec3(INT32_MAX);
+            occupiedMax = glm::ivec3(INT32_MIN);
+            return;
+        }
+        occupiedMin = glm::ivec3(axisCounts[0].begin()->first, axisCounts[1].begin()->first, axisCounts[2].begin()->first);
+        occupiedMax = glm::ivec3(axisCounts[0].rbegin()->first, axisCounts[1].rbegin()->first, axisCounts[2].rbegin()->first);
+    }
+
+    void addToCell(int id, const glm::ivec3& cell) {
+        std::vector<int>& list = cells[key(cell)];
+        objects[id].slot = (int)list.size();
+        list.push_back(id);
+        for (int a = 0; a < 3; ++a)
+            ++axisCounts[a][cellCoord(cell, a)];
+        updateOccupied();
+    }
+
+    void removeFromCell(int id) {
+        const glm::ivec3& cell = objects[id].cell;
+        auto it = cells.find(key(cell));
+        std::vector<int>& list = it->second;
+        int slot = objects[id].slot;
+        int last = list.back();
+        list[slot] = last;
+        objects[last].slot = slot;
+        list.pop_back();
+        if (list.empty())
+            cells.erase(it);
+        objects[id].slot = -1;
+        for (int a = 0; a < 3; ++a) {
+            auto count = axisCounts[a].find(cellCoord(cell, a));
+            if (--count->second == 0)
+                axisCounts[a].erase(count);
+        }
+        updateOccupied();
+    }
+
+    static float distanceSquared(const glm::vec3& p, const AABB& box) {
+        glm::vec3 q = glm::max(box.min, glm::min(p, box.max));
+        glm::vec3 d = p - q;
+        return glm::dot(d, d);
+    }
+
+    // Visita cada objeto nas células a até "ring" células de "center", sem repetir dentro da mesma consulta
+    template <typename F>
+    void forEachInRing(const glm::ivec3& center, int ring, F visit) const {
+        if (visitStamp.size() < objects.size())
+            visitStamp.resize(objects.size(), 0);
+        for (int z = center.z - ring; z <= center.z + ring; ++z)
+            for (int y = center.y - ring; y <= center.y + ring; ++y)
+                for (int x = center.x - ring; x <= center.x + ring; ++x) {
+                    auto it = cells.find(key(glm::ivec3(x, y, z)));
+                    if (it == cells.end()) continue;
+                    for (int id : it->second) {
+                        if (visitStamp[id] == stamp) continue;
+                        visitStamp[id] = stamp;
+                        visit(id);
+                    }
+                }
+    }
+
+    // Visita os objetos das células exatamente a distância de Chebyshev r de "center"
+    template <typename F>
+    void forEachOnShell(const glm::ivec3& center, int r, F visit) const {
+        for (int z = center.z - r; z <= center.z + r; ++z)
+            for (int y = center.y - r; y <= center.y + r; ++y) {
+                bool faceRow = std::abs(z - center.z) == r || std::abs(y - center.y) == r;
+                int xStep = faceRow ? 1 : std::max(2 * r, 1);
+                for (int x = center.x - r; x <= center.x + r; x += xStep) {
+                    auto it = cells.find(key(glm::ivec3(x, y, z)));
+                    if (it == cells.end()) continue;
+                    for (int id : it->second)
+                        visit(id);
+                }
+            }
+    }
+};
@@ -19,6 +19,9 @@ using namespace std;
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "Headless.h"
+#include "ShapeGenerator.h"
+
 // GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -113,10 +116,12 @@ void main()
 })";
 
 // Função MAIN
-int main()
+int main(int argc, char** argv)
 {
+	HeadlessRun headless(argc, argv);
+
 	// Inicialização da GLFW
-	glfwInit();
+	headless.initGlfw();
 
 	// Muita atenção aqui: alguns ambientes não aceitam essas configurações
 	// Você deve adaptar para a versão do OpenGL suportada por sua placa
@@ -132,7 +137,7 @@ int main()
 	// #endif
 
 	// Criação da janela GLFW
-	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Ola esfera iluminada!", nullptr, nullptr);
+	GLFWwindow *window = headless.createWindow(WIDTH, HEIGHT, "Ola esfera iluminada!");
 	glfwMakeContextCurrent(window);
 
 	// Fazendo o registro da função de callback para a janela GLFW
@@ -144,6 +149,8 @@ int main()
 		std::cout << "Failed to initialize GLAD" << std::endl;
 	}
 
+	headless.setupFramebuffer();
+
 	// Obtendo as informações de versão
 	const GLubyte *renderer = glGetString(GL_RENDERER); /* get renderer string */
 	const GLubyte *version = glGetString(GL_VERSION);	/* version as a string */
@@ -217,10 +224,12 @@ int main()
 
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
+		headless.endFrame(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
+	headless.finish();
 	glfwTerminate();
 	return 0;
 }
@@ -407,85 +416,48 @@ void drawGeometry(GLuint shaderID, GLuint VAO, vec3 position, vec3 dimensions, f
 	//glUniform4f(glGetUniformLocation(shaderID, "inputColor"), color.r, color.g, color.b, 1.0f); // enviando cor para variável uniform inputColor
 																								//  Chamada de desenho - drawcall
 																								//  Poligono Preenchido - GL_TRIANGLES
-	glDrawArrays(GL_TRIANGLES, 0, nVertices);
+	// Cor (location 1, sem array): o valor corrente do atributo é estado do contexto, não
+	// do VAO, então é definido a cada desenho
+	glVertexAttrib3f(1, color.r, color.g, color.b);
+	glDrawElements(GL_TRIANGLES, nVertices, GL_UNSIGNED_INT, 0);
 }
 
+// Esfera indexada do ShapeGenerator: 32 bytes por vértice compartilhado, em vez de 6
+// vértices de 11 floats por quadrado. nVertices recebe o número de índices. A cópia na
+// CPU é liberada ao sair, depois de enviada para a GPU.
 GLuint generateSphere(float radius, int latSegments, int lonSegments, int &nVertices) {
-    vector<GLfloat> vBuffer; // Posição + Cor + Normal + UV
-
-    vec3 color = vec3(1.0f, 0.0f, 0.0f); // Laranja
-
-    auto calcPosUVNormal = [&](int lat, int lon, vec3& pos, vec2& uv, vec3& normal) {
-        float theta = lat * pi<float>() / latSegments;
-        float phi = lon * 2.0f * pi<float>() / lonSegments;
-
-        pos = vec3(
-            radius * cos(phi) * sin(theta),
-            radius * cos(theta),
-            radius * sin(phi) * sin(theta)
-        );
-
-        uv = vec2(
-            phi / (2.0f * pi<float>()),  // u
-            theta / pi<float>()          // v
-        );
-
-        // Normal é a posição normalizada (posição/radius)
-        normal = normalize(pos);
-    };
-
-    for (int i = 0; i < latSegments; ++i) {
-        for (int j = 0; j < lonSegments; ++j) {
-            vec3 v0, v1, v2, v3;
-            vec2 uv0, uv1, uv2, uv3;
-            vec3 n0, n1, n2, n3;
-
-            calcPosUVNormal(i, j, v0, uv0, n0);
-            calcPosUVNormal(i + 1, j, v1, uv1, n1);
-            calcPosUVNormal(i, j + 1, v2, uv2, n2);
-            calcPosUVNormal(i + 1, j + 1, v3, uv3, n3);
-
-            // Primeiro triângulo
-            vBuffer.insert(vBuffer.end(), { v0.x, v0.y, v0.z, color.r, color.g, color.b, n0.x, n0.y, n0.z, uv0.x, uv0.y });
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-
-            // Segundo triângulo
-            vBuffer.insert(vBuffer.end(), { v1.x, v1.y, v1.z, color.r, color.g, color.b, n1.x, n1.y, n1.z, uv1.x, uv1.y });
-            vBuffer.insert(vBuffer.end(), { v3.x, v3.y, v3.z, color.r, color.g, color.b, n3.x, n3.y, n3.z, uv3.x, uv3.y });
-            vBuffer.insert(vBuffer.end(), { v2.x, v2.y, v2.z, color.r, color.g, color.b, n2.x, n2.y, n2.z, uv2.x, uv2.y });
-        }
-    }
-
-    // Criar VAO e VBO
-    GLuint VAO, VBO;
+    ShapeMesh sphere = generateUvSphere(radius, latSegments, lonSegments);
+
+    GLuint VAO, VBO, EBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vBuffer.size() * sizeof(GLfloat), vBuffer.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sphere.vertices.size() * sizeof(MeshVertex), sphere.vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sphere.indices.size() * sizeof(uint32_t), sphere.indices.data(), GL_STATIC_DRAW);
 
     // Layout da posição (location 0)
-glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(0));
-glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
 
-// Layout da cor (location 1)
-glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-glEnableVertexAttribArray(1);
+    // Cor (location 1) sem array: valor constante, definido no drawGeometry
+    glDisableVertexAttribArray(1);
 
-// Layout da normal (location 2)
-glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-glEnableVertexAttribArray(2);
+    // Layout da normal (location 2)
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, normal));
+    glEnableVertexAttribArray(2);
 
-// Layout da UV (location 3)
-glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, 11 * sizeof(GLfloat), (GLvoid*)(9 * sizeof(GLfloat)));
-glEnableVertexAttribArray(3);
+    // Layout da UV (location 3)
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (GLvoid*)offsetof(MeshVertex, texCoord));
+    glEnableVertexAttribArray(3);
 
     glBindVertexArray(0);
 
-    nVertices = vBuffer.size() / 11; // Cada vértice agora tem 11 floats!
+    nVertices = (int)sphere.indices.size();
 
     return VAO;
-}
\ No newline at end of file
+}
@@ -0,0 +1,179 @@
+// Importação de OBJ em streaming (ObjStream.h) para arquivos maiores que a memória:
+// gera um OBJ sintético do tamanho pedido e/ou importa um OBJ para um blob binário
+// (ObjBlobHeader + MeshVertex) ou, com --gl, para um buffer GL mapeado. Imprime as duas
+// passadas, a vazão e o pico de memória residente (sai com código 1 se o pico passar
+// do orçamento no caminho do blob).
+//
+// Uso: StreamImport [--generate saida.obj] [--size-gb N] [--obj entrada.obj] [--out blob.bin]
+//                   [--budget-mb N] [--scratch dir] [--gl [--headless LxA]]
+//      ./StreamImport --generate terrain.obj --size-gb 10 --obj terrain.obj --out terrain.bin --budget-mb 256
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#ifdef _WIN32
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#include "Headless.h"
+#include "ObjStream.h"
+#include "ObjStreamUpload.h"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct Options {
+    string generatePath;
+    double sizeGb = 10.0;
+    string objPath;
+    string outPath;
+    size_t budgetMb = 256;
+    string scratchDirectory;
+    bool gl = false;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--generate" && hasValue) options.generatePath = argv[++i];
+        else if (arg == "--size-gb" && hasValue) options.sizeGb = max(0.0, atof(argv[++i]));
+        else if (arg == "--obj" && hasValue) options.objPath = argv[++i];
+        else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+        else if (arg == "--budget-mb" && hasValue) options.budgetMb = (size_t)max(1, atoi(argv[++i]));
+        else if (arg == "--scratch" && hasValue) options.scratchDirectory = argv[++i];
+        else if (arg == "--gl") options.gl = true;
+        else if ((arg == "--headless" || arg == "--frames" || arg == "--png") && hasValue) ++i;   // HeadlessRun
+        else {
+            cerr << "Unknown option: " << arg << endl;
+            return false;
+        }
+    }
+    if (options.generatePath.empty() && options.objPath.empty()) {
+        cerr << "Nothing to do: pass --generate and/or --obj" << endl;
+        return false;
+    }
+    return true;
+}
+
+// Memória residente atual e de pico, em bytes (0 se o sistema não informar)
+#ifdef _WIN32
+size_t residentBytes(bool peak) {
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return peak ? counters.PeakWorkingSetSize : counters.WorkingSetSize;
+}
+
+bool resetPeakResident() { return false; }
+#else
+size_t residentBytes(bool peak) {
+    ifstream status("/proc/self/status");
+    string line;
+    const char* key = peak ? "VmHWM:" : "VmRSS:";
+    while (getline(status, line))
+        if (line.compare(0, strlen(key), key) == 0)
+            return (size_t)strtoull(line.c_str() + strlen(key), nullptr, 10) * 1024;
+    return 0;
+}
+
+// Zera o pico (VmHWM) para medir só a importação
+bool resetPeakResident() {
+    ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.close();
+    return !clearRefs.fail();
+}
+#endif
+
+double megabytes(uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    if (!options.generatePath.empty()) {
+        auto start = Clock::now();
+        uint64_t triangles = 0;
+        if (!writeSyntheticStreamObj(options.generatePath, (uint64_t)(options.sizeGb * 1024.0 * 1024.0 * 1024.0), &triangles))
+            return 1;
+        double seconds = chrono::duration<double>(Clock::now() - start).count();
+        uint64_t bytes = filesystem::file_size(options.generatePath);
+        printf("generated %s: %.1f MB, %llu triangles in %.1f s (%.1f MB/s)\n", options.generatePath.c_str(), megabytes(bytes),
+               (unsigned long long)triangles, seconds, megabytes(bytes) / seconds);
+    }
+    if (options.objPath.empty()) return 0;
+
+    ObjStreamOptions streamOptions;
+    streamOptions.memoryBudget = options.budgetMb << 20;
+    streamOptions.scratchDirectory = options.scratchDirectory;
+    ObjStreamStats stats;
+    bool ok = false;
+    size_t baseline = 0;
+    bool peakReset = false;
+
+    if (options.gl) {
+        HeadlessRun headless(argc, argv);
+        headless.initGlfw();
+        GLFWwindow* window = headless.createWindow(320, 240, "StreamImport");
+        if (!window) return 1;
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            cout << "Failed to initialize GLAD" << endl;
+            return 1;
+        }
+        baseline = residentBytes(false);
+        peakReset = resetPeakResident();
+        ObjBufferUpload upload;
+        ok = streamObj(options.objPath, upload, streamOptions, &stats);
+        glFinish();
+        GLuint buffer = upload.buffer();
+        glDeleteBuffers(1, &buffer);
+        glfwTerminate();
+    } else {
+        string outPath = options.outPath.empty() ? options.objPath + ".bin" : options.outPath;
+        baseline = residentBytes(false);
+        peakReset = resetPeakResident();
+        ObjBlobWriter writer(outPath);
+        ok = streamObj(options.objPath, writer, streamOptions, &stats);
+        if (ok) printf("wrote %s (%.1f MB)\n", outPath.c_str(), megabytes(filesystem::file_size(outPath)));
+    }
+    if (!ok) return 1;
+
+    double totalSeconds = (stats.countMs + stats.streamMs) / 1000.0;
+    printf("%.1f MB OBJ: %llu positions, %llu texcoords, %llu normals, %llu faces -> %llu triangles\n", megabytes(stats.fileBytes),
+           (unsigned long long)stats.positions, (unsigned long long)stats.texCoords, (unsigned long long)stats.normals,
+           (unsigned long long)stats.faces, (unsigned long long)stats.triangles);
+    printf("pass 1 (count + attributes): %.1f ms, pass 2 (faces, %llu chunks, %llu page loads): %.1f ms\n", stats.countMs,
+           (unsigned long long)stats.chunks, (unsigned long long)stats.pageLoads, stats.streamMs);
+    printf("throughput: %.1f MB/s, %.2f M triangles/s\n", megabytes(stats.fileBytes) / totalSeconds, stats.triangles / totalSeconds / 1e6);
+
+    size_t budget = max(streamOptions.memoryBudget, obj_stream_detail::MinimumBudget);
+    size_t peak = residentBytes(true);
+    if (!peak) {
+        printf("budget %.1f MB (read %.1f, output %.1f, attribute cache %.1f); peak RSS not available\n", megabytes(budget),
+               megabytes(stats.readBytes), megabytes(stats.outputBytes), megabytes(stats.cacheBytes));
+        return 0;
+    }
+    size_t growth = peak > baseline ? peak - baseline : 0;
+    printf("budget %.1f MB (read %.1f, output %.1f, attribute cache %.1f); peak RSS %.1f MB, %.1f MB over the %.1f MB baseline%s\n",
+           megabytes(budget), megabytes(stats.readBytes), megabytes(stats.outputBytes), megabytes(stats.cacheBytes), megabytes(peak),
+           megabytes(growth), megabytes(baseline), peakReset ? "" : " (peak not reset, includes startup)");
+    // Com --gl o driver também conta (cópias do buffer mapeado); só o blob é conferido.
+    // streamObj desconta do cache o que fica fora dele, então o teto é o próprio orçamento
+    if (!options.gl && peakReset && growth > budget) {
+        printf("peak RSS exceeded the memory budget\n");
+        return 1;
+    }
+    return 0;
+}
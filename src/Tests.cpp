@@ -0,0 +1,939 @@
+// Testes de correção dos componentes compartilhados pelos exercícios (os tempos ficam
+// no Benchmarks). Cada teste imprime o que conferiu e "ok" ou "FAILED"; o processo
+// termina com 1 se algum falhar.
+// Uso: Tests [nome...]   (sem argumentos executa todos)
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "BatchMath.h"
+#include "Bounds.h"
+#include "Bvh.h"
+#include "MeshNormals.h"
+#include "NumberParse.h"
+#include "ObjMaterials.h"
+#include "ObjMesh.h"
+#include "ObjStream.h"
+#include "OcclusionCuller.h"
+#include "SceneGraph.h"
+#include "ShapeGenerator.h"
+#include "SpatialGrid.h"
+
+using namespace std;
+
+// Distância em ULPs entre dois floats (dois NaN contam como iguais)
+uint32_t ulpDistance(float a, float b) {
+    if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b) ? 0 : UINT32_MAX;
+    int32_t ia, ib;
+    memcpy(&ia, &a, sizeof(float));
+    memcpy(&ib, &b, sizeof(float));
+    if (ia < 0) ia = INT32_MIN - ia;
+    if (ib < 0) ib = INT32_MIN - ib;
+    return ia > ib ? (uint32_t)((int64_t)ia - ib) : (uint32_t)((int64_t)ib - ia);
+}
+
+// Valores aleatórios com alguns casos de borda misturados (zero, -0, subnormal, enormes)
+void fillBatchValues(mt19937& rng, vector<float>& values, float range) {
+    const float edges[] = {0.0f, -0.0f, 1e-40f, -1e-40f, 1e30f, -1e30f, 1.0f, -1.0f};
+    uniform_real_distribution<float> dist(-range, range);
+    uniform_int_distribution<int> pick(0, 15);
+    for (float& v : values) {
+        int p = pick(rng);
+        v = p < 8 ? edges[p] : dist(rng);
+    }
+}
+
+// Cena sintética: N cubos de tamanho variado espalhados num cubo de lado "extent"
+vector<AABB> randomBoxes(int count, float extent, unsigned seed) {
+    mt19937 rng(seed);
+    uniform_real_distribution<float> pos(-extent * 0.5f, extent * 0.5f);
+    uniform_real_distribution<float> size(0.25f, 1.0f);
+    vector<AABB> boxes(count);
+    for (AABB& box : boxes) {
+        glm::vec3 c(pos(rng), pos(rng), pos(rng));
+        float h = size(rng);
+        box.min = c - glm::vec3(h);
+        box.max = c + glm::vec3(h);
+    }
+    return boxes;
+}
+
+float distanceSquared(const glm::vec3& p, const AABB& box) {
+    glm::vec3 d = p - glm::max(box.min, glm::min(p, box.max));
+    return glm::dot(d, d);
+}
+
+// Cada kernel de BatchMath em cada nível suportado contra a glm (tamanhos 0..67 para
+// cobrir todas as sobras, mais um lote grande)
+bool testSimd() {
+    BatchIsa supported = batchIsaSupported();
+    vector<BatchIsa> levels;
+    for (int isa = 0; isa <= (int)supported; ++isa)
+        levels.push_back((BatchIsa)isa);
+    cout << "[simd] supported: " << batchIsaName(supported) << endl;
+
+    mt19937 rng(46);
+    vector<size_t> sizes;
+    for (size_t n = 0; n < 68; ++n)
+        sizes.push_back(n);
+    sizes.push_back(4099);
+
+    bool passed = true;
+    for (BatchIsa isa : levels) {
+        setBatchIsa(isa);
+        uint32_t transformUlps = 0, lengthUlps = 0, normalizeUlps = 0, aabbUlps = 0;
+        float trsError = 0.0f;
+        for (size_t n : sizes) {
+            glm::mat4 m = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, -2.0f, 3.0f)), (float)n, glm::vec3(0.3f, 1.0f, 0.2f));
+            m = glm::scale(m, glm::vec3(1.5f, 0.5f, 2.0f));
+
+            Vec4Array points, transformed;
+            points.resize(n);
+            fillBatchValues(rng, points.x, 100.0f);
+            fillBatchValues(rng, points.y, 100.0f);
+            fillBatchValues(rng, points.z, 100.0f);
+            fillBatchValues(rng, points.w, 2.0f);
+            batchTransform(m, points, transformed);
+            for (size_t i = 0; i < n; ++i) {
+                glm::vec4 expected = m * points.get(i), got = transformed.get(i);
+                for (int c = 0; c < 4; ++c)
+                    transformUlps = std::max(transformUlps, ulpDistance(expected[c], got[c]));
+            }
+
+            Vec3Array vectors, normalized;
+            vectors.resize(n);
+            fillBatchValues(rng, vectors.x, 100.0f);
+            fillBatchValues(rng, vectors.y, 100.0f);
+            fillBatchValues(rng, vectors.z, 100.0f);
+            vector<float> lengths;
+            batchLength(vectors, lengths);
+            batchNormalize(vectors, normalized);
+            for (size_t i = 0; i < n; ++i) {
+                lengthUlps = std::max(lengthUlps, ulpDistance(glm::length(vectors.get(i)), lengths[i]));
+                glm::vec3 expected = glm::normalize(vectors.get(i)), got = normalized.get(i);
+                for (int c = 0; c < 3; ++c)
+                    normalizeUlps = std::max(normalizeUlps, ulpDistance(expected[c], got[c]));
+            }
+
+            Vec3Array boxMin, boxMax, outMin, outMax;
+            boxMin.resize(n);
+            boxMax.resize(n);
+            uniform_real_distribution<float> coord(-50.0f, 50.0f), size(0.0f, 10.0f);
+            for (size_t i = 0; i < n; ++i) {
+                glm::vec3 low(coord(rng), coord(rng), coord(rng));
+                boxMin.set(i, low);
+                boxMax.set(i, low + glm::vec3(size(rng), size(rng), size(rng)));
+            }
+            batchTransformAABB(m, boxMin, boxMax, outMin, outMax);
+            for (size_t i = 0; i < n; ++i) {
+                AABB box;
+                box.min = boxMin.get(i);
+                box.max = boxMax.get(i);
+                AABB expected = transformAABB(box, m);
+                for (int c = 0; c < 3; ++c) {
+                    aabbUlps = std::max(aabbUlps, ulpDistance(expected.min[c], outMin.get(i)[c]));
+                    aabbUlps = std::max(aabbUlps, ulpDistance(expected.max[c], outMax.get(i)[c]));
+                }
+            }
+
+            // Ângulos aleatórios e os múltiplos de 45 graus, onde a redução troca de quadrante
+            Vec3Array translation, rotation, scale;
+            translation.resize(n);
+            rotation.resize(n);
+            scale.resize(n);
+            uniform_real_distribution<float> angle(-720.0f, 720.0f), factor(0.1f, 10.0f);
+            uniform_int_distribution<int> step(-16, 16);
+            for (size_t i = 0; i < n; ++i) {
+                translation.set(i, glm::vec3(coord(rng), coord(rng), coord(rng)));
+                float special = 45.0f * step(rng);
+                rotation.set(i, glm::vec3(i % 3 == 0 ? special : angle(rng), angle(rng), i % 5 == 0 ? special : angle(rng)));
+                scale.set(i, glm::vec3(factor(rng), factor(rng), factor(rng)));
+            }
+            vector<glm::mat4> matrices(n);
+            batchComposeTRS(translation, rotation, scale, matrices.data());
+            for (size_t i = 0; i < n; ++i) {
+                Transform t;
+                t.translation = translation.get(i);
+                t.rotation = rotation.get(i);
+                t.scale = scale.get(i);
+                glm::mat4 expected = composeTRS(t);
+                for (int c = 0; c < 4; ++c)
+                    for (int r = 0; r < 4; ++r) {
+                        // Erro relativo à escala da coluna (os termos de rotação ficam em [-1, 1])
+                        float columnScale = c < 3 ? t.scale[c] : 1.0f;
+                        trsError = std::max(trsError, std::fabs(expected[c][r] - matrices[i][c][r]) / columnScale);
+                    }
+            }
+        }
+
+        // Sem FMA os kernels devem dar os mesmos bits da glm. Compilada com FMA (-march=native)
+        // a glm funde operações: transform e aabb divergem nos cancelamentos e ficam de fora
+#ifdef __FMA__
+        bool ok = lengthUlps <= 2 && normalizeUlps <= 4 && trsError <= 1e-6f;
+#else
+        bool ok = transformUlps == 0 && lengthUlps == 0 && normalizeUlps == 0 && aabbUlps == 0 && trsError <= 1e-6f;
+#endif
+        cout << "  " << batchIsaName(isa) << " vs glm: transform " << transformUlps << " ulp, length " << lengthUlps << " ulp, normalize "
+             << normalizeUlps << " ulp, aabb " << aabbUlps << " ulp, trs max error " << trsError << (ok ? ", ok" : ", FAILED") << endl;
+        passed = passed && ok;
+    }
+    setBatchIsa(supported);
+    return passed;
+}
+
+// Leitor de materiais com um OBJ sintético de muitos materiais (os "usemtl" mudam a
+// cada quad): faixas contíguas e em ordem, triângulos por material, parâmetros do MTL
+bool testMaterials() {
+    const int materialCounts[] = {1, 16, 256};
+    const int quadCount = 20000;
+    string objPath = (filesystem::temp_directory_path() / "cg_materials_test.obj").string();
+    bool passed = true;
+    for (int materialCount : materialCounts) {
+        vector<size_t> expected;
+        if (!writeSyntheticMaterialObj(objPath, materialCount, quadCount, 48 + materialCount, &expected))
+            return false;
+        MaterialMesh mesh;
+        bool loaded = loadObjWithMaterials(objPath, mesh);
+        vector<string> errors;
+        if (!loaded || (int)mesh.materials.size() != materialCount + 1)
+            errors.push_back("material table");
+        uint32_t next = 0;
+        int previous = -1;
+        size_t nonEmpty = 0;
+        for (size_t m = 0; m < expected.size(); ++m)
+            nonEmpty += expected[m] > 0;
+        for (const MaterialRange& range : mesh.ranges) {
+            if (range.firstIndex != next || range.material <= previous || range.material >= (int)expected.size())
+                errors.push_back("range order");
+            else if (range.indexCount != 3 * expected[range.material])
+                errors.push_back("triangles of " + mesh.materials[range.material].name);
+            next = range.firstIndex + range.indexCount;
+            previous = range.material;
+        }
+        if (next != mesh.indices.size() || mesh.ranges.size() != nonEmpty)
+            errors.push_back("range coverage");
+        uint32_t runIndices = 0;
+        for (const MaterialRange& run : mesh.runs) {
+            const MaterialRange* owner = nullptr;
+            for (const MaterialRange& range : mesh.ranges)
+                if (range.material == run.material) owner = &range;
+            if (!owner || run.firstIndex < owner->firstIndex || run.firstIndex + run.indexCount > owner->firstIndex + owner->indexCount)
+                errors.push_back("run outside its range");
+            runIndices += run.indexCount;
+        }
+        if (runIndices != mesh.indices.size())
+            errors.push_back("run coverage");
+        for (int m = 0; m < materialCount && loaded; ++m) {
+            const ObjMaterial& material = mesh.materials[m];
+            if (material.name != "synthetic_" + to_string(m) || std::fabs(material.diffuse.r - (float)m / materialCount) > 1e-5f ||
+                material.shininess != (float)m || material.specular != glm::vec3(0.5f)) {
+                errors.push_back("parameters of " + material.name);
+                break;
+            }
+        }
+        if (loaded && mesh.materials.back().name != "default")
+            errors.push_back("default material");
+        // Os quads ficam em z = 0 com normal +z (do "vn"), e o triângulo do "default" em z = -1
+        for (const MeshVertex& v : mesh.vertices)
+            if (v.normal != glm::vec3(0.0f, 0.0f, 1.0f)) {
+                errors.push_back("normals");
+                break;
+            }
+
+        cout << "[materials] " << materialCount << " materials, " << mesh.indices.size() / 3 << " triangles, " << mesh.ranges.size()
+             << " ranges, " << mesh.runs.size() << " runs";
+        if (errors.empty()) {
+            cout << ", ok" << endl;
+        } else {
+            cout << ", FAILED: " << errors.front() << " (" << errors.size() << " errors)" << endl;
+            passed = false;
+        }
+    }
+    filesystem::remove(objPath);
+    filesystem::remove(objPath.substr(0, objPath.size() - 4) + ".mtl");
+
+    // "usemtl" antes do "mtllib", material inexistente, Kd com um valor só, CRLF e nome com espaço
+    string mtlPath = objPath.substr(0, objPath.size() - 4) + ".mtl";
+    ofstream(mtlPath) << "newmtl late\r\nKd 0.25\r\nNs 12.5\r\nd 0.5\r\nillum 1\r\nmap_Kd -bm 0.5 late.png\r\n"
+                      << "newmtl two words \r\nKs 0.1 0.2 0.3\r\n";
+    ofstream(objPath) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nusemtl late\nf 1 2 3\nmtllib " << mtlPath.substr(mtlPath.find_last_of("/\\") + 1)
+                      << "\nusemtl missing\nf 1 2 3\nusemtl two words\nf 1 2 3\n";
+    MaterialMesh mesh;
+    bool ok = loadObjWithMaterials(objPath, mesh) && mesh.materials.size() == 3 && mesh.ranges.size() == 3;
+    if (ok) {
+        const ObjMaterial& late = mesh.materials[0];
+        ok = late.name == "late" && late.diffuse == glm::vec3(0.25f) && late.shininess == 12.5f && late.opacity == 0.5f && late.illum == 1
+          && late.diffuseMap == obj_detail::directoryOf(mtlPath) + "late.png" && mesh.materials[1].name == "two words"
+          && mesh.materials[1].specular == glm::vec3(0.1f, 0.2f, 0.3f) && mesh.materials[2].name == "missing"
+          && mesh.materials[2].diffuse == ObjMaterial().diffuse && mesh.ranges[0].material == 0 && mesh.ranges[1].material == 1
+          && mesh.ranges[2].material == 2;
+    }
+    cout << "[materials] usemtl before mtllib, missing material, MTL values: " << (ok ? "ok" : "FAILED") << endl;
+    filesystem::remove(objPath);
+    filesystem::remove(mtlPath);
+    return passed && ok;
+}
+
+// Importação em streaming (ObjStream.h): um terreno sintético lido com orçamentos de
+// memória diferentes tem que sair igual, vértice a vértice, ao loadObjTriangles; depois
+// polígonos e índices negativos num OBJ pequeno
+bool testObjStream() {
+    string objPath = (filesystem::temp_directory_path() / "cg_stream_test.obj").string();
+    string blobPath = objPath + ".bin";
+    uint64_t triangles = 0;
+    if (!writeSyntheticStreamObj(objPath, uint64_t(16) << 20, &triangles))
+        return false;
+    vector<MeshVertex> reference;
+    loadObjTriangles(objPath, reference);
+    bool passed = true;
+
+    auto readBlob = [&](vector<MeshVertex>& vertices, ObjBlobHeader& header) {
+        ifstream blob(blobPath, ios::binary);
+        if (!blob.read((char*)&header, sizeof(header))) return false;
+        vertices.resize(header.vertexCount);
+        return (bool)blob.read((char*)vertices.data(), vertices.size() * sizeof(MeshVertex));
+    };
+
+    const size_t budgets[] = {size_t(4) << 20, size_t(16) << 20, size_t(256) << 20};
+    for (size_t budget : budgets) {
+        ObjStreamOptions options;
+        options.memoryBudget = budget;
+        ObjStreamStats stats;
+        ObjBlobWriter writer(blobPath);
+        bool ok = streamObj(objPath, writer, options, &stats);
+
+        vector<MeshVertex> streamed;
+        ObjBlobHeader header;
+        ok = ok && readBlob(streamed, header) && streamed.size() == reference.size() && stats.triangles == triangles
+                && memcmp(streamed.data(), reference.data(), reference.size() * sizeof(MeshVertex)) == 0
+                && header.boundsMin[1] == stats.bounds.min.y && header.boundsMax[0] == stats.bounds.max.x;
+        cout << "[objstream] " << triangles << " triangles, budget " << (budget >> 20) << " MB (" << stats.chunks << " chunks, "
+             << stats.pageLoads << " page loads) vs loadObjTriangles, " << (ok ? "ok" : "FAILED") << endl;
+        passed = passed && ok;
+    }
+
+    // Uma página por atributo: os triângulos entre duas linhas do terreno que caem em
+    // páginas diferentes trocam a página a cada vértice, então o LRU relê páginas já
+    // descartadas e o resultado ainda tem que ser o mesmo
+    {
+        ObjStreamOptions options;
+        options.memoryBudget = size_t(4) << 20;
+        options.cacheLimit = 1;
+        ObjStreamStats stats;
+        ObjBlobWriter writer(blobPath);
+        bool ok = streamObj(objPath, writer, options, &stats);
+        auto pages = [](uint64_t count) { return (count + obj_stream_detail::PageElements - 1) >> obj_stream_detail::PageShift; };
+        uint64_t pageCount = pages(stats.positions) + pages(stats.texCoords) + pages(stats.normals);
+        vector<MeshVertex> streamed;
+        ObjBlobHeader header;
+        ok = ok && readBlob(streamed, header) && streamed.size() == reference.size()
+                && memcmp(streamed.data(), reference.data(), reference.size() * sizeof(MeshVertex)) == 0 && stats.pageLoads > pageCount;
+        cout << "[objstream] one cached page per attribute: " << stats.pageLoads << " page loads for " << pageCount << " pages, "
+             << (ok ? "ok" : "FAILED") << endl;
+        passed = passed && ok;
+    }
+    filesystem::remove(objPath);
+
+    // Quad com índices negativos, pentágono em leque, face de "v" só e atributos depois das faces
+    {
+        ofstream obj(objPath);
+        obj << "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\n"
+               "f -4/-1/-1 -3/-1/-1 -2/-1/-1 -1/-1/-1\n"
+               "v 0.5 2 0\n"
+               "f 1 2 3 5 4\n"
+               "f 5 4\n"
+               "vn 1 0 0\n"
+               "f 1//2 2//2 3//2\n";
+    }
+    ObjBlobWriter writer(blobPath);
+    ObjStreamStats stats;
+    vector<MeshVertex> streamed;
+    ObjBlobHeader header;
+    bool ok = streamObj(objPath, writer, ObjStreamOptions(), &stats) && readBlob(streamed, header) && streamed.size() == 18;
+    const int expected[18] = {0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 2, 4, 0, 4, 3, 0, 1, 2};
+    const glm::vec3 corners[5] = {glm::vec3(0, 0, 0), glm::vec3(1, 0, 0), glm::vec3(1, 1, 0), glm::vec3(0, 1, 0), glm::vec3(0.5f, 2, 0)};
+    for (int i = 0; ok && i < 18; ++i)
+        ok = streamed[i].position == corners[expected[i]]
+          && streamed[i].normal == (i < 6 ? glm::vec3(0, 0, 1) : i < 15 ? glm::vec3(0.0f) : glm::vec3(1, 0, 0))
+          && streamed[i].texCoord == (i < 6 ? glm::vec2(0, 1) : glm::vec2(0.0f));
+    cout << "[objstream] polygons and negative indices: " << stats.faces << " faces -> " << stats.triangles << " triangles, "
+         << (ok ? "ok" : "FAILED") << endl;
+    filesystem::remove(objPath);
+    filesystem::remove(blobPath);
+    return passed && ok;
+}
+
+// NumberParse.h: entradas aleatórias (dígitos, ponto, expoente, zeros à esquerda, floats
+// e doubles impressos com todos os dígitos, meios exatos entre dois floats) têm que dar
+// os mesmos bits que strtof/strtod, assim como os números no formato dos OBJ ("%.6f");
+// countTokens (SSE2) tem que contar as palavras das faces como o laço de um byte por vez
+bool testFloatParse() {
+    mt19937_64 rng(50);
+    auto randomText = [&](string& text) {
+        text.clear();
+        int kind = (int)(rng() % 8);
+        char buffer[128];
+        if (kind == 0) {
+            uint32_t bits = (uint32_t)rng();
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            if (!std::isfinite(value)) value = 1.0f;
+            snprintf(buffer, sizeof(buffer), "%.9g", value);
+            text = buffer;
+            return;
+        }
+        if (kind == 1) {
+            uint64_t bits = rng();
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            if (!std::isfinite(value)) value = 1.0;
+            snprintf(buffer, sizeof(buffer), "%.17g", value);
+            text = buffer;
+            return;
+        }
+        if (kind == 2) {
+            // Meio exato entre dois floats normais (e vizinhos com 17 dígitos)
+            float low = std::ldexp((float)(rng() % (1u << 23) + (1u << 23)), (int)(rng() % 200) - 120);
+            double middle = ((double)low + (double)std::nextafter(low, INFINITY)) / 2.0;
+            if (rng() % 2) middle = std::nextafter(middle, rng() % 2 ? INFINITY : 0.0);
+            snprintf(buffer, sizeof(buffer), rng() % 2 ? "%.17g" : "%.40g", middle);
+            text = buffer;
+            return;
+        }
+        int sign = (int)(rng() % 3);
+        if (sign == 1) text += '-';
+        if (sign == 2) text += '+';
+        int leadingZeros = rng() % 4 == 0 ? (int)(rng() % 5) : 0;
+        text.append((size_t)leadingZeros, '0');
+        int digits = 1 + (int)(rng() % (kind == 3 ? 25 : 9));
+        int point = (int)(rng() % (digits + 2)) - 1;
+        for (int d = 0; d < digits; ++d) {
+            if (d == point) text += '.';
+            text += (char)('0' + rng() % 10);
+        }
+        if (point == digits) text += '.';
+        if (rng() % 3 == 0) {
+            text += rng() % 2 ? 'e' : 'E';
+            int range = kind == 4 ? 700 : 90;
+            int exponent = (int)(rng() % (2 * range + 1)) - range;
+            if (exponent >= 0 && rng() % 2) text += '+';
+            text += to_string(exponent);
+        }
+    };
+
+    const int fuzzCount = 2000000;
+    int floatMismatches = 0, doubleMismatches = 0;
+    string text, firstMismatch;
+    for (int i = 0; i < fuzzCount; ++i) {
+        randomText(text);
+        const char* first = text.data();
+        const char* last = first + text.size();
+        char* expectedEnd = nullptr;
+        float expectedFloat = strtof(text.c_str(), &expectedEnd);
+        double expectedDouble = strtod(text.c_str(), nullptr);
+        float parsedFloat = 0.0f;
+        double parsedDouble = 0.0;
+        const char* floatEnd = parseFloat(first, last, parsedFloat);
+        const char* doubleEnd = parseDouble(first, last, parsedDouble);
+        if (floatEnd != expectedEnd || memcmp(&parsedFloat, &expectedFloat, sizeof(float)) != 0) {
+            if (!floatMismatches++) firstMismatch = text;
+        }
+        if (doubleEnd != expectedEnd || memcmp(&parsedDouble, &expectedDouble, sizeof(double)) != 0) {
+            if (!doubleMismatches++ && firstMismatch.empty()) firstMismatch = text;
+        }
+    }
+    cout << "[floatparse] fuzz " << fuzzCount << " inputs: " << floatMismatches << " float / " << doubleMismatches
+         << " double mismatches against strtof/strtod";
+    bool ok = !floatMismatches && !doubleMismatches;
+    if (!ok) cout << " (first: \"" << firstMismatch << "\"), FAILED" << endl;
+    else cout << ", ok" << endl;
+
+
+    const int numberCount = 200000;
+    string numbers;
+    uniform_real_distribution<float> coordinate(-100.0f, 100.0f);
+    char buffer[64];
+    for (int i = 0; i < numberCount; ++i) {
+        snprintf(buffer, sizeof(buffer), "%.6f ", coordinate(rng));
+        numbers += buffer;
+    }
+    int objMismatches = 0;
+    const char* p = numbers.data();
+    const char* last = p + numbers.size();
+    char* expected = &numbers[0];
+    for (int i = 0; i < numberCount; ++i) {
+        float parsed = 0.0f;
+        p = parseFloat(skipBlanks(p, last), last, parsed);
+        float reference = strtof(expected, &expected);
+        if (p != expected || memcmp(&parsed, &reference, sizeof(float)) != 0) ++objMismatches;
+    }
+    cout << "[floatparse] " << numberCount << " OBJ coordinates: " << objMismatches << " mismatches against strtof, "
+         << (objMismatches ? "FAILED" : "ok") << endl;
+
+    int lineMismatches = 0;
+    const int lineCount = 100000;
+    for (int i = 0; i < lineCount; ++i) {
+        // Cantos "v/vt/vn" com brancos variados (também no início e no fim) e linhas longas
+        string line;
+        const char blanks[3] = {' ', '\t', '\r'};
+        int corners = 3 + (int)(rng() % 6);
+        for (int c = 0; c < corners; ++c) {
+            line.append((size_t)(c == 0 ? rng() % 3 : 1 + rng() % 3), blanks[rng() % 3]);
+            line += to_string(rng() % 10000000 + 1) + "/" + to_string(rng() % 10000000 + 1) + "/" + to_string(rng() % 10000000 + 1);
+        }
+        line.append((size_t)(rng() % 3), blanks[rng() % 3]);
+        int scalarTokens = 0;
+        bool previousBlank = true;
+        for (char c : line) {
+            bool blank = c == ' ' || c == '\t' || c == '\r';
+            scalarTokens += !blank && previousBlank;
+            previousBlank = blank;
+        }
+        if (countTokens(line.data(), line.data() + line.size()) != scalarTokens || scalarTokens != corners) ++lineMismatches;
+    }
+    cout << "[floatparse] " << lineCount << " face lines: " << lineMismatches << " countTokens mismatches, "
+         << (lineMismatches ? "FAILED" : "ok") << endl;
+    return ok && !objMismatches && !lineMismatches;
+}
+
+// SpatialGrid.h: raycast, queryRadius e queryNearest contra a força bruta depois de
+// inserções, movimentos (alguns para longe e com caixas grandes, depois desfeitos) e
+// remoções; ids inválidos são recusados e a folga e a região ocupada voltam a encolher
+bool testSpatialGrid() {
+    const int N = 3000;
+    const float extent = 120.0f;
+    vector<AABB> boxes = randomBoxes(N, extent, 27);
+    vector<bool> active(N, true);
+    SpatialGrid grid(4.0f);
+    for (int i = 0; i < N; ++i)
+        grid.insert(i, boxes[i]);
+
+    mt19937 rng(27);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    uniform_int_distribution<int> pickObject(0, N - 1);
+    vector<string> errors;
+
+    // Ids inválidos: nada muda
+    int removed = 0;
+    grid.remove(removed);
+    active[removed] = false;
+    if (grid.move(removed, boxes[1]) || grid.remove(removed) || grid.remove(-1) || grid.remove(N + 5) || grid.insert(-1, boxes[1])
+        || grid.move(N + 5, boxes[1]))
+        errors.push_back("invalid ids accepted");
+
+    // Um objeto enorme e um muito longe alargam a busca; ao voltarem, ela encolhe
+    float initialExtent = grid.getMaxHalfExtent();
+    AABB initialRegion = grid.occupiedBounds();
+    AABB huge = boxes[1], far = boxes[2];
+    huge.min -= glm::vec3(40.0f);
+    huge.max += glm::vec3(40.0f);
+    far.min += glm::vec3(5000.0f);
+    far.max += glm::vec3(5000.0f);
+    grid.move(1, huge);
+    grid.move(2, far);
+    bool widened = grid.getMaxHalfExtent() > 40.0f && grid.occupiedBounds().max.x > 5000.0f;
+    grid.move(1, boxes[1]);
+    grid.move(2, boxes[2]);
+    AABB region = grid.occupiedBounds();
+    if (!widened || grid.getMaxHalfExtent() != initialExtent || region.min != initialRegion.min || region.max != initialRegion.max)
+        errors.push_back("extent or occupied region did not shrink");
+
+    // Movimentos e remoções aleatórios
+    for (int step = 0; step < 5000; ++step) {
+        int id = pickObject(rng);
+        if (step % 10 == 0) {
+            if (active[id]) grid.remove(id);
+            else grid.insert(id, boxes[id]);
+            active[id] = !active[id];
+        } else if (active[id]) {
+            glm::vec3 d = glm::vec3(unit(rng), unit(rng), unit(rng)) * 6.0f;
+            float grow = 1.0f + 0.5f * unit(rng);
+            glm::vec3 center = boxes[id].center() + d, half = boxes[id].extents() * grow;
+            boxes[id].min = center - half;
+            boxes[id].max = center + half;
+            grid.move(id, boxes[id]);
+        }
+    }
+
+    int rayMismatches = 0, radiusMismatches = 0, nearestMismatches = 0;
+    vector<int> found;
+    for (int q = 0; q < 500; ++q) {
+        glm::vec3 origin = glm::vec3(unit(rng), unit(rng), unit(rng)) * extent * 0.7f;
+        glm::vec3 direction = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        if (q % 10 == 0) direction = glm::vec3(0.0f, q % 20 ? 1.0f : -1.0f, 0.0f);   // eixo: componentes zero
+        glm::vec3 invDir(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+        float bestT = 1000.0f, tEnter, tExit;
+        int best = -1;
+        for (int i = 0; i < N; ++i)
+            if (active[i] && SpatialGrid::rayAABB(origin, invDir, boxes[i], bestT, tEnter, tExit) && tEnter < bestT) {
+                bestT = tEnter;
+                best = i;
+            }
+        float hitT = 0.0f;
+        int hit = grid.raycast(origin, direction, 1000.0f, &hitT);
+        if (hit != best && !(hit >= 0 && best >= 0 && hitT == bestT))
+            ++rayMismatches;
+
+        float radius = 2.0f + 10.0f * (unit(rng) + 1.0f);
+        grid.queryRadius(origin, radius, found);
+        sort(found.begin(), found.end());
+        vector<int> expected;
+        for (int i = 0; i < N; ++i)
+            if (active[i] && distanceSquared(origin, boxes[i]) <= radius * radius)
+                expected.push_back(i);
+        if (found != expected)
+            ++radiusMismatches;
+
+        // Compara as distâncias (empates podem trocar a ordem dos ids)
+        int k = 1 + q % 16;
+        grid.queryNearest(origin, k, found);
+        vector<float> distances;
+        for (int i = 0; i < N; ++i)
+            if (active[i]) distances.push_back(distanceSquared(origin, boxes[i]));
+        sort(distances.begin(), distances.end());
+        bool same = (int)found.size() == min(k, (int)distances.size());
+        for (size_t i = 0; same && i < found.size(); ++i)
+            same = active[found[i]] && distanceSquared(origin, boxes[found[i]]) == distances[i];
+        if (!same)
+            ++nearestMismatches;
+    }
+    if (rayMismatches) errors.push_back("raycast");
+    if (radiusMismatches) errors.push_back("queryRadius");
+    if (nearestMismatches) errors.push_back("queryNearest");
+
+    cout << "[grid] " << N << " objects, 5000 moves/removes, 500 queries: " << rayMismatches << " raycast / " << radiusMismatches
+         << " radius / " << nearestMismatches << " nearest mismatches";
+    if (errors.empty()) {
+        cout << ", ok" << endl;
+        return true;
+    }
+    cout << ", FAILED: " << errors.front() << " (" << errors.size() << " errors)" << endl;
+    return false;
+}
+
+// Bvh.h: cull() tem que devolver exatamente os objetos que Frustum::intersects aceita,
+// em frusta aleatórios, depois da construção, de update() (objetos movidos, alguns
+// para longe), de refit() e de uma reconstrução por rebuildIfDegraded()
+bool testBvh() {
+    const int N = 5000;
+    const float extent = 200.0f;
+    vector<AABB> boxes = randomBoxes(N, extent, 26);
+    Bvh bvh;
+    bvh.build(boxes);
+
+    mt19937 rng(26);
+    uniform_real_distribution<float> unit(-1.0f, 1.0f), positive(0.0f, 1.0f);
+    vector<int> visible, expected;
+    bool passed = true;
+    auto check = [&](const char* stage) {
+        int mismatches = 0;
+        long total = 0;
+        const int frusta = 200;
+        for (int f = 0; f < frusta; ++f) {
+            glm::vec3 eye = glm::vec3(unit(rng), unit(rng), unit(rng)) * extent * 0.6f;
+            glm::vec3 target = glm::vec3(unit(rng), unit(rng), unit(rng)) * extent * 0.5f;
+            if (glm::length(target - eye) < 1.0f) target = eye + glm::vec3(0.0f, 0.0f, -1.0f);
+            glm::vec3 up = std::fabs(glm::normalize(target - eye).y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+            float fov = glm::radians(20.0f + 100.0f * positive(rng));
+            float aspect = 0.5f + 2.0f * positive(rng);
+            float nearPlane = 0.05f + 2.0f * positive(rng), farPlane = nearPlane + 20.0f + extent * positive(rng);
+            Frustum frustum = Frustum::fromMatrix(glm::perspective(fov, aspect, nearPlane, farPlane) * glm::lookAt(eye, target, up));
+            bvh.cull(frustum, visible);
+            sort(visible.begin(), visible.end());
+            expected.clear();
+            for (int i = 0; i < N; ++i)
+                if (frustum.intersects(boxes[i]))
+                    expected.push_back(i);
+            mismatches += visible != expected;
+            total += (long)expected.size();
+        }
+        cout << "[bvh] " << stage << ": " << frusta << " frusta, " << total / frusta << " visible on average, " << mismatches
+             << " mismatches against Frustum::intersects, " << (mismatches ? "FAILED" : "ok") << endl;
+        passed = passed && !mismatches;
+    };
+    check("build");
+
+    // 1/4 dos objetos movidos, um em cada 50 para longe e maior
+    for (int i = 0; i < N; i += 4) {
+        glm::vec3 d = glm::vec3(unit(rng), unit(rng), unit(rng)) * (i % 200 == 0 ? extent * 2.0f : 5.0f);
+        boxes[i].min += d;
+        boxes[i].max += d;
+        if (i % 200 == 0) boxes[i].max += glm::vec3(10.0f);
+        bvh.update(i, boxes[i]);
+    }
+    check("update");
+    bvh.refit();
+    check("refit");
+    bool rebuilt = bvh.rebuildIfDegraded(0.0f);
+    if (!rebuilt) {
+        cout << "[bvh] rebuildIfDegraded(0) did not rebuild, FAILED" << endl;
+        passed = false;
+    }
+    check("rebuild");
+    return passed;
+}
+
+// Triângulos (3 vértices cada) de uma malha indexada, com as normais zeradas
+vector<MeshVertex> unindexedTriangles(const ShapeMesh& mesh) {
+    vector<MeshVertex> triangles;
+    triangles.reserve(mesh.indices.size());
+    for (uint32_t index : mesh.indices) {
+        triangles.push_back(mesh.vertices[index]);
+        triangles.back().normal = glm::vec3(0.0f);
+    }
+    return triangles;
+}
+
+// MeshNormals.h: cubo com vinco < 90 graus (normais das faces) e suave (cantos na
+// diagonal), esfera UV (normais radiais, tangentes perpendiculares à normal e na
+// direção de dP/du) e o mesmo resultado, bit a bit, com 1 e com 8 threads
+bool testMeshNormals() {
+    vector<string> errors;
+
+    vector<MeshVertex> cube = unindexedTriangles(generateCube(2.0f, 1));
+    NormalOptions creased;
+    creased.creaseAngle = 80.0f;
+    generateNormals(cube, creased);
+    float worstFace = 0.0f;
+    for (size_t t = 0; t < cube.size() / 3; ++t) {
+        const glm::vec3& p0 = cube[3 * t].position;
+        glm::vec3 face = glm::normalize(glm::cross(cube[3 * t + 1].position - p0, cube[3 * t + 2].position - p0));
+        for (int k = 0; k < 3; ++k)
+            worstFace = max(worstFace, glm::length(cube[3 * t + k].normal - face));
+    }
+    if (worstFace > 1e-6f) errors.push_back("creased cube");
+
+    generateNormals(cube);
+    float worstCorner = 0.0f;
+    for (const MeshVertex& v : cube)
+        worstCorner = max(worstCorner, glm::length(v.normal - v.position / std::sqrt(3.0f)));
+    if (worstCorner > 1e-6f) errors.push_back("smooth cube");
+
+    vector<MeshVertex> sphere = unindexedTriangles(generateUvSphere(1.0f, 32, 48));
+    generateNormals(sphere);
+    float worstRadial = 1.0f;
+    for (const MeshVertex& v : sphere)
+        worstRadial = min(worstRadial, glm::dot(v.normal, glm::normalize(v.position)));
+    if (worstRadial < 0.999f) errors.push_back("sphere normals");
+
+    vector<glm::vec4> tangents;
+    generateTangents(sphere, tangents);
+    float worstPerpendicular = 0.0f, worstAligned = 1.0f;
+    for (size_t i = 0; i < sphere.size(); ++i) {
+        const MeshVertex& v = sphere[i];
+        glm::vec3 tangent(tangents[i]);
+        worstPerpendicular = max(worstPerpendicular, std::fabs(glm::dot(tangent, v.normal)));
+        // dP/du da esfera (phi = 2 pi u); nos polos a direção não é definida
+        float phi = 2.0f * 3.14159265f * v.texCoord.x;
+        if (std::fabs(v.position.y) < 0.95f)
+            worstAligned = min(worstAligned, glm::dot(tangent, glm::vec3(-std::sin(phi), 0.0f, std::cos(phi))));
+    }
+    if (worstPerpendicular > 1e-5f) errors.push_back("tangents not perpendicular to N");
+    if (worstAligned < 0.99f) errors.push_back("tangents not along dP/du");
+
+    // Malha grande o bastante para dividir o trabalho em vários blocos
+    vector<MeshVertex> large = unindexedTriangles(generateUvSphere(1.0f, 96, 128));
+    ThreadPool single(1), many(8);
+    NormalOptions sharp;
+    sharp.creaseAngle = 30.0f;
+    bool identical = true;
+    for (const NormalOptions& options : {NormalOptions(), sharp}) {
+        vector<MeshVertex> a = large, b = large;
+        generateNormals(a, options, single);
+        generateNormals(b, options, many);
+        vector<glm::vec4> tangentsA, tangentsB;
+        generateTangents(a, tangentsA, single);
+        generateTangents(b, tangentsB, many);
+        identical = identical && memcmp(a.data(), b.data(), a.size() * sizeof(MeshVertex)) == 0
+                 && memcmp(tangentsA.data(), tangentsB.data(), tangentsA.size() * sizeof(glm::vec4)) == 0;
+    }
+    if (!identical) errors.push_back("1 vs 8 threads");
+
+    cout << "[meshnormals] creased cube error " << worstFace << ", smooth cube corner error " << worstCorner << ", sphere min cos "
+         << worstRadial << ", tangent |T.N| max " << worstPerpendicular << ", T.dPdu min " << worstAligned << ", 1 vs 8 threads "
+         << (identical ? "identical" : "different");
+    if (errors.empty()) {
+        cout << ", ok" << endl;
+        return true;
+    }
+    cout << ", FAILED: " << errors.front() << " (" << errors.size() << " errors)" << endl;
+    return false;
+}
+
+// ShapeGenerator.h: todas as formas em sentido anti-horário visto de fora (normal da
+// face no mesmo sentido das normais dos vértices) e sem triângulos de área zero; a
+// esfera UV com um triângulo só por quadrado nos polos
+bool testShapes() {
+    vector<string> errors;
+    const pair<const char*, ShapeDesc> shapes[] = {
+        {"uv sphere", ShapeDesc::uvSphere(1.0f, 16, 24)},
+        {"icosphere", ShapeDesc::icosphere(1.0f, 3)},
+        {"cube", ShapeDesc::cube(1.0f, 4)},
+        {"cylinder", ShapeDesc::cylinder(0.5f, 2.0f, 24, 3)},
+        {"torus", ShapeDesc::torus(1.0f, 0.25f, 32, 16)},
+        {"plane", ShapeDesc::plane(2.0f, 1.0f, 8, 4)},
+    };
+    size_t triangles = 0;
+    for (const auto& shape : shapes) {
+        ShapeMesh mesh = generateShape(shape.second);
+        triangles += mesh.triangleCount();
+        int reversed = 0, degenerate = 0;
+        for (size_t t = 0; t < mesh.triangleCount(); ++t) {
+            const MeshVertex& v0 = mesh.vertices[mesh.indices[3 * t]];
+            const MeshVertex& v1 = mesh.vertices[mesh.indices[3 * t + 1]];
+            const MeshVertex& v2 = mesh.vertices[mesh.indices[3 * t + 2]];
+            glm::vec3 face = glm::cross(v1.position - v0.position, v2.position - v0.position);
+            if (glm::length(face) < 1e-9f)
+                ++degenerate;
+            else if (glm::dot(face, v0.normal + v1.normal + v2.normal) <= 0.0f)
+                ++reversed;
+        }
+        if (reversed) errors.push_back(string(shape.first) + ": " + to_string(reversed) + " reversed");
+        if (degenerate) errors.push_back(string(shape.first) + ": " + to_string(degenerate) + " zero-area");
+    }
+    size_t sphereTriangles = generateUvSphere(1.0f, 16, 24).triangleCount();
+    if (sphereTriangles != 2 * 24 * 15) errors.push_back("uv sphere triangle count " + to_string(sphereTriangles));
+
+    cout << "[shapes] " << size(shapes) << " shapes, " << triangles << " triangles, uv sphere 16x24 " << sphereTriangles << " triangles";
+    if (errors.empty()) {
+        cout << ", ok" << endl;
+        return true;
+    }
+    cout << ", FAILED: " << errors.front() << " (" << errors.size() << " errors)" << endl;
+    return false;
+}
+
+// true se o segmento de "from" até "to" (sem a ponta) atravessa a caixa
+bool segmentHitsBox(const glm::vec3& from, const glm::vec3& to, const AABB& box) {
+    float enter = 0.0f, exit = 1.0f - 1e-4f;
+    for (int axis = 0; axis < 3; ++axis) {
+        float d = to[axis] - from[axis];
+        if (std::fabs(d) < 1e-12f) {
+            if (from[axis] < box.min[axis] || from[axis] > box.max[axis]) return false;
+            continue;
+        }
+        float t0 = (box.min[axis] - from[axis]) / d, t1 = (box.max[axis] - from[axis]) / d;
+        enter = max(enter, min(t0, t1));
+        exit = min(exit, max(t0, t1));
+    }
+    return enter < exit;
+}
+
+// OcclusionCuller.h: o Hi-Z é conservador. Caixas aleatórias atrás e em volta das paredes
+// de buildOcclusionTestScene; se algum ponto amostrado na superfície de uma caixa está
+// na tela e não tem parede entre ele e a câmera, a caixa não pode ser descartada
+bool testOcclusion() {
+    vector<AABB> walls;
+    vector<glm::vec3> positions;
+    buildOcclusionTestScene(walls, positions);
+    mt19937 rng(36);
+    uniform_real_distribution<float> px(-12.0f, 12.0f), py(-4.0f, 4.0f), pz(-40.0f, 0.0f), size(0.05f, 1.5f);
+    vector<AABB> boxes(4000);
+    for (AABB& box : boxes) {
+        glm::vec3 c(px(rng), py(rng), pz(rng));
+        glm::vec3 h(size(rng), size(rng), size(rng));
+        box.min = c - h;
+        box.max = c + h;
+    }
+    vector<int> candidates(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i)
+        candidates[i] = (int)i;
+
+    OcclusionCuller occlusion(256, 256);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
+    const int samples = 6;
+    int culledVisible = 0, sampledVisible = 0, occluded = 0;
+    for (float x : {-2.0f, 0.0f, 1.3f}) {
+        glm::vec3 eye(x, 0.0f, 3.0f);
+        glm::mat4 viewProjection = projection * glm::lookAt(eye, glm::vec3(x * 0.5f, 0.0f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        occlusion.beginFrame(viewProjection);
+        for (const AABB& wall : walls)
+            occlusion.addOccluderBox(wall);
+        occlusion.renderOccluders();
+        vector<int> visible;
+        occlusion.cull(candidates, boxes, visible);
+        occluded += occlusion.stats().occluded;
+        vector<bool> kept(boxes.size(), false);
+        for (int i : visible)
+            kept[i] = true;
+
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const AABB& box = boxes[i];
+            bool seen = false;
+            // Grade de samples x samples em cada uma das 6 faces
+            for (int face = 0; face < 6 && !seen; ++face) {
+                int axis = face / 2, u = (axis + 1) % 3, v = (axis + 2) % 3;
+                for (int a = 0; a < samples && !seen; ++a) {
+                    for (int b = 0; b < samples && !seen; ++b) {
+                        glm::vec3 p;
+                        p[axis] = face % 2 ? box.max[axis] : box.min[axis];
+                        p[u] = box.min[u] + (box.max[u] - box.min[u]) * a / (samples - 1);
+                        p[v] = box.min[v] + (box.max[v] - box.min[v]) * b / (samples - 1);
+                        glm::vec4 clip = viewProjection * glm::vec4(p, 1.0f);
+                        if (clip.w <= 0.0f || std::fabs(clip.x) > clip.w || std::fabs(clip.y) > clip.w || std::fabs(clip.z) > clip.w)
+                            continue;
+                        bool blocked = false;
+                        for (const AABB& wall : walls)
+                            blocked = blocked || segmentHitsBox(eye, p, wall);
+                        seen = !blocked;
+                    }
+                }
+            }
+            sampledVisible += seen;
+            culledVisible += seen && !kept[i];
+        }
+    }
+
+    bool ok = culledVisible == 0 && occluded > 0;
+    cout << "[occlusion] 3 views x " << boxes.size() << " boxes: " << occluded << " culled, " << sampledVisible
+         << " with a visible sample point, " << culledVisible << " of those culled, " << (ok ? "ok" : "FAILED") << endl;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    vector<pair<string, function<bool()>>> tests = {
+        {"simd", testSimd},
+        {"bvh", testBvh},
+        {"meshnormals", testMeshNormals},
+        {"shapes", testShapes},
+        {"materials", testMaterials},
+        {"objstream", testObjStream},
+        {"floatparse", testFloatParse},
+        {"grid", testSpatialGrid},
+        {"occlusion", testOcclusion},
+    };
+
+    bool ranAny = false, failed = false;
+    for (auto& test : tests) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            if (test.first == argv[i]) selected = true;
+        if (selected) {
+            failed = !test.second() || failed;
+            ranAny = true;
+        }
+    }
+
+    if (!ranAny) {
+        cout << "Available tests:";
+        for (auto& test : tests)
+            cout << " " << test.first;
+        cout << endl;
+        return 1;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+// Instrumentação de CPU por zonas, exportada no formato JSON de trace do Chrome
+// (abre em chrome://tracing ou ui.perfetto.dev).
+//
+//   void drawModel(...) {
+//       TRACE_SCOPE("drawModel");
+//       ...
+//   }
+//
+// Cada thread grava eventos de início/fim num buffer circular próprio (sem locks;
+// só o registro da thread, na primeira vez, usa mutex). O relógio é o rdtsc em x86
+// e o steady_clock nos demais, convertido para microssegundos na exportação.
+// Desligado, TRACE_SCOPE custa uma leitura de bool; com CG_TRACE_DISABLED definido
+// as macros somem por completo. Benchmarks.cpp (benchmark "trace") mede os dois casos.
+//
+// Os exercícios ativam com --trace arquivo.json (ver TraceSession).
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CG_TRACE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CG_TRACE_RDTSC 1
+#endif
+
+struct TraceEvent {
+    const char* name;    // precisa viver até a exportação (literais, __func__)
+    uint64_t ticks;
+    char phase;          // 'B' ou 'E'
+};
+
+class Trace {
+public:
+    static const size_t BufferCapacity = 1 << 16;   // eventos por thread (potência de 2)
+
+    static bool enabled() { return active.load(std::memory_order_relaxed); }
+
+    static void start() {
+        startTicks = now();
+        startTime = std::chrono::steady_clock::now();
+        active.store(true, std::memory_order_relaxed);
+    }
+
+    static void stop() { active.store(false, std::memory_order_relaxed); }
+
+    static uint64_t now() {
+#ifdef CG_TRACE_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    static void record(const char* name, char phase) {
+        ThreadBuffer& buffer = localBuffer();
+        TraceEvent& e = buffer.events[buffer.written & (BufferCapacity - 1)];
+        e.name = name;
+        e.ticks = now();
+        e.phase = phase;
+        ++buffer.written;
+    }
+
+    // Exporta os eventos de todas as threads. As outras threads não devem estar gravando.
+    static bool writeChromeJson(const std::string& path) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Failed to write trace: " << path << std::endl;
+            return false;
+        }
+        double microsPerTick = calibrate();
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        size_t exported = 0, lost = 0;
+        for (const std::unique_ptr<ThreadBuffer>& buffer : buffers) {
+            uint64_t begin = buffer->written > BufferCapacity ? buffer->written - BufferCapacity : 0;
+            lost += (size_t)begin;
+            std::vector<const TraceEvent*> open;
+            uint64_t lastTicks = startTicks;
+            for (uint64_t i = begin; i < buffer->written; ++i) {
+                const TraceEvent& e = buffer->events[i & (BufferCapacity - 1)];
+                if (e.ticks < startTicks) continue;
+                if (e.phase == 'E') {
+                    // O início foi sobrescrito pelo buffer circular (ou gravado antes do start)
+                    if (open.empty()) continue;
+                    open.pop_back();
+                } else {
+                    open.push_back(&e);
+                }
+                writeEvent(out, first, e.name, e.phase, (e.ticks - startTicks) * microsPerTick, buffer->threadId);
+                lastTicks = e.ticks;
+                ++exported;
+            }
+            // Fecha zonas ainda abertas no fim da captura
+            while (!open.empty()) {
+                writeEvent(out, first, open.back()->name, 'E', (lastTicks - startTicks) * microsPerTick, buffer->threadId);
+                open.pop_back();
+            }
+        }
+        out << "\n]}\n";
+        std::cout << "Trace: " << exported << " events from " << buffers.size() << " thread(s) written to " << path;
+        if (lost)
+            std::cout << " (" << lost << " older events overwritten)";
+        std::cout << std::endl;
+        return true;
+    }
+
+private:
+    struct ThreadBuffer {
+        std::unique_ptr<TraceEvent[]> events;
+        uint64_t written = 0;
+        uint32_t threadId = 0;
+    };
+
+    static inline std::atomic<bool> active{false};
+    static inline uint64_t startTicks = 0;
+    static inline std::chrono::steady_clock::time_point startTime;
+    static inline std::mutex registryMutex;
+    static inline std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    static ThreadBuffer& localBuffer() {
+        thread_local ThreadBuffer* buffer = registerThread();
+        return *buffer;
+    }
+
+    static ThreadBuffer* registerThread() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::unique_ptr<ThreadBuffer>(new ThreadBuffer()));
+        ThreadBuffer* buffer = buffers.back().get();
+        buffer->events.reset(new TraceEvent[BufferCapacity]);
+        buffer->threadId = (uint32_t)buffers.size();
+        return buffer;
+    }
+
+    // Microssegundos por tick, medidos entre o start() e agora
+    static double calibrate() {
+#ifdef CG_TRACE_RDTSC
+        uint64_t ticks = now() - startTicks;
+        double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+        return ticks > 0 ? micros / ticks : 0.0;
+#else
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::duration(1)).count();
+#endif
+    }
+
+    static void writeEvent(std::ofstream& out, bool& first, const char* name, char phase, double micros, uint32_t threadId) {
+        out << (first ? "\n" : ",\n") << "{\"name\": \"";
+        for (const char* c = name; *c; ++c) {
+            if (*c == '"' || *c == '\\') out << '\\';
+            out << *c;
+        }
+        out << "\", \"ph\": \"" << phase << "\", \"ts\": " << std::fixed << micros << std::defaultfloat
+            << ", \"pid\": 1, \"tid\": " << threadId << "}";
+        first = false;
+    }
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* zone) : name(Trace::enabled() ? zone : nullptr) {
+        if (name) Trace::record(name, 'B');
+    }
+    ~TraceScope() {
+        if (name) Trace::record(name, 'E');
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+};
+
+// Liga a captura com --trace arquivo.json e grava o arquivo em finish()
+class TraceSession {
+public:
+    TraceSession(int argc, char** argv) {
+        for (int i = 1; i + 1 < argc; ++i)
+            if (std::string(argv[i]) == "--trace")
+                path = argv[i + 1];
+        if (!path.empty())
+            Trace::start();
+    }
+
+    void finish() {
+        if (path.empty()) return;
+        Trace::stop();
+        Trace::writeChromeJson(path);
+        path.clear();
+    }
+
+private:
+    std::string path;
+};
+
+#ifdef CG_TRACE_DISABLED
+#define TRACE_SCOPE(name) ((void)0)
+#else
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#endif
+#define TRACE_FUNCTION() TRACE_SCOPE(__func__)
@@ -0,0 +1,442 @@
+#pragma once
+
+// BVH de triângulos para traçado de raios na CPU (Bvh.h é a de objetos, para culling).
+//
+// Construção por SAH com bins em todos os eixos. Os níveis de cima são divididos em
+// sequência (com o binning dos intervalos grandes repartido entre as threads) até
+// haver subárvores suficientes para ocupar o ThreadPool; cada subárvore é então
+// construída numa thread e as partes são costuradas no vetor final de nós.
+//
+// Travessia de um raio (intersect/occluded) e de pacotes de 4 raios (Simd.h): o pacote
+// visita um nó se qualquer raio ativo acerta a caixa e testa cada triângulo da folha
+// contra os 4 raios de uma vez (Möller-Trumbore). Os triângulos valem dos dois lados,
+// como nos exercícios (sem GL_CULL_FACE). Não depende de OpenGL.
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ObjMesh.h"
+#include "ParallelFor.h"
+#include "Simd.h"
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float tMax = FLT_MAX;
+};
+
+struct RayHit {
+    float t = FLT_MAX;
+    float u = 0.0f, v = 0.0f;   // baricêntricas dos vértices 1 e 2
+    int triangle = -1;          // índice do triângulo na malha original
+};
+
+// 4 raios em SoA; lanes inativas têm tMax negativo
+struct RayPacket4 {
+    float4 ox, oy, oz;
+    float4 dx, dy, dz;
+    float4 tMax;
+};
+
+struct RayHit4 {
+    float4 t, u, v;
+    int triangle[4];
+};
+
+struct TriangleBvhNode {
+    glm::vec3 boundsMin;
+    int leftOrFirst;    // folha: primeiro triângulo; nó interno: filho esquerdo (o direito é o seguinte)
+    glm::vec3 boundsMax;
+    int count;          // folha: nº de triângulos (> 0); nó interno: -eixo da divisão (0, -1 ou -2)
+
+    bool isLeaf() const { return count > 0; }
+};
+
+class TriangleBvh {
+public:
+    static const int SahBins = 16;
+    static const int MaxLeafTriangles = 4;
+    static const int ParallelBinningThreshold = 65536;   // triângulos por intervalo
+
+    // Três vértices por triângulo, como o VBO dos exercícios
+    void build(const std::vector<MeshVertex>& vertices, ThreadPool& pool = ThreadPool::global()) {
+        auto start = std::chrono::steady_clock::now();
+        int count = (int)(vertices.size() / 3);
+        primMin.resize(count);
+        primMax.resize(count);
+        centroids.resize(count);
+        indices.resize(count);
+        nodes.clear();
+        triangles.clear();
+        if (count == 0) {
+            buildTimeMs = 0.0;
+            return;
+        }
+
+        const int chunk = 4096;
+        pool.parallelFor((count + chunk - 1) / chunk, [&](int c, int) {
+            int end = std::min(count, (c + 1) * chunk);
+            for (int i = c * chunk; i < end; ++i) {
+                const glm::vec3& a = vertices[i * 3].position;
+                const glm::vec3& b = vertices[i * 3 + 1].position;
+                const glm::vec3& d = vertices[i * 3 + 2].position;
+                primMin[i] = glm::min(a, glm::min(b, d));
+                primMax[i] = glm::max(a, glm::max(b, d));
+                centroids[i] = (primMin[i] + primMax[i]) * 0.5f;
+                indices[i] = i;
+            }
+        });
+
+        // Fase sequencial: divide até ter algumas subárvores por thread
+        struct Task { int node, begin, end; };
+        std::vector<Task> pending(1, Task{0, 0, count});
+        std::vector<Task> subtrees;
+        int targetSize = std::max(MaxLeafTriangles * 64, count / (pool.threadCount() * 4));
+        nodes.push_back(TriangleBvhNode());
+        while (!pending.empty()) {
+            Task task = pending.back();
+            pending.pop_back();
+            if (task.end - task.begin <= targetSize) {
+                subtrees.push_back(task);
+                continue;
+            }
+            int mid = splitNode(nodes, task.node, task.begin, task.end, &pool);
+            if (mid < 0) continue;
+            int left = nodes[task.node].leftOrFirst;
+            pending.push_back(Task{left, task.begin, mid});
+            pending.push_back(Task{left + 1, mid, task.end});
+        }
+
+        // Fase paralela: cada subárvore num vetor próprio, depois costurado no final
+        std::vector<std::vector<TriangleBvhNode>> local(subtrees.size());
+        pool.parallelFor((int)subtrees.size(), [&](int s, int) {
+            local[s].push_back(TriangleBvhNode());
+            buildRecursive(local[s], 0, subtrees[s].begin, subtrees[s].end);
+        });
+        for (size_t s = 0; s < subtrees.size(); ++s) {
+            // Nó local i (i >= 1) vai para base + i - 1; a raiz substitui o nó reservado
+            int base = (int)nodes.size();
+            for (size_t i = 1; i < local[s].size(); ++i) {
+                TriangleBvhNode node = local[s][i];
+                if (!node.isLeaf()) node.leftOrFirst += base - 1;
+                nodes.push_back(node);
+            }
+            TriangleBvhNode root = local[s][0];
+            if (!root.isLeaf()) root.leftOrFirst += base - 1;
+            nodes[subtrees[s].node] = root;
+        }
+
+        // Triângulos na ordem das folhas, já com as arestas para o teste
+        triangles.resize(count);
+        for (int i = 0; i < count; ++i) {
+            int prim = indices[i];
+            BvhTriangle& tri = triangles[i];
+            tri.v0 = vertices[prim * 3].position;
+            tri.e1 = vertices[prim * 3 + 1].position - tri.v0;
+            tri.e2 = vertices[prim * 3 + 2].position - tri.v0;
+            tri.primitive = prim;
+        }
+        buildTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const std::vector<TriangleBvhNode>& getNodes() const { return nodes; }
+    int triangleCount() const { return (int)triangles.size(); }
+    double lastBuildMs() const { return buildTimeMs; }
+
+    // Interseção mais próxima; com anyHit para no primeiro acerto (raios de sombra)
+    bool intersect(const Ray& ray, RayHit& hit, bool anyHit = false) const {
+        if (nodes.empty()) return false;
+        glm::vec3 invDir = 1.0f / ray.direction;
+        float tMax = ray.tMax;
+        bool found = false;
+        int stack[64];
+        int top = 0;
+        int node = 0;
+        for (;;) {
+            const TriangleBvhNode& n = nodes[node];
+            if (n.isLeaf()) {
+                for (int i = n.leftOrFirst; i < n.leftOrFirst + n.count; ++i) {
+                    float t, u, v;
+                    if (intersectTriangle(triangles[i], ray.origin, ray.direction, tMax, t, u, v)) {
+                        tMax = t;
+                        hit.t = t;
+                        hit.u = u;
+                        hit.v = v;
+                        hit.triangle = triangles[i].primitive;
+                        found = true;
+                        if (anyHit) return true;
+                    }
+                }
+            } else {
+                int left = n.leftOrFirst;
+                float tLeft = slab(nodes[left], ray.origin, invDir, tMax);
+                float tRight = slab(nodes[left + 1], ray.origin, invDir, tMax);
+                if (tLeft != FLT_MAX || tRight != FLT_MAX) {
+                    int nearChild = tLeft <= tRight ? left : left + 1;
+                    int farChild = tLeft <= tRight ? left + 1 : left;
+                    if (std::max(tLeft, tRight) != FLT_MAX)
+                        stack[top++] = farChild;
+                    node = nearChild;
+                    continue;
+                }
+            }
+            if (top == 0) break;
+            node = stack[--top];
+        }
+        return found;
+    }
+
+    bool occluded(const Ray& ray) const {
+        RayHit hit;
+        return intersect(ray, hit, true);
+    }
+
+    // Pacote de 4 raios; com anyHit, lanes que acertam algo saem do pacote (tMax = -1)
+    // e hit.triangle indica qual triângulo bloqueou
+    void intersect(RayPacket4& packet, RayHit4& hit, bool anyHit = false) const {
+        hit.t = float4(FLT_MAX);
+        hit.u = float4(0.0f);
+        hit.v = float4(0.0f);
+        for (int lane = 0; lane < 4; ++lane) hit.triangle[lane] = -1;
+        if (nodes.empty()) return;
+
+        const float4 one(1.0f);
+        float4 invDx = one / packet.dx, invDy = one / packet.dy, invDz = one / packet.dz;
+        // Ordem dos filhos pela direção do primeiro raio (pacotes coerentes)
+        bool negative[3] = {packet.dx[0] < 0.0f, packet.dy[0] < 0.0f, packet.dz[0] < 0.0f};
+        int stack[64];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const TriangleBvhNode& n = nodes[stack[--top]];
+            if (!movemask(slab4(n, packet, invDx, invDy, invDz)))
+                continue;
+            if (n.isLeaf()) {
+                for (int i = n.leftOrFirst; i < n.leftOrFirst + n.count; ++i) {
+                    int bits = intersectTriangle4(triangles[i], packet, hit);
+                    if (!bits) continue;
+                    for (int lane = 0; lane < 4; ++lane)
+                        if (bits & (1 << lane)) hit.triangle[lane] = triangles[i].primitive;
+                    if (anyHit) {
+                        packet.tMax = select(hit.t < float4(FLT_MAX), float4(-1.0f), packet.tMax);
+                        if (!movemask(packet.tMax >= float4(0.0f))) return;
+                    }
+                }
+            } else {
+                int axis = -n.count;
+                int first = negative[axis] ? n.leftOrFirst + 1 : n.leftOrFirst;
+                int second = negative[axis] ? n.leftOrFirst : n.leftOrFirst + 1;
+                stack[top++] = second;
+                stack[top++] = first;
+            }
+        }
+    }
+
+private:
+    struct BvhTriangle {
+        glm::vec3 v0, e1, e2;
+        int primitive;
+    };
+
+    struct Bin {
+        glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+        glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+        int count = 0;
+    };
+
+    std::vector<TriangleBvhNode> nodes;
+    std::vector<BvhTriangle> triangles;
+    std::vector<glm::vec3> primMin, primMax, centroids;
+    std::vector<int> indices;
+    double buildTimeMs = 0.0;
+
+    static float area(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+        glm::vec3 d = boundsMax - boundsMin;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    void binRange(int begin, int end, const glm::vec3& cMin, const glm::vec3& scale, Bin (&bins)[3][SahBins]) const {
+        for (int i = begin; i < end; ++i) {
+            int prim = indices[i];
+            for (int axis = 0; axis < 3; ++axis) {
+                int b = std::min(SahBins - 1, (int)((centroids[prim][axis] - cMin[axis]) * scale[axis]));
+                Bin& bin = bins[axis][b];
+                bin.boundsMin = glm::min(bin.boundsMin, primMin[prim]);
+                bin.boundsMax = glm::max(bin.boundsMax, primMax[prim]);
+                ++bin.count;
+            }
+        }
+    }
+
+    // Calcula a caixa do nó e divide [begin, end) pelo melhor plano SAH.
+    // Retorna o meio da partição, ou -1 se o nó virou folha.
+    int splitNode(std::vector<TriangleBvhNode>& out, int nodeIndex, int begin, int end, ThreadPool* pool) {
+        glm::vec3 bMin(FLT_MAX), bMax(-FLT_MAX), cMin(FLT_MAX), cMax(-FLT_MAX);
+        for (int i = begin; i < end; ++i) {
+            int prim = indices[i];
+            bMin = glm::min(bMin, primMin[prim]);
+            bMax = glm::max(bMax, primMax[prim]);
+            cMin = glm::min(cMin, centroids[prim]);
+            cMax = glm::max(cMax, centroids[prim]);
+        }
+        out[nodeIndex].boundsMin = bMin;
+        out[nodeIndex].boundsMax = bMax;
+        int count = end - begin;
+        auto makeLeaf = [&]() {
+            out[nodeIndex].leftOrFirst = begin;
+            out[nodeIndex].count = count;
+            return -1;
+        };
+        if (count <= MaxLeafTriangles)
+            return makeLeaf();
+
+        glm::vec3 extent = cMax - cMin;
+        glm::vec3 scale;
+        for (int axis = 0; axis < 3; ++axis)
+            scale[axis] = extent[axis] > 0.0f ? SahBins / extent[axis] : 0.0f;
+
+        Bin bins[3][SahBins];
+        if (pool && count >= ParallelBinningThreshold) {
+            const int chunk = 16384;
+            int chunks = (count + chunk - 1) / chunk;
+            std::vector<Bin> partial((size_t)chunks * 3 * SahBins);
+            pool->parallelFor(chunks, [&](int c, int) {
+                Bin local[3][SahBins];
+                binRange(begin + c * chunk, std::min(end, begin + (c + 1) * chunk), cMin, scale, local);
+                std::copy(&local[0][0], &local[0][0] + 3 * SahBins, &partial[(size_t)c * 3 * SahBins]);
+            });
+            for (int c = 0; c < chunks; ++c) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    for (int b = 0; b < SahBins; ++b) {
+                        const Bin& p = partial[((size_t)c * 3 + axis) * SahBins + b];
+                        bins[axis][b].boundsMin = glm::min(bins[axis][b].boundsMin, p.boundsMin);
+                        bins[axis][b].boundsMax = glm::max(bins[axis][b].boundsMax, p.boundsMax);
+                        bins[axis][b].count += p.count;
+                    }
+                }
+            }
+        } else {
+            binRange(begin, end, cMin, scale, bins);
+        }
+
+        // Varredura dos planos: custo = área * triângulos de cada lado
+        float bestCost = FLT_MAX;
+        int bestAxis = -1, bestSplit = -1;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (extent[axis] <= 0.0f) continue;
+            float rightCost[SahBins];
+            glm::vec3 rMin(FLT_MAX), rMax(-FLT_MAX);
+            int rCount = 0;
+            for (int b = SahBins - 1; b > 0; --b) {
+                rMin = glm::min(rMin, bins[axis][b].boundsMin);
+                rMax = glm::max(rMax, bins[axis][b].boundsMax);
+                rCount += bins[axis][b].count;
+                rightCost[b] = rCount ? area(rMin, rMax) * rCount : 0.0f;
+            }
+            glm::vec3 lMin(FLT_MAX), lMax(-FLT_MAX);
+            int lCount = 0;
+            for (int b = 0; b + 1 < SahBins; ++b) {
+                lMin = glm::min(lMin, bins[axis][b].boundsMin);
+                lMax = glm::max(lMax, bins[axis][b].boundsMax);
+                lCount += bins[axis][b].count;
+                if (lCount == 0 || lCount == count) continue;
+                float cost = area(lMin, lMax) * lCount + rightCost[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b + 1;
+                }
+            }
+        }
+        // Custo de folha contra travessia (1) + interseções (1 por triângulo) dos filhos
+        float nodeArea = area(bMin, bMax);
+        if (bestAxis < 0 || (count <= MaxLeafTriangles * 4 && bestCost >= nodeArea * (count - 1)))
+            return makeLeaf();
+
+        float axisMin = cMin[bestAxis], axisScale = scale[bestAxis];
+        int* mid = std::partition(indices.data() + begin, indices.data() + end, [&](int prim) {
+            return std::min(SahBins - 1, (int)((centroids[prim][bestAxis] - axisMin) * axisScale)) < bestSplit;
+        });
+        int left = (int)out.size();
+        out.push_back(TriangleBvhNode());
+        out.push_back(TriangleBvhNode());
+        out[nodeIndex].leftOrFirst = left;
+        out[nodeIndex].count = -bestAxis;
+        return (int)(mid - indices.data());
+    }
+
+    void buildRecursive(std::vector<TriangleBvhNode>& out, int nodeIndex, int begin, int end) {
+        int mid = splitNode(out, nodeIndex, begin, end, nullptr);
+        if (mid < 0) return;
+        int left = out[nodeIndex].leftOrFirst;
+        buildRecursive(out, left, begin, mid);
+        buildRecursive(out, left + 1, mid, end);
+    }
+
+    // Distância de entrada na caixa, ou FLT_MAX se o raio não a acerta antes de tMax
+    static float slab(const TriangleBvhNode& n, const glm::vec3& origin, const glm::vec3& invDir, float tMax) {
+        glm::vec3 t1 = (n.boundsMin - origin) * invDir;
+        glm::vec3 t2 = (n.boundsMax - origin) * invDir;
+        float tNear = std::max(std::max(std::min(t1.x, t2.x), std::min(t1.y, t2.y)), std::min(t1.z, t2.z));
+        float tFar = std::min(std::min(std::max(t1.x, t2.x), std::max(t1.y, t2.y)), std::max(t1.z, t2.z));
+        return tNear <= tFar && tFar >= 0.0f && tNear < tMax ? tNear : FLT_MAX;
+    }
+
+    static float4 slab4(const TriangleBvhNode& n, const RayPacket4& p, float4 invDx, float4 invDy, float4 invDz) {
+        float4 tx1 = (float4(n.boundsMin.x) - p.ox) * invDx, tx2 = (float4(n.boundsMax.x) - p.ox) * invDx;
+        float4 ty1 = (float4(n.boundsMin.y) - p.oy) * invDy, ty2 = (float4(n.boundsMax.y) - p.oy) * invDy;
+        float4 tz1 = (float4(n.boundsMin.z) - p.oz) * invDz, tz2 = (float4(n.boundsMax.z) - p.oz) * invDz;
+        float4 tNear = max(max(min(tx1, tx2), min(ty1, ty2)), min(tz1, tz2));
+        float4 tFar = min(min(max(tx1, tx2), max(ty1, ty2)), max(tz1, tz2));
+        return (tNear <= tFar) & (tFar >= float4(0.0f)) & (tNear < p.tMax);
+    }
+
+    static bool intersectTriangle(const BvhTriangle& tri, const glm::vec3& origin, const glm::vec3& dir, float tMax,
+                                  float& t, float& u, float& v) {
+        const float eps = 1e-8f;
+        glm::vec3 p = glm::cross(dir, tri.e2);
+        float det = glm::dot(tri.e1, p);
+        if (std::fabs(det) < eps) return false;
+        float invDet = 1.0f / det;
+        glm::vec3 s = origin - tri.v0;
+        u = glm::dot(s, p) * invDet;
+        if (u < 0.0f || u > 1.0f) return false;
+        glm::vec3 q = glm::cross(s, tri.e1);
+        v = glm::dot(dir, q) * invDet;
+        if (v < 0.0f || u + v > 1.0f) return false;
+        t = glm::dot(tri.e2, q) * invDet;
+        return t > 1e-5f && t < tMax;
+    }
+
+    // Atualiza t/u/v das lanes que acertam mais perto; devolve a máscara delas
+    static int intersectTriangle4(const BvhTriangle& tri, RayPacket4& p, RayHit4& hit) {
+        const float4 zero(0.0f), one(1.0f);
+        float4 e1x(tri.e1.x), e1y(tri.e1.y), e1z(tri.e1.z);
+        float4 e2x(tri.e2.x), e2y(tri.e2.y), e2z(tri.e2.z);
+        // p = d x e2
+        float4 px = p.dy * e2z - p.dz * e2y, py = p.dz * e2x - p.dx * e2z, pz = p.dx * e2y - p.dy * e2x;
+        float4 det = e1x * px + e1y * py + e1z * pz;
+        float4 invDet = one / det;
+        float4 sx = p.ox - float4(tri.v0.x), sy = p.oy - float4(tri.v0.y), sz = p.oz - float4(tri.v0.z);
+        float4 u = (sx * px + sy * py + sz * pz) * invDet;
+        // q = s x e1
+        float4 qx = sy * e1z - sz * e1y, qy = sz * e1x - sx * e1z, qz = sx * e1y - sy * e1x;
+        float4 v = (p.dx * qx + p.dy * qy + p.dz * qz) * invDet;
+        float4 t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+        float4 mask = (max(det, -det) >= float4(1e-8f)) & (u >= zero) & (v >= zero) & (u + v <= one) &
+                      (t > float4(1e-5f)) & (t < p.tMax);
+        int bits = movemask(mask);
+        if (bits) {
+            p.tMax = select(mask, t, p.tMax);
+            hit.t = select(mask, t, hit.t);
+            hit.u = select(mask, u, hit.u);
+            hit.v = select(mask, v, hit.v);
+        }
+        return bits;
+    }
+};
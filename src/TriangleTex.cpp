@@ -19,6 +19,8 @@ using namespace std;
 // GLFW
 #include <GLFW/glfw3.h>
 
+#include "Headless.h"
+
 // GLM
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -70,10 +72,12 @@ void main()
 })";
 
 // Função MAIN
-int main()
+int main(int argc, char** argv)
 {
+	HeadlessRun headless(argc, argv);
+
 	// Inicialização da GLFW
-	glfwInit();
+	headless.initGlfw();
 
 	// Muita atenção aqui: alguns ambientes não aceitam essas configurações
 	// Você deve adaptar para a versão do OpenGL suportada por sua placa
@@ -89,7 +93,7 @@ int main()
 	// #endif
 
 	// Criação da janela GLFW
-	GLFWwindow *window = glfwCreateWindow(WIDTH, HEIGHT, "Ola Triangulo Texturizado!", nullptr, nullptr);
+	GLFWwindow *window = headless.createWindow(WIDTH, HEIGHT, "Ola Triangulo Texturizado!");
 	glfwMakeContextCurrent(window);
 
 	// Fazendo o registro da função de callback para a janela GLFW
@@ -101,6 +105,8 @@ int main()
 		std::cout << "Failed to initialize GLAD" << std::endl;
 	}
 
+	headless.setupFramebuffer();
+
 	// Obtendo as informações de versão
 	const GLubyte *renderer = glGetString(GL_RENDERER); /* get renderer string */
 	const GLubyte *version = glGetString(GL_VERSION);	/* version as a string */
@@ -166,10 +172,12 @@ int main()
 
 		// Troca os buffers da tela
 		glfwSwapBuffers(window);
+		headless.endFrame(window);
 	}
 	// Pede pra OpenGL desalocar os buffers
 	glDeleteVertexArrays(1, &VAO);
 	// Finaliza a execução da GLFW, limpando os recursos alocados por ela
+	headless.finish();
 	glfwTerminate();
 	return 0;
 }